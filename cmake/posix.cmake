@@ -163,6 +163,8 @@ check_symbol_exists(F_FULLFSYNC fcntl.h HAVE_FULLFSYNC)
 
 check_function_exists(getopt_long HAVE_GETOPT_LONG)
 check_function_exists(fdatasync HAVE_FDATASYNC) 
+check_symbol_exists(pwritev sys/uio.h HAVE_PWRITEV)
+check_function_exists(copy_file_range HAVE_COPY_FILE_RANGE)
 
 set(SIGCHLD_HANDLER 1)
 
@@ -891,6 +891,33 @@ void Connection::ReadBuffer(char** buffer, int *bufLen)
 	m_bufAvail = 0;
 }
 
+/*
+ * Puts data back in front of the read buffer, the next call to ReadLine or
+ * ReadBuffer returns it first. Used on pipelined connections to return bytes
+ * belonging to the next response which were received together with the
+ * current one.
+ */
+void Connection::UnreadBuffer(const char* buffer, int bufLen)
+{
+	if (bufLen <= 0)
+	{
+		return;
+	}
+
+	int offset = m_bufAvail > 0 ? (int)(m_bufPtr - m_readBuf) : 0;
+	int total = bufLen + m_bufAvail;
+	if (total + 1 > m_readBuf.Size())
+	{
+		m_readBuf.Reserve(total + 1);
+	}
+
+	memmove(m_readBuf + bufLen, m_readBuf + offset, m_bufAvail);
+	memcpy(m_readBuf, buffer, bufLen);
+	m_readBuf[total] = '\0';
+	m_bufPtr = m_readBuf;
+	m_bufAvail = total;
+}
+
 void Connection::Cancel()
 {
 	debug("Cancelling connection");
@@ -1144,6 +1171,17 @@ int Connection::FetchTotalBytesRead()
 	return total;
 }
 
+bool Connection::HasBufferedData()
+{
+#ifndef DISABLE_TLS
+	if (m_tlsSocket && m_tlsSocket->Pending() > 0)
+	{
+		return true;
+	}
+#endif
+	return m_bufAvail > 0;
+}
+
 
 #ifdef ANDROID_RESOLVE
 
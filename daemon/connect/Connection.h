@@ -62,6 +62,7 @@ public:
 	int TryRecv(char* buffer, int size);
 	char* ReadLine(char* buffer, int size, int* bytesRead);
 	void ReadBuffer(char** buffer, int *bufLen);
+	void UnreadBuffer(const char* buffer, int bufLen);
 	int WriteLine(const char* buffer);
 	std::unique_ptr<Connection> Accept();
 	void Cancel();
@@ -84,6 +85,9 @@ public:
 	void SetCertVerifLevel(unsigned int level) { m_certVerifLevel = level; }
 #endif
 	int FetchTotalBytesRead();
+	SOCKET GetSocket() { return m_socket; }
+	// received data which was not yet consumed by Recv/ReadLine, no need to wait for the socket
+	bool HasBufferedData();
 
 protected:
 	std::string m_host;
@@ -332,4 +332,9 @@ int TlsSocket::Recv(char* buffer, int size)
 	return m_retCode;
 }
 
+int TlsSocket::Pending()
+{
+	return m_session ? SSL_pending(m_session.get()) : 0;
+}
+
 #endif
@@ -57,6 +57,8 @@ public:
 	void Close();
 	int Send(const char* buffer, int size);
 	int Recv(char* buffer, int size);
+	// number of decrypted bytes available for Recv without reading the socket
+	int Pending();
 	void SetSuppressErrors(bool suppressErrors) { m_suppressErrors = suppressErrors; }
 
 protected:
@@ -69,6 +69,7 @@ private:
 	NzbInfo::EMarkStatus m_markStatus;
 
 	void PrepareParams(const char* scriptName);
+	void SetHistoryChanged(DownloadQueue* downloadQueue);
 };
 
 
@@ -179,6 +180,20 @@ void QueueScriptController::PrepareParams(const char* scriptName)
 	PrepareEnvScript(&m_parameters, scriptName);
 }
 
+/*
+ * Commands of scripts processing history items modify them in place,
+ * history items must be marked to be saved again.
+ */
+void QueueScriptController::SetHistoryChanged(DownloadQueue* downloadQueue)
+{
+	HistoryInfo* historyInfo = downloadQueue->GetHistory()->Find(m_id);
+	if (historyInfo)
+	{
+		historyInfo->SetChanged(true);
+		downloadQueue->HistoryChanged();
+	}
+}
+
 void QueueScriptController::AddMessage(Message::EKind kind, const char* text)
 {
 	const char* msgText = text + m_prefixLen;
@@ -198,6 +213,7 @@ void QueueScriptController::AddMessage(Message::EKind kind, const char* text)
 				if (nzbInfo)
 				{
 					nzbInfo->GetParameters()->SetParameter(param, value + 1);
+					SetHistoryChanged(downloadQueue);
 				}
 			}
 			else
@@ -213,6 +229,7 @@ void QueueScriptController::AddMessage(Message::EKind kind, const char* text)
 			if (nzbInfo)
 			{
 				nzbInfo->SetFinalDir(msgText + 6 + 10);
+				SetHistoryChanged(downloadQueue);
 			}
 		}
 		else if (!strncmp(msgText + 6, "MARK=BAD", 8))
@@ -224,6 +241,7 @@ void QueueScriptController::AddMessage(Message::EKind kind, const char* text)
 			{
 				nzbInfo->PrintMessage(Message::mkWarning, "Marking %s as bad", *m_nzbName);
 				nzbInfo->SetMarkStatus(NzbInfo::ksBad);
+				SetHistoryChanged(downloadQueue);
 			}
 		}
 		else
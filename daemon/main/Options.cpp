@@ -313,8 +313,11 @@ void Options::InitDefaults()
 	SetOption(AUTHORIZEDIP.data(), "");
 	SetOption(ARTICLETIMEOUT.data(), "60");
 	SetOption(ARTICLEREADCHUNKSIZE.data(), "4");
+	SetOption(DOWNLOADTHREADPOOL.data(), "no");
 	SetOption(URLTIMEOUT.data(), "60");
 	SetOption(REMOTETIMEOUT.data(), "90");
+	SetOption(REMOTETHREADS.data(), "10");
+	SetOption(REMOTEEVENTINTERVAL.data(), "1000");
 	SetOption(FLUSHQUEUE.data(), "yes");
 	SetOption(SYSTEMHEALTHCHECK.data(), "yes");
 	SetOption(NZBLOG.data(), "yes");
@@ -337,6 +340,9 @@ void Options::InitDefaults()
 	SetOption(PARSCAN.data(), "extended");
 	SetOption(PARQUICK.data(), "yes");
 	SetOption(POSTSTRATEGY.data(), "sequential");
+	SetOption(POSTREPAIRLIMIT.data(), "1");
+	SetOption(POSTDISKLIMIT.data(), "1");
+	SetOption(POSTSCRIPTLIMIT.data(), "2");
 	SetOption(FILENAMING.data(), "article");
 	SetOption(RENAMEAFTERUNPACK.data(), "yes");
 	SetOption(RENAMEIGNOREEXT.data(), ".zip, .7z, .rar, .par2");
@@ -358,9 +364,11 @@ void Options::InitDefaults()
 	SetOption(CURSESGROUP.data(), "no");
 	SetOption(CRCCHECK.data(), "yes");
 	SetOption(DIRECTWRITE.data(), "yes");
+	SetOption(DIRECTWRITETHREADS.data(), "0");
 	SetOption(WRITEBUFFER.data(), "0");
 	SetOption(NZBDIRINTERVAL.data(), "5");
 	SetOption(NZBDIRFILEAGE.data(), "60");
+	SetOption(NZBDIRWATCH.data(), "yes");
 	SetOption(DISKSPACE.data(), "250");
 	SetOption(CRASHTRACE.data(), "no");
 	SetOption(CRASHDUMP.data(), "no");
@@ -390,6 +398,8 @@ void Options::InitDefaults()
 	SetOption(TIMECORRECTION.data(), "0");
 	SetOption(PROPAGATIONDELAY.data(), "0");
 	SetOption(ARTICLECACHE.data(), "0");
+	SetOption(ARTICLECACHEHUGEPAGES.data(), "no");
+	SetOption(ARTICLECACHEFLUSHTHREADS.data(), "1");
 	SetOption(EVENTINTERVAL.data(), "0");
 	SetOption(SHELLOVERRIDE.data(), "");
 	SetOption(MONTHLYQUOTA.data(), "0");
@@ -604,6 +614,8 @@ void Options::InitOptions()
 	m_articleReadChunkSize  = ParseIntValue(ARTICLEREADCHUNKSIZE.data(), 10) * 1024;
 	m_urlTimeout			= ParseIntValue(URLTIMEOUT.data(), 10);
 	m_remoteTimeout			= ParseIntValue(REMOTETIMEOUT.data(), 10);
+	m_remoteThreads			= ParseIntValue(REMOTETHREADS.data(), 10);
+	m_remoteEventInterval	= ParseIntValue(REMOTEEVENTINTERVAL.data(), 10);
 	m_articleRetries		= ParseIntValue(ARTICLERETRIES.data(), 10);
 	m_articleInterval		= ParseIntValue(ARTICLEINTERVAL.data(), 10);
 	m_urlRetries			= ParseIntValue(URLRETRIES.data(), 10);
@@ -630,9 +642,14 @@ void Options::InitOptions()
 	m_timeCorrection *= 60;
 	m_propagationDelay		= ParseIntValue(PROPAGATIONDELAY.data(), 10) * 60;
 	m_articleCache			= ParseIntValue(ARTICLECACHE.data(), 10);
+	m_articleCacheFlushThreads = ParseIntValue(ARTICLECACHEFLUSHTHREADS.data(), 10);
+	m_directWriteThreads	= ParseIntValue(DIRECTWRITETHREADS.data(), 10);
 	m_eventInterval			= ParseIntValue(EVENTINTERVAL.data(), 10);
 	m_parBuffer				= ParseIntValue(PARBUFFER.data(), 10);
 	m_parThreads			= ParseIntValue(PARTHREADS.data(), 10);
+	m_postRepairLimit		= ParseIntValue(POSTREPAIRLIMIT.data(), 10);
+	m_postDiskLimit			= ParseIntValue(POSTDISKLIMIT.data(), 10);
+	m_postScriptLimit		= ParseIntValue(POSTSCRIPTLIMIT.data(), 10);
 	m_monthlyQuota			= ParseIntValue(MONTHLYQUOTA.data(), 10);
 	m_quotaStartDay			= ParseIntValue(QUOTASTARTDAY.data(), 10);
 	m_dailyQuota			= ParseIntValue(DAILYQUOTA.data(), 10);
@@ -655,6 +672,7 @@ void Options::InitOptions()
 	m_cursesGroup			= (bool)ParseEnumValue(CURSESGROUP.data(), BoolCount, BoolNames, BoolValues);
 	m_crcCheck				= (bool)ParseEnumValue(CRCCHECK.data(), BoolCount, BoolNames, BoolValues);
 	m_directWrite			= (bool)ParseEnumValue(DIRECTWRITE.data(), BoolCount, BoolNames, BoolValues);
+	m_articleCacheHugePages	= (bool)ParseEnumValue(ARTICLECACHEHUGEPAGES.data(), BoolCount, BoolNames, BoolValues);
 	m_rawArticle			= (bool)ParseEnumValue(RAWARTICLE.data(), BoolCount, BoolNames, BoolValues);
 	m_skipWrite				= (bool)ParseEnumValue(SKIPWRITE.data(), BoolCount, BoolNames, BoolValues);
 	m_crashTrace			= (bool)ParseEnumValue(CRASHTRACE.data(), BoolCount, BoolNames, BoolValues);
@@ -673,6 +691,8 @@ void Options::InitOptions()
 	m_certCheck				= (bool)ParseEnumValue(CERTCHECK.data(), BoolCount, BoolNames, BoolValues);
 	m_reorderFiles			= (bool)ParseEnumValue(REORDERFILES.data(), BoolCount, BoolNames, BoolValues);
 	m_renameAfterUnpack     = (bool)ParseEnumValue(RENAMEAFTERUNPACK.data(), BoolCount, BoolNames, BoolValues);
+	m_downloadThreadPool	= (bool)ParseEnumValue(DOWNLOADTHREADPOOL.data(), BoolCount, BoolNames, BoolValues);
+	m_nzbDirWatch			= (bool)ParseEnumValue(NZBDIRWATCH.data(), BoolCount, BoolNames, BoolValues);
 
 	const char* OutputModeNames[] = { "loggable", "logable", "log", "colored", "color", "ncurses", "curses" };
 	const int OutputModeValues[] = { omLoggable, omLoggable, omLoggable, omColored, omColored, omNCurses, omNCurses };
@@ -689,9 +709,9 @@ void Options::InitOptions()
 	const int ParScanCount = 4;
 	m_parScan = (EParScan)ParseEnumValue(PARSCAN.data(), ParScanCount, ParScanNames, ParScanValues);
 
-	const char* PostStrategyNames[] = { "sequential", "balanced", "aggressive", "rocket" };
-	const int PostStrategyValues[] = { ppSequential, ppBalanced, ppAggressive, ppRocket };
-	const int PostStrategyCount = 4;
+	const char* PostStrategyNames[] = { "sequential", "balanced", "aggressive", "rocket", "pipeline" };
+	const int PostStrategyValues[] = { ppSequential, ppBalanced, ppAggressive, ppRocket, ppPipeline };
+	const int PostStrategyCount = 5;
 	m_postStrategy = (EPostStrategy)ParseEnumValue(POSTSTRATEGY.data(), PostStrategyCount, PostStrategyNames, PostStrategyValues);
 
 	const char* FileNamingNames[] = { "auto", "article", "nzb" };
@@ -1009,9 +1029,21 @@ void Options::InitServers()
 		const char* ncipher = GetOption(BString<100>("Server%i.Cipher", n));
 		const char* nconnections = GetOption(BString<100>("Server%i.Connections", n));
 		const char* nretention = GetOption(BString<100>("Server%i.Retention", n));
+		const char* npipelining = GetOption(BString<100>("Server%i.Pipelining", n));
+		int pipelining = 1;
+		if (npipelining)
+		{
+			pipelining = ParseIntValue(BString<100>("Server%i.Pipelining", n), 10);
+			if (pipelining < 1 || pipelining > 100)
+			{
+				ConfigError("Invalid value for option \"Server%i.Pipelining\": %i. Changed to 1", n, pipelining);
+				pipelining = 1;
+			}
+		}
 
 		bool definition = nactive || nname || nlevel || ngroup || nhost || nport || noptional ||
-			nusername || npassword || nconnections || njoingroup || ntls || ncipher || nretention;
+			nusername || npassword || nconnections || njoingroup || ntls || ncipher || nretention ||
+			npipelining;
 		bool completed = nhost && nport && nconnections;
 
 		if (!definition)
@@ -1033,7 +1065,7 @@ void Options::InitServers()
 					nretention ? atoi(nretention) : 0,
 					nlevel ? atoi(nlevel) : 0,
 					ngroup ? atoi(ngroup) : 0,
-					optional, certveriflevel);
+					optional, certveriflevel, pipelining);
 			}
 		}
 		else
@@ -1540,7 +1572,7 @@ bool Options::ValidateOptionName(const char* optname, const char* optvalue)
 			!strcasecmp(p, ".cipher") || !strcasecmp(p, ".group") ||
 			!strcasecmp(p, ".retention") || !strcasecmp(p, ".optional") ||
 			!strcasecmp(p, ".notes") || !strcasecmp(p, ".ipversion") ||
-			!strcasecmp(p, ".certverification")))
+			!strcasecmp(p, ".certverification") || !strcasecmp(p, ".pipelining")))
 		{
 			return true;
 		}
@@ -1850,6 +1882,46 @@ void Options::CheckOptions()
 		m_parBuffer = 400;
 	}
 
+	if (m_articleCacheFlushThreads < 1)
+	{
+		ConfigError("Invalid value for option \"ArticleCacheFlushThreads\": %i. Changed to 1", m_articleCacheFlushThreads);
+		m_articleCacheFlushThreads = 1;
+	}
+	else if (m_articleCacheFlushThreads > 16)
+	{
+		ConfigError("Invalid value for option \"ArticleCacheFlushThreads\": %i. Changed to 16", m_articleCacheFlushThreads);
+		m_articleCacheFlushThreads = 16;
+	}
+
+	if (m_directWriteThreads < 0)
+	{
+		ConfigError("Invalid value for option \"DirectWriteThreads\": %i. Changed to 0", m_directWriteThreads);
+		m_directWriteThreads = 0;
+	}
+	else if (m_directWriteThreads > 16)
+	{
+		ConfigError("Invalid value for option \"DirectWriteThreads\": %i. Changed to 16", m_directWriteThreads);
+		m_directWriteThreads = 16;
+	}
+
+	if (m_postRepairLimit < 1)
+	{
+		ConfigError("Invalid value for option \"PostRepairLimit\": %i. Changed to 1", m_postRepairLimit);
+		m_postRepairLimit = 1;
+	}
+
+	if (m_postDiskLimit < 1)
+	{
+		ConfigError("Invalid value for option \"PostDiskLimit\": %i. Changed to 1", m_postDiskLimit);
+		m_postDiskLimit = 1;
+	}
+
+	if (m_postScriptLimit < 1)
+	{
+		ConfigError("Invalid value for option \"PostScriptLimit\": %i. Changed to 1", m_postScriptLimit);
+		m_postScriptLimit = 1;
+	}
+
 	if (!m_unpackPassFile.Empty() && !FileSystem::FileExists(m_unpackPassFile))
 	{
 		ConfigError("Invalid value for option \"UnpackPassFile\": %s. File not found", *m_unpackPassFile);
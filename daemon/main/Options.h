@@ -74,8 +74,11 @@ public:
 	static constexpr std::string_view AUTHORIZEDIP = "AuthorizedIP";
 	static constexpr std::string_view ARTICLETIMEOUT = "ArticleTimeout";
 	static constexpr std::string_view ARTICLEREADCHUNKSIZE = "ArticleReadChunkSize";
+	static constexpr std::string_view DOWNLOADTHREADPOOL = "DownloadThreadPool";
 	static constexpr std::string_view URLTIMEOUT = "UrlTimeout";
 	static constexpr std::string_view REMOTETIMEOUT = "RemoteTimeout";
+	static constexpr std::string_view REMOTETHREADS = "RemoteThreads";
+	static constexpr std::string_view REMOTEEVENTINTERVAL = "RemoteEventInterval";
 	static constexpr std::string_view FLUSHQUEUE = "FlushQueue";
 	static constexpr std::string_view SYSTEMHEALTHCHECK = "SystemHealthCheck";
 	static constexpr std::string_view NZBLOG = "NzbLog";
@@ -98,6 +101,9 @@ public:
 	static constexpr std::string_view PARSCAN = "ParScan";
 	static constexpr std::string_view PARQUICK = "ParQuick";
 	static constexpr std::string_view POSTSTRATEGY = "PostStrategy";
+	static constexpr std::string_view POSTREPAIRLIMIT = "PostRepairLimit";
+	static constexpr std::string_view POSTDISKLIMIT = "PostDiskLimit";
+	static constexpr std::string_view POSTSCRIPTLIMIT = "PostScriptLimit";
 	static constexpr std::string_view FILENAMING = "FileNaming";
 	static constexpr std::string_view RENAMEAFTERUNPACK = "RenameAfterUnpack";
 	static constexpr std::string_view RENAMEIGNOREEXT = "RenameIgnoreExt";
@@ -116,9 +122,11 @@ public:
 	static constexpr std::string_view CURSESGROUP = "CursesGroup";
 	static constexpr std::string_view CRCCHECK = "CrcCheck";
 	static constexpr std::string_view DIRECTWRITE = "DirectWrite";
+	static constexpr std::string_view DIRECTWRITETHREADS = "DirectWriteThreads";
 	static constexpr std::string_view WRITEBUFFER = "WriteBuffer";
 	static constexpr std::string_view NZBDIRINTERVAL = "NzbDirInterval";
 	static constexpr std::string_view NZBDIRFILEAGE = "NzbDirFileAge";
+	static constexpr std::string_view NZBDIRWATCH = "NzbDirWatch";
 	static constexpr std::string_view DISKSPACE = "DiskSpace";
 	static constexpr std::string_view CRASHTRACE = "CrashTrace";
 	static constexpr std::string_view CRASHDUMP = "CrashDump";
@@ -145,6 +153,8 @@ public:
 	static constexpr std::string_view TIMECORRECTION = "TimeCorrection";
 	static constexpr std::string_view PROPAGATIONDELAY = "PropagationDelay";
 	static constexpr std::string_view ARTICLECACHE = "ArticleCache";
+	static constexpr std::string_view ARTICLECACHEHUGEPAGES = "ArticleCacheHugePages";
+	static constexpr std::string_view ARTICLECACHEFLUSHTHREADS = "ArticleCacheFlushThreads";
 	static constexpr std::string_view EVENTINTERVAL = "EventInterval";
 	static constexpr std::string_view SHELLOVERRIDE = "ShellOverride";
 	static constexpr std::string_view MONTHLYQUOTA = "MonthlyQuota";
@@ -247,7 +257,8 @@ public:
 		ppSequential,
 		ppBalanced,
 		ppAggressive,
-		ppRocket
+		ppRocket,
+		ppPipeline
 	};
 	enum EFileNaming
 	{
@@ -343,7 +354,7 @@ public:
 		virtual void AddNewsServer(int id, bool active, const char* name, const char* host,
 			int port, int ipVersion, const char* user, const char* pass, bool joinGroup,
 			bool tls, const char* cipher, int maxConnections, int retention,
-			int level, int group, bool optional, unsigned int certVerificationfLevel) = 0;
+			int level, int group, bool optional, unsigned int certVerificationfLevel, int pipelining) = 0;
 		virtual void AddFeed(
 			[[maybe_unused]] int id,
 			[[maybe_unused]] const char* name,
@@ -398,8 +409,11 @@ public:
 	EMessageTarget GetDetailTarget() const { return m_detailTarget; }
 	int GetArticleTimeout() const { return m_articleTimeout; }
 	int GetArticleReadChunkSize() const { return m_articleReadChunkSize; }
+	bool GetDownloadThreadPool() const { return m_downloadThreadPool; }
 	int GetUrlTimeout() const { return m_urlTimeout; }
 	int GetRemoteTimeout() const { return m_remoteTimeout; }
+	int GetRemoteThreads() const { return m_remoteThreads; }
+	int GetRemoteEventInterval() const { return m_remoteEventInterval; }
 	bool GetRawArticle() const { return m_rawArticle; }
 	bool GetSkipWrite() const { return m_skipWrite; }
 	bool GetAppendCategoryDir() const { return m_appendCategoryDir; }
@@ -439,6 +453,9 @@ public:
 	EParScan GetParScan() const { return m_parScan; }
 	bool GetParQuick() const { return m_parQuick; }
 	EPostStrategy GetPostStrategy() const { return m_postStrategy; }
+	int GetPostRepairLimit() const { return m_postRepairLimit; }
+	int GetPostDiskLimit() const { return m_postDiskLimit; }
+	int GetPostScriptLimit() const { return m_postScriptLimit; }
 	bool GetParRename() const { return m_parRename; }
 	int GetParBuffer() const { return m_parBuffer; }
 	int GetParThreads() const { return m_parThreads; }
@@ -453,9 +470,11 @@ public:
 	bool GetCursesGroup() const { return m_cursesGroup; }
 	bool GetCrcCheck() const { return m_crcCheck; }
 	bool GetDirectWrite() const { return m_directWrite; }
+	int GetDirectWriteThreads() const { return m_directWriteThreads; }
 	int GetWriteBuffer() const { return m_writeBuffer; }
 	int GetNzbDirInterval() const { return m_nzbDirInterval; }
 	int GetNzbDirFileAge() const { return m_nzbDirFileAge; }
+	bool GetNzbDirWatch() const { return m_nzbDirWatch; }
 	int GetDiskSpace() const { return m_diskSpace; }
 	bool GetTls() const { return m_tls; }
 	bool GetCrashTrace() const { return m_crashTrace; }
@@ -483,6 +502,8 @@ public:
 	int GetTimeCorrection() const { return m_timeCorrection; }
 	int GetPropagationDelay() const { return m_propagationDelay; }
 	int GetArticleCache() const { return m_articleCache; }
+	bool GetArticleCacheHugePages() const { return m_articleCacheHugePages; }
+	int GetArticleCacheFlushThreads() const { return m_articleCacheFlushThreads; }
 	int GetEventInterval() const { return m_eventInterval; }
 	const std::string& GetShellOverride() const { return m_shellOverride; }
 	int GetMonthlyQuota() const { return m_monthlyQuota; }
@@ -584,8 +605,11 @@ private:
 	bool m_systemHealthCheck = true;
 	int m_articleTimeout = 0;
 	int m_articleReadChunkSize = 4;
+	bool m_downloadThreadPool = false;
 	int m_urlTimeout = 0;
 	int m_remoteTimeout = 0;
+	int m_remoteThreads = 10;
+	int m_remoteEventInterval = 1000;
 	bool m_appendCategoryDir = false;
 	bool m_continuePartial = false;
 	int m_articleRetries = 0;
@@ -623,6 +647,9 @@ private:
 	EParScan m_parScan = psLimited;
 	bool m_parQuick = true;
 	EPostStrategy m_postStrategy = ppSequential;
+	int m_postRepairLimit = 1;
+	int m_postDiskLimit = 1;
+	int m_postScriptLimit = 2;
 	bool m_parRename = false;
 	int m_parBuffer = 0;
 	int m_parThreads = 0;
@@ -640,9 +667,11 @@ private:
 	bool m_cursesGroup = false;
 	bool m_crcCheck = false;
 	bool m_directWrite = false;
+	int m_directWriteThreads = 0;
 	int m_writeBuffer = 0;
 	int m_nzbDirInterval = 0;
 	int m_nzbDirFileAge = 0;
+	bool m_nzbDirWatch = false;
 	int m_diskSpace = 0;
 	bool m_tls = false;
 	bool m_crashTrace = false;
@@ -668,6 +697,8 @@ private:
 	int m_timeCorrection = 0;
 	int m_propagationDelay = 0;
 	int m_articleCache = 0;
+	bool m_articleCacheHugePages = false;
+	int m_articleCacheFlushThreads = 1;
 	int m_eventInterval = 0;
 	std::string m_shellOverride;
 	int m_monthlyQuota = 0;
@@ -186,7 +186,7 @@ public:
 	void AddNewsServer(int id, bool active, const char* name, const char* host,
 		int port, int ipVersion, const char* user, const char* pass, bool joinGroup,
 		bool tls, const char* cipher, int maxConnections, int retention,
-		int level, int group, bool optional, unsigned int certVerificationfLevel) override;
+		int level, int group, bool optional, unsigned int certVerificationfLevel, int pipelining) override;
 	void AddFeed(int id, const char* name, const char* url, int interval,
 		const char* filter, bool backlog, bool pauseNzb, const char* category,
 		FeedInfo::CategorySource categorySource, int priority, const char* feedScript) override;
@@ -723,6 +723,10 @@ void NZBGet::DoMainLoop()
 	{
 		m_articleCache->Start();
 	}
+	if (m_options->GetDirectWrite() && m_options->GetDirectWriteThreads() > 0)
+	{
+		m_articleCache->StartAsyncWrite(m_options->GetDirectWriteThreads());
+	}
 
 	// enter main program-loop
 	while (m_queueCoordinator->IsRunning() ||
@@ -776,6 +780,9 @@ void NZBGet::DoMainLoop()
 		}
 	}
 
+	// complete articles still waiting to be written
+	m_articleCache->StopAsyncWrite();
+
 	debug("Main program loop terminated");
 }
 
@@ -1082,10 +1089,10 @@ void NZBGet::Daemonize()
 void NZBGet::AddNewsServer(int id, bool active, const char* name, const char* host,
 	int port, int ipVersion, const char* user, const char* pass, bool joinGroup, bool tls,
 	const char* cipher, int maxConnections, int retention, int level, int group, bool optional,
-	unsigned int certVerificationfLevel)
+	unsigned int certVerificationfLevel, int pipelining)
 {
 	m_serverPool->AddServer(std::make_unique<NewsServer>(id, active, name, host, port, ipVersion, user, pass, joinGroup,
-		tls, cipher, maxConnections, retention, level, group, optional, certVerificationfLevel));
+		tls, cipher, maxConnections, retention, level, group, optional, certVerificationfLevel, pipelining));
 }
 
 void NZBGet::AddFeed(int id, const char* name, const char* url, int interval, const char* filter,
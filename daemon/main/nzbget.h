@@ -112,8 +112,13 @@
 #include <arpa/inet.h>
 #include <netinet/in.h>
 #include <dirent.h>
+#include <poll.h>
 
-#ifndef __linux__
+#ifdef __linux__
+#include <sys/epoll.h>
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#else
 #include <sys/sysctl.h>
 #endif
 
@@ -102,6 +102,20 @@ void ArticleDownloader::Run()
 		SetStatus(adWaiting);
 		while (!m_connection && !(IsStopped() || serverConfigGeneration != g_ServerPool->GetGeneration()))
 		{
+			if (m_pipeline)
+			{
+				// pipelined download: wait for the previous downloader in the chain to pass the connection
+				if (!m_pipeline->Wait(this, &m_connection))
+				{
+					LeavePipeline();
+				}
+				else if (m_connection)
+				{
+					m_pipelineRequested = true;
+					m_pipelineFollower = true;
+				}
+				continue;
+			}
 			m_connection = g_ServerPool->GetConnection(level, wantServer, &failedServers);
 			Util::Sleep(5);
 		}
@@ -201,6 +215,11 @@ void ArticleDownloader::Run()
 		if (connected && status == adFailed && remainedRetries > 0 && !retentionFailure)
 		{
 			wantServer = lastServer;
+			if (m_pipeline)
+			{
+				// the connection belongs to the pipeline, retry with a connection from the pool
+				FreeConnection(true);
+			}
 		}
 		else
 		{
@@ -278,6 +297,7 @@ void ArticleDownloader::Run()
 	}
 
 	FreeConnection(status == adFinished);
+	LeavePipeline();
 
 	if (m_articleWriter.GetDuplicate())
 	{
@@ -321,9 +341,9 @@ ArticleDownloader::EStatus ArticleDownloader::Download()
 	if (m_connection->GetNewsServer()->GetJoinGroup())
 	{
 		// change group
-		for (CString& group : m_fileInfo->GetGroups())
+		for (auto& group : *m_fileInfo->GetGroups())
 		{
-			response = m_connection->JoinGroup(group);
+			response = m_connection->JoinGroup(group->c_str());
 			if (response && !strncmp(response, "2", 1))
 			{
 				break;
@@ -338,12 +358,39 @@ ArticleDownloader::EStatus ArticleDownloader::Download()
 	}
 
 	// retrieve article
-	response = m_connection->Request(BString<1024>("%s %s\r\n",
-		g_Options->GetRawArticle() ? "ARTICLE" : "BODY", m_articleInfo->GetMessageId()));
+	m_pipelineSynced = false;
+	if (m_pipeline && !m_pipelineRequested)
+	{
+		m_pipelineRequested = m_pipeline->SendRequests(this, m_connection);
+	}
+
+	if (m_pipelineRequested)
+	{
+		// the request was sent together with other requests of the pipeline
+		response = m_connection->ReadResponse();
+	}
+	else
+	{
+		response = m_connection->Request(BString<1024>("%s %s\r\n",
+			g_Options->GetRawArticle() ? "ARTICLE" : "BODY", m_articleInfo->GetMessageId()));
+	}
+
+	if (m_pipelineFollower && !IsStopped() && (!response || response[0] < '1' || response[0] > '5'))
+	{
+		detail("Article %s @ %s failed: invalid response to pipelined request", *m_infoName, *m_connectionName);
+		if (m_connection->GetNewsServer()->DisablePipelining("server does not handle pipelined requests properly"))
+		{
+			// the limit of running downloads depends on pipelining depth
+			g_ServerPool->PipeliningChanged();
+		}
+		return adFailed;
+	}
 
 	status = CheckResponse(response, "could not fetch article");
 	if (status != adFinished)
 	{
+		// single line response, the connection can be used for further requests
+		m_pipelineSynced = response != nullptr;
 		return status;
 	}
 
@@ -393,8 +440,18 @@ ArticleDownloader::EStatus ArticleDownloader::Download()
 			AddServerStats();
 		}
 
-		// decode article data
-		len = m_decoder.DecodeBuffer(buffer, len);
+		// decode article data; once the output is known to go into the article cache
+		// the decoder writes directly into the cache segment
+		char* outbuf = m_writingStarted ? m_articleWriter.GetDecodeBuffer(len) : nullptr;
+		if (outbuf)
+		{
+			len = m_decoder.DecodeBuffer(buffer, len, outbuf);
+			buffer = outbuf;
+		}
+		else
+		{
+			len = m_decoder.DecodeBuffer(buffer, len);
+		}
 
 		// write to output file
 		if (len > 0 && !Write(buffer, len))
@@ -404,6 +461,16 @@ ArticleDownloader::EStatus ArticleDownloader::Download()
 		}
 	}
 
+	if (m_decoder.GetEof())
+	{
+		m_pipelineSynced = true;
+		if (m_pipelineRequested)
+		{
+			// data received after the end of article belongs to the next pipelined response
+			m_connection->UnreadBuffer(m_decoder.GetTrailingData(), m_decoder.GetTrailingLength());
+		}
+	}
+
 	if (IsStopped())
 	{
 		status = adFailed;
@@ -496,6 +563,9 @@ bool ArticleDownloader::Write(char* buffer, int len)
 			return false;
 		}
 		m_writingStarted = true;
+
+		// position of article in file is known only for yEnc
+		m_blockCrcCalculator.Start(articleSize > 0 ? m_blockSize : 0, articleOffset, articleSize);
 	}
 
 	bool ok = m_articleWriter.Write(buffer, len);
@@ -505,6 +575,8 @@ bool ArticleDownloader::Write(char* buffer, int len)
 		m_contentAnalyzer->Append(buffer, len);
 	}
 
+	m_blockCrcCalculator.Append(buffer, len);
+
 	return ok;
 }
 
@@ -591,6 +663,21 @@ void ArticleDownloader::FreeConnection(bool keepConnected)
 	{
 		debug("Releasing connection");
 		Guard guard(m_connectionMutex);
+		if (m_pipeline)
+		{
+			bool synced = m_pipelineSynced && m_connection->GetStatus() == Connection::csConnected;
+			ArticlePipeline::EHandOver handOver = m_pipeline->HandOver(this, m_connection, synced);
+			m_pipeline.reset();
+			m_pipelineRequested = false;
+			m_pipelineFollower = false;
+			if (handOver == ArticlePipeline::hoNext)
+			{
+				AddServerStats();
+				m_connection = nullptr;
+				return;
+			}
+			keepConnected &= handOver == ArticlePipeline::hoRelease;
+		}
 		if (!keepConnected || m_connection->GetStatus() == Connection::csCancelled)
 		{
 			m_connection->Disconnect();
@@ -612,3 +699,150 @@ void ArticleDownloader::AddServerStats()
 	g_StatMeter->AddServerStats(stats, serverId);
 	m_downloadedSize += bytesRead;
 }
+
+void ArticleDownloader::LeavePipeline()
+{
+	if (m_pipeline)
+	{
+		NntpConnection* connection = m_pipeline->Leave(this);
+		if (connection)
+		{
+			// the response to our request was not read, the connection can't be reused
+			connection->Disconnect();
+			g_ServerPool->FreeConnection(connection, true);
+		}
+		m_pipeline.reset();
+		m_pipelineRequested = false;
+		m_pipelineFollower = false;
+	}
+}
+
+void ArticlePipeline::Add(ArticleDownloader* downloader)
+{
+	Guard guard(m_mutex);
+	m_members.push_back(downloader);
+}
+
+/*
+ * Sends requests for all members at once. Returns false if the pipeline can't
+ * be used, the caller then sends its own request as usual.
+ */
+bool ArticlePipeline::SendRequests(ArticleDownloader* downloader, NntpConnection* connection)
+{
+	Guard guard(m_mutex);
+
+	if (m_sealed || m_broken || m_members.empty() || m_members.front() != downloader)
+	{
+		return false;
+	}
+
+	m_sealed = true;
+
+	if (m_members.size() == 1)
+	{
+		// all other members have left
+		m_broken = true;
+		return false;
+	}
+
+	StringBuilder requests;
+	for (ArticleDownloader* member : m_members)
+	{
+		requests.AppendFmt("BODY %s\r\n", member->GetArticleInfo()->GetMessageId());
+	}
+
+	m_requested = (int)m_members.size();
+	connection->WriteLine(requests);
+
+	return true;
+}
+
+/*
+ * Waits until the previous member passes the connection. Returns false if the
+ * pipeline is broken, the member must then get a connection from the server pool.
+ */
+bool ArticlePipeline::Wait(ArticleDownloader* downloader, NntpConnection** connection)
+{
+	Guard guard(m_mutex);
+
+	auto myTurn = [&]() { return m_connection && !m_members.empty() && m_members.front() == downloader; };
+	m_waitCond.WaitFor(m_mutex, 100, [&]{ return m_broken || myTurn(); });
+
+	if (myTurn())
+	{
+		*connection = m_connection;
+		m_connection = nullptr;
+		return true;
+	}
+
+	return !m_broken;
+}
+
+/*
+ * Called by the member owning the connection after it has finished reading its
+ * response. The connection is passed to the next member if the response stream
+ * is in sync. Otherwise the pipeline breaks and the connection must be closed
+ * if other responses are still pending.
+ */
+ArticlePipeline::EHandOver ArticlePipeline::HandOver(ArticleDownloader* downloader, NntpConnection* connection, bool synced)
+{
+	Guard guard(m_mutex);
+
+	m_members.erase(std::remove(m_members.begin(), m_members.end(), downloader), m_members.end());
+
+	if (m_requested == 0)
+	{
+		// requests were not sent, other members get connections from the pool
+		m_broken = true;
+		m_waitCond.NotifyAll();
+		return hoRelease;
+	}
+
+	m_requested--;
+
+	if (!synced || m_broken)
+	{
+		m_broken = true;
+		m_waitCond.NotifyAll();
+		return !synced || m_requested > 0 ? hoDisconnect : hoRelease;
+	}
+
+	if (m_requested > 0 && !m_members.empty())
+	{
+		m_connection = connection;
+		m_waitCond.NotifyAll();
+		return hoNext;
+	}
+
+	return m_requested > 0 ? hoDisconnect : hoRelease;
+}
+
+/*
+ * Called by a member leaving the pipeline without reading its response, for
+ * example when the download was cancelled. Returns the connection if it has
+ * already been passed to this member.
+ */
+NntpConnection* ArticlePipeline::Leave(ArticleDownloader* downloader)
+{
+	Guard guard(m_mutex);
+
+	NntpConnection* connection = nullptr;
+	if (m_connection && !m_members.empty() && m_members.front() == downloader)
+	{
+		connection = m_connection;
+		m_connection = nullptr;
+	}
+
+	Members::iterator it = std::find(m_members.begin(), m_members.end(), downloader);
+	if (it != m_members.end())
+	{
+		m_members.erase(it);
+		if (m_requested > 0)
+		{
+			m_broken = true;
+			m_waitCond.NotifyAll();
+		}
+	}
+
+	return connection;
+}
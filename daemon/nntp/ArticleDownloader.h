@@ -24,6 +24,7 @@
 #define ARTICLEDOWNLOADER_H
 
 #include <atomic>
+#include <deque>
 #include "NString.h"
 #include "Observer.h"
 #include "DownloadInfo.h"
@@ -41,6 +42,43 @@ public:
 	virtual void Append(const void* buffer, int len) = 0;
 };
 
+class ArticleDownloader;
+
+/*
+ * Chain of article downloaders sharing one connection (NNTP pipelining).
+ * The first downloader sends the requests for all members at once, then each
+ * member in turn reads its response and passes the connection to the next one.
+ * If the response stream gets out of sync the connection is closed and the
+ * remaining members continue with connections from the server pool.
+ */
+class ArticlePipeline
+{
+public:
+	enum EHandOver
+	{
+		hoNext,
+		hoRelease,
+		hoDisconnect
+	};
+
+	void Add(ArticleDownloader* downloader);
+	bool SendRequests(ArticleDownloader* downloader, NntpConnection* connection);
+	bool Wait(ArticleDownloader* downloader, NntpConnection** connection);
+	EHandOver HandOver(ArticleDownloader* downloader, NntpConnection* connection, bool synced);
+	NntpConnection* Leave(ArticleDownloader* downloader);
+
+private:
+	typedef std::deque<ArticleDownloader*> Members;
+
+	Mutex m_mutex;
+	ConditionVar m_waitCond;
+	Members m_members;
+	int m_requested = 0;
+	NntpConnection* m_connection = nullptr;
+	bool m_sealed = false;
+	bool m_broken = false;
+};
+
 class ArticleDownloader final : public Thread, public Subject
 {
 public:
@@ -79,6 +117,10 @@ public:
 	int GetDownloadedSize() { return m_downloadedSize; }
 	void SetContentAnalyzer(std::unique_ptr<ArticleContentAnalyzer> contentAnalyzer) { m_contentAnalyzer = std::move(contentAnalyzer); }
 	ArticleContentAnalyzer* GetContentAnalyzer() { return m_contentAnalyzer.get(); }
+	void SetPipeline(std::shared_ptr<ArticlePipeline> pipeline) { m_pipeline = std::move(pipeline); }
+	void SetBlockSize(int64 blockSize) { m_blockSize = blockSize; }
+	int64 GetBlockSize() { return m_blockSize; }
+	const std::vector<uint32>& GetBlockCrcs() { return m_blockCrcCalculator.GetCrcs(); }
 
 	void LogDebugInfo();
 
@@ -98,10 +140,17 @@ private:
 	bool m_writingStarted;
 	int m_downloadedSize = 0;
 	std::unique_ptr<ArticleContentAnalyzer> m_contentAnalyzer;
+	int64 m_blockSize = 0;
+	BlockCrcCalculator m_blockCrcCalculator;
+	std::shared_ptr<ArticlePipeline> m_pipeline;
+	bool m_pipelineRequested = false;
+	bool m_pipelineFollower = false;
+	bool m_pipelineSynced = false;
 
 	EStatus Download();
 	EStatus DecodeCheck();
 	void FreeConnection(bool keepConnected);
+	void LeavePipeline();
 	EStatus CheckResponse(const char* response, const char* comment);
 	void SetStatus(EStatus status) { m_status = status; }
 	bool Write(char* buffer, int len);
@@ -29,6 +29,7 @@
 #include "Log.h"
 #include "Util.h"
 #include "FileSystem.h"
+#include "FileMover.h"
 
 CachedSegmentData::~CachedSegmentData()
 {
@@ -58,15 +59,17 @@ void ArticleWriter::SetWriteBuffer(DiskFile& outFile, int recSize)
 void ArticleWriter::Prepare()
 {
 	BuildOutputFilename();
-	m_resultFilename = m_articleInfo->GetResultFilename()
-		? m_articleInfo->GetResultFilename()
-		: "";
+	m_resultFilename = m_fileInfo->GetResultFilename(m_articleInfo);
 }
 
 bool ArticleWriter::Start(Decoder::EFormat format, const char* filename, int64 fileSize,
 	int64 articleOffset, int articleSize)
 {
 	m_outFile.Close();
+	if (m_asyncBuffer.data)
+	{
+		g_ArticleCache->FreeAsyncBuffer(std::move(m_asyncBuffer));
+	}
 	m_format = format;
 	m_articleOffset = articleOffset;
 	m_articleSize = articleSize ? articleSize : m_articleInfo->GetSize();
@@ -132,6 +135,14 @@ bool ArticleWriter::Start(Decoder::EFormat format, const char* filename, int64 f
 	if (!m_articleData.GetData())
 	{
 		bool directWrite = (g_Options->GetDirectWrite() || m_fileInfo->GetForceDirectWrite()) && m_format == Decoder::efYenc;
+
+		if (directWrite && g_ArticleCache->GetAsyncWrite() && !g_Options->GetRawArticle() && !GetSkipDiskWrite())
+		{
+			// the article is collected in memory and written by the async writer in Finish()
+			m_asyncBuffer = g_ArticleCache->AllocAsyncBuffer(m_articleSize);
+			return true;
+		}
+
 		const char* outFilename = directWrite ? m_outputFilename.c_str() : m_tempFilename.c_str();
 		if (!m_outFile.Open(outFilename, directWrite ? DiskFile::omReadWrite : DiskFile::omWrite))
 		{
@@ -177,9 +188,14 @@ bool ArticleWriter::Write(char* buffer, int len)
 		return true;
 	}
 
-	if (!g_Options->GetRawArticle() && m_articleData.GetData())
+	char* data = m_articleData.GetData() ? m_articleData.GetData() : m_asyncBuffer.data.get();
+	if (!g_Options->GetRawArticle() && data)
 	{
-		memcpy(m_articleData.GetData() + m_articlePtr - len, buffer, len);
+		char* dest = data + m_articlePtr - len;
+		if (buffer != dest)
+		{
+			memcpy(dest, buffer, len);
+		}
 		return true;
 	}
 
@@ -191,10 +207,39 @@ bool ArticleWriter::Write(char* buffer, int len)
 	return m_outFile.Write(buffer, len) > 0;
 }
 
+/*
+ * Returns the position in the article cache segment (or in the buffer for
+ * asynchronous writing) where the decoder can put up to "len" bytes directly,
+ * avoiding the copy in "Write". The data must then be passed to "Write" using
+ * the returned pointer. Returns nullptr if the article isn't written into
+ * memory or there is not enough space left.
+ */
+char* ArticleWriter::GetDecodeBuffer(int len)
+{
+	char* data = m_articleData.GetData() ? m_articleData.GetData() : m_asyncBuffer.data.get();
+	if (g_Options->GetRawArticle() || m_format != Decoder::efYenc || !data ||
+		m_articlePtr + len > m_articleSize)
+	{
+		return nullptr;
+	}
+
+	return data + m_articlePtr;
+}
+
 void ArticleWriter::Finish(bool success)
 {
 	m_outFile.Close();
 
+	if (m_asyncBuffer.data)
+	{
+		if (success)
+		{
+			g_ArticleCache->WriteAsync(m_fileInfo, m_outputFilename, m_articleOffset,
+				std::move(m_asyncBuffer), std::min(m_articlePtr, m_articleSize));
+		}
+		g_ArticleCache->FreeAsyncBuffer(std::move(m_asyncBuffer));
+	}
+
 	if (!success)
 	{
 		FileSystem::DeleteFile(m_tempFilename.c_str());
@@ -224,7 +269,9 @@ void ArticleWriter::Finish(bool success)
 				g_ArticleCache->Realloc(&m_articleData, m_articlePtr);
 			}
 			Guard contentGuard = g_ArticleCache->GuardContent();
-			m_articleInfo->AttachSegment(std::make_unique<CachedSegmentData>(std::move(m_articleData)), m_articleOffset, m_articlePtr);
+			m_fileInfo->AttachSegment(m_articleInfo, std::make_unique<CachedSegmentData>(std::move(m_articleData)),
+				m_articleOffset, m_articlePtr);
+			m_fileInfo->SetCacheInfoName(m_infoName);
 			m_fileInfo->SetCachedArticles(m_fileInfo->GetCachedArticles() + 1);
 		}
 		else
@@ -300,7 +347,7 @@ void ArticleWriter::BuildOutputFilename()
 
 	std::string filename = ss.str();
 
-	m_articleInfo->SetResultFilename(filename.c_str());
+	m_articleInfo->SetHasResultFile(true);
 	m_tempFilename = filename + ".tmp";
 	
 	if (g_Options->GetDirectWrite() || m_fileInfo->GetForceDirectWrite())
@@ -337,6 +384,11 @@ void ArticleWriter::CompleteFileParts()
 
 	bool directWrite = (g_Options->GetDirectWrite() || m_fileInfo->GetForceDirectWrite()) && m_fileInfo->GetOutputInitialized();
 
+	// articles written asynchronously must be on disk before the file is completed
+	AsyncFilePtr asyncFile = m_fileInfo->GetAsyncFile();
+	asyncFile->Wait();
+	asyncFile->Close();
+
 	std::string nzbDestDir;
 	std::string nzbName;
 	std::string destDir;
@@ -454,7 +506,7 @@ void ArticleWriter::CompleteFileParts()
 		std::unique_ptr<ArticleCache::FlushGuard> flushGuard;
 		if (cached)
 		{
-			flushGuard = std::make_unique<ArticleCache::FlushGuard>(g_ArticleCache->GuardFlush());
+			flushGuard = std::make_unique<ArticleCache::FlushGuard>(g_ArticleCache->GuardFlush(m_fileInfo));
 		}
 
 		CharBuffer buffer;
@@ -483,19 +535,20 @@ void ArticleWriter::CompleteFileParts()
 				}
 			}
 
-			if (pa->GetSegmentContent())
+			const char* segmentContent = m_fileInfo->GetSegmentContent(pa);
+			if (segmentContent)
 			{
 				if (!GetSkipDiskWrite())
 				{
 					outfile.Seek(pa->GetSegmentOffset());
-					outfile.Write(pa->GetSegmentContent(), pa->GetSegmentSize());
+					outfile.Write(segmentContent, pa->GetSegmentSize());
 				}
-				pa->DiscardSegment();
+				m_fileInfo->DiscardSegment(pa);
 			}
 			else if (!g_Options->GetRawArticle() && !directWrite && !GetSkipDiskWrite())
 			{
 				DiskFile infile;
-				if (pa->GetResultFilename() && infile.Open(pa->GetResultFilename(), DiskFile::omRead))
+				if (pa->GetHasResultFile() && infile.Open(m_fileInfo->GetResultFilename(pa).c_str(), DiskFile::omRead))
 				{
 					int cnt = buffer.Size();
 					while (cnt == buffer.Size())
@@ -511,17 +564,18 @@ void ArticleWriter::CompleteFileParts()
 					m_fileInfo->SetSuccessArticles(m_fileInfo->GetSuccessArticles() - 1);
 					m_fileInfo->GetNzbInfo()->PrintMessage(Message::mkError,
 						"Could not find file %s for %s [%i/%i]",
-						pa->GetResultFilename(), infoFilename.c_str(), pa->GetPartNumber(),
+						m_fileInfo->GetResultFilename(pa).c_str(), infoFilename.c_str(), pa->GetPartNumber(),
 						(int)m_fileInfo->GetArticles()->size());
 				}
 			}
 			else if (g_Options->GetRawArticle())
 			{
 				BString<1024> dstFileName("%s%c%03i", ofn.c_str(), PATH_SEPARATOR, pa->GetPartNumber());
-				if (!FileSystem::MoveFile(pa->GetResultFilename(), dstFileName))
+				std::string resultFilename = m_fileInfo->GetResultFilename(pa);
+				if (!FileSystem::MoveFile(resultFilename.c_str(), dstFileName))
 				{
 					m_fileInfo->GetNzbInfo()->PrintMessage(Message::mkError,
-						"Could not move file %s to %s: %s", pa->GetResultFilename(),
+						"Could not move file %s to %s: %s", resultFilename.c_str(),
 						*dstFileName, *FileSystem::GetLastErrorMessage());
 				}
 			}
@@ -554,9 +608,9 @@ void ArticleWriter::CompleteFileParts()
 	{
 		for (ArticleInfo* pa : m_fileInfo->GetArticles())
 		{
-			if (pa->GetResultFilename())
+			if (pa->GetHasResultFile())
 			{
-				FileSystem::DeleteFile(pa->GetResultFilename());
+				FileSystem::DeleteFile(m_fileInfo->GetResultFilename(pa).c_str());
 			}
 		}
 	}
@@ -628,7 +682,7 @@ void ArticleWriter::FlushCache()
 	int64 flushedSize = 0;
 
 	{
-		ArticleCache::FlushGuard flushGuard = g_ArticleCache->GuardFlush();
+		ArticleCache::FlushGuard flushGuard = g_ArticleCache->GuardFlush(m_fileInfo);
 
 		std::vector<ArticleInfo*> cachedArticles;
 
@@ -642,18 +696,22 @@ void ArticleWriter::FlushCache()
 
 			m_fileInfo->SetFlushLocked(true);
 
-			cachedArticles.reserve(m_fileInfo->GetArticles()->size());
-			for (ArticleInfo* pa : m_fileInfo->GetArticles())
-			{
-				if (pa->GetSegmentContent())
-				{
-					cachedArticles.push_back(pa);
-				}
-			}
+			cachedArticles = m_fileInfo->GetSegmentArticles();
 		}
 
-		for (ArticleInfo* pa : cachedArticles)
+		if (directWrite)
 		{
+			// neighbouring segments are merged into one vectored write
+			std::sort(cachedArticles.begin(), cachedArticles.end(),
+				[](ArticleInfo* a, ArticleInfo* b) { return a->GetSegmentOffset() < b->GetSegmentOffset(); });
+		}
+
+		std::vector<DiskFile::WriteChunk> chunks;
+
+		for (size_t index = 0; index < cachedArticles.size(); index++)
+		{
+			ArticleInfo* pa = cachedArticles[index];
+
 			if (m_fileInfo->GetDeleted() && !m_fileInfo->GetNzbInfo()->GetParking())
 			{
 				// the file was deleted during flushing: stop flushing immediately
@@ -669,7 +727,7 @@ void ArticleWriter::FlushCache()
 						"Could not open file %s: %s", outputFilename.c_str(),
 						*FileSystem::GetLastErrorMessage());
 					// prevent multiple error messages
-					pa->DiscardSegment();
+					m_fileInfo->DiscardSegment(pa);
 					flushedArticles++;
 					break;
 				}
@@ -677,17 +735,19 @@ void ArticleWriter::FlushCache()
 			}
 
 			BString<1024> destFile;
+			std::string resultFilename;
 
 			if (!directWrite)
 			{
-				destFile.Format("%s.tmp", pa->GetResultFilename());
+				resultFilename = m_fileInfo->GetResultFilename(pa);
+				destFile.Format("%s.tmp", resultFilename.c_str());
 				if (!outfile.Open(destFile, DiskFile::omWrite))
 				{
 					m_fileInfo->GetNzbInfo()->PrintMessage(Message::mkError,
 						"Could not create file %s: %s", *destFile,
 						*FileSystem::GetLastErrorMessage());
 					// prevent multiple error messages
-					pa->DiscardSegment();
+					m_fileInfo->DiscardSegment(pa);
 					flushedArticles++;
 					break;
 				}
@@ -702,27 +762,55 @@ void ArticleWriter::FlushCache()
 
 			if (directWrite)
 			{
-				outfile.Seek(pa->GetSegmentOffset());
+				int64 offset = pa->GetSegmentOffset();
+				int64 end = offset;
+				size_t last = index;
+				chunks.clear();
+				for (; last < cachedArticles.size() && cachedArticles[last]->GetSegmentOffset() == end; last++)
+				{
+					ArticleInfo* article = cachedArticles[last];
+					chunks.push_back({m_fileInfo->GetSegmentContent(article), article->GetSegmentSize()});
+					end += article->GetSegmentSize();
+				}
+
+				if (!GetSkipDiskWrite() && !outfile.WriteVectored(offset, chunks))
+				{
+					m_fileInfo->GetNzbInfo()->PrintMessage(Message::mkError,
+						"Could not write file %s: %s", m_fileInfo->GetOutputFilename().c_str(),
+						*FileSystem::GetLastErrorMessage());
+				}
+
+				for (; index < last; index++)
+				{
+					m_fileInfo->DiscardSegment(cachedArticles[index]);
+					flushedArticles++;
+				}
+				index--;
+
+				flushedSize += end - offset;
+				g_ArticleCache->AddFlushedBytes(end - offset);
+				continue;
 			}
 
 			if (!GetSkipDiskWrite())
 			{
-				outfile.Write(pa->GetSegmentContent(), pa->GetSegmentSize());
+				outfile.Write(m_fileInfo->GetSegmentContent(pa), pa->GetSegmentSize());
 			}
 
 			flushedSize += pa->GetSegmentSize();
+			g_ArticleCache->AddFlushedBytes(pa->GetSegmentSize());
 			flushedArticles++;
 
-			pa->DiscardSegment();
+			m_fileInfo->DiscardSegment(pa);
 
 			if (!directWrite)
 			{
 				outfile.Close();
 
-				if (!FileSystem::MoveFile(destFile, pa->GetResultFilename()))
+				if (!FileSystem::MoveFile(destFile, resultFilename.c_str()))
 				{
 					m_fileInfo->GetNzbInfo()->PrintMessage(Message::mkError,
-						"Could not rename file %s to %s: %s", *destFile, pa->GetResultFilename(),
+						"Could not rename file %s to %s: %s", *destFile, resultFilename.c_str(),
 						*FileSystem::GetLastErrorMessage());
 				}
 			}
@@ -756,7 +844,9 @@ bool ArticleWriter::MoveCompletedFiles(NzbInfo* nzbInfo, const char* oldDestDir)
 		return false;
 	}
 
-	// move already downloaded files to new destination
+	// move already downloaded files to new destination,
+	// files are copied in parallel if the new destination is on another file system
+	FileMover mover;
 	for (CompletedFile& completedFile : nzbInfo->GetCompletedFiles())
 	{
 		BString<1024> oldFileName("%s%c%s", oldDestDir, PATH_SEPARATOR, completedFile.GetFilename());
@@ -769,11 +859,17 @@ bool ArticleWriter::MoveCompletedFiles(NzbInfo* nzbInfo, const char* oldDestDir)
 			newFileName = FileSystem::MakeUniqueFilename(nzbInfo->GetDestDir(), completedFile.GetFilename());
 
 			detail("Moving file %s to %s", *oldFileName, *newFileName);
-			if (!FileSystem::MoveFile(oldFileName, newFileName))
-			{
-				nzbInfo->PrintMessage(Message::mkError, "Could not move file %s to %s: %s",
-					*oldFileName, *newFileName, *FileSystem::GetLastErrorMessage());
-			}
+			mover.AddFile(*oldFileName, *newFileName);
+		}
+	}
+
+	mover.Execute(nullptr);
+	for (FileMover::File& file : mover.GetFiles())
+	{
+		if (!file.success)
+		{
+			nzbInfo->PrintMessage(Message::mkError, "Could not move file %s to %s: %s",
+				file.srcFilename.c_str(), file.dstFilename.c_str(), *file.errmsg);
 		}
 	}
 
@@ -811,18 +907,43 @@ bool ArticleWriter::MoveCompletedFiles(NzbInfo* nzbInfo, const char* oldDestDir)
 }
 
 
+void ArticleCache::InitArena()
+{
+	m_arenaInitialized = true;
+
+	size_t capacity = (size_t)g_Options->GetArticleCache() * 1024 * 1024;
+	if (!m_arena.Init(capacity, g_Options->GetArticleCacheHugePages()))
+	{
+		warn("Could not reserve %i MB for article cache, allocating articles on heap", g_Options->GetArticleCache());
+		return;
+	}
+
+	SlabArena::Stats stats = m_arena.GetStats();
+	detail("Article cache reserved %i MB in %i slabs of %i KB%s", (int)(stats.capacity / 1024 / 1024),
+		stats.slabCount, (int)(stats.slabSize / 1024), stats.hugePages ? " with huge pages" : "");
+}
+
 CachedSegmentData ArticleCache::Alloc(int size)
 {
 	std::lock_guard<std::mutex> guard(m_allocMutex);
 
+	if (!m_arenaInitialized)
+	{
+		InitArena();
+	}
+
+	// segments not fitting into a slab are allocated on heap
+	bool useArena = m_arena.IsInitialized() && (size_t)size <= m_arena.GetMaxSlotSize();
+	size_t allocSize = useArena ? SlabArena::SlotSize(size) : size;
+
 	void* p = nullptr;
 
-	if (m_allocated + size <= (size_t)g_Options->GetArticleCache() * 1024 * 1024)
+	if (m_allocated + allocSize <= (size_t)g_Options->GetArticleCache() * 1024 * 1024)
 	{
-		p = malloc(size);
+		p = useArena ? m_arena.Alloc(size) : malloc(size);
 		if (p)
 		{
-			if (!m_allocated && g_Options->GetServerMode() && g_Options->GetContinuePartial())
+			if (!m_allocated && !m_pendingWrites && g_Options->GetServerMode() && g_Options->GetContinuePartial())
 			{
 				g_DiskState->WriteCacheFlag();
 			}
@@ -831,7 +952,17 @@ CachedSegmentData ArticleCache::Alloc(int size)
 				// Resume Run(), the notification arrives later, after releasing m_allocMutex
 				m_allocCond.notify_all();
 			}
-			m_allocated += size;
+			if (!useArena)
+			{
+				m_heapAllocated += size;
+			}
+			UpdateAllocated();
+		}
+		else if (useArena && g_Options->GetDirectWrite())
+		{
+			// no free slab of this size class although the cache isn't full (fragmentation),
+			// the flusher frees slabs and the writer waits for it instead of using disk
+			m_arenaFull = true;
 		}
 	}
 
@@ -842,12 +973,25 @@ bool ArticleCache::Realloc(CachedSegmentData* segment, int newSize)
 {
 	std::lock_guard<std::mutex> guard(m_allocMutex);
 
+	if (m_arena.Contains(segment->m_data))
+	{
+		if (newSize > segment->m_size)
+		{
+			return false;
+		}
+		segment->m_data = m_arena.Shrink(segment->m_data, segment->m_size, newSize);
+		segment->m_size = newSize;
+		UpdateAllocated();
+		return true;
+	}
+
 	void* p = realloc(segment->m_data, newSize);
 	if (p)
 	{
-		m_allocated += newSize - segment->m_size;
+		m_heapAllocated += newSize - segment->m_size;
 		segment->m_size = newSize;
 		segment->m_data = (char*)p;
+		UpdateAllocated();
 	}
 
 	return p;
@@ -857,37 +1001,140 @@ void ArticleCache::Free(CachedSegmentData* segment)
 {
 	if (segment->m_size)
 	{
-		free(segment->m_data);
-
 		std::lock_guard<std::mutex> guard(m_allocMutex);
-		m_allocated -= segment->m_size;
-		if (!m_allocated && g_Options->GetServerMode() && g_Options->GetContinuePartial())
+
+		if (m_arena.Contains(segment->m_data))
+		{
+			m_arena.Free(segment->m_data, segment->m_size);
+		}
+		else
+		{
+			free(segment->m_data);
+			m_heapAllocated -= segment->m_size;
+		}
+		UpdateAllocated();
+
+		if (!m_allocated && !m_pendingWrites && g_Options->GetServerMode() && g_Options->GetContinuePartial())
 		{
 			g_DiskState->DeleteCacheFlag();
 		}
 	}
 }
 
+void ArticleCache::StartAsyncWrite(int threads)
+{
+	// limit memory held by articles waiting to be written
+	size_t maxPending = (size_t)std::max(g_Options->GetWriteBuffer(), 1024) * 1024 * threads * 8;
+	m_asyncWriter.Start(threads, maxPending);
+}
+
+void ArticleCache::WriteAsync(FileInfo* fileInfo, const std::string& filename, int64 offset,
+	AsyncWriter::Buffer buffer, int size)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_allocMutex);
+		// unsaved data in memory, same as articles in cache
+		if (!m_allocated && !m_pendingWrites && g_Options->GetServerMode() && g_Options->GetContinuePartial())
+		{
+			g_DiskState->WriteCacheFlag();
+		}
+		m_pendingWrites++;
+	}
+
+	m_asyncWriter.Write(fileInfo->GetAsyncFile(), filename, offset, std::move(buffer), size,
+		[this, filename](bool success, const char* errmsg)
+		{
+			if (!success)
+			{
+				error("Could not write file %s: %s", filename.c_str(), errmsg);
+			}
+
+			{
+				std::lock_guard<std::mutex> guard(m_allocMutex);
+				m_pendingWrites--;
+				if (!m_allocated && !m_pendingWrites && g_Options->GetServerMode() && g_Options->GetContinuePartial())
+				{
+					g_DiskState->DeleteCacheFlag();
+				}
+			}
+		});
+}
+
+SlabArena::Stats ArticleCache::GetArenaStats()
+{
+	std::lock_guard<std::mutex> guard(m_allocMutex);
+	return m_arena.GetStats();
+}
+
 void ArticleCache::Run()
+{
+	// additional flushers work on other files than the one being flushed by this thread
+	std::vector<std::thread> flushers;
+	for (int i = 1; i < g_Options->GetArticleCacheFlushThreads(); i++)
+	{
+		flushers.emplace_back([this] { FlushLoop(false); });
+	}
+
+	FlushLoop(true);
+
+	for (std::thread& flusher : flushers)
+	{
+		flusher.join();
+	}
+}
+
+void ArticleCache::FlushLoop(bool mainThread)
 {
 	// automatically flush the cache if it is filled to 90% (only in DirectWrite mode)
 	size_t fillThreshold = (size_t)g_Options->GetArticleCache() * 1024 * 1024 / 100 * 90;
 
+	auto rateTime = std::chrono::steady_clock::now();
+	int64 rateBytes = m_flushedBytes;
+
 	int resetCounter = 0;
 	bool justFlushed = false;
 	while (!IsStopped() || m_allocated > 0)
 	{
-		if ((justFlushed || resetCounter >= 1000 || IsStopped() ||
+		if (mainThread)
+		{
+			auto now = std::chrono::steady_clock::now();
+			int64 elapsedMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - rateTime).count();
+			if (elapsedMs >= 1000)
+			{
+				int64 bytes = m_flushedBytes;
+				m_flushRate = (int)((bytes - rateBytes) * 1000 / elapsedMs);
+				rateBytes = bytes;
+				rateTime = now;
+			}
+		}
+
+		bool arenaFull = m_arenaFull;
+		if ((justFlushed || resetCounter >= 1000 || IsStopped() || arenaFull ||
 			(g_Options->GetDirectWrite() && m_allocated >= fillThreshold)) &&
 			m_allocated > 0)
 		{
-			justFlushed = CheckFlush(m_allocated >= fillThreshold);
+			justFlushed = CheckFlush(m_allocated >= fillThreshold || arenaFull);
+			if (arenaFull)
+			{
+				// waiting writers retry, a failed allocation sets the flag again
+				m_arenaFull = false;
+			}
 			resetCounter = 0;
+			if (!justFlushed && IsStopped())
+			{
+				// the remaining files are being flushed by other threads
+				Util::Sleep(5);
+			}
 		}
 		else if (!m_allocated)
 		{
 			std::unique_lock<std::mutex> lk(m_allocMutex);
+			// the cache is empty, give memory of the slabs back to the system
+			m_arena.Trim();
+			m_flushRate = 0;
 			m_allocCond.wait(lk, [&] { return IsStopped() || m_allocated > 0; });
+			rateTime = std::chrono::steady_clock::now();
+			rateBytes = m_flushedBytes;
 			resetCounter = 0;
 		}
 		else
@@ -911,36 +1158,18 @@ bool ArticleCache::CheckFlush(bool flushEverything)
 {
 	debug("Checking cache, Allocated: %i, FlushEverything: %i", (int)m_allocated, (int)flushEverything);
 
-	BString<1024> infoName;
-
-	{
-		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
-		for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
-		{
-			if (m_fileInfo)
-			{
-				break;
-			}
+	CachedFileList* cachedFiles = FileInfo::GetCachedFiles();
 
-			for (FileInfo* fileInfo : nzbInfo->GetFileList())
-			{
-				if (fileInfo->GetCachedArticles() > 0 && (fileInfo->GetActiveDownloads() == 0 || flushEverything))
-				{
-					m_fileInfo = fileInfo;
-					infoName.Format("%s%c%s", m_fileInfo->GetNzbInfo()->GetName(), PATH_SEPARATOR, m_fileInfo->GetFilename());
-					break;
-				}
-			}
-		}
-	}
+	// files taken by other flushers are not in the list
+	FileInfo* fileInfo = cachedFiles->Acquire(flushEverything);
 
-	if (m_fileInfo)
+	if (fileInfo)
 	{
 		ArticleWriter articleWriter;
-		articleWriter.SetFileInfo(m_fileInfo);
-		articleWriter.SetInfoName(infoName);
+		articleWriter.SetFileInfo(fileInfo);
+		articleWriter.SetInfoName(fileInfo->GetCacheInfoName());
 		articleWriter.FlushCache();
-		m_fileInfo = nullptr;
+		cachedFiles->Release(fileInfo);
 		return true;
 	}
 
@@ -949,15 +1178,36 @@ bool ArticleCache::CheckFlush(bool flushEverything)
 	return false;
 }
 
-ArticleCache::FlushGuard::FlushGuard(Mutex& mutex) : m_guard(&mutex)
+void ArticleCache::LockFlush(FileInfo* fileInfo)
 {
-	g_ArticleCache->m_flushing = true;
+	std::unique_lock<std::mutex> lock(m_flushMutex);
+	m_flushCond.wait(lock, [&]
+		{
+			return std::find(m_flushingFiles.begin(), m_flushingFiles.end(), fileInfo) == m_flushingFiles.end();
+		});
+	m_flushingFiles.push_back(fileInfo);
+	m_flushing = (int)m_flushingFiles.size();
+}
+
+void ArticleCache::UnlockFlush(FileInfo* fileInfo)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_flushMutex);
+		m_flushingFiles.erase(std::find(m_flushingFiles.begin(), m_flushingFiles.end(), fileInfo));
+		m_flushing = (int)m_flushingFiles.size();
+	}
+	m_flushCond.notify_all();
+}
+
+ArticleCache::FlushGuard::FlushGuard(FileInfo* fileInfo) : m_fileInfo(fileInfo)
+{
+	g_ArticleCache->LockFlush(m_fileInfo);
 }
 
 ArticleCache::FlushGuard::~FlushGuard()
 {
-	if (m_guard)
+	if (m_fileInfo)
 	{
-		g_ArticleCache->m_flushing = false;
+		g_ArticleCache->UnlockFlush(m_fileInfo);
 	}
 }
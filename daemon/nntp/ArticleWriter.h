@@ -28,6 +28,8 @@
 #include "DownloadInfo.h"
 #include "Decoder.h"
 #include "FileSystem.h"
+#include "SlabArena.h"
+#include "AsyncWriter.h"
 
 class CachedSegmentData : public SegmentData
 {
@@ -58,6 +60,7 @@ public:
 	void Prepare();
 	bool Start(Decoder::EFormat format, const char* filename, int64 fileSize, int64 articleOffset, int articleSize);
 	bool Write(char* buffer, int len);
+	char* GetDecodeBuffer(int len);
 	void Finish(bool success);
 	bool GetDuplicate() { return m_duplicate; }
 	void CompleteFileParts();
@@ -88,6 +91,7 @@ private:
 	std::string m_infoName;
 	Decoder::EFormat m_format = Decoder::efUnknown;
 	CachedSegmentData m_articleData;
+	AsyncWriter::Buffer m_asyncBuffer;
 	int64 m_articleOffset;
 	int m_articleSize;
 	int m_articlePtr;
@@ -101,14 +105,18 @@ private:
 class ArticleCache : public Thread
 {
 public:
+	/**
+	 * Prevents the cached articles of a file from being flushed by another
+	 * thread. Different files can be flushed in parallel.
+	 */
 	class FlushGuard
 	{
 	public:
-		FlushGuard(FlushGuard&& other) = default;
+		FlushGuard(FlushGuard&& other) : m_fileInfo(other.m_fileInfo) { other.m_fileInfo = nullptr; }
 		~FlushGuard();
 	private:
-		Guard m_guard;
-		FlushGuard(Mutex& mutex);
+		FileInfo* m_fileInfo;
+		FlushGuard(FileInfo* fileInfo);
 		friend class ArticleCache;
 	};
 
@@ -117,22 +125,49 @@ public:
 	CachedSegmentData Alloc(int size);
 	bool Realloc(CachedSegmentData* segment, int newSize);
 	void Free(CachedSegmentData* segment);
-	FlushGuard GuardFlush() { return FlushGuard(m_flushMutex); }
+	FlushGuard GuardFlush(FileInfo* fileInfo) { return FlushGuard(fileInfo); }
 	Guard GuardContent() { return Guard(m_contentMutex); }
-	bool GetFlushing() { return m_flushing; }
+	bool GetFlushing() { return m_flushing > 0 || m_arenaFull; }
 	size_t GetAllocated() { return m_allocated; }
-	bool FileBusy(FileInfo* fileInfo) { return fileInfo == m_fileInfo; }
+	SlabArena::Stats GetArenaStats();
+	bool FileBusy(FileInfo* fileInfo) { return FileInfo::GetCachedFiles()->IsBusy(fileInfo); }
+	int GetFlushRate() { return m_flushRate; }
+	int GetFlushActive() { return m_flushing; }
+	int GetFlushQueue() { return FileInfo::GetCachedFiles()->GetCount(); }
+	void AddFlushedBytes(int64 bytes) { m_flushedBytes += bytes; }
+	void StartAsyncWrite(int threads);
+	void StopAsyncWrite() { m_asyncWriter.Stop(); }
+	bool GetAsyncWrite() { return m_asyncWriter.IsActive(); }
+	AsyncWriter::Buffer AllocAsyncBuffer(int size) { return m_asyncWriter.AllocBuffer(size); }
+	void FreeAsyncBuffer(AsyncWriter::Buffer buffer) { m_asyncWriter.FreeBuffer(std::move(buffer)); }
+	void WriteAsync(FileInfo* fileInfo, const std::string& filename, int64 offset,
+		AsyncWriter::Buffer buffer, int size);
+	int GetAsyncWritePending() { return m_asyncWriter.GetPendingJobs(); }
 
 private:
 	std::atomic<size_t> m_allocated{0};
-	FileInfo* m_fileInfo = nullptr;
+	SlabArena m_arena;
+	bool m_arenaInitialized = false;
+	std::atomic<bool> m_arenaFull{false};
+	size_t m_heapAllocated = 0;
 	std::mutex m_allocMutex;
 	std::condition_variable m_allocCond;
-	Mutex m_flushMutex;
+	std::mutex m_flushMutex;
+	std::condition_variable m_flushCond;
+	std::vector<FileInfo*> m_flushingFiles;
+	std::atomic<int> m_flushing{0};
+	std::atomic<int64> m_flushedBytes{0};
+	std::atomic<int> m_flushRate{0};
 	Mutex m_contentMutex;
-	bool m_flushing = false;
+	AsyncWriter m_asyncWriter;
+	int m_pendingWrites = 0;
 
+	void FlushLoop(bool mainThread);
 	bool CheckFlush(bool flushEverything);
+	void InitArena();
+	void UpdateAllocated() { m_allocated = m_arena.GetSlotBytes() + m_heapAllocated; }
+	void LockFlush(FileInfo* fileInfo);
+	void UnlockFlush(FileInfo* fileInfo);
 };
 
 extern ArticleCache* g_ArticleCache;
@@ -60,12 +60,18 @@ void Decoder::Clear()
  * At the end of yEnc-data switches back to line by line mode to
  * process '=yend'-marker and EOF-marker.
  * UU-encoded articles are processed completely in line by line mode.
+ * The decoded data is stored in "outbuf", which can be the input buffer itself
+ * or a separate buffer with at least "len" bytes of space.
  */
-int Decoder::DecodeBuffer(char* buffer, int len)
+int Decoder::DecodeBuffer(char* buffer, int len, char* outbuf)
 {
 	if (m_rawMode)
 	{
 		ProcessRaw(buffer, len);
+		if (outbuf != buffer)
+		{
+			memcpy(outbuf, buffer, len);
+		}
 		return len;
 	}
 
@@ -73,7 +79,7 @@ int Decoder::DecodeBuffer(char* buffer, int len)
 
 	if (m_body && m_format == efYenc)
 	{
-		outlen = DecodeYenc(buffer, buffer, len);
+		outlen = DecodeYenc(buffer, outbuf, len);
 		if (m_body)
 		{
 			return outlen;
@@ -92,7 +98,11 @@ int Decoder::DecodeBuffer(char* buffer, int len)
 		if (line[0] == '.' && line[1] == '\r')
 		{
 			m_eof = true;
-			m_lineBuf.SetLength(0);
+			// keep data received after the terminator, on pipelined
+			// connections it belongs to the response for the next request
+			int rem = m_lineBuf.Length() - (int)(end + 1 - m_lineBuf);
+			memmove((char*)m_lineBuf, end + 1, rem);
+			m_lineBuf.SetLength(rem);
 			return outlen;
 		}
 
@@ -106,7 +116,7 @@ int Decoder::DecodeBuffer(char* buffer, int len)
 			ProcessYenc(line, llen);
 			if (m_body)
 			{
-				outlen = DecodeYenc(end + 1, buffer, m_lineBuf.Length() - (int)(end + 1 - m_lineBuf));
+				outlen = DecodeYenc(end + 1, outbuf, m_lineBuf.Length() - (int)(end + 1 - m_lineBuf));
 				if (m_body)
 				{
 					m_lineBuf.SetLength(0);
@@ -118,7 +128,7 @@ int Decoder::DecodeBuffer(char* buffer, int len)
 		}
 		else if (m_format == efUx)
 		{
-			outlen += DecodeUx(line, llen, buffer + outlen);
+			outlen += DecodeUx(line, llen, outbuf + outlen);
 		}
 
 		line = end + 1;
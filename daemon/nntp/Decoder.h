@@ -49,7 +49,8 @@ public:
 	Decoder();
 	EStatus Check();
 	void Clear();
-	int DecodeBuffer(char* buffer, int len);
+	int DecodeBuffer(char* buffer, int len) { return DecodeBuffer(buffer, len, buffer); }
+	int DecodeBuffer(char* buffer, int len, char* outbuf);
 	void SetCrcCheck(bool crcCheck) { m_crcCheck = crcCheck; }
 	void SetRawMode(bool rawMode) { m_rawMode = rawMode; }
 	EFormat GetFormat() { return m_format; }
@@ -59,6 +60,8 @@ public:
 	uint32 GetExpectedCrc() { return m_expectedCRC; }
 	uint32 GetCalculatedCrc() { return m_calculatedCRC; }
 	bool GetEof() { return m_eof; }
+	const char* GetTrailingData() { return m_eof ? (const char*)m_lineBuf : nullptr; }
+	int GetTrailingLength() { return m_eof ? m_lineBuf.Length() : 0; }
 	const char* GetArticleFilename() { return m_articleFilename.c_str(); }
 
 private:
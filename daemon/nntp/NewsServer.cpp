@@ -21,17 +21,36 @@
 
 #include "nzbget.h"
 #include "NewsServer.h"
+#include "Log.h"
 
 NewsServer::NewsServer(int id, bool active, const char* name, const char* host, int port, int ipVersion,
 	const char* user, const char* pass, bool joinGroup, bool tls, const char* cipher,
-	int maxConnections, int retention, int level, int group, bool optional, unsigned int certVerificationfLevel) :
+	int maxConnections, int retention, int level, int group, bool optional, unsigned int certVerificationfLevel,
+	int pipelining) :
 		m_id(id), m_active(active), m_name(name), m_host(host ? host : ""), m_port(port), m_ipVersion(ipVersion),
 		m_user(user ? user : ""), m_password(pass ? pass : ""), m_joinGroup(joinGroup), m_tls(tls),
 		m_cipher(cipher ? cipher : ""), m_maxConnections(maxConnections), m_retention(retention),
-		m_level(level), m_normLevel(level), m_group(group), m_optional(optional), m_certVerificationfLevel(certVerificationfLevel)
+		m_level(level), m_normLevel(level), m_group(group), m_optional(optional), m_certVerificationfLevel(certVerificationfLevel),
+		m_pipelining(pipelining)
 {
 	if (m_name.Empty())
 	{
 		m_name.Format("server%i", id);
 	}
 }
+
+/*
+ * Called when the server did not answer pipelined requests properly. Further
+ * downloads from this server send one request at a time.
+ * Returns true if pipelining was enabled before.
+ */
+bool NewsServer::DisablePipelining(const char* reason)
+{
+	if (m_pipeliningFailed.exchange(true))
+	{
+		return false;
+	}
+
+	warn("Pipelining disabled for %s: %s", *m_name, reason);
+	return true;
+}
@@ -28,6 +28,7 @@
 #ifndef NEWSSERVER_H
 #define NEWSSERVER_H
 
+#include <atomic>
 #include "NString.h"
 
 class NewsServer
@@ -36,7 +37,7 @@ public:
 	NewsServer(int id, bool active, const char* name, const char* host, int port, int ipVersion,
 		const char* user, const char* pass, bool joinGroup,
 		bool tls, const char* cipher, int maxConnections, int retention,
-		int level, int group, bool optional, unsigned int certVerificationfLevel);
+		int level, int group, bool optional, unsigned int certVerificationfLevel, int pipelining);
 	int GetId() const { return m_id; }
 	int GetStateId() const { return m_stateId; }
 	void SetStateId(int stateId) { m_stateId = stateId; }
@@ -61,6 +62,9 @@ public:
 	time_t GetBlockTime() const { return m_blockTime; }
 	void SetBlockTime(time_t blockTime) { m_blockTime = blockTime; }
 	unsigned int GetCertVerificationLevel() const { return m_certVerificationfLevel; }
+	int GetPipelining() const { return m_pipelining; }
+	int GetPipeliningDepth() const { return m_joinGroup || m_pipeliningFailed || m_pipelining < 1 ? 1 : m_pipelining; }
+	bool DisablePipelining(const char* reason);
 
 private:
 	int m_id;
@@ -83,6 +87,8 @@ private:
 	bool m_optional = false;
 	time_t m_blockTime = 0;
 	unsigned int m_certVerificationfLevel;
+	int m_pipelining;
+	std::atomic<bool> m_pipeliningFailed{false};
 };
 
 typedef std::vector<std::unique_ptr<NewsServer>> Servers;
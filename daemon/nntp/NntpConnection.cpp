@@ -75,6 +75,16 @@ const char* NntpConnection::Request(const char* req)
 	return answer;
 }
 
+/*
+ * Reads the response to a request which was sent earlier without waiting
+ * for the answer (pipelining).
+ */
+const char* NntpConnection::ReadResponse()
+{
+	m_authError = false;
+	return ReadLine(m_lineBuf, m_lineBuf.Size(), nullptr);
+}
+
 bool NntpConnection::Authenticate()
 {
 	if (strlen(m_newsServer->GetUser()) == 0 || strlen(m_newsServer->GetPassword()) == 0)
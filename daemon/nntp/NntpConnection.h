@@ -34,6 +34,7 @@ public:
 	virtual bool Disconnect();
 	NewsServer* GetNewsServer() { return m_newsServer; }
 	const char* Request(const char* req);
+	const char* ReadResponse();
 	const char* JoinGroup(const char* grp);
 	bool GetAuthError() { return m_authError; }
 
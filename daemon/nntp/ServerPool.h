@@ -46,6 +46,9 @@ public:
 	void CloseUnusedConnections();
 	void Changed();
 	int GetGeneration() { return m_generation; }
+	// pipelining depth of a server was reduced, unlike config changes this doesn't restart downloads
+	void PipeliningChanged() { m_pipeliningGeneration++; }
+	int GetPipeliningGeneration() { return m_pipeliningGeneration; }
 	void BlockServer(NewsServer* newsServer);
 	bool IsServerBlocked(NewsServer* newsServer);
 
@@ -77,7 +80,8 @@ private:
 	Mutex m_connectionsMutex;
 	int m_timeout = 60;
 	int m_retryInterval = 0;
-	int m_generation = 0;
+	std::atomic<int> m_generation{0};
+	std::atomic<int> m_pipeliningGeneration{0};
 
 	void NormalizeLevels();
 	NntpConnection* LockedGetConnection(int level, NewsServer* wantServer, RawServerList* ignoreServers);
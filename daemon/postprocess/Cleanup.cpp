@@ -93,8 +93,26 @@ bool MoveController::MoveFiles()
 	}
 
 	bool ok = true;
-	MoveFiles(m_interDir, m_destDir, ok);
-	
+	FileMover mover;
+	AddFiles(mover, m_interDir, m_destDir, ok);
+
+	// files on different file systems are copied, the copy can take a while
+	m_postInfo->SetStageProgress(0);
+	mover.Execute([postInfo = m_postInfo](int64 movedSize, int64 totalSize)
+		{
+			postInfo->SetStageProgress(totalSize > 0 ? (int)(movedSize * 1000 / totalSize) : 1000);
+		});
+
+	for (FileMover::File& file : mover.GetFiles())
+	{
+		if (!file.success)
+		{
+			ok = false;
+			PrintMessage(Message::mkError, "Could not move file %s to %s: %s",
+				file.srcFilename.c_str(), file.dstFilename.c_str(), *file.errmsg);
+		}
+	}
+
 	if (ok && !FileSystem::DeleteDirectoryWithContent(m_interDir.c_str(), errmsg))
 	{
 		PrintMessage(Message::mkWarning, "Could not delete intermediate directory %s: %s", m_interDir.c_str(), *errmsg);
@@ -103,7 +121,7 @@ bool MoveController::MoveFiles()
 	return ok;
 }
 
-void MoveController::MoveFiles(const std::string& src, const std::string& dest, bool& isOk)
+void MoveController::AddFiles(FileMover& mover, const std::string& src, const std::string& dest, bool& isOk)
 {
 	DirBrowser dir(src.c_str());
 	while (const char* filename = dir.Next())
@@ -115,7 +133,7 @@ void MoveController::MoveFiles(const std::string& src, const std::string& dest,
 			CString errmsg;
 			if (FileSystem::ForceDirectories(dstFile.c_str(), errmsg))
 			{
-				MoveFiles(srcFile, dstFile, isOk);
+				AddFiles(mover, srcFile, dstFile, isOk);
 			}
 			else
 			{
@@ -130,13 +148,7 @@ void MoveController::MoveFiles(const std::string& src, const std::string& dest,
 				continue;
 
 			PrintMessage(Message::mkInfo, "Moving file %s to %s", filename, dest.c_str());
-
-			if (!FileSystem::MoveFile(srcFile.c_str(), dstFile.c_str()))
-			{
-				isOk = false;
-				PrintMessage(Message::mkError, "Could not move file %s to %s: %s",
-					srcFile.c_str(), dstFile.c_str(), *FileSystem::GetLastErrorMessage());
-			}
+			mover.AddFile(srcFile, dstFile);
 		}
 	}
 }
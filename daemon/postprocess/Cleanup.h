@@ -28,6 +28,7 @@
 #include "Thread.h"
 #include "DownloadInfo.h"
 #include "ScriptController.h"
+#include "FileMover.h"
 
 class MoveController : public Thread, public ScriptController
 {
@@ -44,7 +45,7 @@ private:
 	std::string m_destDir;
 
 	bool MoveFiles();
-	void MoveFiles(const std::string& src, const std::string& dest, bool& isOk);
+	void AddFiles(FileMover& mover, const std::string& src, const std::string& dest, bool& isOk);
 };
 
 class CleanupController : public Thread, public ScriptController
@@ -76,6 +76,13 @@ void DirectUnpack::Run()
 		CString archive;
 		{
 			Guard guard(m_volumeMutex);
+			if (m_archives.empty() && !m_nzbCompleted)
+			{
+				// woken up by new archives, completion of nzb or stopping
+				m_volumeCond.WaitFor(m_volumeMutex, 1000,
+					[&]{ return !m_archives.empty() || m_nzbCompleted || IsStopped(); });
+			}
+
 			if (!m_archives.empty())
 			{
 				archive = std::move(m_archives.front());
@@ -100,13 +107,9 @@ void DirectUnpack::Run()
 				break;
 			}
 		}
-		else
+		else if (m_nzbCompleted)
 		{
-			if (m_nzbCompleted)
-			{
-				break;
-			}
-			Util::Sleep(100);
+			break;
 		}
 	}
 
@@ -144,11 +147,15 @@ void DirectUnpack::Run()
 		}
 
 		AddExtraTime(nzbInfo);
+		AddStallTime(nzbInfo);
 
 		if (nzbInfo->GetPostInfo())
 		{
 			nzbInfo->GetPostInfo()->SetWorking(false);
 		}
+
+		nzbInfo->SetChanged(true);
+		downloadQueue->SaveChanged();
 	}
 
 	debug("Exiting DirectUnpack-loop for %i", m_nzbId);
@@ -423,6 +430,7 @@ void DirectUnpack::Stop(DownloadQueue* downloadQueue, NzbInfo* nzbInfo)
 		}
 	}
 	Thread::Stop();
+	m_volumeCond.NotifyAll();
 	if (m_unpacking)
 	{
 		Terminate();
@@ -433,34 +441,77 @@ void DirectUnpack::WaitNextVolume(const char* filename)
 {
 	debug("WaitNextVolume for %s", filename);
 
-	// Stop direct unpack if destination directory was changed during unpack
+	BString<1024> fullFilename("%s%c%s", *m_destDir, PATH_SEPARATOR, filename);
+	if (FileSystem::FileExists(fullFilename))
 	{
-		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
-		NzbInfo* nzbInfo = downloadQueue->GetQueue()->Find(m_nzbId);
-		if (nzbInfo && (strcmp(m_destDir, nzbInfo->GetDestDir()) ||
-			strcmp(m_finalDir, nzbInfo->BuildFinalDirName())))
+		Write("\n"); // emulating click on Enter-key for "continue"
+		return;
+	}
+
+	bool completed = false;
+	{
+		Guard guard(m_volumeMutex);
+		completed = m_nzbCompleted;
+		if (!completed)
 		{
-			nzbInfo->AddMessage(Message::mkWarning, BString<1024>("Destination directory changed for %s", nzbInfo->GetName()));
-			Stop(downloadQueue, nzbInfo);
+			m_waitingFile = filename;
+			m_waitingStart = Util::CurrentTicks();
+
+			// the volume may have been completed after the first check but before
+			// it was marked as waited for; from now on "FileDownloaded" reports it
+			if (FileSystem::FileExists(fullFilename))
+			{
+				m_waitingFile = nullptr;
+				Write("\n");
+				return;
+			}
 		}
 	}
 
-	BString<1024> fullFilename("%s%c%s", *m_destDir, PATH_SEPARATOR, filename);
-	if (FileSystem::FileExists(fullFilename))
+	if (completed)
 	{
-		Write("\n"); // emulating click on Enter-key for "continue"
+		// nzb completed but unrar waits for another volume;
+		// the message is logged via "AddMessage" which takes the queue lock
+		PrintMessage(Message::mkWarning, "Could not find volume %s", filename);
 	}
-	else
+
+	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+	NzbInfo* nzbInfo = downloadQueue->GetQueue()->Find(m_nzbId);
+
+	// Stop direct unpack if destination directory was changed during unpack
+	if (nzbInfo && (strcmp(m_destDir, nzbInfo->GetDestDir()) ||
+		strcmp(m_finalDir, nzbInfo->BuildFinalDirName())))
 	{
-		Guard guard(m_volumeMutex);
-		m_waitingFile = filename;
-		if (m_nzbCompleted)
+		nzbInfo->AddMessage(Message::mkWarning, BString<1024>("Destination directory changed for %s", nzbInfo->GetName()));
+		Stop(downloadQueue, nzbInfo);
+	}
+	else if (completed)
+	{
+		Stop(downloadQueue, nzbInfo);
+	}
+
+	Guard guard(m_volumeMutex);
+	if (!completed && m_waitingFile && nzbInfo)
+	{
+		PrioritizeVolume(nzbInfo, filename);
+	}
+}
+
+/*
+ * Unrar is blocked until the volume is downloaded: download it before other files.
+ */
+void DirectUnpack::PrioritizeVolume(NzbInfo* nzbInfo, const char* filename)
+{
+	for (FileInfo* fileInfo : nzbInfo->GetFileList())
+	{
+		if (!strcasecmp(fileInfo->GetFilename(), filename))
 		{
-			// nzb completed but unrar waits for another volume
-			PrintMessage(Message::mkWarning, "Could not find volume %s", filename);
-			GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
-			NzbInfo* nzbInfo = downloadQueue->GetQueue()->Find(m_nzbId);
-			Stop(downloadQueue, nzbInfo);
+			if (!fileInfo->GetExtraPriority())
+			{
+				nzbInfo->PrintMessage(Message::mkDetail, "Prioritizing %s for %s", filename, *m_infoName);
+				fileInfo->SetExtraPriority(true);
+			}
+			return;
 		}
 	}
 }
@@ -479,12 +530,14 @@ void DirectUnpack::FileDownloaded(DownloadQueue* downloadQueue, FileInfo* fileIn
 	if (m_waitingFile && !strcasecmp(fileInfo->GetFilename(), m_waitingFile))
 	{
 		m_waitingFile = nullptr;
+		m_stallTicks += Util::CurrentTicks() - m_waitingStart;
 		Write("\n"); // emulating click on Enter-key for "continue"
 	}
 
 	if (IsMainArchive(fileInfo->GetFilename()))
 	{
 		m_archives.emplace_back(fileInfo->GetFilename());
+		m_volumeCond.NotifyAll();
 	}
 }
 
@@ -502,6 +555,7 @@ void DirectUnpack::NzbDownloaded(DownloadQueue* downloadQueue, NzbInfo* nzbInfo)
 
 	Guard guard(m_volumeMutex);
 	m_nzbCompleted = true;
+	m_volumeCond.NotifyAll();
 	if (m_waitingFile)
 	{
 		// nzb completed but unrar waits for another volume
@@ -565,6 +619,28 @@ void DirectUnpack::AddExtraTime(NzbInfo* nzbInfo)
 	}
 }
 
+/*
+ * Time unrar was waiting for volumes not downloaded yet: direct unpack
+ * was faster than download.
+ */
+void DirectUnpack::AddStallTime(NzbInfo* nzbInfo)
+{
+	if (m_waitingFile)
+	{
+		// stopped while waiting
+		m_stallTicks += Util::CurrentTicks() - m_waitingStart;
+		m_waitingStart = Util::CurrentTicks();
+	}
+
+	int stallSec = (int)(m_stallTicks / 1000000);
+	if (stallSec > 0)
+	{
+		nzbInfo->SetUnpackStallSec(nzbInfo->GetUnpackStallSec() + stallSec);
+		nzbInfo->PrintMessage(Message::mkDetail, "%s was waiting for volumes %i sec", *m_infoNameUp, stallSec);
+	}
+	m_stallTicks = 0;
+}
+
 bool DirectUnpack::IsArchiveFilename(const char* filename)
 {
 	if (Util::EndsWith(filename, ".rar", false))
@@ -73,6 +73,9 @@ private:
 	CString m_progressLabel;
 	std::atomic<bool> m_nzbCompleted{false};
 	Mutex m_volumeMutex;
+	ConditionVar m_volumeCond;
+	int64 m_waitingStart = 0;
+	int64 m_stallTicks = 0;
 	ArchiveList m_archives;
 	time_t m_extraStartTime = 0;
 	ArchiveList m_extractedArchives;
@@ -86,10 +89,12 @@ private:
 	void ExecuteUnrar(const char* archiveName);
 	bool PrepareCmdParams(const char* command, ParamList* params, const char* infoName);
 	void WaitNextVolume(const char* filename);
+	void PrioritizeVolume(NzbInfo* nzbInfo, const char* filename);
 	void Cleanup();
 	bool IsMainArchive(const char* filename);
 	void SetProgressLabel(NzbInfo* nzbInfo, const char* progressLabel);
 	void AddExtraTime(NzbInfo* nzbInfo);
+	void AddStallTime(NzbInfo* nzbInfo);
 };
 
 #endif
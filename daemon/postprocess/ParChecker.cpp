@@ -413,7 +413,16 @@ ParChecker::EStatus ParChecker::RunParCheck(std::string parFilename)
 	else if (res == Par2::eRepairPossible)
 	{
 		status = psRepairPossible;
-		if (g_Options->GetParRepair())
+		if (!g_Options->GetParRepair())
+		{
+			PrintMessage(Message::mkInfo, "Repair possible for %s", m_infoName.c_str());
+		}
+		else
+		{
+			WaitRepairSlot();
+		}
+
+		if (g_Options->GetParRepair() && !IsStopped())
 		{
 			PrintMessage(Message::mkInfo, "Repairing %s", m_infoName.c_str());
 
@@ -439,10 +448,6 @@ ParChecker::EStatus ParChecker::RunParCheck(std::string parFilename)
 				status = psFailed;
 			}
 		}
-		else
-		{
-			PrintMessage(Message::mkInfo, "Repair possible for %s", m_infoName.c_str());
-		}
 	}
 
 	if (IsStopped())
@@ -1197,7 +1202,9 @@ void ParChecker::DeleteLeftovers()
  *   download with CRC stored in PAR2-file;
  * - for partially downloaded files the CRCs of articles are compared with block-CRCs stored
  *   in PAR2-file;
- * - for completely failed files (not a single successful article) no verification is needed at all.
+ * - for completely failed files (not a single successful article) no verification is needed at all;
+ * - for files verified block by block during download (see BlockVerifier) only blocks, which
+ *   couldn't be verified during download, are read from disk.
  *
  * Limitation of the function:
  * This function requires every block in the file to have an unique CRC (across all blocks
@@ -1233,22 +1240,45 @@ ParChecker::EFileStatus ParChecker::VerifyDataFile(Par2::DiskFile& diskFile, Par
 		return fsFailure;
 	}
 
-	// find file status and CRC computed during download
 	uint32 downloadCrc;
 	SegmentList segments;
-	EFileStatus	fileStatus = FindFileCrc(FileSystem::BaseFileName(filename.c_str()), &downloadCrc, &segments);
+	EFileStatus	fileStatus;
 	ValidBlocks validBlocks;
+	BlockVerifier::BlockStatusList blockStatus;
 
-	if (fileStatus == fsFailure || fileStatus == fsUnknown)
+	if (FindFileBlocks(FileSystem::BaseFileName(filename.c_str()), GetRepairer()->mainpacket->BlockSize(), &blockStatus) &&
+		blockStatus.size() == packet->BlockCount())
 	{
-		return fileStatus;
+		// blocks verified during download
+		if (!VerifyDownloadedBlocks(sourceFile, blockStatus, validBlocks))
+		{
+			return fsUnknown;
+		}
+
+		int validCount = (int)std::count(validBlocks.begin(), validBlocks.end(), true);
+		fileStatus = validCount == (int)validBlocks.size() ? fsSuccess : validCount > 0 ? fsPartial : fsFailure;
+		if (fileStatus == fsFailure)
+		{
+			availableBlocks = 0;
+			return fsFailure;
+		}
 	}
-	else if ((fileStatus == fsSuccess && !VerifySuccessDataFile(diskFile, sourceFile, downloadCrc)) ||
-		(fileStatus == fsPartial && !VerifyPartialDataFile(diskFile, sourceFile, segments, validBlocks)))
+	else
 	{
-		PrintMessage(Message::mkWarning, "Quick verification failed for %s file %s, performing full verification instead",
-			fileStatus == fsSuccess ? "good" : "damaged", FileSystem::BaseFileName(filename.c_str()));
-		return fsUnknown; // let libpar2 do the full verification of the file
+		// find file status and CRC computed during download
+		fileStatus = FindFileCrc(FileSystem::BaseFileName(filename.c_str()), &downloadCrc, &segments);
+
+		if (fileStatus == fsFailure || fileStatus == fsUnknown)
+		{
+			return fileStatus;
+		}
+		else if ((fileStatus == fsSuccess && !VerifySuccessDataFile(diskFile, sourceFile, downloadCrc)) ||
+			(fileStatus == fsPartial && !VerifyPartialDataFile(diskFile, sourceFile, segments, validBlocks)))
+		{
+			PrintMessage(Message::mkWarning, "Quick verification failed for %s file %s, performing full verification instead",
+				fileStatus == fsSuccess ? "good" : "damaged", FileSystem::BaseFileName(filename.c_str()));
+			return fsUnknown; // let libpar2 do the full verification of the file
+		}
 	}
 
 	// attach verification blocks to the file
@@ -1416,57 +1446,122 @@ bool ParChecker::VerifyPartialDataFile(Par2::DiskFile& diskFile, Par2::Par2Repai
 	return true;
 }
 
+/*
+ * Determine valid blocks of a file verified during download. Blocks whose status
+ * remained unknown are read from disk and verified using block CRCs.
+ */
+bool ParChecker::VerifyDownloadedBlocks(Par2::Par2RepairerSourceFile& sourceFile,
+	BlockVerifier::BlockStatusList& blockStatus, ValidBlocks& validBlocks)
+{
+	Par2::VerificationPacket* packet = sourceFile.GetVerificationPacket();
+	int64 blocksize = GetRepairer()->mainpacket->BlockSize();
+	std::string filenameObj = sourceFile.GetTargetFile()->FileName();
+	const char* filename = filenameObj.c_str();
+	int64 fileSize = sourceFile.GetTargetFile()->FileSize();
+
+	validBlocks.resize(blockStatus.size(), false);
+
+	DiskFile infile;
+	for (size_t i = 0; i < blockStatus.size(); ++i)
+	{
+		if (blockStatus[i] != BlockVerifier::bsUnknown)
+		{
+			validBlocks[i] = blockStatus[i] == BlockVerifier::bsValid;
+			continue;
+		}
+
+		if (!infile.Active() && !infile.Open(filename, DiskFile::omRead))
+		{
+			PrintMessage(Message::mkError, "Could not open file %s: %s",
+				filename, *FileSystem::GetLastErrorMessage());
+			return false;
+		}
+
+		int64 bytesStart = i * blocksize;
+		int64 bytesEnd = bytesStart + blocksize - 1;
+		uint32 blockCrc = 0;
+		if (!DumbCalcFileRangeCrc(infile, bytesStart, bytesEnd < fileSize - 1 ? bytesEnd : fileSize - 1, blockCrc))
+		{
+			return false;
+		}
+		if (bytesEnd > fileSize - 1)
+		{
+			// for the last block: extend CRC to block size
+			blockCrc = Par2::CRCUpdateBlock(blockCrc ^ 0xFFFFFFFF, (size_t)(bytesEnd - (fileSize - 1))) ^ 0xFFFFFFFF;
+		}
+
+		Par2::u32 parCrc = packet->VerificationEntry(i)->crc;
+		validBlocks[i] = blockCrc == parCrc;
+	}
+
+	return true;
+}
+
 /*
  * Compute CRC of bytes range of file using CRCs of segments and reading some data directly
- * from file if necessary
+ * from file if necessary: only parts of segments crossing range boundaries and gaps
+ * between segments are read
  */
 bool ParChecker::SmartCalcFileRangeCrc(DiskFile& file, int64 start, int64 end, SegmentList& segments,
 	uint32& downloadCrcOut)
 {
 	uint32 downloadCrc = 0;
-	bool started = false;
-	for (Segment& segment : segments)
+	int64 pos = start;
+
+	auto appendCrc = [&downloadCrc, &pos, start](uint32 crc, int64 size)
+	{
+		downloadCrc = pos == start ? crc : Crc32::Combine(downloadCrc, crc, (uint32)size);
+		pos += size;
+	};
+
+	auto readRange = [this, &file, &appendCrc, &pos](int64 rangeEnd)
 	{
-		if (!started && segment.GetOffset() > start)
+		uint32 partialCrc = 0;
+		if (!DumbCalcFileRangeCrc(file, pos, rangeEnd, partialCrc))
 		{
-			// read start of range from file
-			if (!DumbCalcFileRangeCrc(file, start, segment.GetOffset() - 1, downloadCrc))
-			{
-				return false;
-			}
-			if (segment.GetOffset() + segment.GetSize() >= end)
-			{
-				break;
-			}
-			started = true;
+			return false;
 		}
+		appendCrc(partialCrc, rangeEnd - pos + 1);
+		return true;
+	};
 
-		if (segment.GetOffset() >= start && segment.GetOffset() + segment.GetSize() <= end)
+	for (Segment& segment : segments)
+	{
+		int64 segmentEnd = segment.GetOffset() + segment.GetSize() - 1;
+		if (segmentEnd < pos)
 		{
-			downloadCrc = !started ? segment.GetCrc() : Crc32::Combine(downloadCrc, segment.GetCrc(), (uint32)segment.GetSize());
-			started = true;
+			continue;
 		}
-
-		if (segment.GetOffset() + segment.GetSize() == end)
+		if (segment.GetOffset() > end)
 		{
 			break;
 		}
 
-		if (segment.GetOffset() + segment.GetSize() > end)
+		if (segment.GetOffset() > pos && !readRange(segment.GetOffset() - 1))
 		{
-			// read end of range from file
-			uint32 partialCrc = 0;
-			if (!DumbCalcFileRangeCrc(file, segment.GetOffset(), end, partialCrc))
-			{
-				return false;
-			}
+			return false;
+		}
 
-			downloadCrc = Crc32::Combine(downloadCrc, (uint32)partialCrc, (uint32)(end - segment.GetOffset() + 1));
+		if (segment.GetSuccess() && segment.GetOffset() == pos && segmentEnd <= end)
+		{
+			appendCrc(segment.GetCrc(), segment.GetSize());
+		}
+		else if (!readRange(std::min(segmentEnd, end)))
+		{
+			return false;
+		}
 
+		if (pos > end)
+		{
 			break;
 		}
 	}
 
+	if (pos <= end && !readRange(end))
+	{
+		return false;
+	}
+
 	downloadCrcOut = downloadCrc;
 	return true;
 }
@@ -1485,7 +1580,7 @@ bool ParChecker::DumbCalcFileRangeCrc(DiskFile& file, int64 start, int64 end, ui
 	Crc32 downloadCrc;
 
 	int cnt = buffer.Size();
-	while (cnt == buffer.Size() && start < end)
+	while (cnt == buffer.Size() && start <= end)
 	{
 		int needBytes = end - start + 1 > buffer.Size() ? buffer.Size() : (int)(end - start + 1);
 		cnt = (int)file.Read(buffer, needBytes);
@@ -33,6 +33,7 @@
 #include "Container.h"
 #include "FileSystem.h"
 #include "Log.h"
+#include "BlockVerifier.h"
 
 class Repairer;
 
@@ -142,12 +143,18 @@ protected:
 	virtual void UpdateProgress() {}
 	virtual bool IsStopped() { return false; };
 	virtual void Completed() {}
+	/**
+	* Called before repair, returns when the repair can start or if the par-check was stopped
+	*/
+	virtual void WaitRepairSlot() {}
 	virtual void PrintMessage([[maybe_unused]] Message::EKind kind,
 		[[maybe_unused]] const char* format, ...) PRINTF_SYNTAX(3) {}
 	virtual void RegisterParredFile([[maybe_unused]] const char* filename) {}
 	virtual bool IsParredFile([[maybe_unused]] const char* filename) { return false; }
 	virtual EFileStatus FindFileCrc([[maybe_unused]] const char* filename, [[maybe_unused]] uint32* crc,
 		[[maybe_unused]] SegmentList* segments) { return fsUnknown; }
+	virtual bool FindFileBlocks([[maybe_unused]] const char* filename, [[maybe_unused]] int64 blockSize,
+		[[maybe_unused]] BlockVerifier::BlockStatusList* blockStatus) { return false; }
 	virtual const char* FindFileOrigname([[maybe_unused]] const char* filename) { return nullptr; }
 	virtual void RequestDupeSources([[maybe_unused]] DupeSourceList* dupeSourceList) {}
 	virtual void StatDupeSources([[maybe_unused]] DupeSourceList* dupeSourceList) {}
@@ -232,6 +239,7 @@ private:
 	EFileStatus VerifyDataFile(Par2::DiskFile& diskFile, Par2::Par2RepairerSourceFile& sourceFile, int& availableBlocks);
 	bool VerifySuccessDataFile(Par2::DiskFile& diskFile, Par2::Par2RepairerSourceFile& sourceFile, uint32 downloadCrc);
 	bool VerifyPartialDataFile(Par2::DiskFile& diskFile, Par2::Par2RepairerSourceFile& sourceFile, SegmentList& segments, ValidBlocks& validBlocks);
+	bool VerifyDownloadedBlocks(Par2::Par2RepairerSourceFile& sourceFile, BlockVerifier::BlockStatusList& blockStatus, ValidBlocks& validBlocks);
 	void FindExtraFiles(std::vector<std::string> extrafiles, const char* directory, bool externalDir);
 	void SortExtraFiles(std::vector<std::string>& extrafiles);
 	bool SmartCalcFileRangeCrc(DiskFile& file, int64 start, int64 end, SegmentList& segments, uint32& downloadCrc);
@@ -0,0 +1,82 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+#include "PostStageLimiter.h"
+
+PostStageLimiter::EStageClass PostStageLimiter::GetStageClass(PostInfo::EStage stage)
+{
+	switch (stage)
+	{
+		case PostInfo::ptQueued:
+		case PostInfo::ptFinished:
+			return scNone;
+
+		case PostInfo::ptRepairing:
+			return scRepair;
+
+		case PostInfo::ptExecutingScript:
+			return scScript;
+
+		default:
+			return scDisk;
+	}
+}
+
+/*
+ * A par-check job holding a repair slot counts as repair until the job ends,
+ * a job waiting for a repair slot doesn't count at all.
+ */
+PostStageLimiter::EStageClass PostStageLimiter::GetJobClass(PostInfo* postInfo)
+{
+	if (!postInfo->GetWorking() || postInfo->GetWaitingRepair())
+	{
+		return scNone;
+	}
+
+	return postInfo->GetRepairSlot() ? scRepair : GetStageClass(postInfo->GetStage());
+}
+
+bool PostStageLimiter::CanEnterStage(const RawNzbList& activeJobs, PostInfo* postInfo,
+	PostInfo::EStage stage, int64 deviceId)
+{
+	EStageClass stageClass = GetStageClass(stage);
+	if (stageClass == scNone)
+	{
+		return true;
+	}
+
+	int limit =
+		stageClass == scRepair ? m_repairLimit :
+		stageClass == scDisk ? m_diskLimit :
+		m_scriptLimit;
+
+	int jobs = 0;
+	for (NzbInfo* postJob : activeJobs)
+	{
+		PostInfo* postInfo1 = postJob->GetPostInfo();
+		// disk intensive stages are limited per disk
+		if (postInfo1 != postInfo && GetJobClass(postInfo1) == stageClass &&
+			(stageClass != scDisk || postInfo1->GetDeviceId() == deviceId))
+		{
+			jobs++;
+		}
+	}
+
+	return jobs < limit;
+}
@@ -0,0 +1,58 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef POSTSTAGELIMITER_H
+#define POSTSTAGELIMITER_H
+
+#include "DownloadInfo.h"
+
+/*
+ * Limits the number of post-processing jobs running stages of the same class
+ * at once (strategy "pipeline"): par-repairs, disk intensive stages (per disk)
+ * and extension scripts.
+ */
+class PostStageLimiter
+{
+public:
+	enum EStageClass
+	{
+		scNone,
+		scRepair,
+		scDisk,
+		scScript
+	};
+
+	PostStageLimiter(int repairLimit, int diskLimit, int scriptLimit) :
+		m_repairLimit(repairLimit), m_diskLimit(diskLimit), m_scriptLimit(scriptLimit) {}
+	static EStageClass GetStageClass(PostInfo::EStage stage);
+	static EStageClass GetJobClass(PostInfo* postInfo);
+
+	/*
+	 * Returns true if the job can enter the stage without exceeding the limit
+	 * of the stage class; "deviceId" is the disk the job writes to.
+	 */
+	bool CanEnterStage(const RawNzbList& activeJobs, PostInfo* postInfo, PostInfo::EStage stage,
+		int64 deviceId);
+
+private:
+	int m_repairLimit;
+	int m_diskLimit;
+	int m_scriptLimit;
+};
+
+#endif
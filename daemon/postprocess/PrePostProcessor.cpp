@@ -38,6 +38,7 @@
 #include "ParParser.h"
 #include "DirectUnpack.h"
 #include "PostUnpackRenamer.h"
+#include "PostStageLimiter.h"
 #include <mutex>
 
 PrePostProcessor::PrePostProcessor()
@@ -561,6 +562,8 @@ void PrePostProcessor::CheckRequestPar(DownloadQueue* downloadQueue)
 
 void PrePostProcessor::CleanupJobs(DownloadQueue* downloadQueue)
 {
+	size_t jobCount = m_activeJobs.size();
+
 	m_activeJobs.erase(std::remove_if(m_activeJobs.begin(), m_activeJobs.end(),
 		[processor = this, downloadQueue](NzbInfo* postJob)
 		{
@@ -571,6 +574,8 @@ void PrePostProcessor::CleanupJobs(DownloadQueue* downloadQueue)
 				delete postInfo->GetPostThread();
 				postInfo->SetPostThread(nullptr);
 
+				postInfo->SetWaitingRepair(false);
+				postInfo->SetRepairSlot(false);
 				postInfo->SetStageTime(0);
 				postInfo->SetStageProgress(0);
 				postInfo->SetFileProgress(0);
@@ -596,6 +601,12 @@ void PrePostProcessor::CleanupJobs(DownloadQueue* downloadQueue)
 			return false;
 		}),
 		m_activeJobs.end());
+
+	if (m_activeJobs.size() != jobCount)
+	{
+		// the finished jobs released their slots
+		NotifyRepairSlots();
+	}
 }
 
 bool PrePostProcessor::CanRunMoreJobs(bool* allowPar)
@@ -631,6 +642,11 @@ bool PrePostProcessor::CanRunMoreJobs(bool* allowPar)
 		case Options::ppRocket:
 			*allowPar = parJobs < 2;
 			return totalJobs < 6;
+
+		case Options::ppPipeline:
+			// jobs are limited per stage in EnterStage
+			*allowPar = true;
+			return true;
 	}
 
 	return false;
@@ -649,7 +665,9 @@ NzbInfo* PrePostProcessor::PickNextJob(DownloadQueue* downloadQueue, bool allowP
 			(!g_WorkState->GetPausePostProcess() || nzbInfo1->GetForcePriority()) &&
 			(allowPar || !nzbInfo1->GetPostInfo()->GetNeedParCheck()) &&
 			(std::find(m_activeJobs.begin(), m_activeJobs.end(), nzbInfo1) == m_activeJobs.end()) &&
-			nzbInfo1->IsDownloadCompleted(true))
+			nzbInfo1->IsDownloadCompleted(true) &&
+			(nzbInfo1->GetPostInfo()->GetWaitingStage() == PostInfo::ptQueued ||
+			 CanEnterStage(nzbInfo1->GetPostInfo(), nzbInfo1->GetPostInfo()->GetWaitingStage())))
 		{
 			nzbInfo = nzbInfo1;
 		}
@@ -715,7 +733,10 @@ void PrePostProcessor::StartJob(DownloadQueue* downloadQueue, PostInfo* postInfo
 		nzbInfo->GetDeleteStatus() == NzbInfo::dsNone &&
 		g_Options->GetParRename())
 	{
-		EnterStage(downloadQueue, postInfo, PostInfo::ptParRenaming);
+		if (!EnterStage(downloadQueue, postInfo, PostInfo::ptParRenaming))
+		{
+			return;
+		}
 		RenameController::StartJob(postInfo, RenameController::jkPar);
 		return;
 	}
@@ -732,7 +753,10 @@ void PrePostProcessor::StartJob(DownloadQueue* downloadQueue, PostInfo* postInfo
 				return;
 			}
 
-			EnterStage(downloadQueue, postInfo, PostInfo::ptLoadingPars);
+			if (!EnterStage(downloadQueue, postInfo, PostInfo::ptLoadingPars))
+			{
+				return;
+			}
 			postInfo->SetNeedParCheck(false);
 			RepairController::StartJob(postInfo);
 		}
@@ -788,7 +812,10 @@ void PrePostProcessor::StartJob(DownloadQueue* downloadQueue, PostInfo* postInfo
 	if (nzbInfo->GetRarRenameStatus() == NzbInfo::rsNone &&
 		unpack && g_Options->GetRarRename())
 	{
-		EnterStage(downloadQueue, postInfo, PostInfo::ptRarRenaming);
+		if (!EnterStage(downloadQueue, postInfo, PostInfo::ptRarRenaming))
+		{
+			return;
+		}
 		RenameController::StartJob(postInfo, RenameController::jkRar);
 		return;
 	}
@@ -866,35 +893,132 @@ void PrePostProcessor::StartJob(DownloadQueue* downloadQueue, PostInfo* postInfo
 
 	if (unpack)
 	{
-		EnterStage(downloadQueue, postInfo, PostInfo::ptUnpacking);
+		if (!EnterStage(downloadQueue, postInfo, PostInfo::ptUnpacking))
+		{
+			return;
+		}
 		UnpackController::StartJob(postInfo);
 	}
 	else if (cleanup)
 	{
-		EnterStage(downloadQueue, postInfo, PostInfo::ptCleaningUp);
+		if (!EnterStage(downloadQueue, postInfo, PostInfo::ptCleaningUp))
+		{
+			return;
+		}
 		CleanupController::StartJob(postInfo);
 	}
 	else if (moveInter)
 	{
-		EnterStage(downloadQueue, postInfo, PostInfo::ptMoving);
+		if (!EnterStage(downloadQueue, postInfo, PostInfo::ptMoving))
+		{
+			return;
+		}
 		MoveController::StartJob(postInfo);
 	}
 	else if (postUnpackRenaming)
 	{
-		EnterStage(downloadQueue, postInfo, PostInfo::ptPostUnpackRenaming);
+		if (!EnterStage(downloadQueue, postInfo, PostInfo::ptPostUnpackRenaming))
+		{
+			return;
+		}
 		PostUnpackRenamer::Controller::StartJob(postInfo);
 	}
 	else
 	{
-		EnterStage(downloadQueue, postInfo, PostInfo::ptExecutingScript);
+		if (!EnterStage(downloadQueue, postInfo, PostInfo::ptExecutingScript))
+		{
+			return;
+		}
 		PostScriptController::StartJob(postInfo);
 	}
 }
 
-void PrePostProcessor::EnterStage(DownloadQueue* downloadQueue, PostInfo* postInfo, PostInfo::EStage stage)
+/*
+ * Returns false if the job must wait for a free slot of the stage (strategy "pipeline"),
+ * the stage is remembered to not pick the job until a slot becomes free.
+ */
+bool PrePostProcessor::EnterStage(DownloadQueue* downloadQueue, PostInfo* postInfo, PostInfo::EStage stage)
 {
+	if (g_Options->GetPostStrategy() == Options::ppPipeline)
+	{
+		if (!CanEnterStage(postInfo, stage))
+		{
+			postInfo->SetWaitingStage(stage);
+			return false;
+		}
+		postInfo->SetDeviceId(FileSystem::GetDeviceId(postInfo->GetNzbInfo()->GetDestDir()));
+	}
+
+	postInfo->SetWaitingStage(PostInfo::ptQueued);
 	postInfo->SetWorking(true);
 	postInfo->SetStage(stage);
+	return true;
+}
+
+bool PrePostProcessor::CanEnterStage(PostInfo* postInfo, PostInfo::EStage stage)
+{
+	PostStageLimiter limiter(g_Options->GetPostRepairLimit(), g_Options->GetPostDiskLimit(),
+		g_Options->GetPostScriptLimit());
+	int64 deviceId = PostStageLimiter::GetStageClass(stage) == PostStageLimiter::scDisk ?
+		FileSystem::GetDeviceId(postInfo->GetNzbInfo()->GetDestDir()) : 0;
+	return limiter.CanEnterStage(m_activeJobs, postInfo, stage, deviceId);
+}
+
+/*
+ * Called by par-checker before repair. With strategy "pipeline" the number of
+ * simultaneous repairs is limited, the job waits for a free slot without
+ * occupying its disk slot and keeps the slot until the par-check ends.
+ * Other strategies limit par-jobs on their own.
+ */
+bool PrePostProcessor::AcquireRepairSlot(PostInfo* postInfo)
+{
+	if (g_Options->GetPostStrategy() != Options::ppPipeline)
+	{
+		return true;
+	}
+
+	GuardedDownloadQueue guard = DownloadQueue::Guard();
+
+	bool acquired = CanEnterStage(postInfo, PostInfo::ptRepairing);
+	postInfo->SetRepairSlot(acquired);
+	postInfo->SetWaitingRepair(!acquired);
+	return acquired;
+}
+
+/*
+ * Waits until a repair slot becomes free, returns false if the thread was
+ * stopped. Slots are released when jobs end, see CleanupJobs().
+ */
+bool PrePostProcessor::WaitRepairSlot(PostInfo* postInfo, Thread* thread)
+{
+	while (!thread->IsStopped())
+	{
+		int slotChanges;
+		{
+			std::lock_guard<std::mutex> guard(m_slotMutex);
+			slotChanges = m_slotChanges;
+		}
+
+		if (AcquireRepairSlot(postInfo))
+		{
+			return true;
+		}
+
+		std::unique_lock<std::mutex> lock(m_slotMutex);
+		m_slotCond.wait(lock, [&] { return m_slotChanges != slotChanges || thread->IsStopped(); });
+	}
+
+	return false;
+}
+
+// Wakes up jobs waiting for repair slots, also called when a waiting thread is stopped
+void PrePostProcessor::NotifyRepairSlots()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_slotMutex);
+		m_slotChanges++;
+	}
+	m_slotCond.notify_all();
 }
 
 void PrePostProcessor::JobCompleted(DownloadQueue* downloadQueue, PostInfo* postInfo)
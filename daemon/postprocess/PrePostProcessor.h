@@ -38,6 +38,9 @@ public:
 		const char* args);
 	void NzbAdded(DownloadQueue* downloadQueue, NzbInfo* nzbInfo);
 	void NzbDownloaded(DownloadQueue* downloadQueue, NzbInfo* nzbInfo);
+	bool AcquireRepairSlot(PostInfo* postInfo);
+	bool WaitRepairSlot(PostInfo* postInfo, Thread* thread);
+	void NotifyRepairSlots();
 
 protected:
 	void Update(Subject*, void* aspect) override { DownloadQueueUpdate(aspect); }
@@ -47,6 +50,9 @@ private:
 	RawNzbList m_activeJobs;
 	std::mutex m_waitMutex;
 	std::condition_variable m_waitCond;
+	std::mutex m_slotMutex;
+	std::condition_variable m_slotCond;
+	int m_slotChanges = 0;
 
 	void CheckPostQueue();
 	void CheckRequestPar(DownloadQueue* downloadQueue);
@@ -54,7 +60,8 @@ private:
 	bool CanRunMoreJobs(bool* allowPar);
 	NzbInfo* PickNextJob(DownloadQueue* downloadQueue, bool allowPar);
 	void StartJob(DownloadQueue* downloadQueue, PostInfo* postInfo, bool allowPar);
-	void EnterStage(DownloadQueue* downloadQueue, PostInfo* postInfo, PostInfo::EStage stage);
+	bool EnterStage(DownloadQueue* downloadQueue, PostInfo* postInfo, PostInfo::EStage stage);
+	bool CanEnterStage(PostInfo* postInfo, PostInfo::EStage stage);
 	void SanitisePostQueue();
 	void UpdatePauseState();
 	void NzbFound(DownloadQueue* downloadQueue, NzbInfo* nzbInfo);
@@ -27,6 +27,7 @@
 #include "DiskState.h"
 #include "Log.h"
 #include "FileSystem.h"
+#include "PrePostProcessor.h"
 
 #ifndef DISABLE_PARCHECK
 bool RepairController::PostParChecker::RequestMorePars(int blockNeeded, int* blockFound)
@@ -100,10 +101,28 @@ ParChecker::EFileStatus RepairController::PostParChecker::FindFileCrc(const char
 			return ParChecker::fsUnknown;
 		}
 
+		int64 successSize = 0;
 		for (ArticleInfo* pa : tmpFileInfo.GetArticles())
 		{
 			segments->emplace_back(pa->GetStatus() == ArticleInfo::aiFinished,
 				pa->GetSegmentOffset(), pa->GetSegmentSize(), pa->GetCrc());
+			successSize += pa->GetStatus() == ArticleInfo::aiFinished ? pa->GetSegmentSize() : 0;
+		}
+
+		// CRCs of articles split at par2-block boundaries allow to verify blocks
+		// without reading the file; the map must cover all downloaded articles
+		int64 mapSize = 0;
+		for (BlockVerifier::CrcRange& range : *tmpFileInfo.GetCrcMap())
+		{
+			mapSize += range.size;
+		}
+		if (mapSize > 0 && mapSize == successSize)
+		{
+			segments->clear();
+			for (BlockVerifier::CrcRange& range : *tmpFileInfo.GetCrcMap())
+			{
+				segments->emplace_back(true, range.offset, range.size, range.crc);
+			}
 		}
 	}
 
@@ -115,6 +134,30 @@ ParChecker::EFileStatus RepairController::PostParChecker::FindFileCrc(const char
 		ParChecker::fsUnknown;
 }
 
+bool RepairController::PostParChecker::FindFileBlocks(const char* filename, int64 blockSize,
+	BlockVerifier::BlockStatusList* blockStatus)
+{
+	if (m_postInfo->GetNzbInfo()->GetReprocess())
+	{
+		return false;
+	}
+
+	for (CompletedFile& completedFile : m_postInfo->GetNzbInfo()->GetCompletedFiles())
+	{
+		if (!strcasecmp(completedFile.GetFilename(), filename))
+		{
+			if (completedFile.GetBlockSize() != blockSize || completedFile.GetBlockStatus()->empty())
+			{
+				return false;
+			}
+			*blockStatus = *completedFile.GetBlockStatus();
+			return true;
+		}
+	}
+
+	return false;
+}
+
 const char* RepairController::PostParChecker::FindFileOrigname(const char* filename)
 {
 	for (CompletedFile& completedFile : m_postInfo->GetNzbInfo()->GetCompletedFiles())
@@ -174,6 +217,8 @@ void RepairController::PostParChecker::StatDupeSources(DupeSourceList* dupeSourc
 					historyInfo->GetNzbInfo()->GetId() == dupeSource.GetId())
 				{
 					historyInfo->GetNzbInfo()->SetExtraParBlocks(historyInfo->GetNzbInfo()->GetExtraParBlocks() - dupeSource.GetUsedBlocks());
+					historyInfo->SetChanged(true);
+					downloadQueue->HistoryChanged();
 				}
 			}
 		}
@@ -213,6 +258,8 @@ void RepairController::Stop()
 	Thread::Stop();
 #ifndef DISABLE_PARCHECK
 	m_parChecker.Cancel();
+	// the thread may be waiting for a repair slot
+	g_PrePostProcessor->NotifyRepairSlots();
 #endif
 }
 
@@ -304,6 +351,16 @@ void RepairController::ParCheckCompleted()
 	postInfo->SetWorking(false);
 }
 
+void RepairController::WaitRepairSlot()
+{
+	if (!g_PrePostProcessor->AcquireRepairSlot(m_postInfo))
+	{
+		m_parChecker.PrintMessage(Message::mkInfo, "Waiting for other par-repairs to finish for %s",
+			m_parChecker.GetInfoName());
+		g_PrePostProcessor->WaitRepairSlot(m_postInfo, this);
+	}
+}
+
 /**
 * Unpause par2-files
 * returns true, if the files with required number of blocks were unpaused,
@@ -45,6 +45,7 @@ public:
 protected:
 	void UpdateParCheckProgress();
 	void ParCheckCompleted();
+	void WaitRepairSlot();
 	void CheckPauseState(PostInfo* postInfo);
 	bool RequestMorePars(NzbInfo* nzbInfo, const char* parFilename, int blockNeeded, int* blockFound);
 
@@ -65,10 +66,12 @@ private:
 		virtual void UpdateProgress();
 		virtual bool IsStopped() { return m_owner->IsStopped(); };
 		virtual void Completed() { m_owner->ParCheckCompleted(); }
+		void WaitRepairSlot() override { m_owner->WaitRepairSlot(); }
 		virtual void PrintMessage(Message::EKind kind, const char* format, ...) PRINTF_SYNTAX(3);
 		virtual void RegisterParredFile(const char* filename);
 		virtual bool IsParredFile(const char* filename);
 		EFileStatus FindFileCrc(const char* filename, uint32* crc, SegmentList* segments) override;
+		bool FindFileBlocks(const char* filename, int64 blockSize, BlockVerifier::BlockStatusList* blockStatus) override;
 		virtual const char* FindFileOrigname(const char* filename);
 		virtual void RequestDupeSources(DupeSourceList* dupeSourceList);
 		virtual void StatDupeSources(DupeSourceList* dupeSourceList);
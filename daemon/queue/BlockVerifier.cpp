@@ -0,0 +1,214 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include "BlockVerifier.h"
+
+BlockVerifier::BlockVerifier(int64 fileSize, int64 blockSize, std::vector<uint32> blockCrcs) :
+	m_fileSize(fileSize), m_blockSize(blockSize), m_blockCrcs(std::move(blockCrcs))
+{
+	m_status.resize(m_blockCrcs.size(), bsUnknown);
+	m_uncertain.resize(m_blockCrcs.size(), false);
+	m_usable = m_blockSize > 0 && (int64)m_blockCrcs.size() == (m_fileSize + m_blockSize - 1) / m_blockSize;
+}
+
+int BlockVerifier::GetBlockLength(int block)
+{
+	int64 blockStart = block * m_blockSize;
+	return (int)std::min(m_blockSize, m_fileSize - blockStart);
+}
+
+void BlockVerifier::AddArticle(int64 offset, int size, uint32 crc, const std::vector<uint32>& pieceCrcs)
+{
+	if (!m_usable)
+	{
+		return;
+	}
+
+	if (size <= 0 || offset < 0 || offset + size > m_fileSize)
+	{
+		// the article doesn't belong to the file described by par2-file
+		m_usable = false;
+		return;
+	}
+
+	int firstBlock = (int)(offset / m_blockSize);
+	int lastBlock = (int)((offset + size - 1) / m_blockSize);
+	if ((int)pieceCrcs.size() != lastBlock - firstBlock)
+	{
+		// article crosses block boundaries but CRCs of its parts are unknown
+		for (int block = firstBlock; block <= lastBlock; block++)
+		{
+			m_uncertain[block] = true;
+		}
+		m_crcMap.push_back({offset, size, crc});
+		return;
+	}
+
+	int64 pos = offset;
+	uint32 headCrc = 0;
+	int64 headSize = 0;
+	for (uint32 pieceCrc : pieceCrcs)
+	{
+		int64 boundary = (pos / m_blockSize + 1) * m_blockSize;
+		int pieceSize = (int)(boundary - pos);
+		AddPiece((int)(pos / m_blockSize), (int)(pos % m_blockSize), pieceSize, pieceCrc);
+		m_crcMap.push_back({pos, pieceSize, pieceCrc});
+		headCrc = headSize == 0 ? pieceCrc : Crc32::Combine(headCrc, pieceCrc, pieceSize);
+		headSize += pieceSize;
+		pos = boundary;
+	}
+
+	// crc(head + tail) = combine(crc(head), 0, len(tail)) ^ crc(tail)
+	int tailSize = (int)(offset + size - pos);
+	uint32 tailCrc = headSize == 0 ? crc : crc ^ Crc32::Combine(headCrc, 0, tailSize);
+	AddPiece(lastBlock, (int)(pos % m_blockSize), tailSize, tailCrc);
+	m_crcMap.push_back({pos, tailSize, tailCrc});
+}
+
+void BlockVerifier::AddPiece(int block, int offset, int size, uint32 crc)
+{
+	if (m_status[block] != bsUnknown)
+	{
+		return;
+	}
+
+	PieceList& pieces = m_pieces[block];
+	pieces.push_back({offset, size, crc});
+
+	int64 known = 0;
+	for (Piece& piece : pieces)
+	{
+		known += piece.size;
+	}
+
+	if (known >= GetBlockLength(block))
+	{
+		CheckBlock(block, pieces);
+		m_pieces.erase(block);
+	}
+}
+
+void BlockVerifier::CheckBlock(int block, PieceList& pieces)
+{
+	std::sort(pieces.begin(), pieces.end(),
+		[](const Piece& piece1, const Piece& piece2)
+		{
+			return piece1.offset < piece2.offset;
+		});
+
+	uint32 crc = 0;
+	int pos = 0;
+	for (Piece& piece : pieces)
+	{
+		if (piece.offset != pos)
+		{
+			// overlapping articles
+			m_usable = false;
+			return;
+		}
+		crc = pos == 0 ? piece.crc : Crc32::Combine(crc, piece.crc, piece.size);
+		pos += piece.size;
+	}
+
+	if (pos < m_blockSize)
+	{
+		// par2 calculates CRC of the last block padded with zeros
+		static const char zeros[16 * 1024] = {0};
+		Crc32 padding;
+		for (int64 remaining = m_blockSize - pos; remaining > 0; remaining -= sizeof(zeros))
+		{
+			padding.Append((uchar*)zeros, (uint32)std::min(remaining, (int64)sizeof(zeros)));
+		}
+		crc = Crc32::Combine(crc, padding.Finish(), (uint32)(m_blockSize - pos));
+	}
+
+	SetStatus(block, crc == m_blockCrcs[block] ? bsValid : bsDamaged);
+}
+
+void BlockVerifier::SetStatus(int block, EBlockStatus status)
+{
+	m_status[block] = status;
+	m_validBlocks += status == bsValid ? 1 : 0;
+	m_damagedBlocks += status == bsDamaged ? 1 : 0;
+}
+
+bool BlockVerifier::Finish()
+{
+	if (!m_usable)
+	{
+		return false;
+	}
+
+	for (int block = 0; block < (int)m_status.size(); block++)
+	{
+		if (m_status[block] == bsUnknown && !m_uncertain[block])
+		{
+			SetStatus(block, bsDamaged);
+		}
+	}
+	m_pieces.clear();
+
+	return true;
+}
+
+BlockVerifier::CrcMap BlockVerifier::GetCrcMap()
+{
+	if (!m_usable)
+	{
+		return {};
+	}
+
+	CrcMap crcMap = m_crcMap;
+	std::sort(crcMap.begin(), crcMap.end(),
+		[](const CrcRange& range1, const CrcRange& range2)
+		{
+			return range1.offset < range2.offset;
+		});
+	return crcMap;
+}
+
+void BlockCrcCalculator::Start(int64 blockSize, int64 articleOffset, int articleSize)
+{
+	m_crc.Reset();
+	m_crcs.clear();
+	m_blockSize = blockSize;
+	m_pos = articleOffset;
+	m_nextBoundary = blockSize > 0 ? (articleOffset / blockSize + 1) * blockSize : 0;
+	m_lastBoundary = blockSize > 0 ? (articleOffset + articleSize - 1) / blockSize * blockSize : 0;
+}
+
+void BlockCrcCalculator::Append(const char* buffer, int len)
+{
+	while (len > 0 && m_pos < m_lastBoundary)
+	{
+		int size = (int)std::min((int64)len, m_nextBoundary - m_pos);
+		m_crc.Append((uchar*)buffer, size);
+		buffer += size;
+		len -= size;
+		m_pos += size;
+
+		if (m_pos == m_nextBoundary)
+		{
+			m_crcs.push_back(m_crc.Finish());
+			m_crc.Reset();
+			m_nextBoundary += m_blockSize;
+		}
+	}
+}
@@ -0,0 +1,140 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef BLOCKVERIFIER_H
+#define BLOCKVERIFIER_H
+
+#include <vector>
+#include <unordered_map>
+#include "Util.h"
+
+/**
+ * Verifies a file against checksums of par2-blocks (IFSC-packets) while the
+ * file is being downloaded, without reading the file from disk.
+ *
+ * Articles are added as they complete. Once all data of a block is known, the
+ * CRC of the block is combined from CRCs of its pieces and compared with the
+ * CRC from the par2-file. Articles rarely end on block boundaries: CRCs of
+ * parts of an article before its last block boundary are calculated during
+ * decoding (see BlockCrcCalculator), the CRC of the remaining part is derived
+ * from the CRC of the whole article.
+ *
+ * Blocks touched by articles whose pieces are unknown (articles crossing a block
+ * boundary, downloaded before the verifier was created) remain unknown; only
+ * these blocks need to be read from disk during par-check.
+ *
+ * CRCs of all added pieces and articles form the CRC map of the file, which is
+ * saved on disk for partially downloaded files, allowing par-check to verify
+ * blocks later without reading the file.
+ */
+class BlockVerifier
+{
+public:
+	enum EBlockStatus : uint8
+	{
+		bsUnknown,
+		bsValid,
+		bsDamaged
+	};
+
+	typedef std::vector<EBlockStatus> BlockStatusList;
+
+	struct CrcRange
+	{
+		int64 offset;
+		int size;
+		uint32 crc;
+	};
+
+	typedef std::vector<CrcRange> CrcMap;
+
+	BlockVerifier(int64 fileSize, int64 blockSize, std::vector<uint32> blockCrcs);
+	int64 GetBlockSize() { return m_blockSize; }
+	int GetBlockCount() { return (int)m_blockCrcs.size(); }
+	int GetValidBlocks() { return m_validBlocks; }
+	int GetDamagedBlocks() { return m_damagedBlocks; }
+	bool GetUsable() { return m_usable; }
+
+	/**
+	 * @param pieceCrcs CRCs of parts of the article before its last block boundary;
+	 * empty if the article is within one block or if the CRCs weren't calculated.
+	 */
+	void AddArticle(int64 offset, int size, uint32 crc, const std::vector<uint32>& pieceCrcs);
+
+	/**
+	 * Called after all articles were added. Blocks not completely covered by
+	 * downloaded articles are damaged, unless their pieces are partially unknown.
+	 * @return false if the articles don't match the par2-file.
+	 */
+	bool Finish();
+	const BlockStatusList& GetBlockStatus() { return m_status; }
+
+	/**
+	 * @return CRCs of downloaded data sorted by offset, split at block boundaries
+	 * where possible; empty if the articles don't match the par2-file.
+	 */
+	CrcMap GetCrcMap();
+
+private:
+	struct Piece
+	{
+		int offset;
+		int size;
+		uint32 crc;
+	};
+
+	typedef std::vector<Piece> PieceList;
+
+	int64 m_fileSize;
+	int64 m_blockSize;
+	std::vector<uint32> m_blockCrcs;
+	BlockStatusList m_status;
+	std::vector<bool> m_uncertain;
+	std::unordered_map<int, PieceList> m_pieces;	// blocks whose data is partially known
+	CrcMap m_crcMap;
+	int m_validBlocks = 0;
+	int m_damagedBlocks = 0;
+	bool m_usable = true;
+
+	int GetBlockLength(int block);
+	void AddPiece(int block, int offset, int size, uint32 crc);
+	void CheckBlock(int block, PieceList& pieces);
+	void SetStatus(int block, EBlockStatus status);
+};
+
+/**
+ * Calculates CRCs of parts of an article split at block boundaries, as needed
+ * by BlockVerifier. The part after the last block boundary is skipped.
+ */
+class BlockCrcCalculator
+{
+public:
+	void Start(int64 blockSize, int64 articleOffset, int articleSize);
+	void Append(const char* buffer, int len);
+	const std::vector<uint32>& GetCrcs() { return m_crcs; }
+
+private:
+	Crc32 m_crc;
+	std::vector<uint32> m_crcs;
+	int64 m_blockSize = 0;
+	int64 m_pos = 0;
+	int64 m_nextBoundary = 0;
+	int64 m_lastBoundary = 0;
+};
+
+#endif
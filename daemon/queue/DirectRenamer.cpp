@@ -182,7 +182,20 @@ void DirectParLoader::LoadParFile(const char* parFile)
 		std::string hash = sourceFile->GetDescriptionPacket()->Hash16k().print();
 
 		debug("file: %s, hash-16k: %s", filename.c_str(), hash.c_str());
-		m_parHashes.emplace_back(filename.c_str(), hash.c_str());
+		DirectRenamer::FileHash& fileHash = m_parHashes.emplace_back(filename.c_str(), hash.c_str());
+
+		Par2::VerificationPacket* packet = sourceFile->GetVerificationPacket();
+		if (packet && repairer.mainpacket)
+		{
+			std::vector<uint32> blockCrcs;
+			blockCrcs.reserve(packet->BlockCount());
+			for (uint32 i = 0; i < packet->BlockCount(); i++)
+			{
+				blockCrcs.push_back(packet->VerificationEntry(i)->crc);
+			}
+			fileHash.SetBlocks(sourceFile->GetDescriptionPacket()->FileSize(),
+				repairer.mainpacket->BlockSize(), std::move(blockCrcs));
+		}
 	}
 }
 #endif
@@ -379,6 +392,8 @@ void DirectRenamer::RenameFiles(DownloadQueue* downloadQueue, NzbInfo* nzbInfo,
 	int vol = 1;
 	bool needRenamePars = NeedRenamePars(nzbInfo);
 
+	StartBlockVerification(nzbInfo, parHashes);
+
 	renamedCount += RenameFilesInProgress(nzbInfo, parHashes, needRenamePars, vol);
 	renamedCount += RenameCompletedFiles(nzbInfo, parHashes, needRenamePars, vol);
 
@@ -394,6 +409,57 @@ void DirectRenamer::RenameFiles(DownloadQueue* downloadQueue, NzbInfo* nzbInfo,
 	RenameCompleted(downloadQueue, nzbInfo);
 }
 
+/**
+ * Files still being downloaded are verified against checksums of par2-blocks
+ * as their articles complete. The articles downloaded so far are added at once,
+ * that works for articles within one block. For other articles the CRCs
+ * of their parts are unknown and par-check reads these blocks from disk.
+ */
+void DirectRenamer::StartBlockVerification(NzbInfo* nzbInfo, FileHashList* parHashes)
+{
+	if (!g_Options->GetCrcCheck() || g_Options->GetRawArticle())
+	{
+		return;
+	}
+
+	for (FileInfo* fileInfo : nzbInfo->GetFileList())
+	{
+		if (fileInfo->GetParFile() || fileInfo->GetBlockVerifier() || Util::EmptyStr(fileInfo->GetHash16k()))
+		{
+			continue;
+		}
+
+		FileHashList::iterator pos = std::find_if(parHashes->begin(), parHashes->end(),
+			[fileInfo](FileHash& parHash)
+			{
+				return !parHash.GetBlockCrcs()->empty() && !strcmp(parHash.GetHash(), fileInfo->GetHash16k());
+			});
+
+		if (pos == parHashes->end())
+		{
+			continue;
+		}
+
+		std::unique_ptr<BlockVerifier> blockVerifier = std::make_unique<BlockVerifier>(
+			pos->GetFileSize(), pos->GetBlockSize(), *pos->GetBlockCrcs());
+
+		static const std::vector<uint32> noCrcs;
+		for (ArticleInfo* articleInfo : fileInfo->GetArticles())
+		{
+			if (articleInfo->GetStatus() == ArticleInfo::aiFinished)
+			{
+				blockVerifier->AddArticle(articleInfo->GetSegmentOffset(), articleInfo->GetSegmentSize(),
+					articleInfo->GetCrc(), noCrcs);
+			}
+		}
+
+		if (blockVerifier->GetUsable())
+		{
+			fileInfo->SetBlockVerifier(std::move(blockVerifier));
+		}
+	}
+}
+
 /**
  * @brief Renames (metadata only) partially downloaded files using info from PAR files.
  * Doesn't rename the files themselves. The actual renaming happens only when the download is complete.
@@ -35,10 +35,22 @@ public:
 			m_filename(filename), m_hash(hash) {}
 		const char* GetFilename() { return m_filename; }
 		const char* GetHash() { return m_hash; }
+		int64 GetFileSize() { return m_fileSize; }
+		int64 GetBlockSize() { return m_blockSize; }
+		std::vector<uint32>* GetBlockCrcs() { return &m_blockCrcs; }
+		void SetBlocks(int64 fileSize, int64 blockSize, std::vector<uint32> blockCrcs)
+		{
+			m_fileSize = fileSize;
+			m_blockSize = blockSize;
+			m_blockCrcs = std::move(blockCrcs);
+		}
 
 	private:
 		CString m_filename;
 		CString m_hash;
+		int64 m_fileSize = 0;
+		int64 m_blockSize = 0;
+		std::vector<uint32> m_blockCrcs;	// from IFSC-packet, for verification during download
 	};
 
 	typedef std::deque<FileHash> FileHashList;
@@ -81,6 +93,7 @@ private:
 	std::string BuildNewParName(const char* oldName, const char* destDir, const char* setId, int& vol);
 	int RenameCompletedFiles(NzbInfo* nzbInfo, FileHashList* parHashes, bool needRenamePars, int& vol);
 	int RenameFilesInProgress(NzbInfo* nzbInfo, FileHashList* parHashes, bool needRenamePars, int& vol);
+	void StartBlockVerification(NzbInfo* nzbInfo, FileHashList* parHashes);
 
 	friend class DirectParLoader;
 };
@@ -28,17 +28,52 @@
 #include "FileSystem.h"
 
 static const char* FORMATVERSION_SIGNATURE = "nzbget diskstate file version ";
-const int DISKSTATE_QUEUE_VERSION = 62;
-const int DISKSTATE_FILE_VERSION = 7;
+const int DISKSTATE_QUEUE_VERSION = 63;
+const int DISKSTATE_FILE_VERSION = 8;
 const int DISKSTATE_STATS_VERSION = 4;
 const int DISKSTATE_FEEDS_VERSION = 3;
+const int DISKSTATE_GENERATION_VERSION = 1;
 
+static const char JOURNAL_SIGNATURE[8] = { 'n', 'z', 'b', 'g', 'j', 'r', 'n', 'l' };
+static const int64 JOURNAL_MIN_COMPACT_SIZE = 1024 * 1024;
+// upper bound for numbers of articles and crc ranges of a file, checked before reserving memory
+static const int MAX_FILE_ARTICLES = 1000000;
+
+/*
+ * Besides disk files the class can read from and write to memory buffers,
+ * which is used for records of the history journal.
+ */
 class StateDiskFile : public DiskFile
 {
 public:
+	StateDiskFile() = default;
+	StateDiskFile(std::string* writeBuffer) : m_writeBuffer(writeBuffer) {}
+	StateDiskFile(const char* data, size_t len) : m_readPtr(data), m_readEnd(data + len) {}
 	int64 PrintLine(const char* format, ...) PRINTF_SYNTAX(2);
 	char* ReadLine(char* buffer, int64 size);
 	int ScanLine(const char* format, ...) SCANF_SYNTAX(2);
+	template <typename... Args> int ScanNumbers(Args*... values);
+
+private:
+	std::string* m_writeBuffer = nullptr;
+	const char* m_readPtr = nullptr;
+	const char* m_readEnd = nullptr;
+
+	char* ReadRawLine(char* buffer, int64 size);
+};
+
+enum EJournalRecordType
+{
+	jrHistoryPut = 1,
+	jrHistoryDelete
+};
+
+struct JournalRecord
+{
+	uint32 size; // of payload following the record header
+	uint32 hash; // of id, type and payload
+	int32 id;
+	uint32 type;
 };
 
 
@@ -53,14 +88,51 @@ int64 StateDiskFile::PrintLine(const char* format, ...)
 	// replacing terminating <NULL> with <LF>
 	str[len++] = '\n';
 
-	Write(*str, len);
+	if (m_writeBuffer)
+	{
+		m_writeBuffer->append(*str, len);
+	}
+	else
+	{
+		Write(*str, len);
+	}
 
 	return len;
 }
 
+/*
+ * Works like "fgets" for both disk and memory files.
+ */
+char* StateDiskFile::ReadRawLine(char* buffer, int64 size)
+{
+	if (!m_readPtr)
+	{
+		return DiskFile::ReadLine(buffer, size);
+	}
+
+	if (m_readPtr >= m_readEnd || size < 2)
+	{
+		return nullptr;
+	}
+
+	int64 len = 0;
+	while (m_readPtr < m_readEnd && len < size - 1)
+	{
+		char ch = *m_readPtr++;
+		buffer[len++] = ch;
+		if (ch == '\n')
+		{
+			break;
+		}
+	}
+	buffer[len] = '\0';
+
+	return buffer;
+}
+
 char* StateDiskFile::ReadLine(char* buffer, int64 size)
 {
-	if (!DiskFile::ReadLine(buffer, size))
+	if (!ReadRawLine(buffer, size))
 	{
 		return nullptr;
 	}
@@ -71,7 +143,7 @@ char* StateDiskFile::ReadLine(char* buffer, int64 size)
 		if (buffer[strlen(buffer) - 1] != '\n')
 		{
 			// the line is longer than "size", scroll file position to the end of the line
-			for (char skipbuf[1024]; DiskFile::ReadLine(skipbuf, 1024) && *skipbuf && skipbuf[strlen(skipbuf) - 1] != '\n'; ) ;
+			for (char skipbuf[1024]; ReadRawLine(skipbuf, 1024) && *skipbuf && skipbuf[strlen(skipbuf) - 1] != '\n'; ) ;
 		}
 
 		buffer[strlen(buffer) - 1] = 0;
@@ -100,6 +172,53 @@ int StateDiskFile::ScanLine(const char* format, ...)
 	return res;
 }
 
+template <typename T>
+static bool ParseNumber(const char*& ptr, T* value)
+{
+	bool negative = *ptr == '-';
+	if (negative)
+	{
+		ptr++;
+	}
+
+	if (*ptr < '0' || *ptr > '9')
+	{
+		return false;
+	}
+
+	T result = 0;
+	for (; *ptr >= '0' && *ptr <= '9'; ptr++)
+	{
+		result = result * 10 + (*ptr - '0');
+	}
+
+	*value = negative ? (T)(0 - result) : result;
+	return true;
+}
+
+/*
+ * Faster replacement for "ScanLine" for lines consisting of comma separated
+ * decimal numbers, such as "ScanLine("%i,%u", ...)". Used for per-file state
+ * files, which are loaded in large numbers on startup.
+ * Returns the number of parsed values like "sscanf".
+ */
+template <typename... Args>
+int StateDiskFile::ScanNumbers(Args*... values)
+{
+	char line[1024];
+	if (!ReadLine(line, sizeof(line)))
+	{
+		return 0;
+	}
+
+	const char* ptr = line;
+	int count = 0;
+	bool ok = true;
+	((ok = ok && (count == 0 || *ptr++ == ',') && ParseNumber(ptr, values) && ++count), ...);
+
+	return count;
+}
+
 
 class StateFile
 {
@@ -291,25 +410,7 @@ bool DiskState::SaveDownloadQueue(DownloadQueue* downloadQueue, bool saveHistory
 
 	if (saveHistory)
 	{
-		StateFile stateFile("history", DISKSTATE_QUEUE_VERSION, true);
-		if (!downloadQueue->GetHistory()->empty())
-		{
-			StateDiskFile* outfile = stateFile.BeginWrite();
-			if (!outfile)
-			{
-				return false;
-			}
-
-			// save history
-			SaveHistory(downloadQueue->GetHistory(), *outfile);
-
-			// now rename to dest file name
-			ok &= stateFile.FinishWrite();
-		}
-		else
-		{
-			stateFile.Discard();
-		}
+		ok &= SaveHistoryChanges(downloadQueue->GetHistory());
 	}
 
 	// progress-file isn't needed after saving of full queue data
@@ -325,6 +426,11 @@ bool DiskState::LoadDownloadQueue(DownloadQueue* downloadQueue, Servers* servers
 
 	bool ok = false;
 	int formatVersion = 0;
+	int64 startTime = Util::CurrentTicks();
+	int64 historyTime = startTime;
+	int64 fileInfosTime = startTime;
+	int64 fileStatesTime = startTime;
+	int64 endTime = startTime;
 
 	{
 		StateFile stateFile("queue", DISKSTATE_QUEUE_VERSION, true);
@@ -379,6 +485,8 @@ bool DiskState::LoadDownloadQueue(DownloadQueue* downloadQueue, Servers* servers
 		}
 	}
 
+	historyTime = Util::CurrentTicks();
+
 	if (formatVersion == 0 || formatVersion >= 57)
 	{
 		StateFile stateFile("history", DISKSTATE_QUEUE_VERSION, true);
@@ -397,13 +505,22 @@ bool DiskState::LoadDownloadQueue(DownloadQueue* downloadQueue, Servers* servers
 			}
 
 			if (!LoadHistory(downloadQueue->GetHistory(), servers, *infile, stateFile.GetFileVersion())) goto error;
+			m_snapshotSize = FileSystem::FileSize(stateFile.GetDestFilename());
 		}
+
+		if (!LoadHistoryJournal(downloadQueue->GetHistory(), servers)) goto error;
 	}
 
+	ResetHistoryChanges(downloadQueue->GetHistory());
+
+	fileInfosTime = Util::CurrentTicks();
+
 	LoadAllFileInfos(downloadQueue);
 
 	CleanupQueueDir(downloadQueue);
 
+	fileStatesTime = Util::CurrentTicks();
+
 	if (!LoadAllFileStates(downloadQueue, servers)) goto error;
 
 	ok = true;
@@ -420,6 +537,19 @@ error:
 
 	CalcFileStats(downloadQueue, formatVersion);
 
+	endTime = Util::CurrentTicks();
+
+	if (ok)
+	{
+		info("Loaded diskstate in %i ms: queue %i ms, history %i ms, file infos %i ms, partial states %i ms, stats %i ms",
+			(int)((endTime - startTime + m_statsLoadTime) / 1000),
+			(int)((historyTime - startTime) / 1000),
+			(int)((fileInfosTime - historyTime) / 1000),
+			(int)((fileStatesTime - fileInfosTime) / 1000),
+			(int)((endTime - fileStatesTime) / 1000),
+			(int)(m_statsLoadTime / 1000));
+	}
+
 	return ok;
 }
 
@@ -582,8 +712,8 @@ void DiskState::SaveNzbInfo(NzbInfo* nzbInfo, StateDiskFile& outfile)
 	outfile.PrintLine("%i,%i,%i", (int)nzbInfo->GetDupeMode(), nzbInfo->GetDupeScore(), (int)nzbInfo->GetDupeHint());
 
 	Util::SplitInt64(nzbInfo->GetDownloadedSize(), &High1, &Low1);
-	outfile.PrintLine("%u,%u,%i,%i,%i,%i,%i", High1, Low1, nzbInfo->GetDownloadSec(), nzbInfo->GetPostTotalSec(),
-		nzbInfo->GetParSec(), nzbInfo->GetRepairSec(), nzbInfo->GetUnpackSec());
+	outfile.PrintLine("%u,%u,%i,%i,%i,%i,%i,%i", High1, Low1, nzbInfo->GetDownloadSec(), nzbInfo->GetPostTotalSec(),
+		nzbInfo->GetParSec(), nzbInfo->GetRepairSec(), nzbInfo->GetUnpackSec(), nzbInfo->GetUnpackStallSec());
 
 	outfile.PrintLine("%i", (int)nzbInfo->GetCompletedFiles()->size());
 	for (CompletedFile& completedFile : nzbInfo->GetCompletedFiles())
@@ -833,14 +963,22 @@ bool DiskState::LoadNzbInfo(NzbInfo* nzbInfo, Servers* servers, StateDiskFile& i
 
 	if (formatVersion >= 48)
 	{
-		uint32 High1, Low1, downloadSec, postTotalSec, parSec, repairSec, unpackSec;
-		if (infile.ScanLine("%u,%u,%i,%i,%i,%i,%i", &High1, &Low1, &downloadSec, &postTotalSec, &parSec, &repairSec, &unpackSec) != 7) goto error;
+		uint32 High1, Low1, downloadSec, postTotalSec, parSec, repairSec, unpackSec, unpackStallSec = 0;
+		if (formatVersion >= 63)
+		{
+			if (infile.ScanLine("%u,%u,%i,%i,%i,%i,%i,%i", &High1, &Low1, &downloadSec, &postTotalSec, &parSec, &repairSec, &unpackSec, &unpackStallSec) != 8) goto error;
+		}
+		else
+		{
+			if (infile.ScanLine("%u,%u,%i,%i,%i,%i,%i", &High1, &Low1, &downloadSec, &postTotalSec, &parSec, &repairSec, &unpackSec) != 7) goto error;
+		}
 		nzbInfo->SetDownloadedSize(Util::JoinInt64(High1, Low1));
 		nzbInfo->SetDownloadSec(downloadSec);
 		nzbInfo->SetPostTotalSec(postTotalSec);
 		nzbInfo->SetParSec(parSec);
 		nzbInfo->SetRepairSec(repairSec);
 		nzbInfo->SetUnpackSec(unpackSec);
+		nzbInfo->SetUnpackStallSec(unpackStallSec);
 	}
 
 	nzbInfo->GetCompletedFiles()->clear();
@@ -1020,11 +1158,11 @@ void DiskState::SaveServerStats(ServerStatList* serverStatList, StateDiskFile& o
 bool DiskState::LoadServerStats(ServerStatList* serverStatList, Servers* servers, StateDiskFile& infile)
 {
 	int statCount;
-	if (infile.ScanLine("%i", &statCount) != 1) goto error;
+	if (infile.ScanNumbers(&statCount) != 1) goto error;
 	for (int i = 0; i < statCount; i++)
 	{
 		int serverId, successArticles, failedArticles;
-		if (infile.ScanLine("%i,%i,%i", &serverId, &successArticles, &failedArticles) != 3) goto error;
+		if (infile.ScanNumbers(&serverId, &successArticles, &failedArticles) != 3) goto error;
 
 		if (servers)
 		{
@@ -1082,9 +1220,9 @@ bool DiskState::SaveFileInfo(FileInfo* fileInfo, StateDiskFile& outfile, bool ar
 	outfile.PrintLine("%i,%i", fileInfo->GetTotalArticles(), fileInfo->GetMissedArticles());
 
 	outfile.PrintLine("%i", (int)fileInfo->GetGroups()->size());
-	for (CString& group : fileInfo->GetGroups())
+	for (auto& group : *fileInfo->GetGroups())
 	{
-		outfile.PrintLine("%s", *group);
+		outfile.PrintLine("%s", group->c_str());
 	}
 
 	if (articles)
@@ -1149,58 +1287,59 @@ bool DiskState::LoadFileInfo(FileInfo* fileInfo, StateDiskFile& infile, int form
 	if (formatVersion >= 5)
 	{
 		int time, filenameConfirmed;
-		if (infile.ScanLine("%i,%i", &filenameConfirmed, &time) != 2) goto error;
+		if (infile.ScanNumbers(&filenameConfirmed, &time) != 2) goto error;
 		if (fileSummary) fileInfo->SetFilenameConfirmed(static_cast<bool>(filenameConfirmed));
 		if (fileSummary) fileInfo->SetTime(static_cast<time_t>(time));
 	}
 	else if (formatVersion >= 4)
 	{
 		int time;
-		if (infile.ScanLine("%i", &time) != 1) goto error;
+		if (infile.ScanNumbers(&time) != 1) goto error;
 		if (fileSummary) fileInfo->SetTime(static_cast<time_t>(time));
 	}
 
 	uint32 High, Low;
-	if (infile.ScanLine("%u,%u", &High, &Low) != 2) goto error;
+	if (infile.ScanNumbers(&High, &Low) != 2) goto error;
 	if (fileSummary) fileInfo->SetSize(Util::JoinInt64(High, Low));
 	if (fileSummary) fileInfo->SetRemainingSize(fileInfo->GetSize());
 
-	if (infile.ScanLine("%u,%u", &High, &Low) != 2) goto error;
+	if (infile.ScanNumbers(&High, &Low) != 2) goto error;
 	if (fileSummary) fileInfo->SetMissedSize(Util::JoinInt64(High, Low));
 	if (fileSummary) fileInfo->SetRemainingSize(fileInfo->GetSize() - fileInfo->GetMissedSize());
 
 	int parFile;
-	if (infile.ScanLine("%i", &parFile) != 1) goto error;
+	if (infile.ScanNumbers(&parFile) != 1) goto error;
 	if (fileSummary) fileInfo->SetParFile(static_cast<bool>(parFile));
 
 	int totalArticles, missedArticles;
-	if (infile.ScanLine("%i,%i", &totalArticles, &missedArticles) != 2) goto error;
+	if (infile.ScanNumbers(&totalArticles, &missedArticles) != 2) goto error;
 	if (fileSummary) fileInfo->SetTotalArticles(totalArticles);
 	if (fileSummary) fileInfo->SetMissedArticles(missedArticles);
 
 	int size;
-	if (infile.ScanLine("%i", &size) != 1) goto error;
+	if (infile.ScanNumbers(&size) != 1) goto error;
 	for (int i = 0; i < size; i++)
 	{
 		if (!infile.ReadLine(buf, sizeof(buf))) goto error;
-		if (fileSummary && !Util::EmptyStr(buf)) fileInfo->GetGroups()->push_back(buf);
+		if (fileSummary && !Util::EmptyStr(buf)) fileInfo->GetGroups()->push_back(std::make_shared<const std::string>(buf));
 	}
 
 	if (articles)
 	{
-		if (infile.ScanLine("%i", &size) != 1) goto error;
+		if (infile.ScanNumbers(&size) != 1) goto error;
+		if (size < 0 || size > MAX_FILE_ARTICLES) goto error;
+		fileInfo->GetArticles()->reserve(size);
 		for (int i = 0; i < size; i++)
 		{
 			int PartNumber, PartSize;
-			if (infile.ScanLine("%i,%i", &PartNumber, &PartSize) != 2) goto error;
+			if (infile.ScanNumbers(&PartNumber, &PartSize) != 2) goto error;
 
 			if (!infile.ReadLine(buf, sizeof(buf))) goto error;
 
-			std::unique_ptr<ArticleInfo> articleInfo = std::make_unique<ArticleInfo>();
+			ArticleInfo* articleInfo = fileInfo->GetArticles()->Add();
 			articleInfo->SetPartNumber(PartNumber);
 			articleInfo->SetSize(PartSize);
-			articleInfo->SetMessageId(buf);
-			fileInfo->GetArticles()->push_back(std::move(articleInfo));
+			articleInfo->SetMessageId(fileInfo->GetMessageIds(), buf);
 		}
 	}
 
@@ -1255,6 +1394,18 @@ bool DiskState::SaveFileState(FileInfo* fileInfo, StateDiskFile& outfile, bool c
 		);
 	}
 
+	// CRCs of articles split at par2-block boundaries, only for completed files
+	BlockVerifier::CrcMap crcMap;
+	if (completed)
+	{
+		crcMap = fileInfo->GetBlockVerifier() ? fileInfo->GetBlockVerifier()->GetCrcMap() : *fileInfo->GetCrcMap();
+	}
+	outfile.PrintLine("%i", (int)crcMap.size());
+	for (BlockVerifier::CrcRange& range : crcMap)
+	{
+		outfile.PrintLine("%" PRIi64 ",%i,%u", range.offset, range.size, range.crc);
+	}
+
 	outfile.Close();
 	return true;
 }
@@ -1280,12 +1431,12 @@ bool DiskState::LoadFileState(FileInfo* fileInfo, Servers* servers, StateDiskFil
 	bool hasArticles = !fileInfo->GetArticles()->empty();
 
 	int successArticles, failedArticles;
-	if (infile.ScanLine("%i,%i", &successArticles, &failedArticles) != 2) goto error;
+	if (infile.ScanNumbers(&successArticles, &failedArticles) != 2) goto error;
 	fileInfo->SetSuccessArticles(successArticles);
 	fileInfo->SetFailedArticles(failedArticles);
 
 	uint32 High1, Low1, High2, Low2, High3, Low3;
-	if (infile.ScanLine("%u,%u,%u,%u,%u,%u", &High1, &Low1, &High2, &Low2, &High3, &Low3) != 6) goto error;
+	if (infile.ScanNumbers(&High1, &Low1, &High2, &Low2, &High3, &Low3) != 6) goto error;
 	fileInfo->SetRemainingSize(Util::JoinInt64(High1, Low1));
 	fileInfo->SetSuccessSize(Util::JoinInt64(High2, Low2));
 	fileInfo->SetFailedSize(Util::JoinInt64(High3, Low3));
@@ -1308,7 +1459,7 @@ bool DiskState::LoadFileState(FileInfo* fileInfo, Servers* servers, StateDiskFil
 			fileInfo->SetParSetId(*buf ? buf : nullptr);
 		}
 		int parFile = 0;
-		if (infile.ScanLine("%i", &parFile) != 1) goto error;
+		if (infile.ScanNumbers(&parFile) != 1) goto error;
 		fileInfo->SetParFile((bool)parFile);
 	}
 
@@ -1318,14 +1469,15 @@ bool DiskState::LoadFileState(FileInfo* fileInfo, Servers* servers, StateDiskFil
 	completedArticles = 0; //clang requires initialization in a separate line (due to goto statements)
 
 	int size;
-	if (infile.ScanLine("%i", &size) != 1) goto error;
+	if (infile.ScanNumbers(&size) != 1) goto error;
+	if (size < 0 || size > (hasArticles ? (int)fileInfo->GetArticles()->size() : MAX_FILE_ARTICLES)) goto error;
+	if (!hasArticles)
+	{
+		fileInfo->GetArticles()->reserve(size);
+	}
 	for (int i = 0; i < size; i++)
 	{
-		if (!hasArticles)
-		{
-			fileInfo->GetArticles()->push_back(std::make_unique<ArticleInfo>());
-		}
-		std::unique_ptr<ArticleInfo>& pa = fileInfo->GetArticles()->at(i);
+		ArticleInfo* pa = hasArticles ? &fileInfo->GetArticles()->at(i) : fileInfo->GetArticles()->Add();
 
 		int statusInt;
 
@@ -1334,14 +1486,14 @@ bool DiskState::LoadFileState(FileInfo* fileInfo, Servers* servers, StateDiskFil
 			int64 segmentOffset;
 			uint32 crc;
 			int segmentSize;
-			if (infile.ScanLine("%i,%" PRIi64 ",%i,%u", &statusInt, &segmentOffset, &segmentSize, &crc) != 4) goto error;
+			if (infile.ScanNumbers(&statusInt, &segmentOffset, &segmentSize, &crc) != 4) goto error;
 			pa->SetSegmentOffset(segmentOffset);
 			pa->SetSegmentSize(segmentSize);
 			pa->SetCrc(crc);
 		}
 		else
 		{
-			if (infile.ScanLine("%i", &statusInt) != 1) goto error;
+			if (infile.ScanNumbers(&statusInt) != 1) goto error;
 		}
 
 		ArticleInfo::EStatus status = (ArticleInfo::EStatus)statusInt;
@@ -1352,10 +1504,9 @@ bool DiskState::LoadFileState(FileInfo* fileInfo, Servers* servers, StateDiskFil
 		}
 
 		if (status == ArticleInfo::aiFinished && !g_Options->GetDirectWrite() &&
-			!fileInfo->GetForceDirectWrite() && !pa->GetResultFilename())
+			!fileInfo->GetForceDirectWrite())
 		{
-			pa->SetResultFilename(BString<1024>("%s%c%i.%03i", g_Options->GetTempDir(),
-				PATH_SEPARATOR, fileInfo->GetId(), pa->GetPartNumber()));
+			pa->SetHasResultFile(true);
 		}
 
 		// don't allow all articles be completed or the file will stuck.
@@ -1374,6 +1525,21 @@ bool DiskState::LoadFileState(FileInfo* fileInfo, Servers* servers, StateDiskFil
 
 	fileInfo->SetCompletedArticles(completedArticles);
 
+	if (formatVersion >= 8)
+	{
+		if (infile.ScanNumbers(&size) != 1) goto error;
+		if (size < 0 || size > MAX_FILE_ARTICLES) goto error;
+		BlockVerifier::CrcMap* crcMap = fileInfo->GetCrcMap();
+		crcMap->clear();
+		crcMap->reserve(size);
+		for (int i = 0; i < size; i++)
+		{
+			BlockVerifier::CrcRange range;
+			if (infile.ScanNumbers(&range.offset, &range.size, &range.crc) != 3) goto error;
+			crcMap->push_back(range);
+		}
+	}
+
 	infile.Close();
 	return true;
 
@@ -1453,16 +1619,7 @@ void DiskState::SaveHistory(HistoryList* history, StateDiskFile& outfile)
 	outfile.PrintLine("%i", (int)history->size());
 	for (HistoryInfo* historyInfo : history)
 	{
-		outfile.PrintLine("%i,%i,%i", historyInfo->GetId(), (int)historyInfo->GetKind(), (int)historyInfo->GetTime());
-
-		if (historyInfo->GetKind() == HistoryInfo::hkNzb || historyInfo->GetKind() == HistoryInfo::hkUrl)
-		{
-			SaveNzbInfo(historyInfo->GetNzbInfo(), outfile);
-		}
-		else if (historyInfo->GetKind() == HistoryInfo::hkDup)
-		{
-			SaveDupInfo(historyInfo->GetDupInfo(), outfile);
-		}
+		SaveHistoryInfo(historyInfo, outfile);
 	}
 }
 
@@ -1474,46 +1631,417 @@ bool DiskState::LoadHistory(HistoryList* history, Servers* servers, StateDiskFil
 	if (infile.ScanLine("%i", &size) != 1) goto error;
 	for (int i = 0; i < size; i++)
 	{
-		std::unique_ptr<HistoryInfo> historyInfo;
-		HistoryInfo::EKind kind = HistoryInfo::hkNzb;
-		int id = 0;
-		int time;
+		std::unique_ptr<HistoryInfo> historyInfo = LoadHistoryInfo(servers, infile, formatVersion);
+		if (!historyInfo) goto error;
+		history->push_back(std::move(historyInfo));
+	}
 
-		int kindval = 0;
-		if (infile.ScanLine("%i,%i,%i", &id, &kindval, &time) != 3) goto error;
-		kind = (HistoryInfo::EKind)kindval;
+	return true;
 
+error:
+	error("Error reading diskstate for history");
+	return false;
+}
+
+void DiskState::SaveHistoryInfo(HistoryInfo* historyInfo, StateDiskFile& outfile)
+{
+	outfile.PrintLine("%i,%i,%i", historyInfo->GetId(), (int)historyInfo->GetKind(), (int)historyInfo->GetTime());
+
+	if (historyInfo->GetKind() == HistoryInfo::hkNzb || historyInfo->GetKind() == HistoryInfo::hkUrl)
+	{
+		SaveNzbInfo(historyInfo->GetNzbInfo(), outfile);
+	}
+	else if (historyInfo->GetKind() == HistoryInfo::hkDup)
+	{
+		SaveDupInfo(historyInfo->GetDupInfo(), outfile);
+	}
+}
+
+std::unique_ptr<HistoryInfo> DiskState::LoadHistoryInfo(Servers* servers, StateDiskFile& infile, int formatVersion)
+{
+	std::unique_ptr<HistoryInfo> historyInfo;
+	int id = 0;
+	int kindval = 0;
+	int time;
+	if (infile.ScanLine("%i,%i,%i", &id, &kindval, &time) != 3)
+	{
+		return nullptr;
+	}
+	HistoryInfo::EKind kind = (HistoryInfo::EKind)kindval;
+
+	if (kind == HistoryInfo::hkNzb || kind == HistoryInfo::hkUrl)
+	{
+		std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
+		if (!LoadNzbInfo(nzbInfo.get(), servers, infile, formatVersion))
+		{
+			return nullptr;
+		}
 		if (kind == HistoryInfo::hkNzb)
 		{
-			std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
-			if (!LoadNzbInfo(nzbInfo.get(), servers, infile, formatVersion)) goto error;
 			nzbInfo->LeavePostProcess();
-			historyInfo = std::make_unique<HistoryInfo>(std::move(nzbInfo));
 		}
-		else if (kind == HistoryInfo::hkUrl)
+		historyInfo = std::make_unique<HistoryInfo>(std::move(nzbInfo));
+	}
+	else if (kind == HistoryInfo::hkDup)
+	{
+		std::unique_ptr<DupInfo> dupInfo = std::make_unique<DupInfo>();
+		if (!LoadDupInfo(dupInfo.get(), infile, formatVersion))
 		{
-			std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
-			if (!LoadNzbInfo(nzbInfo.get(), servers, infile, formatVersion)) goto error;
-			historyInfo = std::make_unique<HistoryInfo>(std::move(nzbInfo));
+			return nullptr;
+		}
+		dupInfo->SetId(id);
+		historyInfo = std::make_unique<HistoryInfo>(std::move(dupInfo));
+	}
+	else
+	{
+		return nullptr;
+	}
+
+	historyInfo->SetTime((time_t)time);
+
+	return historyInfo;
+}
+
+/*
+ * History changes are appended to file "history.journal" instead of rewriting
+ * the whole history. The journal contains a record with the complete entry
+ * for each added or changed entry and a record with the id for each deleted
+ * entry. Once the journal grows large compared to the snapshot in file
+ * "history" (or the most of the history has changed) the snapshot is
+ * rewritten and the journal is started anew.
+ *
+ * Entries edited in place are marked by the code editing them with
+ * HistoryInfo::SetChanged, new entries are marked on creation. Only marked
+ * entries are serialized. Deleted entries are searched for only if the history
+ * has fewer saved entries than the journal knows of.
+ */
+bool DiskState::SaveHistoryChanges(HistoryList* history)
+{
+	if (!m_journalValid || history->empty())
+	{
+		return CompactHistory(history);
+	}
+
+	std::vector<HistoryInfo*> changed;
+	size_t added = 0;
+	for (HistoryInfo* historyInfo : history)
+	{
+		if (historyInfo->GetChanged())
+		{
+			changed.push_back(historyInfo);
+			added += m_journalIds.count(historyInfo->GetId()) ? 0 : 1;
+		}
+	}
+
+	std::vector<int> deleted;
+	if (history->size() - added < m_journalIds.size())
+	{
+		std::unordered_set<int> ids;
+		ids.reserve(history->size());
+		for (HistoryInfo* historyInfo : history)
+		{
+			ids.insert(historyInfo->GetId());
 		}
-		else if (kind == HistoryInfo::hkDup)
+		for (int id : m_journalIds)
 		{
-			std::unique_ptr<DupInfo> dupInfo = std::make_unique<DupInfo>();
-			if (!LoadDupInfo(dupInfo.get(), infile, formatVersion)) goto error;
-			dupInfo->SetId(id);
-			historyInfo = std::make_unique<HistoryInfo>(std::move(dupInfo));
+			if (!ids.count(id))
+			{
+				deleted.push_back(id);
+			}
 		}
+	}
+
+	if (changed.size() + deleted.size() > history->size() / 2 ||
+		m_journalSize > std::max(m_snapshotSize / 2, JOURNAL_MIN_COMPACT_SIZE))
+	{
+		return CompactHistory(history);
+	}
 
-		historyInfo->SetTime((time_t)time);
+	if (changed.empty() && deleted.empty())
+	{
+		return true;
+	}
 
-		history->push_back(std::move(historyInfo));
+	debug("Saving %i changed and %i deleted history items to journal", (int)changed.size(), (int)deleted.size());
+
+	BString<1024> filename("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history.journal");
+	DiskFile outfile;
+	if (!outfile.Open(filename, m_journalSize > 0 ? DiskFile::omAppend : DiskFile::omWrite))
+	{
+		error("Error saving diskstate: Could not open file %s: %s", *filename,
+			*FileSystem::GetLastErrorMessage());
+		return false;
+	}
+
+	std::string buffer;
+	if (m_journalSize == 0)
+	{
+		int32 version = DISKSTATE_QUEUE_VERSION;
+		buffer.append(JOURNAL_SIGNATURE, sizeof(JOURNAL_SIGNATURE));
+		buffer.append((const char*)&version, sizeof(version));
+	}
+
+	auto appendRecord = [&buffer](EJournalRecordType type, int id, const std::string& payload)
+	{
+		JournalRecord record{(uint32)payload.size(), 0, id, (uint32)type};
+		record.hash = Util::HashBJ96((const char*)&record.id, sizeof(record.id) + sizeof(record.type), 0);
+		record.hash = Util::HashBJ96(payload.data(), (int)payload.size(), record.hash);
+		buffer.append((const char*)&record, sizeof(record));
+		buffer.append(payload);
+	};
+
+	for (HistoryInfo* historyInfo : changed)
+	{
+		std::string payload;
+		StateDiskFile recordFile(&payload);
+		SaveHistoryInfo(historyInfo, recordFile);
+		appendRecord(jrHistoryPut, historyInfo->GetId(), payload);
+	}
+
+	for (int id : deleted)
+	{
+		appendRecord(jrHistoryDelete, id, "");
+	}
+
+	bool ok = outfile.Write(buffer.data(), buffer.size()) == (int64)buffer.size();
+	if (ok && g_Options->GetFlushQueue())
+	{
+		outfile.Flush();
+		CString errmsg;
+		if (!outfile.Sync(errmsg))
+		{
+			warn("Could not flush file %s into disk: %s", *filename, *errmsg);
+		}
+	}
+	outfile.Close();
+
+	if (!ok)
+	{
+		error("Error saving diskstate: Could not write file %s: %s", *filename,
+			*FileSystem::GetLastErrorMessage());
+		// the journal may end with a partial record now, the next save rewrites everything
+		m_journalValid = false;
+		return false;
+	}
+
+	m_journalSize += buffer.size();
+	for (HistoryInfo* historyInfo : changed)
+	{
+		historyInfo->SetChanged(false);
+		m_journalIds.insert(historyInfo->GetId());
+	}
+	for (int id : deleted)
+	{
+		m_journalIds.erase(id);
 	}
 
 	return true;
+}
 
-error:
-	error("Error reading diskstate for history");
-	return false;
+/*
+ * Writes complete history into the snapshot and discards the journal.
+ */
+bool DiskState::CompactHistory(HistoryList* history)
+{
+	debug("Compacting history journal");
+
+	bool ok = true;
+	StateFile stateFile("history", DISKSTATE_QUEUE_VERSION, true);
+	if (!history->empty())
+	{
+		StateDiskFile* outfile = stateFile.BeginWrite();
+		if (!outfile)
+		{
+			return false;
+		}
+
+		// save history
+		SaveHistory(history, *outfile);
+
+		// now rename to dest file name
+		ok = stateFile.FinishWrite();
+	}
+	else
+	{
+		stateFile.Discard();
+	}
+
+	if (!ok)
+	{
+		return false;
+	}
+
+	FileSystem::DeleteFile(BString<1024>("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history.journal"));
+
+	m_snapshotSize = history->empty() ? 0 : FileSystem::FileSize(stateFile.GetDestFilename());
+	m_journalSize = 0;
+	m_journalValid = true;
+	ResetHistoryChanges(history);
+
+	return true;
+}
+
+/*
+ * Called once the saved state matches the history in memory.
+ */
+void DiskState::ResetHistoryChanges(HistoryList* history)
+{
+	m_journalIds.clear();
+	m_journalIds.reserve(history->size());
+	for (HistoryInfo* historyInfo : history)
+	{
+		historyInfo->SetChanged(false);
+		m_journalIds.insert(historyInfo->GetId());
+	}
+}
+
+/*
+ * Applies the records of the history journal to the history loaded from the snapshot.
+ * A damaged record (incomplete write during crash) and everything after it are ignored.
+ */
+bool DiskState::LoadHistoryJournal(HistoryList* history, Servers* servers)
+{
+	m_journalSize = 0;
+	m_journalValid = false;
+
+	BString<1024> filename("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history.journal");
+	if (!FileSystem::FileExists(filename))
+	{
+		m_journalValid = true;
+		return true;
+	}
+
+	DiskFile infile;
+	int64 fileSize = FileSystem::FileSize(filename);
+	std::vector<char> data((size_t)fileSize);
+	if (!infile.Open(filename, DiskFile::omRead) || infile.Read(data.data(), fileSize) != fileSize)
+	{
+		error("Error reading diskstate: could not read file %s: %s", *filename,
+			*FileSystem::GetLastErrorMessage());
+		return false;
+	}
+	infile.Close();
+
+	int32 version = 0;
+	size_t headerSize = sizeof(JOURNAL_SIGNATURE) + sizeof(version);
+	if (data.size() < headerSize || memcmp(data.data(), JOURNAL_SIGNATURE, sizeof(JOURNAL_SIGNATURE)))
+	{
+		warn("Ignoring damaged diskstate file %s", *filename);
+		return true;
+	}
+	memcpy(&version, data.data() + sizeof(JOURNAL_SIGNATURE), sizeof(version));
+	if (version > DISKSTATE_QUEUE_VERSION)
+	{
+		error("Could not load diskstate file %s due to file version mismatch", *filename);
+		return false;
+	}
+
+	// entries from the snapshot by id
+	std::unordered_map<int, HistoryInfo*> snapshot;
+	for (HistoryInfo* historyInfo : history)
+	{
+		snapshot[historyInfo->GetId()] = historyInfo;
+	}
+
+	// final state of entries touched by the journal
+	std::unordered_map<int, std::unique_ptr<HistoryInfo>> puts;
+	std::unordered_set<int> deleted;
+	// entries added to the top of history, with sequence numbers to keep their order
+	std::unordered_map<int, int> added;
+	int records = 0;
+
+	size_t pos = headerSize;
+	while (pos < data.size())
+	{
+		JournalRecord record;
+		if (pos + sizeof(record) > data.size())
+		{
+			break;
+		}
+		memcpy(&record, data.data() + pos, sizeof(record));
+		if (pos + sizeof(record) + record.size > data.size())
+		{
+			break;
+		}
+
+		const char* payload = data.data() + pos + sizeof(record);
+		uint32 hash = Util::HashBJ96((const char*)&record.id, sizeof(record.id) + sizeof(record.type), 0);
+		hash = Util::HashBJ96(payload, (int)record.size, hash);
+		if (hash != record.hash)
+		{
+			break;
+		}
+
+		if (record.type == jrHistoryPut)
+		{
+			StateDiskFile recordFile(payload, record.size);
+			std::unique_ptr<HistoryInfo> historyInfo = LoadHistoryInfo(servers, recordFile, version);
+			if (!historyInfo)
+			{
+				break;
+			}
+
+			// entries returning into history get a new time, edited entries keep theirs
+			auto it = puts.find(record.id);
+			HistoryInfo* prev = it != puts.end() ? it->second.get() :
+				!deleted.count(record.id) && snapshot.count(record.id) ? snapshot[record.id] : nullptr;
+			if (!prev || prev->GetTime() != historyInfo->GetTime())
+			{
+				added[record.id] = records;
+			}
+
+			puts[record.id] = std::move(historyInfo);
+			deleted.erase(record.id);
+		}
+		else if (record.type == jrHistoryDelete)
+		{
+			puts.erase(record.id);
+			added.erase(record.id);
+			deleted.insert(record.id);
+		}
+
+		records++;
+		pos += sizeof(record) + record.size;
+	}
+
+	if (pos < data.size())
+	{
+		// the next save rewrites the snapshot and starts a new journal
+		warn("Diskstate file %s is damaged, %i record(s) recovered", *filename, records);
+	}
+	else
+	{
+		m_journalSize = fileSize;
+		m_journalValid = true;
+	}
+
+	std::vector<std::pair<int, int>> addedOrder(added.begin(), added.end());
+	std::sort(addedOrder.begin(), addedOrder.end(),
+		[](const std::pair<int, int>& a, const std::pair<int, int>& b) { return a.second > b.second; });
+
+	HistoryList newHistory;
+	for (std::pair<int, int>& item : addedOrder)
+	{
+		newHistory.push_back(std::move(puts[item.first]));
+	}
+
+	for (std::unique_ptr<HistoryInfo>& historyInfo : *history)
+	{
+		int id = historyInfo->GetId();
+		if (deleted.count(id) || added.count(id))
+		{
+			continue;
+		}
+
+		auto it = puts.find(id);
+		newHistory.push_back(it != puts.end() ? std::move(it->second) : std::move(historyInfo));
+	}
+
+	history->swap(newHistory);
+
+	debug("Loaded %i record(s) from history journal", records);
+
+	return true;
 }
 
 /*
@@ -1529,6 +2057,11 @@ void DiskState::DiscardDownloadQueue()
 	fullFilename.Format("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history");
 	FileSystem::DeleteFile(fullFilename);
 
+	fullFilename.Format("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history.journal");
+	FileSystem::DeleteFile(fullFilename);
+	m_journalIds.clear();
+	m_journalValid = false;
+
 	DirBrowser dir(g_Options->GetQueueDir());
 	while (const char* filename = dir.Next())
 	{
@@ -1563,7 +2096,8 @@ bool DiskState::DownloadQueueExists()
 	debug("Checking if a saved queue exists on disk");
 
 	return FileSystem::FileExists(BString<1024>("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "queue")) ||
-		FileSystem::FileExists(BString<1024>("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history"));
+		FileSystem::FileExists(BString<1024>("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history")) ||
+		FileSystem::FileExists(BString<1024>("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "history.journal"));
 }
 
 void DiskState::DiscardFile(int fileId, bool deleteData, bool deletePartialState, bool deleteCompletedState)
@@ -1923,6 +2457,13 @@ bool DiskState::SaveAllFileInfos(DownloadQueue* downloadQueue)
 	return ok;
 }
 
+/*
+ * Per-file state files are loaded on several threads: there may be thousands
+ * of them and reading them one by one leaves the cpu and the disk idle most of
+ * the time.
+ */
+static const int FILESTATES_PER_THREAD_MIN = 32;
+
 bool DiskState::LoadAllFileInfos(DownloadQueue* downloadQueue)
 {
 	if (downloadQueue->GetQueue()->empty())
@@ -1954,17 +2495,19 @@ bool DiskState::LoadAllFileInfos(DownloadQueue* downloadQueue)
 		}
 	}
 
+	// hibernate-file is read sequentially, files missing there are loaded from
+	// their own state files in parallel
+	RawFileList pendingFileInfos;
+
 	for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
 	{
-		RawFileList brokenFileInfos;
-
 		for (FileInfo* fileInfo : nzbInfo->GetFileList())
 		{
 			bool res = false;
 			if (useHibernate)
 			{
 				int id = 0;
-				infile->ScanLine("%i", &id);
+				infile->ScanNumbers(&id);
 				if (id == fileInfo->GetId())
 				{
 					res = LoadFileInfo(fileInfo, *infile, stateFile.GetFileVersion(), true, false);
@@ -1972,17 +2515,23 @@ bool DiskState::LoadAllFileInfos(DownloadQueue* downloadQueue)
 			}
 			if (!res)
 			{
-				res = LoadFile(fileInfo, true, false);
-			}
-			if (!res)
-			{
-				brokenFileInfos.push_back(fileInfo);
+				pendingFileInfos.push_back(fileInfo);
 			}
 		}
+	}
 
-		for (FileInfo* fileInfo : brokenFileInfos)
+	std::vector<char> loaded(pendingFileInfos.size());
+	Util::ParallelFor((int)pendingFileInfos.size(), FILESTATES_PER_THREAD_MIN, [this, &pendingFileInfos, &loaded](int index)
+		{
+			loaded[index] = LoadFile(pendingFileInfos[index], true, false);
+		});
+
+	for (int i = 0; i < (int)pendingFileInfos.size(); i++)
+	{
+		if (!loaded[i])
 		{
-			nzbInfo->GetFileList()->Remove(fileInfo);
+			FileInfo* fileInfo = pendingFileInfos[i];
+			fileInfo->GetNzbInfo()->GetFileList()->Remove(fileInfo);
 		}
 	}
 
@@ -2000,6 +2549,18 @@ bool DiskState::LoadAllFileStates(DownloadQueue* downloadQueue, Servers* servers
 	BString<1024> cacheFlagFilename("%s%c%s", g_Options->GetQueueDir(), PATH_SEPARATOR, "acache");
 	bool cacheWasActive = FileSystem::FileExists(cacheFlagFilename);
 
+	std::unordered_map<int, FileInfo*> fileInfos;
+	for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
+	{
+		for (FileInfo* fileInfo : nzbInfo->GetFileList())
+		{
+			fileInfos[fileInfo->GetId()] = fileInfo;
+		}
+	}
+
+	// file state to load for each file, completed state wins if both exist
+	std::unordered_map<FileInfo*, bool> states;
+
 	DirBrowser dir(g_Options->GetQueueDir());
 	while (const char* filename = dir.Next())
 	{
@@ -2009,18 +2570,10 @@ bool DiskState::LoadAllFileStates(DownloadQueue* downloadQueue, Servers* servers
 		{
 			if (suffix == 'c' || (suffix == 's' && g_Options->GetContinuePartial() && !cacheWasActive))
 			{
-				for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
+				auto it = fileInfos.find(id);
+				if (it != fileInfos.end())
 				{
-					for (FileInfo* fileInfo : nzbInfo->GetFileList())
-					{
-						if (fileInfo->GetId() == id)
-						{
-							if (!LoadFileState(fileInfo, servers, suffix == 'c')) goto error;
-							fileInfo->GetArticles()->clear();
-							fileInfo->SetPartialState(suffix == 'c' ? FileInfo::psCompleted : FileInfo::psPartial);
-							goto next;
-						}
-					}
+					states[it->second] |= suffix == 'c';
 				}
 			}
 			else
@@ -2029,13 +2582,24 @@ bool DiskState::LoadAllFileStates(DownloadQueue* downloadQueue, Servers* servers
 				FileSystem::DeleteFile(fullFilename);
 			}
 		}
-		next:;
 	}
 
-	return true;
+	std::vector<std::pair<FileInfo*, bool>> jobs(states.begin(), states.end());
+	std::atomic<bool> ok{true};
+	Util::ParallelFor((int)jobs.size(), FILESTATES_PER_THREAD_MIN, [this, servers, &jobs, &ok](int index)
+		{
+			FileInfo* fileInfo = jobs[index].first;
+			bool completed = jobs[index].second;
+			if (!LoadFileState(fileInfo, servers, completed))
+			{
+				ok = false;
+				return;
+			}
+			fileInfo->DiscardArticles();
+			fileInfo->SetPartialState(completed ? FileInfo::psCompleted : FileInfo::psPartial);
+		});
 
-error:
-	return false;
+	return ok;
 }
 
 bool DiskState::SaveStats(Servers* servers, ServerVolumes* serverVolumes)
@@ -2070,6 +2634,7 @@ bool DiskState::LoadStats(Servers* servers, ServerVolumes* serverVolumes, bool*
 {
 	debug("Loading stats from disk");
 
+	int64 startTime = Util::CurrentTicks();
 	StateFile stateFile("stats", DISKSTATE_STATS_VERSION, true);
 
 	if (!stateFile.FileExists())
@@ -2102,9 +2667,52 @@ error:
 		error("Error reading diskstate for statistics");
 	}
 
+	m_statsLoadTime = Util::CurrentTicks() - startTime;
+
 	return ok;
 }
 
+bool DiskState::SaveGeneration(int generation)
+{
+	debug("Saving change generation to disk");
+
+	StateFile stateFile("generation", DISKSTATE_GENERATION_VERSION, true);
+
+	StateDiskFile* outfile = stateFile.BeginWrite();
+	if (!outfile)
+	{
+		return false;
+	}
+
+	outfile->PrintLine("%i", generation);
+
+	// now rename to dest file name
+	return stateFile.FinishWrite();
+}
+
+bool DiskState::LoadGeneration(int* generation)
+{
+	debug("Loading change generation from disk");
+
+	StateFile stateFile("generation", DISKSTATE_GENERATION_VERSION, true);
+
+	*generation = 0;
+	if (!stateFile.FileExists())
+	{
+		return true;
+	}
+
+	StateDiskFile* infile = stateFile.BeginRead();
+	if (!infile || infile->ScanLine("%i", generation) != 1 || *generation < 0)
+	{
+		error("Error reading diskstate for change generation");
+		*generation = 0;
+		return false;
+	}
+
+	return true;
+}
+
 bool DiskState::SaveServerInfo(Servers* servers, StateDiskFile& outfile)
 {
 	debug("Saving server info to disk");
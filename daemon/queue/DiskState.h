@@ -51,6 +51,8 @@ public:
 	bool LoadFeeds(Feeds* feeds, FeedHistory* feedHistory);
 	bool SaveStats(Servers* servers, ServerVolumes* serverVolumes);
 	bool LoadStats(Servers* servers, ServerVolumes* serverVolumes, bool* perfectMatch);
+	bool SaveGeneration(int generation);
+	bool LoadGeneration(int* generation);
 	void CleanupTempDir(DownloadQueue* downloadQueue);
 	void WriteCacheFlag();
 	void DeleteCacheFlag();
@@ -72,6 +74,12 @@ private:
 	bool LoadDupInfo(DupInfo* dupInfo, StateDiskFile& infile, int formatVersion);
 	void SaveHistory(HistoryList* history, StateDiskFile& outfile);
 	bool LoadHistory(HistoryList* history, Servers* servers, StateDiskFile& infile, int formatVersion);
+	void SaveHistoryInfo(HistoryInfo* historyInfo, StateDiskFile& outfile);
+	std::unique_ptr<HistoryInfo> LoadHistoryInfo(Servers* servers, StateDiskFile& infile, int formatVersion);
+	bool SaveHistoryChanges(HistoryList* history);
+	bool CompactHistory(HistoryList* history);
+	void ResetHistoryChanges(HistoryList* history);
+	bool LoadHistoryJournal(HistoryList* history, Servers* servers);
 	bool SaveFeedStatus(Feeds* feeds, StateDiskFile& outfile);
 	bool LoadFeedStatus(Feeds* feeds, StateDiskFile& infile, int formatVersion);
 	bool SaveFeedHistory(FeedHistory* feedHistory, StateDiskFile& outfile);
@@ -86,6 +94,15 @@ private:
 	void SaveServerStats(ServerStatList* serverStatList, StateDiskFile& outfile);
 	bool LoadServerStats(ServerStatList* serverStatList, Servers* servers, StateDiskFile& infile);
 	void CleanupQueueDir(DownloadQueue* downloadQueue);
+
+	// state of the history journal
+	std::unordered_set<int> m_journalIds; // entries saved in snapshot or journal
+	int64 m_snapshotSize = 0;
+	int64 m_journalSize = 0;
+	bool m_journalValid = false;
+
+	// for startup timing breakdown, in microseconds
+	int64 m_statsLoadTime = 0;
 };
 
 extern DiskState* g_DiskState;
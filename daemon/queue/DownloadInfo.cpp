@@ -26,8 +26,9 @@
 #include "Options.h"
 #include "Util.h"
 #include "FileSystem.h"
+#include "AsyncWriter.h"
 
-int FileInfo::m_idGen = 0;
+std::atomic<int> FileInfo::m_idGen{0};
 int FileInfo::m_idMax = 0;
 int NzbInfo::m_idGen = 0;
 int NzbInfo::m_idMax = 0;
@@ -650,6 +651,64 @@ const char* NzbInfo::MakeTextStatus(bool ignoreScriptStatus)
 	return status;
 }
 
+uint32 NzbInfo::CalcStateHash()
+{
+	int64 numbers[] = { m_id, m_kind, m_fileCount, m_parkedFileCount, m_size, m_remainingSize,
+		m_pausedFileCount, m_pausedSize, m_remainingParCount, m_activeDownloads, m_successSize, m_failedSize,
+		m_currentSuccessSize, m_currentFailedSize, m_parSize, m_parSuccessSize, m_parFailedSize,
+		m_parCurrentSuccessSize, m_parCurrentFailedSize, m_totalArticles, m_successArticles, m_failedArticles,
+		m_currentSuccessArticles, m_currentFailedArticles, m_minTime, m_maxTime, m_priority,
+		(int64)m_completedFiles.size(), m_parStatus, m_directUnpackStatus, m_unpackStatus, m_moveStatus,
+		m_deleteStatus, m_markStatus, m_urlStatus, m_extraParBlocks, m_dupeScore, m_dupeMode,
+		m_downloadedSize, m_downloadSec, m_postTotalSec, m_parSec, m_repairSec, m_unpackSec,
+		m_messageCount, m_cachedMessageCount, (int64)m_fileList.size() };
+
+	uint32 hash = Util::HashBJ96((const char*)numbers, sizeof(numbers), 0);
+
+	auto hashStr = [&hash](const char* str)
+	{
+		// hashing the terminating null too keeps "ab"+"c" and "a"+"bc" apart
+		hash = str ? Util::HashBJ96(str, strlen(str) + 1, hash) : hash + 1;
+	};
+
+	hashStr(m_name);
+	hashStr(m_url);
+	hashStr(m_filename);
+	hashStr(m_destDir);
+	hashStr(m_finalDir);
+	hashStr(m_category);
+	hashStr(m_dupeKey);
+
+	for (NzbParameter& parameter : m_ppParameters)
+	{
+		hashStr(parameter.GetName());
+		hashStr(parameter.GetValue());
+	}
+
+	for (ScriptStatus& scriptStatus : m_scriptStatuses)
+	{
+		hashStr(scriptStatus.GetName());
+		hash += scriptStatus.GetStatus();
+	}
+
+	for (ServerStat& serverStat : m_currentServerStats)
+	{
+		int stat[] = { serverStat.GetServerId(), serverStat.GetSuccessArticles(), serverStat.GetFailedArticles() };
+		hash = Util::HashBJ96((const char*)stat, sizeof(stat), hash);
+	}
+
+	if (m_postInfo)
+	{
+		// stage and total times are reported relative to current time and change every second
+		int64 post[] = { m_postInfo->GetStage(), m_postInfo->GetStageProgress(), m_postInfo->GetFileProgress(),
+			m_postInfo->GetStartTime(), m_postInfo->GetStageTime(), Util::CurrentTime() };
+		hash = Util::HashBJ96((const char*)post, sizeof(post), hash);
+		hashStr(m_postInfo->GetProgressLabel());
+	}
+
+	return hash;
+}
+
 void NzbInfo::UpdateCurrentStats()
 {
 	m_pausedFileCount = 0;
@@ -765,16 +824,17 @@ bool NzbInfo::IsDownloadCompleted(bool ignorePausedPars)
 	return true;
 }
 
-void ArticleInfo::AttachSegment(std::unique_ptr<SegmentData> content, int64 offset, int size)
-{
-	m_segmentContent = std::move(content);
-	m_segmentOffset = offset;
-	m_segmentSize = size;
-}
-
-void ArticleInfo::DiscardSegment()
+ArticleInfo& ArticleInfo::operator=(ArticleInfo&& other) noexcept
 {
-	m_segmentContent.reset();
+	m_segmentOffset = other.m_segmentOffset.load();
+	m_segmentSize = other.m_segmentSize.load();
+	m_crc = other.m_crc.load();
+	m_messageId = other.m_messageId;
+	m_partNumber = other.m_partNumber;
+	m_size = other.m_size;
+	m_status = other.m_status;
+	m_hasResultFile = other.m_hasResultFile;
+	return *this;
 }
 
 
@@ -824,10 +884,136 @@ void FileInfo::MakeValidFilename()
 	m_filename = FileSystem::MakeValidFilename(m_filename.c_str()).Str();
 }
 
+FileInfo::FileInfo(int id) :
+	m_id(id ? id : ++m_idGen),
+	m_asyncFile(std::make_shared<AsyncFile>())
+{
+}
+
+FileInfo::~FileInfo()
+{
+	GetCachedFiles()->Remove(this, true);
+}
+
+void FileInfo::DiscardArticles()
+{
+	std::unordered_map<ArticleInfo*, std::unique_ptr<SegmentData>> segments;
+	{
+		Guard guard(m_segmentsMutex);
+		segments.swap(m_segments);
+	}
+	m_articles.clear();
+	m_messageIds.Clear();
+}
+
+std::string FileInfo::GetResultFilename(ArticleInfo* article)
+{
+	if (!article->GetHasResultFile())
+	{
+		return "";
+	}
+
+	return *BString<1024>("%s%c%i.%03i", g_Options->GetTempDir(), PATH_SEPARATOR, m_id, article->GetPartNumber());
+}
+
+void FileInfo::AttachSegment(ArticleInfo* article, std::unique_ptr<SegmentData> content, int64 offset, int size)
+{
+	article->SetSegmentOffset(offset);
+	article->SetSegmentSize(size);
+
+	Guard guard(m_segmentsMutex);
+	m_segments[article] = std::move(content);
+}
+
+void FileInfo::DiscardSegment(ArticleInfo* article)
+{
+	std::unique_ptr<SegmentData> content;
+
+	{
+		Guard guard(m_segmentsMutex);
+		auto it = m_segments.find(article);
+		if (it == m_segments.end())
+		{
+			return;
+		}
+		content = std::move(it->second);
+		m_segments.erase(it);
+	}
+
+	// segment data is released outside of the lock
+}
+
+const char* FileInfo::GetSegmentContent(ArticleInfo* article)
+{
+	Guard guard(m_segmentsMutex);
+	if (m_segments.empty())
+	{
+		return nullptr;
+	}
+	auto it = m_segments.find(article);
+	return it != m_segments.end() ? it->second->GetData() : nullptr;
+}
+
+void FileInfo::SetCacheInfoName(const std::string& infoName)
+{
+	Guard guard(m_segmentsMutex);
+	m_cacheInfoName = infoName;
+}
+
+std::string FileInfo::GetCacheInfoName()
+{
+	Guard guard(m_segmentsMutex);
+	return m_cacheInfoName;
+}
+
+std::vector<ArticleInfo*> FileInfo::GetSegmentArticles()
+{
+	std::vector<ArticleInfo*> articles;
+
+	{
+		Guard guard(m_segmentsMutex);
+		articles.reserve(m_segments.size());
+		for (auto& segment : m_segments)
+		{
+			articles.push_back(segment.first);
+		}
+	}
+
+	// in the order of article list
+	std::sort(articles.begin(), articles.end());
+	return articles;
+}
+
+CachedFileList* FileInfo::GetCachedFiles()
+{
+	static CachedFileList cachedFiles;
+	return &cachedFiles;
+}
+
+void FileInfo::SetCachedArticles(int cachedArticles)
+{
+	m_cachedArticles = cachedArticles;
+
+	if (cachedArticles > 0)
+	{
+		GetCachedFiles()->Add(this);
+	}
+	else
+	{
+		GetCachedFiles()->Remove(this, false);
+	}
+}
+
 void FileInfo::SetActiveDownloads(int activeDownloads)
 {
+	bool idleChanged = (m_activeDownloads == 0) != (activeDownloads == 0);
 	m_activeDownloads = activeDownloads;
 
+	if (idleChanged)
+	{
+		GetCachedFiles()->ActiveChanged(this);
+	}
+
 	if (m_activeDownloads > 0 && !m_outputFileMutex)
 	{
 		m_outputFileMutex = std::make_unique<Mutex>();
@@ -844,6 +1030,125 @@ bool FileInfo::IsHardLinked()
 }
 
 
+void CachedFileList::Add(FileInfo* fileInfo)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	// a busy file is linked again when released
+	if (!fileInfo->m_cachedListed && !fileInfo->m_cachedBusy)
+	{
+		Link(fileInfo);
+	}
+}
+
+void CachedFileList::Remove(FileInfo* fileInfo, bool waitBusy)
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	if (waitBusy)
+	{
+		m_busyCond.wait(lock, [&] { return !fileInfo->m_cachedBusy; });
+	}
+
+	if (fileInfo->m_cachedListed)
+	{
+		Unlink(fileInfo);
+	}
+}
+
+void CachedFileList::ActiveChanged(FileInfo* fileInfo)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	if (fileInfo->m_cachedListed && fileInfo->m_cachedIdle != (fileInfo->GetActiveDownloads() == 0))
+	{
+		Unlink(fileInfo);
+		Link(fileInfo);
+	}
+}
+
+FileInfo* CachedFileList::Acquire(bool includeActive)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	FileInfo* fileInfo = m_idle.head ? m_idle.head : includeActive ? m_active.head : nullptr;
+	if (fileInfo)
+	{
+		Unlink(fileInfo);
+		fileInfo->m_cachedBusy = true;
+	}
+	return fileInfo;
+}
+
+void CachedFileList::Release(FileInfo* fileInfo)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		fileInfo->m_cachedBusy = false;
+		if (fileInfo->GetCachedArticles() > 0)
+		{
+			// not everything was flushed
+			Link(fileInfo);
+		}
+	}
+	m_busyCond.notify_all();
+}
+
+bool CachedFileList::IsBusy(FileInfo* fileInfo)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	return fileInfo->m_cachedBusy;
+}
+
+void CachedFileList::Link(FileInfo* fileInfo)
+{
+	fileInfo->m_cachedIdle = fileInfo->GetActiveDownloads() == 0;
+	List& list = fileInfo->m_cachedIdle ? m_idle : m_active;
+
+	fileInfo->m_cachedPrev = list.tail;
+	fileInfo->m_cachedNext = nullptr;
+	if (list.tail)
+	{
+		list.tail->m_cachedNext = fileInfo;
+	}
+	else
+	{
+		list.head = fileInfo;
+	}
+	list.tail = fileInfo;
+	fileInfo->m_cachedListed = true;
+	m_count++;
+}
+
+void CachedFileList::Unlink(FileInfo* fileInfo)
+{
+	List& list = fileInfo->m_cachedIdle ? m_idle : m_active;
+
+	if (fileInfo->m_cachedPrev)
+	{
+		fileInfo->m_cachedPrev->m_cachedNext = fileInfo->m_cachedNext;
+	}
+	else
+	{
+		list.head = fileInfo->m_cachedNext;
+	}
+
+	if (fileInfo->m_cachedNext)
+	{
+		fileInfo->m_cachedNext->m_cachedPrev = fileInfo->m_cachedPrev;
+	}
+	else
+	{
+		list.tail = fileInfo->m_cachedPrev;
+	}
+
+	fileInfo->m_cachedPrev = nullptr;
+	fileInfo->m_cachedNext = nullptr;
+	fileInfo->m_cachedListed = false;
+	m_count--;
+}
+
+
 CompletedFile::CompletedFile(int id, std::string filename, std::string origname, EStatus status,
 	uint32 crc, bool parFile, std::string hash16k, std::string parSetId) 
 	: m_id(id)
@@ -912,6 +1217,64 @@ const char* HistoryInfo::GetName()
 	}
 }
 
+const char* HistoryInfo::GetCategory()
+{
+	return m_kind == hkNzb || m_kind == hkUrl ? GetNzbInfo()->GetCategory() : "";
+}
+
+int64 HistoryInfo::GetSize()
+{
+	return m_kind == hkNzb || m_kind == hkUrl ? GetNzbInfo()->GetSize() :
+		m_kind == hkDup ? GetDupInfo()->GetSize() : 0;
+}
+
+const char* HistoryInfo::MakeTextStatus()
+{
+	const char* status = "FAILURE/INTERNAL_ERROR";
+
+	if (m_kind == hkNzb || m_kind == hkUrl)
+	{
+		status = GetNzbInfo()->MakeTextStatus(false);
+	}
+	else if (m_kind == hkDup)
+	{
+		const char* dupStatusName[] = { "FAILURE/INTERNAL_ERROR", "SUCCESS/HIDDEN", "FAILURE/HIDDEN",
+			"DELETED/MANUAL", "DELETED/DUPE", "FAILURE/BAD", "SUCCESS/GOOD" };
+		status = dupStatusName[GetDupInfo()->GetStatus()];
+	}
+
+	return status;
+}
+
+
+DownloadQueue::DownloadQueue() :
+	m_generation(1), m_queueGeneration(m_generation), m_historyGeneration(m_generation),
+	m_generationReserved(m_generation), m_queueDeleted(m_generation), m_historyDeleted(m_generation)
+{
+}
+
+void DownloadQueue::StartGenerations(int lastGeneration)
+{
+	const int MAX_START = std::numeric_limits<int>::max() / 2;
+
+	// a generation handed out before a restart is at most "lastGeneration" and therefore
+	// below the range of the new run, clients holding it get detected as outdated
+	m_generation = lastGeneration > 0 && lastGeneration < MAX_START ? lastGeneration + 1 : 1;
+	m_queueGeneration = m_generation;
+	m_historyGeneration = m_generation;
+	m_queueDeleted = DeletedLog(m_generation);
+	m_historyDeleted = DeletedLog(m_generation);
+	ReserveGenerations();
+}
+
+void DownloadQueue::ReserveGenerations()
+{
+	// persisting only every few thousand generations keeps disk writes rare while polling
+	const int RESERVE_BLOCK = 10000;
+
+	m_generationReserved = m_generation + RESERVE_BLOCK;
+	SaveGeneration(m_generationReserved);
+}
 
 void DownloadQueue::CalcRemainingSize(int64* remaining, int64* remainingForced)
 {
@@ -940,3 +1303,194 @@ void DownloadQueue::CalcRemainingSize(int64* remaining, int64* remainingForced)
 		*remainingForced = remainingForcedSize;
 	}
 }
+
+void DownloadQueue::UpdateGenerations(std::function<uint32(NzbInfo* nzbInfo)> statusHash)
+{
+	int generation = m_generation + 1;
+	bool queueChanged = false;
+	bool historyChanged = false;
+
+	IdList queueIds;
+	queueIds.reserve(m_queue.size());
+	for (NzbInfo* nzbInfo : &m_queue)
+	{
+		queueIds.push_back(nzbInfo->GetId());
+	}
+
+	std::unordered_set<int> addedIds;
+	if (queueIds != m_queueIds)
+	{
+		// order or membership changed
+		queueChanged = true;
+		std::unordered_set<int> oldIds(m_queueIds.begin(), m_queueIds.end());
+		std::unordered_set<int> newIds(queueIds.begin(), queueIds.end());
+		for (int id : m_queueIds)
+		{
+			if (!newIds.count(id))
+			{
+				m_queueDeleted.Add(id, generation);
+			}
+		}
+		for (int id : queueIds)
+		{
+			if (!oldIds.count(id))
+			{
+				addedIds.insert(id);
+			}
+		}
+		m_queueIds = std::move(queueIds);
+	}
+
+	for (NzbInfo* nzbInfo : &m_queue)
+	{
+		uint32 hash = nzbInfo->CalcStateHash() ^ statusHash(nzbInfo);
+		if (nzbInfo->GetChangeGen() == 0 || hash != nzbInfo->GetStateHash() || addedIds.count(nzbInfo->GetId()))
+		{
+			nzbInfo->SetStateHash(hash);
+			nzbInfo->SetChangeGen(generation);
+			queueChanged = true;
+		}
+	}
+
+	for (HistoryInfo* historyInfo : &m_history)
+	{
+		if (historyInfo->GetChangeGen() == 0)
+		{
+			historyInfo->SetChangeGen(generation);
+			historyChanged = true;
+		}
+	}
+
+	// deletions are detected by comparing id sets, which is only necessary if the history has
+	// changed in a way seen above or has shrunk
+	if (historyChanged || m_history.size() != m_historyIds.size())
+	{
+		std::unordered_set<int> historyIds;
+		for (HistoryInfo* historyInfo : &m_history)
+		{
+			historyIds.insert(historyInfo->GetId());
+		}
+		for (int id : m_historyIds)
+		{
+			if (!historyIds.count(id))
+			{
+				m_historyDeleted.Add(id, generation);
+				historyChanged = true;
+			}
+		}
+		m_historyIds = std::move(historyIds);
+	}
+
+	if (queueChanged || historyChanged)
+	{
+		m_generation = generation;
+		m_queueGeneration = queueChanged ? generation : m_queueGeneration;
+		m_historyGeneration = historyChanged ? generation : m_historyGeneration;
+		if (m_generation >= m_generationReserved)
+		{
+			ReserveGenerations();
+		}
+	}
+}
+
+void DownloadQueue::DeletedLog::Add(int id, int generation)
+{
+	const uint32 MAX_ENTRIES = 10000;
+
+	m_entries.emplace_back(id, generation);
+	if (m_entries.size() > MAX_ENTRIES)
+	{
+		m_floor = m_entries.front().second;
+		m_entries.pop_front();
+	}
+}
+
+bool DownloadQueue::DeletedLog::Since(int generation, IdList* idList)
+{
+	if (generation < m_floor)
+	{
+		return false;
+	}
+
+	for (Entries::reverse_iterator it = m_entries.rbegin(); it != m_entries.rend() && it->second > generation; it++)
+	{
+		idList->push_back(it->first);
+	}
+
+	return true;
+}
+
+RawHistoryList* DownloadQueue::GetHistoryIndex(EHistorySort sort, bool hidden, const char* category, const char* status)
+{
+	const size_t MAX_INDEXES = 32;
+
+	if (m_historyIndexGen != m_historyGeneration || m_historyIndexSize != m_history.size() ||
+		m_historyIndex.size() >= MAX_INDEXES)
+	{
+		m_historyIndex.clear();
+		m_historyIndexGen = m_historyGeneration;
+		m_historyIndexSize = m_history.size();
+	}
+
+	category = category ? category : "";
+	status = status ? status : "";
+
+	std::string key = std::to_string(sort) + (hidden ? "H" : "-") + category + '\n' + status;
+	auto it = m_historyIndex.find(key);
+	if (it != m_historyIndex.end())
+	{
+		return &it->second;
+	}
+
+	RawHistoryList list;
+
+	if (!hidden || *category || *status)
+	{
+		// filtered indexes are derived from the unfiltered index with the same order
+		RawHistoryList* all = GetHistoryIndex(sort, true, nullptr, nullptr);
+		int statusLen = strlen(status);
+		std::copy_if(all->begin(), all->end(), std::back_inserter(list),
+			[hidden, category, status, statusLen](HistoryInfo* historyInfo)
+			{
+				return (hidden || historyInfo->GetKind() != HistoryInfo::hkDup) &&
+					(!*category || !strcasecmp(historyInfo->GetCategory(), category)) &&
+					(!*status || !strncasecmp(historyInfo->MakeTextStatus(), status, statusLen));
+			});
+	}
+	else
+	{
+		list.reserve(m_history.size());
+		for (HistoryInfo* historyInfo : &m_history)
+		{
+			list.push_back(historyInfo);
+		}
+
+		switch (sort)
+		{
+			case hsTime:
+				std::stable_sort(list.begin(), list.end(),
+					[](HistoryInfo* a, HistoryInfo* b) { return a->GetTime() < b->GetTime(); });
+				break;
+
+			case hsName:
+				std::stable_sort(list.begin(), list.end(),
+					[](HistoryInfo* a, HistoryInfo* b) { return strcasecmp(a->GetName(), b->GetName()) < 0; });
+				break;
+
+			case hsCategory:
+				std::stable_sort(list.begin(), list.end(),
+					[](HistoryInfo* a, HistoryInfo* b) { return strcasecmp(a->GetCategory(), b->GetCategory()) < 0; });
+				break;
+
+			case hsSize:
+				std::stable_sort(list.begin(), list.end(),
+					[](HistoryInfo* a, HistoryInfo* b) { return a->GetSize() < b->GetSize(); });
+				break;
+
+			case hsNone:
+				break;
+		}
+	}
+
+	return &(m_historyIndex[key] = std::move(list));
+}
@@ -30,6 +30,7 @@
 #include "Observer.h"
 #include "Log.h"
 #include "Thread.h"
+#include "BlockVerifier.h"
 
 class NzbInfo;
 class DownloadQueue;
@@ -77,7 +78,7 @@ public:
 class ArticleInfo
 {
 public:
-	enum EStatus
+	enum EStatus : uint8
 	{
 		aiUndefined,
 		aiRunning,
@@ -85,39 +86,65 @@ public:
 		aiFailed
 	};
 
+	ArticleInfo() = default;
+	ArticleInfo(ArticleInfo&& other) noexcept { *this = std::move(other); }
+	ArticleInfo& operator=(ArticleInfo&& other) noexcept;
 	void SetPartNumber(int s) { m_partNumber = s; }
 	int GetPartNumber() { return m_partNumber; }
 	const char* GetMessageId() { return m_messageId; }
-	void SetMessageId(const char* messageId) { m_messageId = messageId; }
+	void SetMessageId(StringArena* arena, const char* messageId, int len = 0) { m_messageId = arena->Add(messageId, len); }
 	void SetSize(int size) { m_size = size; }
 	int GetSize() { return m_size; }
-	void AttachSegment(std::unique_ptr<SegmentData> content, int64 offset, int size);
-	void DiscardSegment();
-	const char* GetSegmentContent() { return m_segmentContent ? m_segmentContent->GetData() : nullptr; }
 	void SetSegmentOffset(int64 segmentOffset) { m_segmentOffset = segmentOffset; }
 	int64 GetSegmentOffset() { return m_segmentOffset; }
 	void SetSegmentSize(int segmentSize) { m_segmentSize = segmentSize; }
 	int GetSegmentSize() { return m_segmentSize; }
 	EStatus GetStatus() { return m_status; }
 	void SetStatus(EStatus Status) { m_status = Status; }
-	const char* GetResultFilename() { return m_resultFilename; }
-	void SetResultFilename(const char* resultFilename) { m_resultFilename = resultFilename; }
+	bool GetHasResultFile() { return m_hasResultFile; }
+	void SetHasResultFile(bool hasResultFile) { m_hasResultFile = hasResultFile; }
 	uint32 GetCrc() { return m_crc; }
 	void SetCrc(uint32 crc) { m_crc = crc; }
 
 private:
-	std::unique_ptr<SegmentData> m_segmentContent;
+	// the queue may hold millions of articles, the layout is kept compact:
+	// message-id is stored in arena of the file, cached segment data in the
+	// side table of the file and the name of result file is derived from the
+	// file id and part number (see FileInfo::GetResultFilename).
 	std::atomic<int64> m_segmentOffset{0};
 	std::atomic<int> m_segmentSize{0};
 	std::atomic<uint32> m_crc{0};
-	CString m_messageId;
-	CString m_resultFilename;
-	EStatus m_status = aiUndefined;
-	int m_partNumber;
+	const char* m_messageId = nullptr;
+	int m_partNumber = 0;
 	int m_size = 0;
+	EStatus m_status = aiUndefined;
+	bool m_hasResultFile = false;
 };
 
-typedef std::vector<std::unique_ptr<ArticleInfo>> ArticleList;
+/*
+ * Articles of a file are stored by value in one array. For-range loops on
+ * pointer to the list iterate through raw pointers, same as lists of unique_ptr.
+ * Pointers to articles remain valid as long as the list isn't resized.
+ */
+class ArticleList : public std::vector<ArticleInfo>
+{
+public:
+	ArticleInfo* Add() { return &emplace_back(); }
+};
+
+struct ArticleListIterator
+{
+	ArticleListIterator(ArticleInfo* article) : m_article(article) {}
+	ArticleInfo* m_article;
+	bool operator!=(const ArticleListIterator& other) const { return m_article != other.m_article; }
+	ArticleInfo* operator*() const { return m_article; }
+	ArticleListIterator& operator++() { m_article++; return *this; }
+};
+inline ArticleListIterator begin(ArticleList* list) { return ArticleListIterator(list->data()); }
+inline ArticleListIterator end(ArticleList* list) { return ArticleListIterator(list->data() + list->size()); }
+
+class CachedFileList;
+class AsyncFile;
 
 class FileInfo
 {
@@ -129,15 +156,25 @@ public:
 		psCompleted
 	};
 
-	typedef std::vector<CString> Groups;
+	typedef std::vector<std::shared_ptr<const std::string>> Groups;
 
-	FileInfo(int id = 0) : m_id(id ? id : ++m_idGen) {}
+	FileInfo(int id = 0);
+	~FileInfo();
 	int GetId() { return m_id; }
 	void SetId(int id);
 	static void ResetGenId(bool max);
 	NzbInfo* GetNzbInfo() { return m_nzbInfo; }
 	void SetNzbInfo(NzbInfo* nzbInfo) { m_nzbInfo = nzbInfo; }
 	ArticleList* GetArticles() { return &m_articles; }
+	StringArena* GetMessageIds() { return &m_messageIds; }
+	void DiscardArticles();
+	std::string GetResultFilename(ArticleInfo* article);
+	void AttachSegment(ArticleInfo* article, std::unique_ptr<SegmentData> content, int64 offset, int size);
+	void DiscardSegment(ArticleInfo* article);
+	const char* GetSegmentContent(ArticleInfo* article);
+	std::vector<ArticleInfo*> GetSegmentArticles();
+	void SetCacheInfoName(const std::string& infoName);
+	std::string GetCacheInfoName();
 	Groups* GetGroups() { return &m_groups; }
 	const char* GetSubject() { return m_subject; }
 	void SetSubject(const char* subject) { m_subject = subject; }
@@ -190,7 +227,11 @@ public:
 	bool GetDupeDeleted() { return m_dupeDeleted; }
 	void SetDupeDeleted(bool dupeDeleted) { m_dupeDeleted = dupeDeleted; }
 	int GetCachedArticles() { return m_cachedArticles; }
-	void SetCachedArticles(int cachedArticles) { m_cachedArticles = cachedArticles; }
+	void SetCachedArticles(int cachedArticles);
+	static CachedFileList* GetCachedFiles();
+	// asynchronous article writes hold a reference to the output file, not to
+	// the FileInfo, so the FileInfo can be deleted while they are in progress
+	std::shared_ptr<AsyncFile> GetAsyncFile() { return m_asyncFile; }
 	bool GetPartialChanged() { return m_partialChanged; }
 	void SetPartialChanged(bool partialChanged) { m_partialChanged = partialChanged; }
 	bool GetForceDirectWrite() { return m_forceDirectWrite; }
@@ -208,13 +249,19 @@ public:
 	const std::string& GetHardLinkPath() const { return m_hardLinkPath; }
 	void SetHardLinkPath(std::string hardLinkPath) { m_hardLinkPath = std::move(hardLinkPath); }
 	bool IsHardLinked();
+	BlockVerifier* GetBlockVerifier() { return m_blockVerifier.get(); }
+	void SetBlockVerifier(std::unique_ptr<BlockVerifier> blockVerifier) { m_blockVerifier = std::move(blockVerifier); }
+	BlockVerifier::CrcMap* GetCrcMap() { return &m_crcMap; }
 
 	ServerStatList* GetServerStats() { return &m_serverStats; }
 
 private:
 	int m_id;
 	NzbInfo* m_nzbInfo = nullptr;
+	StringArena m_messageIds;
 	ArticleList m_articles;
+	std::unordered_map<ArticleInfo*, std::unique_ptr<SegmentData>> m_segments;	// articles in article cache
+	Mutex m_segmentsMutex;
 	Groups m_groups;
 	ServerStatList m_serverStats;
 	CString m_subject;
@@ -239,9 +286,16 @@ private:
 	std::string m_outputFilename;
 	std::unique_ptr<Mutex> m_outputFileMutex;
 	bool m_extraPriority = false;
-	int m_activeDownloads = 0;
+	std::atomic<int> m_activeDownloads{0};
 	bool m_dupeDeleted = false;
 	std::atomic<int> m_cachedArticles{0};
+	FileInfo* m_cachedPrev = nullptr;
+	FileInfo* m_cachedNext = nullptr;
+	bool m_cachedListed = false;
+	bool m_cachedIdle = false;
+	bool m_cachedBusy = false;
+	std::string m_cacheInfoName;
+	std::shared_ptr<AsyncFile> m_asyncFile;
 	bool m_partialChanged = false;
 	bool m_forceDirectWrite = false;
 	EPartialState m_partialState = psNone;
@@ -250,14 +304,58 @@ private:
 	CString m_parSetId;
 	bool m_flushLocked = false;
 	std::string m_hardLinkPath;
+	std::unique_ptr<BlockVerifier> m_blockVerifier;
+	BlockVerifier::CrcMap m_crcMap;	// loaded from completed state of partially downloaded file
 
-	static int m_idGen;
+	static std::atomic<int> m_idGen;	// nzb-files may be parsed on several threads
 	static int m_idMax;
 
 	friend class CompletedFile;
+	friend class CachedFileList;
 };
 
 typedef UniqueDeque<FileInfo> FileList;
+
+/**
+ * Intrusive lists of files having articles in article cache, maintained by
+ * ArticleWriter. Files without active downloads (idle) and files still being
+ * downloaded are kept in separate lists, each in the order the files were added.
+ * Lets the cache flusher pick a file in constant time without the queue lock.
+ */
+class CachedFileList
+{
+public:
+	void Add(FileInfo* fileInfo);
+	void Remove(FileInfo* fileInfo, bool waitBusy);
+	void ActiveChanged(FileInfo* fileInfo);
+
+	/**
+	 * Takes the oldest idle file, or the oldest file being downloaded if there
+	 * are no idle files and "includeActive" is set, and marks it busy.
+	 * A busy file is not destroyed until it is released with Release().
+	 */
+	FileInfo* Acquire(bool includeActive);
+	void Release(FileInfo* fileInfo);
+	bool IsBusy(FileInfo* fileInfo);
+	int GetCount() { return m_count; }
+
+private:
+	struct List
+	{
+		FileInfo* head = nullptr;
+		FileInfo* tail = nullptr;
+	};
+
+	std::mutex m_mutex;
+	std::condition_variable m_busyCond;
+	List m_idle;
+	List m_active;
+	std::atomic<int> m_count{0};
+
+	void Link(FileInfo* fileInfo);
+	void Unlink(FileInfo* fileInfo);
+};
+
 typedef std::vector<FileInfo*> RawFileList;
 
 class CompletedFile
@@ -285,6 +383,9 @@ public:
 	void SetHash16k(std::string hash16k) { m_hash16k = std::move(hash16k); }
 	const char* GetParSetId() { return m_parSetId.c_str(); }
 	void SetParSetId(std::string parSetId) { m_parSetId = std::move(parSetId); }
+	int64 GetBlockSize() { return m_blockSize; }
+	BlockVerifier::BlockStatusList* GetBlockStatus() { return &m_blockStatus; }
+	void SetBlockStatus(int64 blockSize, BlockVerifier::BlockStatusList blockStatus) { m_blockSize = blockSize; m_blockStatus = std::move(blockStatus); }
 
 private:
 	int m_id;
@@ -295,6 +396,8 @@ private:
 	std::string m_origname;
 	std::string m_hash16k;
 	std::string m_parSetId;
+	int64 m_blockSize = 0;
+	BlockVerifier::BlockStatusList m_blockStatus;	// verified during download, not saved to disk
 };
 
 typedef std::deque<CompletedFile> CompletedFileList;
@@ -630,6 +733,8 @@ public:
 	void SetRepairSec(int repairSec) { m_repairSec = repairSec; }
 	int GetUnpackSec() { return m_unpackSec; }
 	void SetUnpackSec(int unpackSec) { m_unpackSec = unpackSec; }
+	int GetUnpackStallSec() { return m_unpackStallSec; }
+	void SetUnpackStallSec(int unpackStallSec) { m_unpackStallSec = unpackStallSec; }
 	time_t GetDownloadStartTime() { return m_downloadStartTime; }
 	void SetDownloadStartTime(time_t downloadStartTime) { m_downloadStartTime = downloadStartTime; }
 	bool GetChanged() { return m_changed; }
@@ -675,6 +780,11 @@ public:
 	bool GetSkipDiskWrite() { return m_scipDiskWrite; }
 	void SetAutoCategory(bool autoCategory) { m_autoCategory = autoCategory; }
 	bool GetAutoCategory() const { return m_autoCategory; }
+	uint32 CalcStateHash();
+	int GetChangeGen() { return m_changeGen; }
+	void SetChangeGen(int changeGen) { m_changeGen = changeGen; }
+	uint32 GetStateHash() { return m_stateHash; }
+	void SetStateHash(uint32 stateHash) { m_stateHash = stateHash; }
 
 	static const int FORCE_PRIORITY = 900;
 
@@ -761,6 +871,7 @@ private:
 	int m_parSec = 0;
 	int m_repairSec = 0;
 	int m_unpackSec = 0;
+	int m_unpackStallSec = 0;	// direct unpack was waiting for volumes
 	bool m_reprocess = false;
 	bool m_changed = false;
 	time_t m_queueScriptTime = 0;
@@ -776,6 +887,8 @@ private:
 	bool m_skipScriptProcessing = false;
 	bool m_scipDiskWrite = false;
 	bool m_autoCategory = false;
+	int m_changeGen = 0;
+	uint32 m_stateHash = 0;
 
 	static int m_idGen;
 	static int m_idMax;
@@ -845,6 +958,14 @@ public:
 	void SetLastUnpackStatus(int unpackStatus) { m_lastUnpackStatus = unpackStatus; }
 	bool GetNeedParCheck() { return m_needParCheck; }
 	void SetNeedParCheck(bool needParCheck) { m_needParCheck = needParCheck; }
+	EStage GetWaitingStage() { return m_waitingStage; }
+	void SetWaitingStage(EStage waitingStage) { m_waitingStage = waitingStage; }
+	bool GetWaitingRepair() { return m_waitingRepair; }
+	void SetWaitingRepair(bool waitingRepair) { m_waitingRepair = waitingRepair; }
+	bool GetRepairSlot() { return m_repairSlot; }
+	void SetRepairSlot(bool repairSlot) { m_repairSlot = repairSlot; }
+	int64 GetDeviceId() { return m_deviceId; }
+	void SetDeviceId(int64 deviceId) { m_deviceId = deviceId; }
 	Thread* GetPostThread() { return m_postThread; }
 	void SetPostThread(Thread* postThread) { m_postThread = postThread; }
 	ParredFiles* GetParredFiles() { return &m_parredFiles; }
@@ -862,6 +983,10 @@ private:
 	bool m_passListTried = false;
 	int m_lastUnpackStatus = 0;
 	bool m_needParCheck = false;
+	EStage m_waitingStage = ptQueued;
+	bool m_waitingRepair = false;
+	bool m_repairSlot = false;
+	int64 m_deviceId = -1;
 	EStage m_stage = ptQueued;
 	CString m_progressLabel = "";
 	int m_fileProgress = 0;
@@ -945,14 +1070,24 @@ public:
 	time_t GetTime() { return m_time; }
 	void SetTime(time_t time) { m_time = time; }
 	const char* GetName();
+	const char* GetCategory();
+	int64 GetSize();
+	const char* MakeTextStatus();
+	bool GetChanged() { return m_changed; }
+	void SetChanged(bool changed) { m_changed = changed; if (changed) m_changeGen = 0; }
+	int GetChangeGen() { return m_changeGen; }
+	void SetChangeGen(int changeGen) { m_changeGen = changeGen; }
 
 private:
 	void* m_info;
 	EKind m_kind;
 	time_t m_time = 0;
+	bool m_changed = true; // not saved to disk yet
+	int m_changeGen = 0; // not yet seen by DownloadQueue::UpdateGenerations
 };
 
 typedef UniqueDeque<HistoryInfo> HistoryList;
+typedef std::vector<HistoryInfo*> RawHistoryList;
 
 typedef GuardedPtr<DownloadQueue> GuardedDownloadQueue;
 
@@ -1046,6 +1181,15 @@ public:
 		mmRegEx
 	};
 
+	enum EHistorySort
+	{
+		hsNone, // order of history list, newest first
+		hsTime,
+		hsName,
+		hsCategory,
+		hsSize
+	};
+
 	static bool IsLoaded() { return g_Loaded; }
 	static GuardedDownloadQueue Guard() { return GuardedDownloadQueue(g_DownloadQueue, &g_DownloadQueue->m_lockMutex); }
 	NzbList* GetQueue() { return &m_queue; }
@@ -1057,19 +1201,69 @@ public:
 	virtual void SaveChanged() = 0;
 	void CalcRemainingSize(int64* remaining, int64* remainingForced);
 
+	/* Change generations for clients polling queue and history.
+	 * Must be called under lock; detects changed, added and deleted entries since the previous call
+	 * and stamps them with a new generation. Parameter "statusHash" folds in state not stored in NzbInfo
+	 * and must be the same function on every call. */
+	void UpdateGenerations(std::function<uint32(NzbInfo* nzbInfo)> statusHash);
+	/* Continue generations after "lastGeneration" saved by the previous run via "SaveGeneration",
+	 * must be called under lock before the first UpdateGenerations. */
+	void StartGenerations(int lastGeneration);
+	int GetGeneration() { return m_generation; }
+	int GetQueueGeneration() { return m_queueGeneration; }
+	int GetHistoryGeneration() { return m_historyGeneration; }
+	// return false if the generation is too old (or from another run) to compute deletions
+	bool GetQueueDeleted(int generation, IdList* idList) { return m_queueDeleted.Since(generation, idList); }
+	bool GetHistoryDeleted(int generation, IdList* idList) { return m_historyDeleted.Since(generation, idList); }
+
+	/* Secondary index over history: entries in ascending order of the sort key, limited to entries
+	 * matching the filters ("hidden" - include dup-entries; "status" - prefix of the text status).
+	 * Built on first use and kept until the history changes, must be called under lock
+	 * after UpdateGenerations. */
+	RawHistoryList* GetHistoryIndex(EHistorySort sort, bool hidden, const char* category, const char* status);
+
 protected:
-	DownloadQueue() {}
+	DownloadQueue();
 	static void Init(DownloadQueue* globalInstance) { g_DownloadQueue = globalInstance; }
 	static void Final() { g_DownloadQueue = nullptr; }
 	static void Loaded() { g_Loaded = true; }
+	// persist the highest generation reserved for handing out, passed to StartGenerations on next start
+	virtual void SaveGeneration([[maybe_unused]] int generation) {}
 
 private:
+	class DeletedLog
+	{
+	public:
+		DeletedLog(int floor) : m_floor(floor) {}
+		void Add(int id, int generation);
+		bool Since(int generation, IdList* idList);
+
+	private:
+		typedef std::deque<std::pair<int, int>> Entries;
+
+		Entries m_entries;
+		int m_floor;
+	};
+
 	NzbList m_queue;
 	HistoryList m_history;
 	Mutex m_lockMutex;
+	int m_generation;
+	int m_queueGeneration;
+	int m_historyGeneration;
+	int m_generationReserved;
+	IdList m_queueIds;
+	std::unordered_set<int> m_historyIds;
+	DeletedLog m_queueDeleted;
+	DeletedLog m_historyDeleted;
+	std::map<std::string, RawHistoryList> m_historyIndex;
+	int m_historyIndexGen = 0;
+	size_t m_historyIndexSize = 0;
 
 	static DownloadQueue* g_DownloadQueue;
 	static std::atomic<bool> g_Loaded;
+
+	void ReserveGenerations();
 };
 
 #endif
@@ -261,6 +261,7 @@ bool HistoryCoordinator::EditList(DownloadQueue* downloadQueue, IdList* idList,
 			if (historyInfo->GetId() == id)
 			{
 				ok = true;
+				historyInfo->SetChanged(true);
 
 				switch (action)
 				{
@@ -400,6 +401,7 @@ void HistoryCoordinator::MoveToQueue(DownloadQueue* downloadQueue, HistoryList::
 		nzbInfo->SetRarRenameStatus(NzbInfo::rsNone);
 		nzbInfo->SetPostTotalSec(nzbInfo->GetPostTotalSec() - nzbInfo->GetUnpackSec());
 		nzbInfo->SetUnpackSec(0);
+		nzbInfo->SetUnpackStallSec(0);
 
 		if (ParParser::FindMainPars(nzbInfo->GetDestDir(), nullptr))
 		{
@@ -524,6 +526,7 @@ void HistoryCoordinator::HistoryRedownload(DownloadQueue* downloadQueue, History
 	nzbInfo->SetParSec(0);
 	nzbInfo->SetRepairSec(0);
 	nzbInfo->SetUnpackSec(0);
+	nzbInfo->SetUnpackStallSec(0);
 	nzbInfo->SetExtraParBlocks(0);
 	nzbInfo->SetAllFirst(false);
 	nzbInfo->SetWaitingPar(false);
@@ -648,7 +651,7 @@ void HistoryCoordinator::HistoryRetry(DownloadQueue* downloadQueue, HistoryList:
 				{
 					g_DiskState->SaveFileState(fileInfo.get(), true);
 				}
-				fileInfo->GetArticles()->clear();
+				fileInfo->DiscardArticles();
 
 				nzbInfo->GetFileList()->Add(std::move(fileInfo), false);
 
@@ -0,0 +1,297 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include "NzbDirWatcher.h"
+#include "FileSystem.h"
+#include "Log.h"
+
+NzbDirWatcher::~NzbDirWatcher()
+{
+	Stop();
+}
+
+bool NzbDirWatcher::HasChanges()
+{
+	Guard guard(m_changesMutex);
+	return !m_changes.files.empty() || !m_changes.dirs.empty() || m_changes.overflow;
+}
+
+NzbDirWatcher::Changes NzbDirWatcher::TakeChanges()
+{
+	Guard guard(m_changesMutex);
+	Changes changes = std::move(m_changes);
+	m_changes = Changes();
+	return changes;
+}
+
+#ifdef __linux__
+
+bool NzbDirWatcher::Start(const char* directory)
+{
+	m_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (m_fd == -1)
+	{
+		warn("Could not watch directory %s: %s", directory, *FileSystem::GetLastErrorMessage());
+		return false;
+	}
+
+	if (!AddWatches(directory))
+	{
+		close(m_fd);
+		m_fd = -1;
+		m_watches.clear();
+		return false;
+	}
+
+	for (auto& watch : m_watches)
+	{
+		if (watch.second == directory)
+		{
+			m_rootWatch = watch.first;
+		}
+	}
+
+	m_active = true;
+	m_thread = std::thread(&NzbDirWatcher::Run, this);
+	return true;
+}
+
+void NzbDirWatcher::Stop()
+{
+	m_stopped = true;
+	if (m_thread.joinable())
+	{
+		m_thread.join();
+	}
+	if (m_fd != -1)
+	{
+		close(m_fd);
+		m_fd = -1;
+	}
+	m_active = false;
+}
+
+/*
+ * Changes made on network shares by other computers are not reported by inotify,
+ * these directories must be polled.
+ */
+bool NzbDirWatcher::IsNetworkFs(const std::string& directory)
+{
+	struct statfs fsInfo;
+	if (statfs(directory.c_str(), &fsInfo) != 0)
+	{
+		return false;
+	}
+
+	switch ((uint32)fsInfo.f_type)
+	{
+		case 0x6969:		// NFS
+		case 0x517B:		// SMB
+		case 0xFF534D42:	// CIFS
+		case 0xFE534D42:	// SMB2
+		case 0x01021997:	// 9P
+		case 0x00C36400:	// Ceph
+		case 0x65735546:	// FUSE (sshfs, rclone and others)
+		case 0x5346414F:	// AFS
+		case 0x564C:		// NCP
+			return true;
+		default:
+			return false;
+	}
+}
+
+/*
+ * Watches the directory and all its subdirectories, except hidden ones like the
+ * scanner skips them. Returns false if the directory itself can't be watched,
+ * for example when the limit of inotify watches is reached or the directory
+ * is on a network share.
+ */
+bool NzbDirWatcher::AddWatches(const std::string& directory)
+{
+	if (IsNetworkFs(directory))
+	{
+		info("Directory %s is on a network share, checking it periodically instead of watching", directory.c_str());
+		return false;
+	}
+
+	int wd = inotify_add_watch(m_fd, directory.c_str(),
+		IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_MOVE_SELF | IN_ONLYDIR);
+	if (wd == -1)
+	{
+		warn("Could not watch directory %s: %s", directory.c_str(), *FileSystem::GetLastErrorMessage());
+		return false;
+	}
+	m_watches[wd] = directory;
+
+	bool ok = true;
+	DirBrowser dir(directory.c_str());
+	while (const char* filename = dir.Next())
+	{
+		std::string fullPath = directory + PATH_SEPARATOR + filename;
+		if (filename[0] != '.' && FileSystem::DirectoryExists(fullPath.c_str()))
+		{
+			ok &= AddWatches(fullPath);
+		}
+	}
+
+	return ok;
+}
+
+void NzbDirWatcher::Run()
+{
+	while (!m_stopped && m_active)
+	{
+		pollfd pollFd{m_fd, POLLIN, 0};
+		if (poll(&pollFd, 1, 1000) <= 0)
+		{
+			continue;
+		}
+
+		if (ReadEvents() && !m_stopped)
+		{
+			m_onChange();
+		}
+	}
+}
+
+/*
+ * Returns true if there are new changes for the scanner.
+ */
+bool NzbDirWatcher::ReadEvents()
+{
+	alignas(inotify_event) char buffer[16 * 1024];
+	int len = (int)read(m_fd, buffer, sizeof(buffer));
+	if (len <= 0)
+	{
+		return false;
+	}
+
+	Guard guard(m_changesMutex);
+	bool changed = false;
+
+	for (char* ptr = buffer; ptr < buffer + len; )
+	{
+		inotify_event* event = (inotify_event*)ptr;
+		ptr += sizeof(inotify_event) + event->len;
+
+		if (event->mask & IN_Q_OVERFLOW)
+		{
+			m_changes.overflow = true;
+			changed = true;
+			continue;
+		}
+
+		auto it = m_watches.find(event->wd);
+		if (it == m_watches.end())
+		{
+			continue;
+		}
+
+		if (event->mask & IN_IGNORED)
+		{
+			if (event->wd == m_rootWatch)
+			{
+				// the incoming directory itself has gone, back to polling
+				m_active = false;
+				m_changes.overflow = true;
+				changed = true;
+			}
+			m_watches.erase(it);
+			continue;
+		}
+
+		if (event->mask & IN_MOVE_SELF)
+		{
+			// a directory moved within the tree was already watched again under its new name,
+			// a directory moved out of the tree is no longer watched together with its subdirectories
+			if (!FileSystem::DirectoryExists(it->second.c_str()))
+			{
+				std::string prefix = it->second + PATH_SEPARATOR;
+				for (auto& watch : m_watches)
+				{
+					if (watch.first == event->wd || !watch.second.compare(0, prefix.length(), prefix))
+					{
+						inotify_rm_watch(m_fd, watch.first);
+					}
+				}
+			}
+			continue;
+		}
+
+		if (event->len == 0 || event->name[0] == '.')
+		{
+			continue;
+		}
+
+		std::string fullPath = it->second + PATH_SEPARATOR + event->name;
+
+		if (event->mask & IN_ISDIR)
+		{
+			if (event->mask & (IN_CREATE | IN_MOVED_TO))
+			{
+				if (!AddWatches(fullPath))
+				{
+					m_changes.overflow = true;
+				}
+				m_changes.dirs.insert(fullPath);
+				changed = true;
+			}
+		}
+		else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO))
+		{
+			m_changes.files.insert(fullPath);
+			changed = true;
+		}
+	}
+
+	return changed;
+}
+
+#else
+
+bool NzbDirWatcher::Start([[maybe_unused]] const char* directory)
+{
+	return false;
+}
+
+void NzbDirWatcher::Stop()
+{
+}
+
+bool NzbDirWatcher::IsNetworkFs([[maybe_unused]] const std::string& directory)
+{
+	return false;
+}
+
+bool NzbDirWatcher::AddWatches([[maybe_unused]] const std::string& directory)
+{
+	return false;
+}
+
+void NzbDirWatcher::Run()
+{
+}
+
+bool NzbDirWatcher::ReadEvents()
+{
+	return false;
+}
+
+#endif
@@ -0,0 +1,75 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NZBDIRWATCHER_H
+#define NZBDIRWATCHER_H
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include "Thread.h"
+
+/**
+ * Watches incoming nzb-directory and its subdirectories for new files using
+ * inotify (Linux only, on other systems and on network shares "Start" fails and
+ * the directory is polled).
+ *
+ * Files which were closed after writing or moved into a watched directory are
+ * complete and are reported at once. New subdirectories are watched too and
+ * reported separately, their content must be scanned. If events were lost
+ * the whole directory must be scanned.
+ *
+ * Events are read on an own thread, which calls "onChange" for new changes.
+ */
+class NzbDirWatcher
+{
+public:
+	struct Changes
+	{
+		std::set<std::string> files;
+		std::set<std::string> dirs;
+		bool overflow = false;
+	};
+
+	NzbDirWatcher(std::function<void()> onChange) : m_onChange(std::move(onChange)) {}
+	NzbDirWatcher(const NzbDirWatcher&) = delete;
+	~NzbDirWatcher();
+	bool Start(const char* directory);
+	void Stop();
+	bool IsActive() { return m_active; }
+	bool HasChanges();
+	Changes TakeChanges();
+
+private:
+	std::function<void()> m_onChange;
+	std::thread m_thread;
+	std::atomic<bool> m_active{false};
+	std::atomic<bool> m_stopped{false};
+	Mutex m_changesMutex;
+	Changes m_changes;
+	int m_fd = -1;
+	int m_rootWatch = -1;
+	std::unordered_map<int, std::string> m_watches;	// used only by the watcher thread after start
+
+	bool IsNetworkFs(const std::string& directory);
+	bool AddWatches(const std::string& directory);
+	void Run();
+	bool ReadEvents();
+};
+
+#endif
@@ -46,17 +46,20 @@ void NzbFile::LogDebugInfo()
 	info(" NZBFile %s", m_fileName.c_str());
 }
 
-void NzbFile::AddArticle(FileInfo* fileInfo, std::unique_ptr<ArticleInfo> articleInfo)
+ArticleInfo* NzbFile::AddArticle(FileInfo* fileInfo, int partNumber)
 {
-	int index = articleInfo->GetPartNumber() - 1;
+	int index = partNumber - 1;
 
-	// make Article-List big enough
+	// make Article-List big enough, missing articles remain with part number 0
 	if (index >= (int)fileInfo->GetArticles()->size())
 	{
 		fileInfo->GetArticles()->resize(index + 1);
 	}
 
-	(*fileInfo->GetArticles())[index] = std::move(articleInfo);
+	ArticleInfo* article = &fileInfo->GetArticles()->at(index);
+	*article = ArticleInfo();
+	article->SetPartNumber(partNumber);
+	return article;
 }
 
 void NzbFile::AddFileInfo(std::unique_ptr<FileInfo> fileInfo)
@@ -69,14 +72,10 @@ void NzbFile::AddFileInfo(std::unique_ptr<FileInfo> fileInfo)
 	int uncountedArticles = 0;
 	int missedArticles = 0;
 	int totalArticles = (int)fileInfo->GetArticles()->size();
-	int i = 0;
-	for (ArticleList::iterator it = fileInfo->GetArticles()->begin(); it != fileInfo->GetArticles()->end(); )
+	for (ArticleInfo* article : fileInfo->GetArticles())
 	{
-		ArticleInfo* article = (*it).get();
-		if (!article)
+		if (article->GetPartNumber() == 0)
 		{
-			fileInfo->GetArticles()->erase(it);
-			it = fileInfo->GetArticles()->begin() + i;
 			missedArticles++;
 			if (oneSize > 0)
 			{
@@ -94,11 +93,17 @@ void NzbFile::AddFileInfo(std::unique_ptr<FileInfo> fileInfo)
 			{
 				oneSize = article->GetSize();
 			}
-			it++;
-			i++;
 		}
 	}
 
+	if (missedArticles > 0)
+	{
+		ArticleList* articles = fileInfo->GetArticles();
+		articles->erase(std::remove_if(articles->begin(), articles->end(),
+			[](ArticleInfo& article) { return article.GetPartNumber() == 0; }), articles->end());
+	}
+	fileInfo->GetArticles()->shrink_to_fit();
+
 	if (fileInfo->GetArticles()->empty())
 	{
 		return;
@@ -281,7 +286,7 @@ void NzbFile::ProcessFiles()
 		for (FileInfo* fileInfo : m_nzbInfo->GetFileList())
 		{
 			g_DiskState->SaveFile(fileInfo);
-			fileInfo->GetArticles()->clear();
+			fileInfo->DiscardArticles();
 		}
 	}
 
@@ -307,20 +312,29 @@ void NzbFile::ReadPasswordFromFilename()
 	    m_password = m_fileName.substr(start, end - start);
 }
 
+static bool IsSpace(char ch)
+{
+	return ch == ' ' || ch == '\n' || ch == '\r' || ch == '\t';
+}
+
 bool NzbFile::Parse()
 {
-	xmlSAXHandler SAX_handler = {0};
-	SAX_handler.startElement = reinterpret_cast<startElementSAXFunc>(SAX_StartElement);
-	SAX_handler.endElement = reinterpret_cast<endElementSAXFunc>(SAX_EndElement);
-	SAX_handler.characters = reinterpret_cast<charactersSAXFunc>(SAX_characters);
-	SAX_handler.error = reinterpret_cast<errorSAXFunc>(SAX_error);
-	SAX_handler.getEntity = reinterpret_cast<getEntitySAXFunc>(SAX_getEntity);
+	CharBuffer buffer;
+	bool ok = FileSystem::LoadFileIntoBuffer(m_fileName.c_str(), buffer, true);
+	if (!ok)
+	{
+		ParseError(BString<1024>("could not read file: %s", *FileSystem::GetLastErrorMessage()));
+	}
 
-	m_ignoreNextError = false;
+	int len = ok ? buffer.Size() - 1 : 0;
+	ok = ok && ConvertEncoding(buffer, len) && ParseBuffer(buffer, len);
 
-	int ret = xmlSAXUserParseFile(&SAX_handler, this, m_fileName.c_str());
+	// parsed content refers to the buffer
+	m_tagContent = {};
+	m_openTags.clear();
+	m_groups.clear();
 
-	if (ret != 0)
+	if (!ok)
 	{
 		m_nzbInfo->AddMessage(Message::mkError, BString<1024>(
 			"Error parsing nzb-file %s", FileSystem::BaseFileName(m_fileName.c_str())));
@@ -339,11 +353,567 @@ bool NzbFile::Parse()
 	return true;
 }
 
+/*
+ * The nzb-file is tokenized directly in the file buffer: tag and attribute names
+ * and attribute values are decoded and null-terminated in place, the text of
+ * elements is passed as references into the buffer. The parser understands the
+ * subset of XML used by nzb-files, a document type declaration is skipped.
+ */
+bool NzbFile::ParseBuffer(char* buf, int len)
+{
+	char* p = buf;
+	char* end = buf + len;
+	bool root = false;
+
+	if (len >= 3 && !strncmp(p, "\xEF\xBB\xBF", 3))
+	{
+		// UTF-8 byte order mark
+		p += 3;
+	}
+
+	while (p < end)
+	{
+		char* tag = (char*)memchr(p, '<', end - p);
+		char* textEnd = tag ? tag : end;
+
+		if (!m_openTags.empty())
+		{
+			if (!ParseText(p, textEnd)) return false;
+		}
+		else if (std::find_if(p, textEnd, [](char ch) { return !IsSpace(ch); }) != textEnd)
+		{
+			ParseError(root ? "Extra content at the end of the document" : "Start tag expected, '<' not found");
+			return false;
+		}
+
+		if (!tag)
+		{
+			break;
+		}
+
+		if (!strncmp(tag, "<?", 2))
+		{
+			p = strstr(tag + 2, "?>");
+			p = p ? p + 2 : nullptr;
+		}
+		else if (!strncmp(tag, "<!--", 4))
+		{
+			p = strstr(tag + 4, "-->");
+			p = p ? p + 3 : nullptr;
+		}
+		else if (!strncmp(tag, "<![CDATA[", 9))
+		{
+			p = strstr(tag + 9, "]]>");
+			if (p && !m_openTags.empty())
+			{
+				AppendContent(tag + 9, (int)(p - tag - 9));
+			}
+			p = p ? p + 3 : nullptr;
+		}
+		else if (!strncmp(tag, "<!", 2))
+		{
+			p = SkipDeclaration(tag + 2, end);
+		}
+		else if (tag[1] == '/')
+		{
+			p = ParseEndTag(tag + 2, end);
+			if (!p) return false;
+		}
+		else
+		{
+			if (root && m_openTags.empty())
+			{
+				ParseError("Extra content at the end of the document");
+				return false;
+			}
+			root = true;
+			p = ParseStartTag(tag + 1, end);
+			if (!p) return false;
+		}
+
+		if (!p)
+		{
+			ParseError("Premature end of data");
+			return false;
+		}
+	}
+
+	if (!m_openTags.empty())
+	{
+		ParseError(BString<1024>("Premature end of data in tag %s", m_openTags.back()));
+		return false;
+	}
+
+	if (!root)
+	{
+		ParseError("Document is empty");
+		return false;
+	}
+
+	return true;
+}
+
+char* NzbFile::ParseStartTag(char* p, char* end)
+{
+	char* name = p;
+	while (p < end && !IsSpace(*p) && *p != '>' && *p != '/') p++;
+	char* nameEnd = p;
+	if (name == nameEnd)
+	{
+		ParseError("StartTag: invalid element name");
+		return nullptr;
+	}
+
+	m_attributes.clear();
+	bool closed = false;
+
+	for (;;)
+	{
+		while (p < end && IsSpace(*p)) p++;
+		if (p >= end)
+		{
+			ParseError("Premature end of data");
+			return nullptr;
+		}
+
+		if (*p == '>')
+		{
+			p++;
+			break;
+		}
+
+		if (*p == '/' && p[1] == '>')
+		{
+			closed = true;
+			p += 2;
+			break;
+		}
+
+		char* attrName = p;
+		while (p < end && !IsSpace(*p) && *p != '=' && *p != '>' && *p != '/') p++;
+		char* attrNameEnd = p;
+		while (p < end && IsSpace(*p)) p++;
+		if (attrName == attrNameEnd || *p != '=')
+		{
+			ParseError(BString<1024>("Specification mandates value for attribute in tag %.*s",
+				(int)(nameEnd - name), name));
+			return nullptr;
+		}
+		p++;
+		while (p < end && IsSpace(*p)) p++;
+
+		char quote = *p;
+		char* value = p + 1;
+		char* valueEnd = quote == '"' || quote == '\'' ? (char*)memchr(value, quote, end - value) : nullptr;
+		if (!valueEnd)
+		{
+			ParseError(BString<1024>("AttValue: \" or ' expected in tag %.*s", (int)(nameEnd - name), name));
+			return nullptr;
+		}
+		p = valueEnd + 1;
+
+		char* decodedEnd = DecodeEntities(value, valueEnd, true);
+		if (!decodedEnd) return nullptr;
+
+		*attrNameEnd = '\0';
+		*decodedEnd = '\0';
+		m_attributes.push_back(attrName);
+		m_attributes.push_back(value);
+	}
+
+	*nameEnd = '\0';
+
+	if (!m_attributes.empty())
+	{
+		m_attributes.push_back(nullptr);
+	}
+
+	Parse_StartElement(name, m_attributes.empty() ? nullptr : m_attributes.data());
+
+	if (closed)
+	{
+		Parse_EndElement(name);
+	}
+	else
+	{
+		m_openTags.push_back(name);
+	}
+
+	return p;
+}
+
+char* NzbFile::ParseEndTag(char* p, char* end)
+{
+	char* name = p;
+	while (p < end && !IsSpace(*p) && *p != '>') p++;
+	char* nameEnd = p;
+	while (p < end && IsSpace(*p)) p++;
+	if (p >= end || *p != '>')
+	{
+		ParseError("Premature end of data");
+		return nullptr;
+	}
+	*nameEnd = '\0';
+
+	if (m_openTags.empty() || strcmp(m_openTags.back(), name))
+	{
+		ParseError(BString<1024>("Opening and ending tag mismatch: %s and %s",
+			m_openTags.empty() ? "" : m_openTags.back(), name));
+		return nullptr;
+	}
+
+	m_openTags.pop_back();
+	Parse_EndElement(name);
+
+	return p + 1;
+}
+
+char* NzbFile::SkipDeclaration(char* p, char* end)
+{
+	// document type declaration may contain an internal subset in brackets
+	int depth = 0;
+	char quote = '\0';
+	for (; p < end; p++)
+	{
+		char ch = *p;
+		if (quote)
+		{
+			if (ch == quote) quote = '\0';
+		}
+		else if (ch == '"' || ch == '\'')
+		{
+			quote = ch;
+		}
+		else if (ch == '[')
+		{
+			depth++;
+		}
+		else if (ch == ']')
+		{
+			depth--;
+		}
+		else if (ch == '>' && depth <= 0)
+		{
+			return p + 1;
+		}
+	}
+	return nullptr;
+}
+
+bool NzbFile::ParseText(char* p, char* end)
+{
+	// element text is trimmed piecewise: each run of characters between
+	// entity references separately, the same way it was done by SAX parser
+	char* start = p;
+	char* out = p;
+	while (p < end)
+	{
+		char* amp = (char*)memchr(p, '&', end - p);
+		char* runEnd = amp ? amp : end;
+		out = AppendTrimmed(out, p, runEnd);
+
+		if (!amp)
+		{
+			break;
+		}
+
+		char value[4];
+		int valueLen = 0;
+		p = DecodeEntity(amp, end, value, &valueLen);
+		if (!p)
+		{
+			return false;
+		}
+		out = AppendTrimmed(out, value, value + valueLen);
+	}
+
+	if (out > start)
+	{
+		AppendContent(start, (int)(out - start));
+	}
+
+	return true;
+}
+
+char* NzbFile::AppendTrimmed(char* out, const char* start, const char* end)
+{
+	while (start < end && IsSpace(*start)) start++;
+	while (end > start && IsSpace(*(end - 1))) end--;
+
+	int len = (int)(end - start);
+	if (len > 0 && out != start)
+	{
+		memmove(out, start, len);
+	}
+	return out + len;
+}
+
+void NzbFile::AppendContent(const char* buf, int len)
+{
+	if (m_tagContent.empty())
+	{
+		m_tagContent = std::string_view(buf, len);
+		return;
+	}
+
+	// content in several parts (e.g. separated by a comment), it has to be copied
+	if (m_tagContent.data() != m_contentBuf.data())
+	{
+		m_contentBuf.assign(m_tagContent);
+	}
+	m_contentBuf.append(buf, len);
+	m_tagContent = m_contentBuf;
+}
+
+char* NzbFile::DecodeEntities(char* p, char* end, bool attribute)
+{
+	char* out = p;
+	while (p < end)
+	{
+		char ch = *p;
+		if (ch == '&')
+		{
+			char value[4];
+			int valueLen = 0;
+			p = DecodeEntity(p, end, value, &valueLen);
+			if (!p)
+			{
+				return nullptr;
+			}
+			memcpy(out, value, valueLen);
+			out += valueLen;
+		}
+		else
+		{
+			// attribute value normalization
+			*out++ = attribute && (ch == '\t' || ch == '\n' || ch == '\r') ? ' ' : ch;
+			p++;
+		}
+	}
+	return out;
+}
+
+char* NzbFile::DecodeEntity(char* p, char* end, char* value, int* valueLen)
+{
+	char* semicolon = (char*)memchr(p, ';', std::min<ptrdiff_t>(end - p, 12));
+	if (!semicolon || semicolon == p + 1)
+	{
+		ParseError("EntityRef: expecting ';'");
+		return nullptr;
+	}
+
+	const char* name = p + 1;
+	int nameLen = (int)(semicolon - name);
+	*valueLen = 1;
+
+	if (*name == '#')
+	{
+		bool hex = name[1] == 'x';
+		char* numEnd = nullptr;
+		uint32 code = strtoul(name + (hex ? 2 : 1), &numEnd, hex ? 16 : 10);
+		if (numEnd != semicolon || code == 0 || code > 0x10FFFF)
+		{
+			ParseError("CharRef: invalid character value");
+			return nullptr;
+		}
+
+		// encode as UTF-8, the result is always shorter than the reference
+		if (code < 0x80)
+		{
+			value[0] = (char)code;
+		}
+		else if (code < 0x800)
+		{
+			value[0] = (char)(0xC0 | (code >> 6));
+			value[1] = (char)(0x80 | (code & 0x3F));
+			*valueLen = 2;
+		}
+		else if (code < 0x10000)
+		{
+			value[0] = (char)(0xE0 | (code >> 12));
+			value[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+			value[2] = (char)(0x80 | (code & 0x3F));
+			*valueLen = 3;
+		}
+		else
+		{
+			value[0] = (char)(0xF0 | (code >> 18));
+			value[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+			value[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+			value[3] = (char)(0x80 | (code & 0x3F));
+			*valueLen = 4;
+		}
+	}
+	else if (nameLen == 2 && !strncmp(name, "lt", 2))
+	{
+		value[0] = '<';
+	}
+	else if (nameLen == 2 && !strncmp(name, "gt", 2))
+	{
+		value[0] = '>';
+	}
+	else if (nameLen == 3 && !strncmp(name, "amp", 3))
+	{
+		value[0] = '&';
+	}
+	else if (nameLen == 4 && !strncmp(name, "quot", 4))
+	{
+		value[0] = '"';
+	}
+	else if (nameLen == 4 && !strncmp(name, "apos", 4))
+	{
+		value[0] = '\'';
+	}
+	else
+	{
+		m_nzbInfo->AddMessage(Message::mkWarning, "entity not found");
+		*valueLen = 0;
+	}
+
+	return semicolon + 1;
+}
+
+/*
+ * Documents in other encodings than UTF-8 are converted to UTF-8 before parsing.
+ * ISO-8859-1 maps directly to the first 256 code points and is converted in place,
+ * all other encodings are converted by libxml.
+ */
+bool NzbFile::ConvertEncoding(CharBuffer& buffer, int& len)
+{
+	const uchar* data = (const uchar*)(const char*)buffer;
+	if (len >= 2 && data[0] == 0xFF && data[1] == 0xFE)
+	{
+		return ConvertToUtf8(buffer, len, 2, "UTF-16LE");
+	}
+	if (len >= 2 && data[0] == 0xFE && data[1] == 0xFF)
+	{
+		return ConvertToUtf8(buffer, len, 2, "UTF-16BE");
+	}
+
+	if (strncmp(buffer, "<?xml", 5))
+	{
+		return true;
+	}
+
+	const char* declEnd = strstr(buffer, "?>");
+	const char* encoding = declEnd ? strstr(buffer, "encoding") : nullptr;
+	if (!encoding || encoding > declEnd)
+	{
+		return true;
+	}
+
+	encoding += 8;
+	while (IsSpace(*encoding) || *encoding == '=') encoding++;
+	const char* encodingEnd = (*encoding == '"' || *encoding == '\'') ?
+		(const char*)memchr(encoding + 1, *encoding, declEnd - encoding - 1) : nullptr;
+	if (!encodingEnd)
+	{
+		return true;
+	}
+
+	std::string name(encoding + 1, encodingEnd);
+	if (!strcasecmp(name.c_str(), "utf-8") || !strcasecmp(name.c_str(), "us-ascii") ||
+		!strcasecmp(name.c_str(), "ascii"))
+	{
+		return true;
+	}
+
+	if (strcasecmp(name.c_str(), "iso-8859-1") && strcasecmp(name.c_str(), "latin1"))
+	{
+		return ConvertToUtf8(buffer, len, 0, name.c_str());
+	}
+
+	int convertedLen = len + (int)std::count_if(data, data + len, [](uchar ch) { return ch >= 0x80; });
+	if (convertedLen == len)
+	{
+		return true;
+	}
+
+	// convert in place, from the end of the buffer
+	buffer.Reserve(convertedLen + 1);
+	char* in = buffer + len;
+	char* out = buffer + convertedLen;
+	*out = '\0';
+	while (in > (char*)buffer)
+	{
+		uchar ch = (uchar)*--in;
+		if (ch < 0x80)
+		{
+			*--out = (char)ch;
+		}
+		else
+		{
+			*--out = (char)(0x80 | (ch & 0x3F));
+			*--out = (char)(0xC0 | (ch >> 6));
+		}
+	}
+	len = convertedLen;
+
+	return true;
+}
+
+/*
+ * Converts the buffer, starting at "offset", with the libxml encoding handler,
+ * which uses iconv or the built-in tables of libxml.
+ */
+bool NzbFile::ConvertToUtf8(CharBuffer& buffer, int& len, int offset, const char* encoding)
+{
+	xmlCharEncodingHandlerPtr handler = xmlFindCharEncodingHandler(encoding);
+	if (!handler)
+	{
+		ParseError(BString<1024>("Unsupported encoding %s", encoding));
+		return false;
+	}
+
+	xmlBufferPtr in = xmlBufferCreateSize(len - offset + 1);
+	xmlBufferPtr out = xmlBufferCreateSize((len - offset) * 2 + 1);
+	xmlBufferAdd(in, (const xmlChar*)(buffer + offset), len - offset);
+
+	int ret = 0;
+	while (ret >= 0 && xmlBufferLength(in) > 0)
+	{
+		int inLen = xmlBufferLength(in);
+		ret = xmlCharEncInFunc(handler, out, in);
+		if (xmlBufferLength(in) == inLen)
+		{
+			// invalid or incomplete character
+			ret = -2;
+		}
+	}
+	xmlCharEncCloseFunc(handler);
+
+	bool ok = ret >= 0;
+	if (ok)
+	{
+		len = xmlBufferLength(out);
+		buffer.Reserve(len + 1);
+		memcpy(buffer, xmlBufferContent(out), len);
+		*(buffer + len) = '\0';
+	}
+	else
+	{
+		ParseError(BString<1024>("Invalid character for encoding %s", encoding));
+	}
+
+	xmlBufferFree(in);
+	xmlBufferFree(out);
+
+	return ok;
+}
+
+void NzbFile::ParseError(const char* msg)
+{
+	m_nzbInfo->AddMessage(Message::mkError, BString<1024>("Error parsing nzb-file: %s", msg));
+}
+
 void NzbFile::Parse_StartElement(const char *name, const char **atts)
 {
-	BString<1024> tagAttrMessage("Malformed nzb-file, tag <%s> must have attributes", name);
+	auto tagAttrMessage = [name]()
+	{
+		return BString<1024>("Malformed nzb-file, tag <%s> must have attributes", name);
+	};
 
-	m_tagContent.Clear();
+	m_tagContent = {};
 
 	if (!strcmp("file", name))
 	{
@@ -352,7 +922,7 @@ void NzbFile::Parse_StartElement(const char *name, const char **atts)
 
 		if (!atts)
 		{
-			m_nzbInfo->AddMessage(Message::mkWarning, tagAttrMessage);
+			m_nzbInfo->AddMessage(Message::mkWarning, tagAttrMessage());
 			return;
 		}
 
@@ -380,7 +950,7 @@ void NzbFile::Parse_StartElement(const char *name, const char **atts)
 
 		if (!atts)
 		{
-			m_nzbInfo->AddMessage(Message::mkWarning, tagAttrMessage);
+			m_nzbInfo->AddMessage(Message::mkWarning, tagAttrMessage());
 			return;
 		}
 
@@ -404,18 +974,15 @@ void NzbFile::Parse_StartElement(const char *name, const char **atts)
 		if (partNumber > 0)
 		{
 			// new segment, add it!
-			std::unique_ptr<ArticleInfo> article = std::make_unique<ArticleInfo>();
-			article->SetPartNumber(partNumber);
-			article->SetSize(lsize);
-			m_article = article.get();
-			AddArticle(m_fileInfo.get(), std::move(article));
+			m_article = AddArticle(m_fileInfo.get(), partNumber);
+			m_article->SetSize(lsize);
 		}
 	}
 	else if (!strcmp("meta", name))
 	{
 		if (!atts)
 		{
-			m_nzbInfo->AddMessage(Message::mkWarning, tagAttrMessage);
+			m_nzbInfo->AddMessage(Message::mkWarning, tagAttrMessage());
 			return;
 		}
 		m_hasPassword = atts[0] && atts[1] && !strcmp("type", atts[0]) && !strcmp("password", atts[1]);
@@ -433,14 +1000,20 @@ void NzbFile::Parse_EndElement(const char *name)
 	}
 	else if (!strcmp("group", name))
 	{
-		if (!m_fileInfo)
+		if (!m_fileInfo || m_tagContent.empty())
 		{
 			// error: bad nzb-file
 			return;
 		}
 
-		m_fileInfo->GetGroups()->push_back(*m_tagContent);
-		m_tagContent.Clear();
+		// all files of nzb usually share the same few groups
+		auto it = m_groups.find(m_tagContent);
+		if (it == m_groups.end())
+		{
+			it = m_groups.emplace(m_tagContent, std::make_shared<const std::string>(m_tagContent)).first;
+		}
+		m_fileInfo->GetGroups()->push_back(it->second);
+		m_tagContent = {};
 	}
 	else if (!strcmp("segment", name))
 	{
@@ -451,8 +1024,8 @@ void NzbFile::Parse_EndElement(const char *name)
 		}
 
 		// Get the #text part
-		BString<1024> id("<%s>", *m_tagContent);
-		m_article->SetMessageId(id);
+		m_messageId.assign("<").append(m_tagContent).append(">");
+		m_article->SetMessageId(m_fileInfo->GetMessageIds(), m_messageId.c_str(), (int)m_messageId.length());
 		m_article = nullptr;
 	}
 	else if (!strcmp("meta", name) && m_hasPassword)
@@ -464,94 +1037,3 @@ void NzbFile::Parse_EndElement(const char *name)
 		m_category = m_tagContent;
 	}
 }
-
-void NzbFile::Parse_Content(const char *buf, int len)
-{
-	m_tagContent.Append(buf, len);
-}
-
-void NzbFile::SAX_StartElement(NzbFile* file, const char *name, const char **atts)
-{
-	file->Parse_StartElement(name, atts);
-}
-
-void NzbFile::SAX_EndElement(NzbFile* file, const char *name)
-{
-	file->Parse_EndElement(name);
-}
-
-void NzbFile::SAX_characters(NzbFile* file, const char * xmlstr, int len)
-{
-	char* str = (char*)xmlstr;
-
-	// trim starting blanks
-	int off = 0;
-	for (int i = 0; i < len; i++)
-	{
-		char ch = str[i];
-		if (ch == ' ' || ch == 10 || ch == 13 || ch == 9)
-		{
-			off++;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	int newlen = len - off;
-
-	// trim ending blanks
-	for (int i = len - 1; i >= off; i--)
-	{
-		char ch = str[i];
-		if (ch == ' ' || ch == 10 || ch == 13 || ch == 9)
-		{
-			newlen--;
-		}
-		else
-		{
-			break;
-		}
-	}
-
-	if (newlen > 0)
-	{
-		// interpret tag content
-		file->Parse_Content(str + off, newlen);
-	}
-}
-
-void* NzbFile::SAX_getEntity(NzbFile* file, const char * name)
-{
-	xmlEntityPtr e = xmlGetPredefinedEntity((xmlChar* )name);
-
-	if (!e)
-	{
-		file->m_nzbInfo->AddMessage(Message::mkWarning, "entity not found");
-		file->m_ignoreNextError = true;
-	}
-
-	return e;
-}
-
-void NzbFile::SAX_error(NzbFile* file, const char *msg, ...)
-{
-	if (file->m_ignoreNextError)
-	{
-		file->m_ignoreNextError = false;
-		return;
-	}
-
-	va_list argp;
-	va_start(argp, msg);
-	char errMsg[1024];
-	vsnprintf(errMsg, sizeof(errMsg), msg, argp);
-	errMsg[1024-1] = '\0';
-	va_end(argp);
-
-	// remove trailing CRLF
-	for (char* pend = errMsg + strlen(errMsg) - 1; pend >= errMsg && (*pend == '\n' || *pend == '\r' || *pend == ' '); pend--) *pend = '\0';
-
-	file->m_nzbInfo->AddMessage(Message::mkError, BString<1024>("Error parsing nzb-file: %s", errMsg));
-}
@@ -44,7 +44,7 @@ private:
 	std::string m_category;
 	std::string m_password;
 
-	void AddArticle(FileInfo* fileInfo, std::unique_ptr<ArticleInfo> articleInfo);
+	ArticleInfo* AddArticle(FileInfo* fileInfo, int partNumber);
 	void AddFileInfo(std::unique_ptr<FileInfo> fileInfo);
 	void ParseSubject(FileInfo* fileInfo, bool TryQuotes);
 	void BuildFilenames();
@@ -55,19 +55,30 @@ private:
 
 	std::unique_ptr<FileInfo> m_fileInfo;
 	ArticleInfo* m_article = nullptr;
-	StringBuilder m_tagContent;
-	bool m_ignoreNextError;
+	std::string_view m_tagContent;
+	std::string m_contentBuf;
+	std::string m_messageId;
+	std::vector<const char*> m_attributes;
+	std::vector<const char*> m_openTags;
+	std::map<std::string, std::shared_ptr<const std::string>, std::less<>> m_groups;
 	bool m_hasPassword = false;
 	bool m_hasCategory = false;
 
-	static void SAX_StartElement(NzbFile* file, const char *name, const char **atts);
-	static void SAX_EndElement(NzbFile* file, const char *name);
-	static void SAX_characters(NzbFile* file, const char *  xmlstr, int len);
-	static void* SAX_getEntity(NzbFile* file, const char *  name);
-	static void SAX_error(NzbFile* file, const char *msg, ...);
+	bool ConvertEncoding(CharBuffer& buffer, int& len);
+	bool ConvertToUtf8(CharBuffer& buffer, int& len, int offset, const char* encoding);
+	bool ParseBuffer(char* buf, int len);
+	char* ParseStartTag(char* p, char* end);
+	char* ParseEndTag(char* p, char* end);
+	char* SkipDeclaration(char* p, char* end);
+	bool ParseText(char* p, char* end);
+	char* DecodeEntities(char* p, char* end, bool attribute);
+	char* DecodeEntity(char* p, char* end, char* value, int* valueLen);
+	void AppendContent(const char* buf, int len);
+	void ParseError(const char* msg);
 	void Parse_StartElement(const char *name, const char **atts);
 	void Parse_EndElement(const char *name);
-	void Parse_Content(const char *buf, int len);
+
+	static char* AppendTrimmed(char* out, const char* start, const char* end);
 };
 
 #endif
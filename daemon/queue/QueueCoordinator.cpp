@@ -88,6 +88,14 @@ void QueueCoordinator::CoordinatorDownloadQueue::SaveChanged()
 	}
 }
 
+void QueueCoordinator::CoordinatorDownloadQueue::SaveGeneration(int generation)
+{
+	if (g_Options->GetServerMode())
+	{
+		g_DiskState->SaveGeneration(generation);
+	}
+}
+
 QueueCoordinator::QueueCoordinator()
 {
 	debug("Creating QueueCoordinator");
@@ -133,6 +141,13 @@ void QueueCoordinator::Load()
 		}
 	}
 
+	int lastGeneration = 0;
+	if (g_Options->GetServerMode())
+	{
+		g_DiskState->LoadGeneration(&lastGeneration);
+	}
+	downloadQueue->StartGenerations(lastGeneration);
+
 	if (queueLoaded && statLoaded)
 	{
 		g_DiskState->CleanupTempDir(downloadQueue);
@@ -146,6 +161,10 @@ void QueueCoordinator::Load()
 		g_StatMeter->Save();
 
 		// re-save queue into diskstate to update server ids
+		for (HistoryInfo* historyInfo : downloadQueue->GetHistory())
+		{
+			historyInfo->SetChanged(true);
+		}
 		downloadQueue->HistoryChanged();
 		downloadQueue->Save();
 
@@ -205,6 +224,7 @@ void QueueCoordinator::Run()
 		{
 			GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
 
+			AdjustDownloadsLimit();
 			bool hasMoreArticles = GetNextArticle(downloadQueue, fileInfo, articleInfo);
 			articeDownloadsRunning = !m_activeDownloads.empty();
 			m_hasMoreJobs = hasMoreArticles || articeDownloadsRunning;
@@ -229,7 +249,7 @@ void QueueCoordinator::Run()
 					downloadsChecked = true;
 					articeDownloadsRunning = true;
 					downloadStarted = true;
-					StartArticleDownload(fileInfo, articleInfo, connection);
+					StartArticleDownload(downloadQueue, fileInfo, articleInfo, connection);
 				}
 			}
 		}
@@ -282,13 +302,13 @@ void QueueCoordinator::Run()
 			}
 			g_StatMeter->IntervalCheck();
 			g_Log->IntervalCheck();
-			AdjustDownloadsLimit();
 			Util::SetStandByMode(standBy);
 			lastReset = Util::CurrentTime();
 		}
 	}
 
 	WaitJobs();
+	m_downloadPool.Shutdown();
 	SaveAllPartialState();
 	SaveQueueIfChanged();
 	SaveAllFileState();
@@ -331,10 +351,14 @@ void QueueCoordinator::WaitJobs()
 **/
 void QueueCoordinator::AdjustDownloadsLimit()
 {
-	if (m_serverConfigGeneration == g_ServerPool->GetGeneration())
+	int generation = g_ServerPool->GetGeneration();
+	int pipeliningGeneration = g_ServerPool->GetPipeliningGeneration();
+	if (m_serverConfigGeneration == generation && m_pipeliningGeneration == pipeliningGeneration)
 	{
 		return;
 	}
+	m_serverConfigGeneration = generation;
+	m_pipeliningGeneration = pipeliningGeneration;
 
 	// two extra threads for completing files (when connections are not needed)
 	int downloadsLimit = 2;
@@ -344,7 +368,8 @@ void QueueCoordinator::AdjustDownloadsLimit()
 	{
 		if ((newsServer->GetNormLevel() == 0 || newsServer->GetNormLevel() == 1) && newsServer->GetActive())
 		{
-			downloadsLimit += newsServer->GetMaxConnections();
+			// pipelined connections have several downloads running at once
+			downloadsLimit += newsServer->GetMaxConnections() * newsServer->GetPipeliningDepth();
 		}
 	}
 
@@ -352,13 +377,24 @@ void QueueCoordinator::AdjustDownloadsLimit()
 }
 
 NzbInfo* QueueCoordinator::AddNzbFileToQueue(std::unique_ptr<NzbInfo> nzbInfo, NzbInfo* urlInfo, bool addFirst)
+{
+	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+	NzbInfo* addedNzb = AddNzbFileToQueue(downloadQueue, std::move(nzbInfo), urlInfo, addFirst);
+	downloadQueue->Save();
+	return addedNzb;
+}
+
+/*
+ * Adds nzb to the already locked queue without saving it. Allows to add
+ * many nzbs with one lock and one save of the queue.
+ */
+NzbInfo* QueueCoordinator::AddNzbFileToQueue(DownloadQueue* downloadQueue, std::unique_ptr<NzbInfo> nzbInfo,
+	NzbInfo* urlInfo, bool addFirst)
 {
 	debug("Adding NZBFile to queue");
 
 	NzbInfo* addedNzb = nzbInfo.get();
 
-	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
-
 	DownloadQueue::Aspect foundAspect = { DownloadQueue::eaNzbFound, downloadQueue, nzbInfo.get(), nullptr };
 	downloadQueue->Notify(&foundAspect);
 
@@ -428,8 +464,6 @@ NzbInfo* QueueCoordinator::AddNzbFileToQueue(std::unique_ptr<NzbInfo> nzbInfo, N
 		}
 	}
 
-	downloadQueue->Save();
-
 	return addedNzb;
 }
 
@@ -614,7 +648,7 @@ bool QueueCoordinator::GetNextFirstArticle(NzbInfo* nzbInfo, FileInfo* &fileInfo
 			}
 			if (!fileInfo1->GetArticles()->empty())
 			{
-				ArticleInfo* article = fileInfo1->GetArticles()->at(0).get();
+				ArticleInfo* article = &fileInfo1->GetArticles()->at(0);
 				if (article->GetStatus() == ArticleInfo::aiUndefined)
 				{
 					fileInfo = fileInfo1;
@@ -632,7 +666,54 @@ bool QueueCoordinator::GetNextFirstArticle(NzbInfo* nzbInfo, FileInfo* &fileInfo
 	return false;
 }
 
-void QueueCoordinator::StartArticleDownload(FileInfo* fileInfo, ArticleInfo* articleInfo, NntpConnection* connection)
+/*
+ * Starts download of the article using given connection. If the server supports
+ * pipelining more articles are assigned to the same connection; their downloaders
+ * wait for their turn to read the responses.
+ */
+void QueueCoordinator::StartArticleDownload(DownloadQueue* downloadQueue, FileInfo* fileInfo,
+	ArticleInfo* articleInfo, NntpConnection* connection)
+{
+	std::vector<ArticleDownloader*> downloaders;
+	downloaders.push_back(CreateArticleDownloader(fileInfo, articleInfo, connection));
+
+	int depth = g_Options->GetRawArticle() ? 1 : connection->GetNewsServer()->GetPipeliningDepth();
+	int desiredServerId = fileInfo->GetNzbInfo()->GetDesiredServerId();
+
+	while ((int)downloaders.size() < depth &&
+		Util::SafeIntCast<size_t, int>(m_activeDownloads.size()) < m_downloadsLimit &&
+		GetNextArticle(downloadQueue, fileInfo, articleInfo) &&
+		(!g_WorkState->GetTempPauseDownload() || fileInfo->GetExtraPriority()) &&
+		fileInfo->GetNzbInfo()->GetDesiredServerId() == desiredServerId)
+	{
+		downloaders.push_back(CreateArticleDownloader(fileInfo, articleInfo, nullptr));
+	}
+
+	if (downloaders.size() > 1)
+	{
+		std::shared_ptr<ArticlePipeline> pipeline = std::make_shared<ArticlePipeline>();
+		for (ArticleDownloader* articleDownloader : downloaders)
+		{
+			pipeline->Add(articleDownloader);
+			articleDownloader->SetPipeline(pipeline);
+		}
+	}
+
+	for (ArticleDownloader* articleDownloader : downloaders)
+	{
+		if (g_Options->GetDownloadThreadPool())
+		{
+			articleDownloader->StartPooled(&m_downloadPool);
+		}
+		else
+		{
+			articleDownloader->Start();
+		}
+	}
+}
+
+ArticleDownloader* QueueCoordinator::CreateArticleDownloader(FileInfo* fileInfo, ArticleInfo* articleInfo,
+	NntpConnection* connection)
 {
 	debug("Starting new ArticleDownloader");
 
@@ -643,6 +724,11 @@ void QueueCoordinator::StartArticleDownload(FileInfo* fileInfo, ArticleInfo* art
 	articleDownloader->SetArticleInfo(articleInfo);
 	articleDownloader->SetConnection(connection);
 
+	if (fileInfo->GetBlockVerifier())
+	{
+		articleDownloader->SetBlockSize(fileInfo->GetBlockVerifier()->GetBlockSize());
+	}
+
 	if (articleInfo->GetPartNumber() == 1 && g_Options->GetDirectRename() && !g_Options->GetRawArticle())
 	{
 		articleDownloader->SetContentAnalyzer(m_directRenamer.MakeArticleContentAnalyzer());
@@ -656,7 +742,8 @@ void QueueCoordinator::StartArticleDownload(FileInfo* fileInfo, ArticleInfo* art
 	fileInfo->GetNzbInfo()->SetActiveDownloads(fileInfo->GetNzbInfo()->GetActiveDownloads() + 1);
 
 	m_activeDownloads.push_back(articleDownloader);
-	articleDownloader->Start();
+
+	return articleDownloader;
 }
 
 void QueueCoordinator::Update(Subject* caller, void* aspect)
@@ -702,6 +789,15 @@ void QueueCoordinator::ArticleCompleted(ArticleDownloader* articleDownloader)
 			nzbInfo->SetParCurrentSuccessSize(nzbInfo->GetParCurrentSuccessSize() + (fileInfo->GetParFile() ? articleInfo->GetSize() : 0));
 			fileInfo->SetSuccessArticles(fileInfo->GetSuccessArticles() + 1);
 			nzbInfo->SetCurrentSuccessArticles(nzbInfo->GetCurrentSuccessArticles() + 1);
+
+			BlockVerifier* blockVerifier = fileInfo->GetBlockVerifier();
+			if (blockVerifier)
+			{
+				static const std::vector<uint32> noCrcs;
+				blockVerifier->AddArticle(articleInfo->GetSegmentOffset(), articleInfo->GetSegmentSize(),
+					articleInfo->GetCrc(), articleDownloader->GetBlockSize() == blockVerifier->GetBlockSize() ?
+						articleDownloader->GetBlockCrcs() : noCrcs);
+			}
 		}
 		else if (articleDownloader->GetStatus() == ArticleDownloader::adFailed)
 		{
@@ -869,7 +965,7 @@ void QueueCoordinator::DeleteFileInfo(DownloadQueue* downloadQueue, FileInfo* fi
 			? FileSystem::BaseFileName(outputFilename.c_str())
 			: (fileInfo->GetFilename() ? fileInfo->GetFilename() : "");
 
-		fileInfo->GetNzbInfo()->GetCompletedFiles()->emplace_back(
+		CompletedFile& completedFile = fileInfo->GetNzbInfo()->GetCompletedFiles()->emplace_back(
 			fileInfo->GetId(),
 			std::move(filename),
 			fileInfo->GetOrigname() ? fileInfo->GetOrigname() : "", 
@@ -879,6 +975,16 @@ void QueueCoordinator::DeleteFileInfo(DownloadQueue* downloadQueue, FileInfo* fi
 			fileInfo->GetHash16k() ? fileInfo->GetHash16k() : "", 
 			fileInfo->GetParSetId() ? fileInfo->GetParSetId() : ""
 		);
+
+		BlockVerifier* blockVerifier = fileInfo->GetBlockVerifier();
+		if (completed && blockVerifier && blockVerifier->Finish())
+		{
+			completedFile.SetBlockStatus(blockVerifier->GetBlockSize(), blockVerifier->GetBlockStatus());
+			nzbInfo->PrintMessage(blockVerifier->GetDamagedBlocks() > 0 ? Message::mkInfo : Message::mkDetail,
+				"Verified %s during download: %i good, %i damaged, %i unknown par-blocks", completedFile.GetFilename(),
+				blockVerifier->GetValidBlocks(), blockVerifier->GetDamagedBlocks(),
+				blockVerifier->GetBlockCount() - blockVerifier->GetValidBlocks() - blockVerifier->GetDamagedBlocks());
+		}
 	}
 
 	if (g_Options->GetDirectRename())
@@ -909,9 +1015,9 @@ void QueueCoordinator::DiscardTempFiles(FileInfo* fileInfo)
 	{
 		for (ArticleInfo* pa : fileInfo->GetArticles())
 		{
-			if (pa->GetResultFilename())
+			if (pa->GetHasResultFile())
 			{
-				FileSystem::DeleteFile(pa->GetResultFilename());
+				FileSystem::DeleteFile(fileInfo->GetResultFilename(pa).c_str());
 			}
 		}
 	}
@@ -919,6 +1025,8 @@ void QueueCoordinator::DiscardTempFiles(FileInfo* fileInfo)
 	const std::string& outputFilename = fileInfo->GetOutputFilename();
 	if (g_Options->GetDirectWrite() && !outputFilename.empty() && !fileInfo->GetForceDirectWrite())
 	{
+		// kept open by asynchronous writes
+		fileInfo->GetAsyncFile()->Close();
 		FileSystem::DeleteFile(outputFilename.c_str());
 		if (fileInfo->IsHardLinked())
 		{
@@ -1057,6 +1165,7 @@ void QueueCoordinator::LogDebugInfo()
 
 	info("   ---------- QueueCoordinator");
 	info("    Active Downloads: %i, Limit: %i", (int)m_activeDownloads.size(), m_downloadsLimit);
+	info("    Download Workers: %i, Idle: %i", m_downloadPool.GetWorkerCount(), m_downloadPool.GetIdleCount());
 	for (ArticleDownloader* articleDownloader : m_activeDownloads)
 	{
 		articleDownloader->LogDebugInfo();
@@ -1439,7 +1548,7 @@ void QueueCoordinator::DiscardDirectRename(DownloadQueue* downloadQueue, NzbInfo
 			debug("Discarding article infos for %s/%s", nzbInfo->GetName(), fileInfo->GetFilename());
 			fileInfo->SetPartialChanged(true);
 			SavePartialState(fileInfo);
-			fileInfo->GetArticles()->clear();
+			fileInfo->DiscardArticles();
 		}
 	}
 
@@ -1488,7 +1597,7 @@ void QueueCoordinator::DiscardDownloadedArticles(NzbInfo* nzbInfo, FileInfo* fil
 	if (g_Options->GetServerMode())
 	{
 		// free up memory used by articles if possible
-		fileInfo->GetArticles()->clear();
+		fileInfo->DiscardArticles();
 	}
 	else
 	{
@@ -1496,8 +1605,8 @@ void QueueCoordinator::DiscardDownloadedArticles(NzbInfo* nzbInfo, FileInfo* fil
 		for (ArticleInfo* articleInfo : fileInfo->GetArticles())
 		{
 			articleInfo->SetStatus(ArticleInfo::aiUndefined);
-			articleInfo->SetResultFilename(nullptr);
-			articleInfo->DiscardSegment();
+			articleInfo->SetHasResultFile(false);
+			fileInfo->DiscardSegment(articleInfo);
 		}
 	}
 }
@@ -47,6 +47,8 @@ public:
 
 	// editing queue
 	NzbInfo* AddNzbFileToQueue(std::unique_ptr<NzbInfo> nzbInfo, NzbInfo* urlInfo, bool addFirst);
+	NzbInfo* AddNzbFileToQueue(DownloadQueue* downloadQueue, std::unique_ptr<NzbInfo> nzbInfo,
+		NzbInfo* urlInfo, bool addFirst);
 	void CheckDupeFileInfos(NzbInfo* nzbInfo);
 	bool HasMoreJobs() const { return m_hasMoreJobs; }
 	void DiscardTempFiles(FileInfo* fileInfo);
@@ -70,6 +72,8 @@ private:
 		void HistoryChanged() override { m_historyChanged = true; }
 		void Save() override;
 		void SaveChanged() override;
+	protected:
+		void SaveGeneration(int generation) override;
 	private:
 		QueueCoordinator* m_owner;
 		bool m_massEdit = false;
@@ -92,17 +96,21 @@ private:
 
 	CoordinatorDownloadQueue m_downloadQueue{this};
 	ActiveDownloads m_activeDownloads;
+	ThreadPool m_downloadPool;
 	QueueEditor m_queueEditor;
 	CoordinatorDirectRenamer m_directRenamer{this};
 	std::atomic<bool> m_hasMoreJobs{true};
 	int m_downloadsLimit;
-	int m_serverConfigGeneration = 0;
+	int m_serverConfigGeneration = -1;
+	int m_pipeliningGeneration = -1;
 	std::mutex m_waitMutex;
 	std::condition_variable m_waitCond;
 
 	bool GetNextArticle(DownloadQueue* downloadQueue, FileInfo* &fileInfo, ArticleInfo* &articleInfo);
 	bool GetNextFirstArticle(NzbInfo* nzbInfo, FileInfo* &fileInfo, ArticleInfo* &articleInfo);
-	void StartArticleDownload(FileInfo* fileInfo, ArticleInfo* articleInfo, NntpConnection* connection);
+	void StartArticleDownload(DownloadQueue* downloadQueue, FileInfo* fileInfo, ArticleInfo* articleInfo,
+		NntpConnection* connection);
+	ArticleDownloader* CreateArticleDownloader(FileInfo* fileInfo, ArticleInfo* articleInfo, NntpConnection* connection);
 	void ArticleCompleted(ArticleDownloader* articleDownloader);
 	void DeleteDownloader(DownloadQueue* downloadQueue, ArticleDownloader* articleDownloader, bool fileCompleted);
 	void DeleteFileInfo(DownloadQueue* downloadQueue, FileInfo* fileInfo, bool completed);
@@ -106,7 +106,11 @@ int Scanner::ServiceInterval()
 	return m_requestedNzbDirScan ? Service::Now :
 		g_Options->GetNzbDirInterval() <= 0 ? Service::Sleep :
 		// g_Options->GetPauseScan() ? Service::Sleep :   // for that to work we need to react on changing of pause-state
-		m_nzbDirInterval;
+		!m_watcher ? m_nzbDirInterval :
+		// with active watcher the directory is scanned only for new changes or if files are waiting for NzbDirFileAge
+		m_watcher->HasChanges() && !g_WorkState->GetPauseScan() ? Service::Now :
+		m_watcher->HasChanges() || !m_fileList.empty() ? m_nzbDirInterval :
+		Service::Sleep;
 }
 
 void Scanner::ServiceWork()
@@ -129,6 +133,45 @@ void Scanner::ServiceWork()
 
 	std::lock_guard<std::mutex> guard{m_scanMutex};
 
+	bool fullScan = true;
+	if (m_watcher && !m_requestedNzbDirScan)
+	{
+		NzbDirWatcher::Changes changes = m_watcher->TakeChanges();
+		if (!changes.overflow && m_watcher->IsActive())
+		{
+			CheckWatchedChanges(changes);
+			fullScan = !m_fileList.empty() && Util::CurrentTime() - m_lastFullScan >= m_nzbDirInterval;
+		}
+		else
+		{
+			debug("Changes in incoming directory were lost, scanning the whole directory");
+		}
+	}
+
+	if (!m_watcher && !m_watchDisabled && g_Options->GetNzbDirWatch() && g_Options->GetNzbDirInterval() > 0)
+	{
+		// the watcher is started before the scan, changes made during the scan are not lost
+		StartWatcher();
+	}
+	else if (m_watcher && !m_watcher->IsActive())
+	{
+		m_watcher.reset();
+		StartWatcher();
+	}
+	else if (m_watcher && fullScan)
+	{
+		// the scan covers all changes made so far
+		m_watcher->TakeChanges();
+	}
+
+	if (!fullScan)
+	{
+		DropOldFiles();
+		return;
+	}
+
+	m_lastFullScan = Util::CurrentTime();
+
 	CheckIncomingArchives(g_Options->GetNzbDirPath());
 
 	// check nzbdir every g_Options->GetNzbDirInterval() seconds or if requested
@@ -136,10 +179,12 @@ void Scanner::ServiceWork()
 	m_requestedNzbDirScan = false;
 	m_scanning = true;
 	CheckIncomingNzbs(g_Options->GetNzbDir(), "", checkStat);
+	AddScheduledFiles();
 	if (!checkStat && m_scanScript)
 	{
 		// if immediate scan requested, we need second scan to process files extracted by scan-scripts
 		CheckIncomingNzbs(g_Options->GetNzbDir(), "", checkStat);
+		AddScheduledFiles();
 	}
 	m_scanning = false;
 
@@ -167,6 +212,90 @@ void Scanner::ServiceWork()
 	m_queueList.clear();
 }
 
+void Scanner::ServiceStop()
+{
+	std::lock_guard<std::mutex> guard{m_scanMutex};
+
+	m_watchDisabled = true;
+	if (m_watcher)
+	{
+		m_watcher->Stop();
+	}
+}
+
+void Scanner::StartWatcher()
+{
+	m_watcher = std::make_unique<NzbDirWatcher>([this]() { WakeUp(); });
+	if (!m_watcher->Start(g_Options->GetNzbDir()))
+	{
+		// the reason was already reported by the watcher, if the system supports watching
+		m_watcher.reset();
+		m_watchDisabled = true;
+		return;
+	}
+
+	debug("Watching directory %s", g_Options->GetNzbDir());
+}
+
+void Scanner::CheckWatchedChanges(const NzbDirWatcher::Changes& changes)
+{
+	for (const std::string& directory : changes.dirs)
+	{
+		if (FileSystem::DirectoryExists(directory.c_str()))
+		{
+			// files still being written in the new directory are reported by the watcher later
+			CheckIncomingArchives(directory);
+			CheckIncomingNzbs(directory.c_str(), GetWatchedCategory(directory).c_str(), true);
+		}
+	}
+
+	std::vector<fs::path> archives;
+	for (const std::string& filename : changes.files)
+	{
+		if (!FileSystem::FileExists(filename.c_str()))
+		{
+			// already processed or removed
+			continue;
+		}
+
+		fs::path path(filename);
+		if (Unpack::IsArchive(path))
+		{
+			archives.push_back(path);
+			continue;
+		}
+
+		if (!CanProcessFile(filename.c_str(), false))
+		{
+			continue;
+		}
+
+		m_fileList.erase(std::remove_if(m_fileList.begin(), m_fileList.end(),
+			[&filename](FileData& fileData) { return fileData.GetFilename() == filename; }),
+			m_fileList.end());
+
+		std::string directory = path.parent_path().string();
+		std::string baseFilename = path.filename().string();
+		ProcessIncomingFile(directory.c_str(), baseFilename.c_str(), filename.c_str(),
+			GetWatchedCategory(directory).c_str());
+	}
+
+	// extracted files are reported by the watcher
+	UnpackArchives(archives);
+
+	AddScheduledFiles();
+}
+
+/**
+ * Category of files in a subdirectory of incoming directory is the path
+ * of the subdirectory, the same as during a full scan.
+ */
+std::string Scanner::GetWatchedCategory(const std::string& directory)
+{
+	size_t len = strlen(g_Options->GetNzbDir());
+	return directory.length() > len ? directory.substr(len + 1) : "";
+}
+
 void Scanner::CheckIncomingArchives(const boost::filesystem::path& dir)
 {
 	const auto archives = FindArchives(dir);
@@ -397,7 +526,6 @@ void Scanner::ProcessIncomingFile(
 	EAddStatus addStatus = asSkipped;
 	QueueData* queueData = nullptr;
 	NzbInfo* nzbInfo = nullptr;
-	int nzbId = 0;
 
 	for (QueueData& queueData1 : m_queueList)
 	{
@@ -456,7 +584,7 @@ void Scanner::ProcessIncomingFile(
 		bool renameOK = FileSystem::RenameBak(fullFilename, "nzb", true, renamedName);
 		if (renameOK)
 		{
-			bool added = AddFileToQueue(
+			ScheduleFile(
 				renamedName,
 				nzbName.c_str(),
 				nzbCategory.c_str(),
@@ -469,9 +597,9 @@ void Scanner::ProcessIncomingFile(
 				addTop,
 				addPaused,
 				nzbInfo,
-				&nzbId
+				queueData
 			);
-			addStatus = added ? asSuccess : asFailed;
+			return;
 		}
 		else
 		{
@@ -482,7 +610,7 @@ void Scanner::ProcessIncomingFile(
 	}
 	else if (exists && !strcasecmp(extension, ".nzb"))
 	{
-		bool added = AddFileToQueue(
+		ScheduleFile(
 			fullFilename,
 			nzbName.c_str(),
 			nzbCategory.c_str(),
@@ -495,15 +623,15 @@ void Scanner::ProcessIncomingFile(
 			addTop,
 			addPaused,
 			nzbInfo,
-			&nzbId
+			queueData
 		);
-		addStatus = added ? asSuccess : asFailed;
+		return;
 	}
 
 	if (queueData)
 	{
 		queueData->SetAddStatus(addStatus);
-		queueData->SetNzbId(nzbId);
+		queueData->SetNzbId(0);
 	}
 }
 
@@ -595,7 +723,7 @@ void Scanner::DetectAndSetCategory(const NzbFile& nzbFile, NzbInfo& nzbInfo, con
 	}
 }
 
-bool Scanner::AddFileToQueue(
+void Scanner::ScheduleFile(
 	const char* filename,
 	const char* nzbName,
 	const char* category,
@@ -608,18 +736,109 @@ bool Scanner::AddFileToQueue(
 	bool addTop,
 	bool addPaused,
 	NzbInfo* urlInfo,
-	int* nzbId
+	QueueData* request
 )
 {
-	const char* basename = FileSystem::BaseFileName(filename);
+	info("Adding collection %s to queue", FileSystem::BaseFileName(filename));
+
+	m_scheduledList.push_back({
+		QueueData(filename, nzbName, category, autoCategory, priority, dupeKey, dupeScore, dupeMode,
+			parameters, addTop, addPaused, urlInfo, nullptr, nullptr),
+		request,
+		std::make_unique<NzbFile>(filename, category)});
+}
+
+void Scanner::AddScheduledFiles()
+{
+	if (m_scheduledList.empty())
+	{
+		return;
+	}
+
+	int64 startTime = Util::CurrentTicks();
+
+	// parsing doesn't touch the queue, files are parsed on several threads
+	Util::ParallelFor((int)m_scheduledList.size(), 1,
+		[this](int index)
+		{
+			ScheduledFile& file = m_scheduledList[index];
+			file.parsed = file.nzbFile->Parse();
+		});
 
-	info("Adding collection %s to queue", basename);
+	int64 parseTime = Util::CurrentTicks();
 
-	NzbFile nzbFile(filename, category);
-	bool ok = nzbFile.Parse();
+	std::vector<std::unique_ptr<NzbInfo>> nzbInfos;
+	std::vector<bool> added;
+	for (ScheduledFile& file : m_scheduledList)
+	{
+		bool ok;
+		nzbInfos.push_back(PrepareNzbInfo(file, ok));
+		added.push_back(ok);
+	}
+
+	{
+		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+
+		for (int i = 0; i < (int)m_scheduledList.size(); i++)
+		{
+			ScheduledFile& file = m_scheduledList[i];
+			std::unique_ptr<NzbInfo>& nzbInfo = nzbInfos[i];
+			NzbInfo* urlInfo = file.data.GetUrlInfo();
+			NzbInfo* addedNzb = nullptr;
+
+			if (added[i])
+			{
+				addedNzb = g_QueueCoordinator->AddNzbFileToQueue(downloadQueue, std::move(nzbInfo),
+					urlInfo, file.data.GetAddTop());
+			}
+			else if (urlInfo)
+			{
+				for (Message& message : nzbInfo->GuardCachedMessages())
+				{
+					urlInfo->AddMessage(message.GetKind(), message.GetText(), false);
+				}
+			}
+			else
+			{
+				nzbInfo->SetDeleteStatus(NzbInfo::dsScan);
+				addedNzb = g_QueueCoordinator->AddNzbFileToQueue(downloadQueue, std::move(nzbInfo),
+					urlInfo, file.data.GetAddTop());
+			}
+
+			if (file.request)
+			{
+				file.request->SetAddStatus(added[i] ? asSuccess : asFailed);
+				file.request->SetNzbId(addedNzb ? addedNzb->GetId() : 0);
+			}
+		}
+
+		downloadQueue->Save();
+	}
+
+	int64 endTime = Util::CurrentTicks();
+
+	if (m_scheduledList.size() > 1)
+	{
+		info("Added %i collections to queue in %i ms: parsing %i ms, adding %i ms",
+			(int)m_scheduledList.size(), (int)((endTime - startTime) / 1000),
+			(int)((parseTime - startTime) / 1000), (int)((endTime - parseTime) / 1000));
+	}
+
+	m_scheduledList.clear();
+}
+
+std::unique_ptr<NzbInfo> Scanner::PrepareNzbInfo(ScheduledFile& file, bool& ok)
+{
+	QueueData& data = file.data;
+	const char* filename = data.GetFilename();
+	const char* nzbName = data.GetNzbName();
+	NzbParameterList* parameters = data.GetParameters();
+	NzbInfo* urlInfo = data.GetUrlInfo();
+
+	ok = file.parsed;
 	if (!ok)
 	{
-		error("Could not add collection %s to queue", basename);
+		error("Could not add collection %s to queue", FileSystem::BaseFileName(filename));
 	}
 
 	CString bakname2;
@@ -630,26 +849,26 @@ bool Scanner::AddFileToQueue(
 			*FileSystem::GetLastErrorMessage());
 	}
 
-	std::unique_ptr<NzbInfo> nzbInfo = nzbFile.DetachNzbInfo();
+	std::unique_ptr<NzbInfo> nzbInfo = file.nzbFile->DetachNzbInfo();
 	nzbInfo->SetQueuedFilename(bakname2);
 
-	if (autoCategory)
+	if (data.GetAutoCategory())
 	{
-		DetectAndSetCategory(nzbFile, *nzbInfo, nzbName);
+		DetectAndSetCategory(*file.nzbFile, *nzbInfo, nzbName);
 		InitPPParameters(nzbInfo->GetCategory(), parameters, true);
 	}
 
-	if (nzbName && strlen(nzbName) > 0)
+	if (strlen(nzbName) > 0)
 	{
 		nzbInfo->SetName(nullptr);
 		nzbInfo->SetFilename(nzbName);
 		nzbInfo->BuildDestDirName();
 	}
 
-	nzbInfo->SetDupeKey(dupeKey);
-	nzbInfo->SetDupeScore(dupeScore);
-	nzbInfo->SetDupeMode(dupeMode);
-	nzbInfo->SetPriority(priority);
+	nzbInfo->SetDupeKey(data.GetDupeKey());
+	nzbInfo->SetDupeScore(data.GetDupeScore());
+	nzbInfo->SetDupeMode(data.GetDupeMode());
+	nzbInfo->SetPriority(data.GetPriority());
 	if (urlInfo)
 	{
 		nzbInfo->SetUrl(urlInfo->GetUrl());
@@ -661,43 +880,19 @@ bool Scanner::AddFileToQueue(
 		nzbInfo->SetSkipDiskWrite(urlInfo->GetSkipDiskWrite());
 	}
 
-	if (!nzbFile.GetPassword().empty())
+	if (!file.nzbFile->GetPassword().empty())
 	{
-		nzbInfo->GetParameters()->SetParameter("*Unpack:Password", nzbFile.GetPassword().c_str());
+		nzbInfo->GetParameters()->SetParameter("*Unpack:Password", file.nzbFile->GetPassword().c_str());
 	}
 
 	nzbInfo->GetParameters()->CopyFrom(parameters);
 
 	for (FileInfo* fileInfo : nzbInfo->GetFileList())
 	{
-		fileInfo->SetPaused(addPaused);
-	}
-
-	NzbInfo* addedNzb = nullptr;
-
-	if (ok)
-	{
-		addedNzb = g_QueueCoordinator->AddNzbFileToQueue(std::move(nzbInfo), std::move(urlInfo), addTop);
-	}
-	else if (urlInfo)
-	{
-		for (Message& message : nzbInfo->GuardCachedMessages())
-		{
-			urlInfo->AddMessage(message.GetKind(), message.GetText(), false);
-		}
-	}
-	else
-	{
-		nzbInfo->SetDeleteStatus(NzbInfo::dsScan);
-		addedNzb = g_QueueCoordinator->AddNzbFileToQueue(std::move(nzbInfo), std::move(urlInfo), addTop);
-	}
-
-	if (nzbId)
-	{
-		*nzbId = addedNzb ? addedNzb->GetId() : 0;
+		fileInfo->SetPaused(data.GetAddPaused());
 	}
 
-	return ok;
+	return nzbInfo;
 }
 
 void Scanner::ScanNzbDir(bool syncMode)
@@ -30,6 +30,7 @@
 #include "Thread.h"
 #include "Service.h"
 #include "NzbFile.h"
+#include "NzbDirWatcher.h"
 
 class Scanner final : public Service
 {
@@ -95,6 +96,7 @@ public:
 protected:
 	int ServiceInterval() override;
 	void ServiceWork() override;
+	void ServiceStop() override;
 
 private:
 	class FileData
@@ -169,12 +171,30 @@ private:
 
 	using QueueList = std::deque<QueueData>;
 
+	/**
+	 * @brief Nzb-file found during a scan, waiting to be parsed and added to queue
+	 * together with other files of the same scan.
+	 */
+	struct ScheduledFile
+	{
+		QueueData data;
+		QueueData* request;	// request from AddExternalFile or AddArchive, receives the result
+		std::unique_ptr<NzbFile> nzbFile;
+		bool parsed = false;
+	};
+
+	using ScheduledList = std::deque<ScheduledFile>;
+
 	FileList m_fileList;
 	QueueList m_queueList;
+	ScheduledList m_scheduledList;
 	std::mutex m_scanMutex;
 	std::atomic<bool> m_requestedNzbDirScan{false};
 	std::atomic<bool> m_scanning{false};
 	static int m_idGen;
+	std::unique_ptr<NzbDirWatcher> m_watcher;
+	bool m_watchDisabled = false;
+	time_t m_lastFullScan = 0;
 	int m_nzbDirInterval = 0;
 	int m_pass = 0;
 	bool m_scanScript = false;
@@ -190,21 +210,39 @@ private:
 	std::vector<boost::filesystem::path> FindArchives(const boost::filesystem::path& dir);
 	void UnpackArchives(const std::vector<boost::filesystem::path>& archives);
 	void CheckIncomingNzbs(const char* directory, const char* category, bool checkStat);
-	bool AddFileToQueue(
-		const char* filename, 
-		const char* nzbName, 
+	void StartWatcher();
+
+	/**
+	 * @brief Processes files and directories reported by the watcher.
+	 *
+	 * Reported files are complete and are added without waiting for NzbDirFileAge.
+	 * New directories are scanned like during a full scan.
+	 */
+	void CheckWatchedChanges(const NzbDirWatcher::Changes& changes);
+	std::string GetWatchedCategory(const std::string& directory);
+	void ScheduleFile(
+		const char* filename,
+		const char* nzbName,
 		const char* category,
 		bool autoCategory,
-		int priority, 
-		const char* dupeKey, 
-		int dupeScore, 
+		int priority,
+		const char* dupeKey,
+		int dupeScore,
 		EDupeMode dupeMode,
-		NzbParameterList* parameters, 
-		bool addTop, 
-		bool addPaused, 
-		NzbInfo* urlInfo, 
-		int* nzbId
+		NzbParameterList* parameters,
+		bool addTop,
+		bool addPaused,
+		NzbInfo* urlInfo,
+		QueueData* request
 	);
+
+	/**
+	 * @brief Parses scheduled nzb-files on several threads and adds them to queue
+	 *
+	 * The queue is locked and saved once for all files.
+	 */
+	void AddScheduledFiles();
+	std::unique_ptr<NzbInfo> PrepareNzbInfo(ScheduledFile& file, bool& ok);
 	void ProcessIncomingFile(
 		const char* directory, 
 		const char* baseFilename,
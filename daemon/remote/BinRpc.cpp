@@ -168,25 +168,25 @@ BinRpcProcessor::BinRpcProcessor()
 	m_messageBase.m_signature = (int)NZBMESSAGE_SIGNATURE;
 }
 
-void BinRpcProcessor::Execute()
+bool BinRpcProcessor::ReadRequest()
 {
 	// Read the first package which needs to be a request
 	if (!m_connection->Recv(((char*)&m_messageBase) + sizeof(m_messageBase.m_signature), sizeof(m_messageBase) - sizeof(m_messageBase.m_signature)))
 	{
 		warn("Non-nzbget request received on port %i from %s", g_Options->GetControlPort(), m_connection->GetRemoteAddr());
-		return;
+		return false;
 	}
 
 	if ((strlen(g_Options->GetControlUsername()) > 0 && strcmp(m_messageBase.m_username, g_Options->GetControlUsername())) ||
 		strcmp(m_messageBase.m_password, g_Options->GetControlPassword()))
 	{
 		warn("nzbget request received on port %i from %s, but username or password invalid", g_Options->GetControlPort(), m_connection->GetRemoteAddr());
-		return;
+		return false;
 	}
 
 	debug("%s request received from %s", g_MessageRequestNames[ntohl(m_messageBase.m_type)], m_connection->GetRemoteAddr());
 
-	Dispatch();
+	return true;
 }
 
 void BinRpcProcessor::Dispatch()
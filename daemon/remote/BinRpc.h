@@ -29,14 +29,14 @@ class BinRpcProcessor
 {
 public:
 	BinRpcProcessor();
-	void Execute();
+	// reads and authorizes the request header, returns false if the request is invalid
+	bool ReadRequest();
+	void Dispatch();
 	void SetConnection(Connection* connection) { m_connection = connection; }
 
 private:
 	SNzbRequestBase m_messageBase;
 	Connection* m_connection;
-
-	void Dispatch();
 };
 
 #endif
@@ -0,0 +1,80 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+#include "ChangeFeed.h"
+
+int ChangeFeed::Update(const Sample& sample)
+{
+	Guard guard(m_mutex);
+
+	int changes = 0;
+	if (m_sampled)
+	{
+		changes |= sample.queueGeneration != m_last.queueGeneration ? ecQueue : 0;
+		changes |= sample.historyGeneration != m_last.historyGeneration ? ecHistory : 0;
+		changes |= sample.logId != m_last.logId ? ecLog : 0;
+		changes |= sample.statusHash != m_last.statusHash ? ecStatus : 0;
+	}
+	else
+	{
+		// the first sample is the base line for further comparisons
+		m_sampled = true;
+	}
+
+	m_last = sample;
+
+	if (changes)
+	{
+		m_eventId++;
+		m_events.push_back(changes);
+		if ((int)m_events.size() > MAX_EVENTS)
+		{
+			m_events.pop_front();
+		}
+	}
+
+	return changes;
+}
+
+int ChangeFeed::GetEventId()
+{
+	Guard guard(m_mutex);
+	return m_eventId;
+}
+
+int ChangeFeed::GetChanges(int since, int* eventId)
+{
+	Guard guard(m_mutex);
+
+	*eventId = m_eventId;
+
+	int count = m_eventId - since;
+	if (since <= 0 || count < 0 || count > (int)m_events.size())
+	{
+		return ecAll;
+	}
+
+	int changes = 0;
+	for (std::deque<int>::reverse_iterator it = m_events.rbegin(); count > 0; it++, count--)
+	{
+		changes |= *it;
+	}
+
+	return changes;
+}
@@ -0,0 +1,69 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef CHANGEFEED_H
+#define CHANGEFEED_H
+
+#include "Thread.h"
+
+/**
+ * Numbered change events for clients waiting for updates instead of polling.
+ *
+ * The state is sampled periodically; each sample which differs from the previous
+ * one becomes an event with the next ID and a set of flags telling which parts
+ * of the state have changed. Clients remember the last seen event ID and ask which
+ * parts have changed since then, a few recent events are kept for that.
+ */
+class ChangeFeed
+{
+public:
+	enum EChange
+	{
+		ecQueue = 1,
+		ecHistory = 2,
+		ecLog = 4,
+		ecStatus = 8,
+		ecAll = ecQueue | ecHistory | ecLog | ecStatus
+	};
+
+	struct Sample
+	{
+		int queueGeneration;
+		int historyGeneration;
+		uint32 logId;
+		uint32 statusHash;
+	};
+
+	// returns flags of changes compared to the previous sample, 0 if no event was created
+	int Update(const Sample& sample);
+	int GetEventId();
+	/* Returns flags of changes after event "since" and the ID of the last event.
+	   All flags are returned if the event is unknown (too old or from another run). */
+	int GetChanges(int since, int* eventId);
+
+private:
+	static const int MAX_EVENTS = 100;
+
+	Mutex m_mutex;
+	Sample m_last;
+	bool m_sampled = false;
+	int m_eventId = 0;
+	std::deque<int> m_events;		// flags of the last events, the newest at back
+};
+
+#endif
@@ -24,15 +24,169 @@
 #include "RemoteServer.h"
 #include "BinRpc.h"
 #include "WebServer.h"
+#include "XmlRpc.h"
 #include "Log.h"
 #include "Options.h"
 #include "FileSystem.h"
 
+//*****************************************************************
+// SocketPoller
+
+/*
+ * Waits for incoming data on a set of sockets. A ready socket is reported once,
+ * it must be added again to be watched further. Sockets can be added from any
+ * thread. Uses epoll on Linux and poll on other systems.
+ */
+class SocketPoller
+{
+public:
+	SocketPoller();
+	~SocketPoller();
+	void Add(SOCKET socket, void* data);
+	void Remove(SOCKET socket);
+	void Wait(int timeoutMs, std::vector<void*>& ready);
+
+private:
+#ifdef __linux__
+	int m_epollFd;
+#else
+	std::mutex m_mutex;
+	std::map<SOCKET, void*> m_sockets;
+#endif
+};
+
+#ifdef __linux__
+
+SocketPoller::SocketPoller()
+{
+	m_epollFd = epoll_create1(EPOLL_CLOEXEC);
+}
+
+SocketPoller::~SocketPoller()
+{
+	close(m_epollFd);
+}
+
+void SocketPoller::Add(SOCKET socket, void* data)
+{
+	epoll_event event{};
+	event.events = EPOLLIN | EPOLLONESHOT;
+	event.data.ptr = data;
+	if (epoll_ctl(m_epollFd, EPOLL_CTL_ADD, socket, &event) == -1 && errno == EEXIST)
+	{
+		// one-shot sockets stay registered after being reported
+		epoll_ctl(m_epollFd, EPOLL_CTL_MOD, socket, &event);
+	}
+}
+
+void SocketPoller::Remove(SOCKET socket)
+{
+	epoll_ctl(m_epollFd, EPOLL_CTL_DEL, socket, nullptr);
+}
+
+void SocketPoller::Wait(int timeoutMs, std::vector<void*>& ready)
+{
+	epoll_event events[64];
+	int count = epoll_wait(m_epollFd, events, 64, timeoutMs);
+	for (int i = 0; i < count; i++)
+	{
+		ready.push_back(events[i].data.ptr);
+	}
+}
+
+#else
+
+SocketPoller::SocketPoller()
+{
+}
+
+SocketPoller::~SocketPoller()
+{
+}
+
+void SocketPoller::Add(SOCKET socket, void* data)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	m_sockets[socket] = data;
+}
+
+void SocketPoller::Remove(SOCKET socket)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	m_sockets.erase(socket);
+}
+
+void SocketPoller::Wait(int timeoutMs, std::vector<void*>& ready)
+{
+	std::vector<pollfd> fds;
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		for (auto& [socket, data] : m_sockets)
+		{
+			fds.push_back({socket, POLLIN, 0});
+		}
+	}
+
+	// sockets added during waiting are picked up on the next call
+	timeoutMs = std::min(timeoutMs, 100);
+	if (fds.empty())
+	{
+		Util::Sleep(timeoutMs);
+		return;
+	}
+
+#ifdef WIN32
+	int count = WSAPoll(fds.data(), (ULONG)fds.size(), timeoutMs);
+#else
+	int count = poll(fds.data(), fds.size(), timeoutMs);
+#endif
+	if (count <= 0)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> guard(m_mutex);
+	for (pollfd& fd : fds)
+	{
+		auto it = m_sockets.find(fd.fd);
+		if (fd.revents && it != m_sockets.end())
+		{
+			ready.push_back(it->second);
+			m_sockets.erase(it);
+		}
+	}
+}
+
+#endif
+
 //*****************************************************************
 // RemoteServer
 
+RemoteServer::Client::Client()
+{
+}
+
+RemoteServer::Client::~Client()
+{
+}
+
+RemoteServer::RemoteServer(bool tls) :
+	m_tls(tls),
+	m_poller(std::make_unique<SocketPoller>()),
+	m_readThreads(std::max(g_Options->GetRemoteThreads(), 1)),
+	m_readPool(std::make_unique<ThreadPool>(60, m_readThreads)),
+	m_pool(std::make_unique<ThreadPool>(60, std::max(g_Options->GetRemoteThreads(), 1)))
+{
+}
+
 RemoteServer::~RemoteServer()
 {
+	// if the server was killed while requests were still running their connections
+	// are closed, the workers must finish before the clients are destroyed
+	ForceStop();
+	m_readPool->Shutdown();
+	m_pool->Shutdown();
+
 #ifndef DISABLE_TLS
 	OpenSSL::StopSSLThread();
 #endif
@@ -59,10 +213,11 @@ void RemoteServer::Run()
 	}
 #endif
 
+	std::vector<void*> ready;
+	int waitTimeoutMs = 500;
+
 	while (!IsStopped())
 	{
-		bool bind = true;
-
 		if (!m_connection)
 		{
 			m_connection = std::make_unique<Connection>(g_Options->GetControlIp(),
@@ -70,60 +225,60 @@ void RemoteServer::Run()
 				m_tls);
 			m_connection->SetTimeout(g_Options->GetRemoteTimeout());
 			m_connection->SetSuppressErrors(false);
-			bind = m_connection->Bind();
+			if (!m_connection->Bind())
+			{
+				// Remote server could not bind, waiting 1/2 sec and try again
+				m_connection.reset();
+				Util::Sleep(500);
+				continue;
+			}
+			m_poller->Add(m_connection->GetSocket(), m_connection.get());
 		}
 
-		// Accept connections and store the new Connection
-		std::unique_ptr<Connection> acceptedConnection;
-		if (bind)
-		{
-			acceptedConnection = m_connection->Accept();
-		}
-		if (!bind || !acceptedConnection)
+		ready.clear();
+		m_poller->Wait(waitTimeoutMs, ready);
+
+		for (void* data : ready)
 		{
-			// Remote server could not bind or accept connection, waiting 1/2 sec and try again
-			if (IsStopped())
+			if (data == m_connection.get())
 			{
-				break;
+				AcceptClient();
+			}
+			else
+			{
+				StartRequest((Client*)data);
 			}
-			m_connection.reset();
-			Util::Sleep(500);
-			continue;
 		}
 
-		if (!IsStopped())
-		{
-			RequestProcessor* commandThread = new RequestProcessor();
-			commandThread->SetAutoDestroy(true);
-			commandThread->SetConnection(std::move(acceptedConnection));
-#ifndef DISABLE_TLS
-			commandThread->SetTls(m_tls);
-#endif
-			Guard guard(m_processorsMutex);
-			m_activeProcessors.push_back(commandThread);
-			commandThread->Attach(this);
-			commandThread->Start();
-		}
+		CloseIdleClients(false);
+		CancelSlowReads();
+
+		waitTimeoutMs = ResumeWaitingClients() ? std::clamp(g_Options->GetRemoteEventInterval(), 10, 500) : 500;
 	}
 
 	if (m_connection)
 	{
+		m_poller->Remove(m_connection->GetSocket());
 		m_connection->Disconnect();
 	}
 
-	// waiting for request processors
+	// waiting for running requests
 	debug("RemoteServer: waiting for request processor to complete");
 	bool completed = false;
 	while (!completed)
 	{
 		{
-			Guard guard(m_processorsMutex);
-			completed = m_activeProcessors.size() == 0;
+			Guard guard(m_clientsMutex);
+			completed = m_busyCount == 0;
 		}
 		Util::Sleep(100);
 	}
 	debug("RemoteServer: request processor are completed");
 
+	CloseIdleClients(true);
+	m_readPool->Shutdown();
+	m_pool->Shutdown();
+
 	debug("Exiting RemoteServer-loop");
 }
 
@@ -135,37 +290,276 @@ void RemoteServer::Stop()
 		m_connection->SetSuppressErrors(true);
 		m_connection->SetForceClose(true);
 		m_connection->Cancel();
+	}
 
-		debug("Stopping RequestProcessors");
-		Guard guard(m_processorsMutex);
-		for (RequestProcessor* requestProcessor : m_activeProcessors)
+	debug("Stopping RequestProcessors");
+	Guard guard(m_clientsMutex);
+	for (std::unique_ptr<Client>& client : m_clients)
+	{
+		if (client->busy)
 		{
-			requestProcessor->Stop();
+#ifdef WIN32
+			client->connection->SetForceClose(true);
+#endif
+			client->connection->Cancel();
 		}
-		debug("RequestProcessors are notified");
 	}
+	debug("RequestProcessors are notified");
 	debug("RemoteServer stop end");
 }
 
 void RemoteServer::ForceStop()
 {
-	debug("Killing RequestProcessors");
-	Guard guard(m_processorsMutex);
-	for (RequestProcessor* requestProcessor : m_activeProcessors)
+	debug("Closing connections of RequestProcessors");
+	Guard guard(m_clientsMutex);
+	for (std::unique_ptr<Client>& client : m_clients)
 	{
-		requestProcessor->Kill();
+		if (client->busy)
+		{
+			client->connection->SetForceClose(true);
+			client->connection->Cancel();
+		}
 	}
-	m_activeProcessors.clear();
-	debug("RequestProcessors are killed");
+	debug("Connections of RequestProcessors are closed");
 }
 
-void RemoteServer::Update(Subject* caller, void* aspect)
+void RemoteServer::AcceptClient()
 {
-	debug("Notification from RequestProcessor received");
+	std::unique_ptr<Connection> acceptedConnection = m_connection->Accept();
+	if (!acceptedConnection)
+	{
+		// Remote server could not accept connection, waiting 1/2 sec and bind again
+		if (!IsStopped())
+		{
+			m_poller->Remove(m_connection->GetSocket());
+			m_connection.reset();
+			Util::Sleep(500);
+		}
+		return;
+	}
+
+	m_poller->Add(m_connection->GetSocket(), m_connection.get());
+
+	// the connection is served once the client sends something
+	Guard guard(m_clientsMutex);
+	std::unique_ptr<Client> client = std::make_unique<Client>();
+	client->connection = std::move(acceptedConnection);
+	client->lastActive = Util::CurrentTime();
+	m_poller->Add(client->connection->GetSocket(), client.get());
+	m_clients.push_back(std::move(client));
+	m_idle++;
+}
+
+void RemoteServer::StartRequest(Client* client)
+{
+	Guard guard(m_clientsMutex);
+
+	if (m_readCount >= m_readThreads * (1 + READ_QUEUE_FACTOR))
+	{
+		// all reading threads are taken by slow clients, don't let the queue grow
+		debug("Too many requests being received, closing connection from %s", client->connection->GetRemoteAddr());
+		m_idle--;
+		m_clients.erase(std::find_if(m_clients.begin(), m_clients.end(),
+			[client](std::unique_ptr<Client>& item) { return item.get() == client; }));
+		return;
+	}
+
+	client->busy = true;
+	m_busyCount++;
+	m_idle--;
+	SubmitRead(client);
+}
+
+void RemoteServer::SubmitRead(Client* client)
+{
+	m_reading++;
+	m_readCount++;
+	client->readStarted = Util::CurrentTime();
+	RequestProcessor* requestProcessor = new RequestProcessor(this, client, m_tls, true);
+	requestProcessor->SetAutoDestroy(true);
+	requestProcessor->StartPooled(m_readPool.get());
+}
 
-	RequestProcessor* requestProcessor = (RequestProcessor*)caller;
-	Guard guard(m_processorsMutex);
-	m_activeProcessors.erase(std::find(m_activeProcessors.begin(), m_activeProcessors.end(), requestProcessor));
+void RemoteServer::SubmitRequest(Client* client)
+{
+	m_queued++;
+	RequestProcessor* requestProcessor = new RequestProcessor(this, client, m_tls, false);
+	requestProcessor->SetAutoDestroy(true);
+	requestProcessor->StartPooled(m_pool.get());
+}
+
+void RemoteServer::ReadDone(Client* client, bool execute, bool keepAlive)
+{
+	m_reading--;
+
+	{
+		Guard guard(m_clientsMutex);
+		m_readCount--;
+		client->readStarted = 0;
+	}
+
+	if (execute && !IsStopped())
+	{
+		SubmitRequest(client);
+		return;
+	}
+
+	client->webRequest.reset();
+	client->binRequest.reset();
+	FinishRequest(client, keepAlive);
+}
+
+void RemoteServer::RequestStarted()
+{
+	m_queued--;
+	m_active++;
+}
+
+void RemoteServer::RequestDone(Client* client, bool keepAlive, int timeMs)
+{
+	m_active--;
+
+	{
+		Guard guard(m_statsMutex);
+		m_recentTimes[m_requestCount++ % RECENT_REQUESTS] = timeMs;
+	}
+
+	FinishRequest(client, keepAlive);
+}
+
+void RemoteServer::FinishRequest(Client* client, bool keepAlive)
+{
+	Guard guard(m_clientsMutex);
+	client->lastActive = Util::CurrentTime();
+	keepAlive &= !IsStopped();
+
+	if (keepAlive && client->waiting)
+	{
+		// the request is resumed from the poll loop
+		client->busy = false;
+		m_busyCount--;
+		m_waitingCount++;
+		m_waiting++;
+		return;
+	}
+
+	if (keepAlive && client->connection->HasBufferedData())
+	{
+		// next request is already received
+		SubmitRead(client);
+		return;
+	}
+
+	client->busy = false;
+	m_busyCount--;
+
+	if (keepAlive)
+	{
+		m_idle++;
+		m_poller->Add(client->connection->GetSocket(), client);
+		return;
+	}
+
+	m_clients.erase(std::find_if(m_clients.begin(), m_clients.end(),
+		[client](std::unique_ptr<Client>& item) { return item.get() == client; }));
+}
+
+void RemoteServer::CloseIdleClients(bool all)
+{
+	time_t expireTime = Util::CurrentTime() - g_Options->GetRemoteTimeout();
+
+	Guard guard(m_clientsMutex);
+	for (ClientList::iterator it = m_clients.begin(); it != m_clients.end(); )
+	{
+		Client* client = it->get();
+		if (!client->busy && (all || (!client->waiting && client->lastActive < expireTime)))
+		{
+			debug("Closing idle connection from %s", client->connection->GetRemoteAddr());
+			if (client->waiting)
+			{
+				m_waitingCount--;
+				m_waiting--;
+			}
+			else
+			{
+				m_poller->Remove(client->connection->GetSocket());
+				m_idle--;
+			}
+			it = m_clients.erase(it);
+		}
+		else
+		{
+			it++;
+		}
+	}
+}
+
+// Cancels requests which are being received for too long to free their reading threads
+void RemoteServer::CancelSlowReads()
+{
+	time_t expireTime = Util::CurrentTime() - g_Options->GetRemoteTimeout();
+
+	Guard guard(m_clientsMutex);
+	for (std::unique_ptr<Client>& client : m_clients)
+	{
+		if (client->readStarted && client->readStarted < expireTime)
+		{
+			debug("Receiving of request from %s timed out", client->connection->GetRemoteAddr());
+			client->readStarted = 0;
+			client->connection->Cancel();
+		}
+	}
+}
+
+// Resubmits waiting requests which are ready, returns true if requests are still waiting
+bool RemoteServer::ResumeWaitingClients()
+{
+	{
+		Guard guard(m_clientsMutex);
+		if (m_waitingCount == 0)
+		{
+			return false;
+		}
+	}
+
+	XmlRpcProcessor::CheckChanges();
+
+	Guard guard(m_clientsMutex);
+	for (std::unique_ptr<Client>& client : m_clients)
+	{
+		if (!client->busy && client->waiting && client->waiting->IsReady())
+		{
+			client->busy = true;
+			m_busyCount++;
+			m_waitingCount--;
+			m_waiting--;
+			SubmitRequest(client.get());
+		}
+	}
+
+	return m_waitingCount > 0;
+}
+
+RemoteServer::Stats RemoteServer::GetStats()
+{
+	Stats stats;
+	stats.queueDepth = m_queued;
+	stats.activeRequests = m_active;
+	stats.idleConnections = m_idle;
+	stats.waitingRequests = m_waiting;
+
+	Guard guard(m_statsMutex);
+	stats.requestCount = m_requestCount;
+	int recent = (int)std::min(m_requestCount, (int64)RECENT_REQUESTS);
+	int totalTimeMs = 0;
+	for (int i = 0; i < recent; i++)
+	{
+		totalTimeMs += m_recentTimes[i];
+		stats.maxRequestTimeMs = std::max(stats.maxRequestTimeMs, m_recentTimes[i]);
+	}
+	stats.requestTimeMs = recent > 0 ? totalTimeMs / recent : 0;
+
+	return stats;
 }
 
 //*****************************************************************
@@ -173,8 +567,6 @@ void RemoteServer::Update(Subject* caller, void* aspect)
 
 RequestProcessor::~RequestProcessor()
 {
-	m_connection->Disconnect();
-
 #ifndef DISABLE_TLS
 	OpenSSL::StopSSLThread();
 #endif
@@ -182,78 +574,133 @@ RequestProcessor::~RequestProcessor()
 
 void RequestProcessor::Run()
 {
-	Execute();
-	Notify(nullptr);
-}
+	if (m_read)
+	{
+		bool keepAlive = false;
+		bool execute = ReadRequest(keepAlive);
+		m_server->ReadDone(m_client, execute, keepAlive);
+		return;
+	}
 
-void RequestProcessor::Stop()
-{
-	Thread::Stop();
-#ifdef WIN32
-	m_connection->SetForceClose(true);
-#endif
-	m_connection->Cancel();
+	m_server->RequestStarted();
+	int64 startTime = Util::CurrentTicks();
+
+	bool keepAlive = Execute();
+
+	int timeMs = (int)((Util::CurrentTicks() - startTime) / 1000);
+	debug("Request from %s served in %i ms", m_client->connection->GetRemoteAddr(), timeMs);
+	m_server->RequestDone(m_client, keepAlive, timeMs);
 }
 
-void RequestProcessor::Execute()
+/*
+ * Receives the next request, returns true if it must be executed. Otherwise the
+ * request was already answered or failed, "keepAlive" is set if the connection
+ * is kept open for further requests.
+ */
+bool RequestProcessor::ReadRequest(bool& keepAlive)
 {
-	bool ok = false;
-	m_connection->SetSuppressErrors(true);
+	keepAlive = false;
+	Connection* connection = m_client->connection.get();
 
-#ifndef DISABLE_TLS
-	if (m_tls && !m_connection->StartTls(false, g_Options->GetSecureCert(), g_Options->GetSecureKey()))
+	if (!m_client->started)
 	{
-		debug("Could not establish secure connection to web-client: Start TLS failed");
-		return;
-	}
+		m_client->started = true;
+		connection->SetSuppressErrors(true);
+
+#ifndef DISABLE_TLS
+		if (m_tls && !connection->StartTls(false, g_Options->GetSecureCert(), g_Options->GetSecureKey()))
+		{
+			debug("Could not establish secure connection to web-client: Start TLS failed");
+			return false;
+		}
 #endif
+	}
 
 	// Read the first 4 bytes to determine request type
 	uint32 signature = 0;
-	if (!m_connection->Recv((char*)&signature, 4))
+	if (!connection->Recv((char*)&signature, 4))
 	{
 		debug("Could not read request signature");
-		return;
+		return false;
 	}
 
 	if ((int)ntohl(signature) == (int)NZBMESSAGE_SIGNATURE)
 	{
 		// binary request received
-		ok = true;
-		BinRpcProcessor processor;
-		processor.SetConnection(m_connection.get());
-		processor.Execute();
+		m_client->binRequest = std::make_unique<BinRpcProcessor>();
+		m_client->binRequest->SetConnection(connection);
+		return m_client->binRequest->ReadRequest();
 	}
 	else if (!strncmp((char*)&signature, "POST", 4) ||
 		!strncmp((char*)&signature, "GET ", 4) ||
 		!strncmp((char*)&signature, "OPTI", 4))
 	{
 		// HTTP request received
-		ok = true;
-		while (ServWebRequest((char*)&signature))
+		if (ReadWebRequest((char*)&signature, keepAlive))
 		{
-			if (!m_connection->Recv((char*)&signature, 4))
-			{
-				debug("Could not read request signature");
-				break;
-			}
+			return true;
 		}
 
-		m_connection->SetGracefull(true);
-		m_connection->Disconnect();
+		if (!keepAlive)
+		{
+			connection->SetGracefull(true);
+			connection->Disconnect();
+		}
+		return false;
+	}
+
+	warn("Non-nzbget request received on port %i from %s", m_tls ? g_Options->GetSecurePort() : g_Options->GetControlPort(), connection->GetRemoteAddr());
+	return false;
+}
+
+// Executes the received request, returns true if the connection is kept open for further requests
+bool RequestProcessor::Execute()
+{
+	Connection* connection = m_client->connection.get();
+
+	if (m_client->waiting)
+	{
+		if (ResumeWebRequest())
+		{
+			return true;
+		}
+
+		connection->SetGracefull(true);
+		connection->Disconnect();
+		return false;
+	}
+
+	if (m_client->binRequest)
+	{
+		std::unique_ptr<BinRpcProcessor> processor = std::move(m_client->binRequest);
+		processor->Dispatch();
+		return false;
+	}
+
+	std::unique_ptr<WebProcessor> processor = std::move(m_client->webRequest);
+	processor->Dispatch();
+
+	if (processor->IsWaiting())
+	{
+		m_client->waiting = std::move(processor);
+		return true;
 	}
 
-	if (!ok)
+	if (processor->GetKeepAlive())
 	{
-		warn("Non-nzbget request received on port %i from %s", m_tls ? g_Options->GetSecurePort() : g_Options->GetControlPort(), m_connection->GetRemoteAddr());
+		return true;
 	}
+
+	connection->SetGracefull(true);
+	connection->Disconnect();
+	return false;
 }
 
-bool RequestProcessor::ServWebRequest(const char* signature)
+bool RequestProcessor::ReadWebRequest(const char* signature, bool& keepAlive)
 {
 	// HTTP request received
 	char buffer[1024];
-	if (!m_connection->ReadLine(buffer, sizeof(buffer), nullptr))
+	if (!m_client->connection->ReadLine(buffer, sizeof(buffer), nullptr))
 	{
 		return false;
 	}
@@ -282,11 +729,30 @@ bool RequestProcessor::ServWebRequest(const char* signature)
 
 	debug("url: %s", url);
 
-	WebProcessor processor;
-	processor.SetConnection(m_connection.get());
-	processor.SetUrl(url);
-	processor.SetHttpMethod(httpMethod);
-	processor.Execute();
+	std::unique_ptr<WebProcessor> processor = std::make_unique<WebProcessor>();
+	processor->SetConnection(m_client->connection.get());
+	processor->SetUrl(url);
+	processor->SetHttpMethod(httpMethod);
+	if (!processor->ReadRequest())
+	{
+		keepAlive = processor->GetKeepAlive();
+		return false;
+	}
+
+	m_client->webRequest = std::move(processor);
+	return true;
+}
+
+// Sends the response to a request which was waiting for an event
+bool RequestProcessor::ResumeWebRequest()
+{
+	m_client->waiting->Resume();
+	if (m_client->waiting->IsWaiting())
+	{
+		return true;
+	}
 
-	return processor.GetKeepAlive();
+	bool keepAlive = m_client->waiting->GetKeepAlive();
+	m_client->waiting.reset();
+	return keepAlive;
 }
@@ -25,44 +25,119 @@
 
 #include "Thread.h"
 #include "Connection.h"
-#include "Observer.h"
 
+class BinRpcProcessor;
 class RequestProcessor;
+class SocketPoller;
+class WebProcessor;
 
-class RemoteServer : public Thread, public Observer
+/*
+ * Listens on the control port. New connections and connections kept alive
+ * between requests wait for incoming data in one poll loop. A request is then
+ * received on a thread of a separate reading pool, so that slow clients can't block
+ * the execution of other requests, and executed by a worker of the main pool.
+ * Both pools are bounded by option "RemoteThreads". Receiving of a request is
+ * cancelled after "RemoteTimeout" seconds, connections arriving while too many
+ * requests are waiting to be received are closed. Idle connections don't occupy
+ * a thread, neither do requests waiting for events (API-method "waitevents"),
+ * they are resumed from the poll loop.
+ */
+class RemoteServer : public Thread
 {
 public:
-	RemoteServer(bool tls) : m_tls(tls) {}
+	struct Stats
+	{
+		int queueDepth = 0;			// requests waiting for a free worker
+		int readingRequests = 0;	// requests being received
+		int activeRequests = 0;
+		int idleConnections = 0;	// connections waiting for the next request
+		int waitingRequests = 0;	// requests waiting for events
+		int64 requestCount = 0;
+		int requestTimeMs = 0;		// average time of recent requests
+		int maxRequestTimeMs = 0;	// longest of recent requests
+	};
+
+	RemoteServer(bool tls);
 	~RemoteServer();
 	void Run() override;
 	void Stop() override;
 	void ForceStop();
-	void Update(Subject* caller, void* aspect);
+	static Stats GetStats();
 
 private:
-	typedef std::deque<RequestProcessor*> RequestProcessors;
+	struct Client
+	{
+		Client();
+		~Client();
+		std::unique_ptr<Connection> connection;
+		std::unique_ptr<WebProcessor> webRequest;	// received request ready for execution
+		std::unique_ptr<BinRpcProcessor> binRequest;
+		std::unique_ptr<WebProcessor> waiting;	// request waiting for an event
+		bool started = false;
+		bool busy = false;
+		time_t lastActive = 0;
+		time_t readStarted = 0;	// set while the request is being received
+	};
+
+	typedef std::list<std::unique_ptr<Client>> ClientList;
+
+	static const int RECENT_REQUESTS = 100;
+	static const int READ_QUEUE_FACTOR = 2;	// reads waiting for a thread, per reading thread
 
 	bool m_tls;
+	int m_readThreads;
 	std::unique_ptr<Connection> m_connection;
-	RequestProcessors m_activeProcessors;
-	Mutex m_processorsMutex;
+	std::unique_ptr<SocketPoller> m_poller;
+	std::unique_ptr<ThreadPool> m_readPool;
+	std::unique_ptr<ThreadPool> m_pool;
+	ClientList m_clients;
+	int m_readCount = 0;
+	int m_busyCount = 0;
+	int m_waitingCount = 0;
+	Mutex m_clientsMutex;
+
+	inline static Mutex m_statsMutex;
+	inline static std::atomic<int> m_queued{0};
+	inline static std::atomic<int> m_reading{0};
+	inline static std::atomic<int> m_active{0};
+	inline static std::atomic<int> m_idle{0};
+	inline static std::atomic<int> m_waiting{0};
+	inline static int64 m_requestCount = 0;
+	inline static int m_recentTimes[RECENT_REQUESTS];
+
+	void AcceptClient();
+	void StartRequest(Client* client);
+	void SubmitRead(Client* client);
+	void SubmitRequest(Client* client);
+	void ReadDone(Client* client, bool execute, bool keepAlive);
+	void RequestStarted();
+	void RequestDone(Client* client, bool keepAlive, int timeMs);
+	void FinishRequest(Client* client, bool keepAlive);
+	void CloseIdleClients(bool all);
+	void CancelSlowReads();
+	bool ResumeWaitingClients();
+
+	friend class RequestProcessor;
 };
 
-class RequestProcessor : public Thread, public Subject
+class RequestProcessor : public Thread
 {
 public:
+	RequestProcessor(RemoteServer* server, RemoteServer::Client* client, bool tls, bool read) :
+		m_server(server), m_client(client), m_tls(tls), m_read(read) {}
 	~RequestProcessor();
 	void Run() override;
-	void Stop() override;
-	void SetTls(bool tls) { m_tls = tls; }
-	void SetConnection(std::unique_ptr<Connection>&& connection) { m_connection = std::move(connection); }
 
 private:
+	RemoteServer* m_server;
+	RemoteServer::Client* m_client;
 	bool m_tls;
-	std::unique_ptr<Connection> m_connection;
+	bool m_read;
 
-	bool ServWebRequest(const char* signature);
-	void Execute();
+	bool ReadRequest(bool& keepAlive);
+	bool ReadWebRequest(const char* signature, bool& keepAlive);
+	bool ResumeWebRequest();
+	bool Execute();
 };
 
 #endif
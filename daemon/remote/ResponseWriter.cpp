@@ -0,0 +1,409 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+#include "ResponseWriter.h"
+
+#include <stdexcept>
+
+namespace
+{
+	// reads arguments passed to a variadic function
+	class VaArgs
+	{
+	public:
+		VaArgs(va_list ap) { va_copy(m_ap, ap); }
+		~VaArgs() { va_end(m_ap); }
+		int NextInt() { return va_arg(m_ap, int); }
+		uint32 NextUInt() { return va_arg(m_ap, uint32); }
+		const char* NextStr() { return va_arg(m_ap, const char*); }
+
+	private:
+		va_list m_ap;
+	};
+
+	// reads arguments captured in deferred mode
+	class CapturedArgs
+	{
+	public:
+		CapturedArgs(const int64* args, const char* strings) : m_args(args), m_strings(strings) {}
+		int NextInt() { return (int)*m_args++; }
+		uint32 NextUInt() { return (uint32)*m_args++; }
+		const char* NextStr() { return m_strings + *m_args++; }
+
+	private:
+		const int64* m_args;
+		const char* m_strings;
+	};
+
+	// stores arguments for deferred formatting
+	class CaptureArgs
+	{
+	public:
+		CaptureArgs(std::vector<int64>& args, std::string& strings) : m_args(args), m_strings(strings) {}
+		void Int(int value) { m_args.push_back(value); }
+		void UInt(uint32 value) { m_args.push_back(value); }
+		void Str(const char* value)
+		{
+			m_args.push_back((int64)m_strings.size());
+			m_strings.append(value ? value : "");
+			m_strings.push_back('\0');
+		}
+
+	private:
+		std::vector<int64>& m_args;
+		std::string& m_strings;
+	};
+
+	[[noreturn]] void UnsupportedConversion(const char* format)
+	{
+		throw std::invalid_argument(std::string("Unsupported conversion in response template: ") + format);
+	}
+
+	// decodes one utf8 sequence starting at "p", returns false if the string ends within the sequence
+	bool DecodeUtf8(const char*& p, uint32& cp)
+	{
+		uchar ch = *p;
+		cp = ch;
+
+		if ((cp >> 5) == 0x6 && (p[1] & 0xc0) == 0x80)
+		{
+			// 2 bytes
+			if (!(ch = *++p)) return false;
+			cp = ((cp << 6) & 0x7ff) + (ch & 0x3f);
+		}
+		else if ((cp >> 4) == 0xe && (p[1] & 0xc0) == 0x80)
+		{
+			// 3 bytes
+			if (!(ch = *++p)) return false;
+			cp = ((cp << 12) & 0xffff) + ((ch << 6) & 0xfff);
+			if (!(ch = *++p)) return false;
+			cp += ch & 0x3f;
+		}
+		else if ((cp >> 3) == 0x1e && (p[1] & 0xc0) == 0x80)
+		{
+			// 4 bytes
+			if (!(ch = *++p)) return false;
+			cp = ((cp << 18) & 0x1fffff) + ((ch << 12) & 0x3ffff);
+			if (!(ch = *++p)) return false;
+			cp += (ch << 6) & 0xfff;
+			if (!(ch = *++p)) return false;
+			cp += ch & 0x3f;
+		}
+
+		return true;
+	}
+}
+
+void ResponseWriter::SetDeferred(bool deferred)
+{
+	if (m_deferred && !deferred)
+	{
+		Flush();
+	}
+	m_deferred = deferred;
+}
+
+void ResponseWriter::Flush()
+{
+	for (Part& part : m_parts)
+	{
+		if (part.format)
+		{
+			CapturedArgs args(m_args.data() + part.arg, m_strings.data());
+			Format(part.format, args);
+		}
+		else
+		{
+			m_output.Append(m_strings.data() + part.arg);
+		}
+	}
+
+	m_parts.clear();
+	m_args.clear();
+	m_strings.clear();
+}
+
+void ResponseWriter::Append(const char* text)
+{
+	if (!*text)
+	{
+		return;
+	}
+
+	if (m_deferred)
+	{
+		m_parts.push_back({nullptr, m_strings.size()});
+		m_strings.append(text);
+		m_strings.push_back('\0');
+	}
+	else
+	{
+		m_output.Append(text);
+	}
+}
+
+void ResponseWriter::AppendFmt(const char* format, ...)
+{
+	va_list ap;
+	va_start(ap, format);
+	AppendFmtV(format, ap);
+	va_end(ap);
+}
+
+void ResponseWriter::AppendFmtV(const char* format, va_list ap)
+{
+	VaArgs args(ap);
+
+	if (!m_deferred)
+	{
+		Format(format, args);
+		return;
+	}
+
+	m_parts.push_back({format, m_args.size()});
+	CaptureArgs capture(m_args, m_strings);
+	for (const char* p = format; *p; p++)
+	{
+		if (*p != '%')
+		{
+			continue;
+		}
+		switch (*++p)
+		{
+			case 'i':
+			case 'd':
+				capture.Int(args.NextInt());
+				break;
+			case 'u':
+				capture.UInt(args.NextUInt());
+				break;
+			case 's':
+				capture.Str(args.NextStr());
+				break;
+			case '%':
+				break;
+			default:
+				UnsupportedConversion(format);
+		}
+	}
+}
+
+void ResponseWriter::AppendEncoded(const char* str)
+{
+	if (m_deferred)
+	{
+		AppendFmt("%s", str);
+	}
+	else if (m_json)
+	{
+		AppendJsonEncoded(str ? str : "");
+	}
+	else
+	{
+		AppendXmlEncoded(str ? str : "");
+	}
+}
+
+template <typename ArgSource>
+void ResponseWriter::Format(const char* format, ArgSource& args)
+{
+	const char* p = format;
+	while (*p)
+	{
+		const char* start = p;
+		while (*p && *p != '%') p++;
+		if (p > start)
+		{
+			m_output.Append(start, (int)(p - start));
+		}
+		if (!*p)
+		{
+			break;
+		}
+
+		switch (*++p)
+		{
+			case 'i':
+			case 'd':
+				AppendInt(args.NextInt());
+				break;
+			case 'u':
+				AppendInt(args.NextUInt());
+				break;
+			case 's':
+			{
+				const char* str = args.NextStr();
+				if (m_json)
+				{
+					AppendJsonEncoded(str ? str : "");
+				}
+				else
+				{
+					AppendXmlEncoded(str ? str : "");
+				}
+				break;
+			}
+			case '%':
+				m_output.Append("%", 1);
+				break;
+			default:
+				UnsupportedConversion(format);
+		}
+		p++;
+	}
+}
+
+void ResponseWriter::AppendInt(int64 value)
+{
+	char buf[24];
+	char* end = buf + sizeof(buf);
+	char* p = end;
+	uint64 absValue = value < 0 ? 0 - (uint64)value : (uint64)value;
+	do
+	{
+		*--p = (char)('0' + absValue % 10);
+		absValue /= 10;
+	} while (absValue);
+	if (value < 0)
+	{
+		*--p = '-';
+	}
+	m_output.Append(p, (int)(end - p));
+}
+
+// same output as WebUtil::XmlEncode
+void ResponseWriter::AppendXmlEncoded(const char* str)
+{
+	const char* p = str;
+	while (*p)
+	{
+		const char* start = p;
+		for (uchar ch = *p; ch >= 0x20 && ch <= 0x80 && ch != '<' && ch != '>' &&
+			ch != '&' && ch != '\'' && ch != '\"'; ch = *++p) ;
+		if (p > start)
+		{
+			m_output.Append(start, (int)(p - start));
+		}
+
+		switch (*p)
+		{
+			case '\0':
+				return;
+			case '<':
+				m_output.Append("&lt;", 4);
+				break;
+			case '>':
+				m_output.Append("&gt;", 4);
+				break;
+			case '&':
+				m_output.Append("&amp;", 5);
+				break;
+			case '\'':
+				m_output.Append("&apos;", 6);
+				break;
+			case '\"':
+				m_output.Append("&quot;", 6);
+				break;
+			default:
+			{
+				uint32 cp;
+				if (!DecodeUtf8(p, cp))
+				{
+					return;
+				}
+
+				// accept only valid XML 1.0 characters
+				if (cp == 0x9 || cp == 0xA || cp == 0xD ||
+					(0x20 <= cp && cp <= 0xD7FF) ||
+					(0xE000 <= cp && cp <= 0xFFFD) ||
+					(0x10000 <= cp && cp <= 0x10FFFF))
+				{
+					char entity[11];
+					snprintf(entity, sizeof(entity), "&#x%06x;", cp);
+					m_output.Append(entity, 10);
+				}
+				else
+				{
+					// replace invalid characters with dots
+					m_output.Append(".", 1);
+				}
+			}
+		}
+		p++;
+	}
+}
+
+// same output as WebUtil::JsonEncode
+void ResponseWriter::AppendJsonEncoded(const char* str)
+{
+	const char* p = str;
+	while (*p)
+	{
+		const char* start = p;
+		for (uchar ch = *p; ch >= 0x20 && ch <= 0x80 && ch != '\"' && ch != '\\' && ch != '/'; ch = *++p) ;
+		if (p > start)
+		{
+			m_output.Append(start, (int)(p - start));
+		}
+
+		switch (*p)
+		{
+			case '\0':
+				return;
+			case '"':
+				m_output.Append("\\\"", 2);
+				break;
+			case '\\':
+				m_output.Append("\\\\", 2);
+				break;
+			case '/':
+				m_output.Append("\\/", 2);
+				break;
+			case '\b':
+				m_output.Append("\\b", 2);
+				break;
+			case '\f':
+				m_output.Append("\\f", 2);
+				break;
+			case '\n':
+				m_output.Append("\\n", 2);
+				break;
+			case '\r':
+				m_output.Append("\\r", 2);
+				break;
+			case '\t':
+				m_output.Append("\\t", 2);
+				break;
+			default:
+			{
+				uint32 cp;
+				if (!DecodeUtf8(p, cp))
+				{
+					return;
+				}
+
+				// we support only Unicode range U+0000-U+FFFF
+				char escape[7];
+				snprintf(escape, sizeof(escape), "\\u%04x", cp <= 0xFFFF ? cp : '.');
+				m_output.Append(escape, 6);
+			}
+		}
+		p++;
+	}
+}
@@ -0,0 +1,75 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef RESPONSEWRITER_H
+#define RESPONSEWRITER_H
+
+#include <vector>
+#include "NString.h"
+
+/**
+ * Builds XML-RPC and JSON-RPC responses from printf-like templates.
+ *
+ * Only conversions "%i", "%d", "%u", "%s" and "%%" are supported, other conversions
+ * throw std::invalid_argument. String arguments are escaped for XML or JSON while
+ * being copied into the output, no temporary strings are created.
+ *
+ * In deferred mode the arguments are only captured, strings are copied into one
+ * shared buffer, and the output is produced by Flush(). This allows to take a
+ * snapshot of the data while holding a lock and to format it after the lock is
+ * released. Templates are not copied and must stay valid until flushed.
+ */
+class ResponseWriter
+{
+public:
+	ResponseWriter(StringBuilder& output) : m_output(output) {}
+	ResponseWriter(const ResponseWriter&) = delete;
+	ResponseWriter& operator=(const ResponseWriter&) = delete;
+	void SetJson(bool json) { m_json = json; }
+	bool IsDeferred() { return m_deferred; }
+	void SetDeferred(bool deferred);
+	void Flush();
+	void Append(const char* text);
+	void AppendFmt(const char* format, ...) PRINTF_SYNTAX(2);
+	void AppendFmtV(const char* format, va_list ap);
+	void AppendEncoded(const char* str);
+
+private:
+	struct Part
+	{
+		const char* format;		// nullptr for plain text
+		size_t arg;				// first argument in m_args or offset of plain text in m_strings
+	};
+
+	typedef std::vector<Part> PartList;
+	typedef std::vector<int64> ArgList;
+
+	StringBuilder& m_output;
+	bool m_json = false;
+	bool m_deferred = false;
+	PartList m_parts;
+	ArgList m_args;
+	std::string m_strings;
+
+	void AppendInt(int64 value);
+	void AppendXmlEncoded(const char* str);
+	void AppendJsonEncoded(const char* str);
+	template <typename ArgSource> void Format(const char* format, ArgSource& args);
+};
+
+#endif
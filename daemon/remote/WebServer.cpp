@@ -70,7 +70,29 @@ void WebProcessor::Init()
 	}
 }
 
-void WebProcessor::Execute()
+WebProcessor::~WebProcessor()
+{
+}
+
+bool WebProcessor::IsReady()
+{
+	return m_rpcProcessor->IsReady();
+}
+
+void WebProcessor::Resume()
+{
+	m_rpcProcessor->Resume();
+	if (m_rpcProcessor->IsWaiting())
+	{
+		return;
+	}
+
+	std::unique_ptr<XmlRpcProcessor> processor = std::move(m_rpcProcessor);
+	SendBodyResponse(processor->GetResponse(), strlen(processor->GetResponse()), processor->GetContentType(),
+		processor->IsSafeMethod(), processor->GetETag());
+}
+
+bool WebProcessor::ReadRequest()
 {
 	m_gzip =false;
 	m_userAccess = uaControl;
@@ -82,13 +104,13 @@ void WebProcessor::Execute()
 	if (m_httpMethod == hmPost && m_contentLen <= 0)
 	{
 		error("Invalid-request: content length is 0");
-		return;
+		return false;
 	}
 
 	if (m_httpMethod == hmOptions)
 	{
 		SendOptionsResponse();
-		return;
+		return false;
 	}
 
 	ParseUrl();
@@ -99,7 +121,7 @@ void WebProcessor::Execute()
 	if ((!g_Options->GetFormAuth() || m_rpcRequest) && !m_authorized)
 	{
 		SendAuthResponse();
-		return;
+		return false;
 	}
 
 	if (m_httpMethod == hmPost)
@@ -111,14 +133,14 @@ void WebProcessor::Execute()
 		if (!m_connection->Recv(m_request, m_contentLen))
 		{
 			error("Invalid-request: could not read data");
-			return;
+			return false;
 		}
 		debug("Request=%s", *m_request);
 	}
 
 	debug("request received from %s", m_connection->GetRemoteAddr());
 
-	Dispatch();
+	return true;
 }
 
 void WebProcessor::ParseHeaders()
@@ -313,13 +335,21 @@ void WebProcessor::Dispatch()
 
 	if (m_rpcRequest)
 	{
-		XmlRpcProcessor processor;
-		processor.SetRequest(m_request);
-		processor.SetHttpMethod(m_httpMethod == hmGet ? XmlRpcProcessor::hmGet : XmlRpcProcessor::hmPost);
-		processor.SetUserAccess((XmlRpcProcessor::EUserAccess)m_userAccess);
-		processor.SetUrl(m_url);
-		processor.Execute();
-		SendBodyResponse(processor.GetResponse(), strlen(processor.GetResponse()), processor.GetContentType(), processor.IsSafeMethod());
+		std::unique_ptr<XmlRpcProcessor> processor = std::make_unique<XmlRpcProcessor>();
+		processor->SetRequest(m_request);
+		processor->SetHttpMethod(m_httpMethod == hmGet ? XmlRpcProcessor::hmGet : XmlRpcProcessor::hmPost);
+		processor->SetUserAccess((XmlRpcProcessor::EUserAccess)m_userAccess);
+		processor->SetUrl(m_url);
+		processor->SetOldETag(m_oldETag);
+		processor->Execute();
+		if (processor->IsWaiting())
+		{
+			// the processor and the request stay alive until the response is sent by Resume()
+			m_rpcProcessor = std::move(processor);
+			return;
+		}
+		SendBodyResponse(processor->GetResponse(), strlen(processor->GetResponse()), processor->GetContentType(),
+			processor->IsSafeMethod(), processor->GetETag());
 		return;
 	}
 
@@ -445,34 +475,23 @@ void WebProcessor::SendRedirectResponse(const char* url)
 	m_connection->Send(responseHeader, responseHeader.Length());
 }
 
-void WebProcessor::SendBodyResponse(const char* body, int bodyLen, const char* contentType, bool cachable)
+void WebProcessor::SendBodyResponse(const char* body, int bodyLen, const char* contentType, bool cachable,
+	const char* eTag)
 {
-	const char* RESPONSE_HEADER =
-		"HTTP/1.1 %s\r\n"
-		"Connection: %s\r\n"
-		"Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
-		"Access-Control-Allow-Origin: %s\r\n"
-		"Access-Control-Allow-Credentials: true\r\n"
-		"Access-Control-Max-Age: 86400\r\n"
-		"Access-Control-Allow-Headers: Content-Type, Authorization\r\n"
-		"Set-Cookie: Auth-Type=%s; SameSite=Lax\r\n"
-		"Set-Cookie: Auth-Token=%s; HttpOnly; SameSite=Lax\r\n"
-		"Content-Length: %i\r\n"
-		"%s"					// Content-Type: xxx
-		"%s"					// Content-Encoding: gzip
-		"%s"					// ETag
-		"Server: nzbget-%s\r\n"
-		"\r\n";
-
-	BString<1024> eTagHeader;
+	BString<1024> newETag;
 	bool unchanged = false;
 
 	if (cachable)
 	{
-		BString<1024> newETag;
-
-		size_t hash = m_hasher(body);
-		newETag.Format("\"%x\"", hash);
+		if (eTag)
+		{
+			newETag = eTag;
+		}
+		else
+		{
+			size_t hash = m_hasher(body);
+			newETag.Format("\"%x\"", hash);
+		}
 
 		unchanged = m_oldETag && !strcmp(newETag, m_oldETag);
 		if (unchanged)
@@ -480,7 +499,6 @@ void WebProcessor::SendBodyResponse(const char* body, int bodyLen, const char* c
 			body = "";
 			bodyLen = 0;
 		}
-		eTagHeader.Format("ETag: %s\r\n", *newETag);
 	}
 
 #ifndef DISABLE_GZIP
@@ -505,6 +523,51 @@ void WebProcessor::SendBodyResponse(const char* body, int bodyLen, const char* c
 	bool gzip = false;
 #endif
 
+	SendContentResponse(body, bodyLen, contentType, cachable ? *newETag : nullptr, unchanged, gzip);
+}
+
+void WebProcessor::SendAssetResponse(const WebAssetCache::Asset* asset)
+{
+	bool gzip = m_gzip && !asset->gzipBody.empty();
+	const std::string& body = gzip ? asset->gzipBody : asset->body;
+	const char* eTag = gzip ? asset->gzipETag : asset->eTag;
+
+	bool unchanged = m_oldETag && !strcmp(eTag, m_oldETag);
+	if (unchanged)
+	{
+		SendContentResponse("", 0, asset->contentType, eTag, true, false);
+		return;
+	}
+
+	SendContentResponse(body.data(), (int)body.size(), asset->contentType, eTag, false, gzip);
+}
+
+void WebProcessor::SendContentResponse(const char* body, int bodyLen, const char* contentType,
+	const char* eTag, bool unchanged, bool gzip)
+{
+	const char* RESPONSE_HEADER =
+		"HTTP/1.1 %s\r\n"
+		"Connection: %s\r\n"
+		"Access-Control-Allow-Methods: GET, POST, OPTIONS\r\n"
+		"Access-Control-Allow-Origin: %s\r\n"
+		"Access-Control-Allow-Credentials: true\r\n"
+		"Access-Control-Max-Age: 86400\r\n"
+		"Access-Control-Allow-Headers: Content-Type, Authorization\r\n"
+		"Set-Cookie: Auth-Type=%s; SameSite=Lax\r\n"
+		"Set-Cookie: Auth-Token=%s; HttpOnly; SameSite=Lax\r\n"
+		"Content-Length: %i\r\n"
+		"%s"					// Content-Type: xxx
+		"%s"					// Content-Encoding: gzip
+		"%s"					// ETag
+		"Server: nzbget-%s\r\n"
+		"\r\n";
+
+	BString<1024> eTagHeader;
+	if (eTag)
+	{
+		eTagHeader.Format("ETag: %s\r\n", eTag);
+	}
+
 	BString<1024> contentTypeHeader;
 	if (contentType)
 	{
@@ -520,7 +583,7 @@ void WebProcessor::SendBodyResponse(const char* body, int bodyLen, const char* c
 		bodyLen,
 		*contentTypeHeader,
 		gzip ? "Content-Encoding: gzip\r\n" : "",
-		cachable ? *eTagHeader : "",
+		*eTagHeader,
 		Util::VersionRevision());
 
 	debug("[%s] (%s) %s", *m_url, *m_oldETag, *responseHeader);
@@ -543,8 +606,10 @@ void WebProcessor::SendSingleFileResponse()
 
 	debug("serving file: %s", *filename);
 
-	CharBuffer body;
-	if (!FileSystem::LoadFileIntoBuffer(filename, body, true))
+	std::string missingFile;
+	WebAssetCache::AssetPtr asset = WebAssetCache::Get(filename, {*filename}, DetectContentType(filename),
+		missingFile);
+	if (!asset)
 	{
 		// do not print warnings "404 not found" for certain files
 		bool ignorable = !strcmp(filename, "package-info.json") ||
@@ -555,48 +620,35 @@ void WebProcessor::SendSingleFileResponse()
 		return;
 	}
 
-	const char* contentType = DetectContentType(filename);
-	int len = body.Size() - 1;
-
-#ifdef DEBUG
-	if (contentType && !strcmp(contentType, "text/html"))
-	{
-		Util::ReduceStr(body, "<!-- %if-debug%", "");
-		Util::ReduceStr(body, "<!-- %if-not-debug% -->", "<!--");
-		Util::ReduceStr(body, "<!-- %end% -->", "-->");
-		Util::ReduceStr(body, "%end% -->", "");
-		len = strlen(body);
-	}
-#endif
-
-	SendBodyResponse(body, len, contentType, true);
+	SendAssetResponse(asset.get());
 }
 
 void WebProcessor::SendMultiFileResponse()
 {
 	debug("serving multiple files: %s", *m_url);
 
-	StringBuilder response;
+	CString key = *m_url;
 	char* filelist = strchr(m_url, '?');
 	*filelist++ = '\0';
 
+	WebAssetCache::FileList files;
 	Tokenizer tok(filelist, "+");
 	while (const char* filename = tok.Next())
 	{
-		BString<1024> diskFilename("%s%c%s", g_Options->GetWebDir(), PATH_SEPARATOR, filename);
-
-		CharBuffer body;
-		if (!FileSystem::LoadFileIntoBuffer(diskFilename, body, true))
-		{
-			warn("Web-Server: %s, Resource: /%s", ERR_HTTP_NOT_FOUND, filename);
-			SendErrorResponse(ERR_HTTP_NOT_FOUND, false);
-			return;
-		}
+		files.push_back(*BString<1024>("%s%c%s", g_Options->GetWebDir(), PATH_SEPARATOR, filename));
+	}
 
-		response.Append(body);
+	std::string missingFile;
+	WebAssetCache::AssetPtr asset = WebAssetCache::Get(key, files, DetectContentType(m_url), missingFile);
+	if (!asset)
+	{
+		warn("Web-Server: %s, Resource: /%s", ERR_HTTP_NOT_FOUND,
+			missingFile.c_str() + strlen(g_Options->GetWebDir()) + 1);
+		SendErrorResponse(ERR_HTTP_NOT_FOUND, false);
+		return;
 	}
 
-	SendBodyResponse(response, response.Length(), DetectContentType(m_url), true);
+	SendAssetResponse(asset.get());
 }
 
 const char* WebProcessor::DetectContentType(const char* filename)
@@ -634,3 +686,119 @@ const char* WebProcessor::DetectContentType(const char* filename)
 	}
 	return nullptr;
 }
+
+
+//*****************************************************************
+// WebAssetCache
+
+WebAssetCache::AssetPtr WebAssetCache::Get(const char* key, const FileList& files, const char* contentType,
+	std::string& missingFile)
+{
+	Guard guard(m_mutex);
+
+	time_t curTime = Util::CurrentTime();
+	auto it = m_entries.find(key);
+	if (it != m_entries.end())
+	{
+		Entry& entry = it->second;
+		if (entry.checked + CHECK_INTERVAL > curTime && entry.checked <= curTime)
+		{
+			return entry.asset;
+		}
+
+		StampList stamps = ReadStamps(files);
+		if (std::equal(stamps.begin(), stamps.end(), entry.stamps.begin(), entry.stamps.end(),
+			[](const Stamp& a, const Stamp& b) { return a.size == b.size && a.modified == b.modified; }))
+		{
+			entry.checked = curTime;
+			return entry.asset;
+		}
+
+		debug("Reloading web asset %s", key);
+		m_entries.erase(it);
+	}
+
+	// stamps are read before the files so that a modification during loading triggers another reload
+	StampList stamps = ReadStamps(files);
+	AssetPtr asset = Build(files, contentType, missingFile);
+	if (!asset)
+	{
+		return nullptr;
+	}
+
+	if ((int)m_entries.size() >= MAX_ENTRIES)
+	{
+		// only possible with unusual combinations of files in multi-file requests
+		m_entries.clear();
+	}
+
+	m_entries[key] = {asset, std::move(stamps), curTime};
+	return asset;
+}
+
+WebAssetCache::StampList WebAssetCache::ReadStamps(const FileList& files)
+{
+	StampList stamps;
+	for (const std::string& filename : files)
+	{
+		boost::system::error_code ec;
+		time_t modified = boost::filesystem::last_write_time(filename, ec);
+		stamps.push_back({FileSystem::FileSize(filename.c_str()), ec ? 0 : modified});
+	}
+	return stamps;
+}
+
+WebAssetCache::AssetPtr WebAssetCache::Build(const FileList& files, const char* contentType,
+	std::string& missingFile)
+{
+	std::shared_ptr<Asset> asset = std::make_shared<Asset>();
+	asset->contentType = contentType;
+
+	for (const std::string& filename : files)
+	{
+		CharBuffer buffer;
+		if (!FileSystem::LoadFileIntoBuffer(filename.c_str(), buffer, true))
+		{
+			missingFile = filename;
+			return nullptr;
+		}
+		asset->body.append(buffer, buffer.Size() - 1);
+	}
+
+#ifdef DEBUG
+	if (contentType && !strcmp(contentType, "text/html"))
+	{
+		char* body = asset->body.data();
+		Util::ReduceStr(body, "<!-- %if-debug%", "");
+		Util::ReduceStr(body, "<!-- %if-not-debug% -->", "<!--");
+		Util::ReduceStr(body, "<!-- %end% -->", "-->");
+		Util::ReduceStr(body, "%end% -->", "");
+		asset->body.resize(strlen(body));
+	}
+#endif
+
+	int bodyLen = (int)asset->body.size();
+	Crc32 crc;
+	crc.Append((uchar*)asset->body.data(), bodyLen);
+	uint32 hash = crc.Finish();
+	asset->eTag = CString::FormatStr("\"%08x-%x\"", hash, bodyLen);
+
+#ifndef DISABLE_GZIP
+	if (bodyLen > MAX_UNCOMPRESSED_SIZE)
+	{
+		// compressed once with the best ratio, then served from memory
+		uint32 outLen = ZLib::GZipLen(bodyLen);
+		CharBuffer gbuf(outLen);
+		int gzippedLen = ZLib::GZip(asset->body.data(), bodyLen, gbuf, outLen, true);
+		if (gzippedLen > 0 && gzippedLen < bodyLen)
+		{
+			asset->gzipBody.assign(gbuf, gzippedLen);
+			asset->gzipETag = CString::FormatStr("\"%08x-%x-gz\"", hash, bodyLen);
+		}
+	}
+#endif
+
+	debug("Loaded web asset (%i bytes, %i compressed)", bodyLen, (int)asset->gzipBody.size());
+
+	return asset;
+}
@@ -24,6 +24,63 @@
 
 #include "NString.h"
 #include "Connection.h"
+#include "Thread.h"
+
+/*
+ * Keeps web-interface files in memory together with their gzip-compressed copy
+ * and a strong ETag computed from the content. An entry is built on first access
+ * and rebuilt when one of its files is modified; files are checked for
+ * modifications at most once per CHECK_INTERVAL seconds.
+ */
+class WebAssetCache
+{
+public:
+	struct Asset
+	{
+		std::string body;
+		std::string gzipBody;		// empty if compression doesn't reduce the size
+		CString eTag;
+		CString gzipETag;
+		const char* contentType;
+	};
+
+	typedef std::shared_ptr<const Asset> AssetPtr;
+	typedef std::vector<std::string> FileList;
+
+	/* Returns the asset consisting of the given files in the given order or nullptr
+	   if a file cannot be read, the name of that file is then returned in "missingFile" */
+	static AssetPtr Get(const char* key, const FileList& files, const char* contentType,
+		std::string& missingFile);
+
+private:
+	struct Stamp
+	{
+		int64 size;
+		time_t modified;
+	};
+
+	typedef std::vector<Stamp> StampList;
+
+	struct Entry
+	{
+		AssetPtr asset;
+		StampList stamps;
+		time_t checked;
+	};
+
+	typedef std::unordered_map<std::string, Entry> EntryMap;
+
+	static const int CHECK_INTERVAL = 5;
+	static const int MAX_ENTRIES = 100;
+
+	inline static Mutex m_mutex;
+	inline static EntryMap m_entries;
+
+	static StampList ReadStamps(const FileList& files);
+	static AssetPtr Build(const FileList& files, const char* contentType, std::string& missingFile);
+};
+
+class XmlRpcProcessor;
 
 class WebProcessor
 {
@@ -35,8 +92,15 @@ public:
 		hmOptions
 	};
 
+	~WebProcessor();
 	static void Init();
-	void Execute();
+	// reads the request, returns false if it was already answered or failed
+	bool ReadRequest();
+	void Dispatch();
+	// the request waits for an event, Resume() sends the response once IsReady() returns true
+	bool IsWaiting() { return (bool)m_rpcProcessor; }
+	bool IsReady();
+	void Resume();
 	void SetConnection(Connection* connection) { m_connection = connection; }
 	void SetUrl(const char* url) { m_url = url; }
 	void SetHttpMethod(EHttpMethod httpMethod) { m_httpMethod = httpMethod; }
@@ -67,14 +131,18 @@ private:
 	CString m_oldETag;
 	bool m_keepAlive = false;
 	std::hash<std::string> m_hasher;
+	std::unique_ptr<XmlRpcProcessor> m_rpcProcessor;
 
-	void Dispatch();
 	void SendAuthResponse();
 	void SendOptionsResponse();
 	void SendErrorResponse(const char* errCode, bool printWarning);
 	void SendSingleFileResponse();
 	void SendMultiFileResponse();
-	void SendBodyResponse(const char* body, int bodyLen, const char* contentType, bool cachable);
+	void SendBodyResponse(const char* body, int bodyLen, const char* contentType, bool cachable,
+		const char* eTag = nullptr);
+	void SendAssetResponse(const WebAssetCache::Asset* asset);
+	void SendContentResponse(const char* body, int bodyLen, const char* contentType, const char* eTag,
+		bool unchanged, bool gzip);
 	void SendRedirectResponse(const char* url);
 	const char* DetectContentType(const char* filename);
 	bool IsAuthorizedIp(const char* remoteAddr);
@@ -38,6 +38,7 @@
 #include "CommandScript.h"
 #include "UrlCoordinator.h"
 #include "ExtensionManager.h"
+#include "RemoteServer.h"
 #include "SystemInfo.h"
 #include "Benchmark.h"
 #include "NetworkSpeedTest.h"
@@ -48,6 +49,18 @@
 extern void ExitProc();
 extern void Reload();
 
+// All callers must use the same status hash, otherwise entries would be seen as changed on every call
+static void UpdateGenerations(DownloadQueue* downloadQueue)
+{
+	downloadQueue->UpdateGenerations([](NzbInfo* nzbInfo)
+		{
+			// queue script state is reported in field "Status" but isn't stored in NzbInfo
+			bool queueScriptActive = false;
+			return (uint32)(nzbInfo->GetPostInfo() && nzbInfo->GetPostInfo()->GetStage() == PostInfo::ptQueued &&
+				g_QueueScriptCoordinator->HasJob(nzbInfo->GetId(), &queueScriptActive) ? 1 + queueScriptActive : 0);
+		});
+}
+
 class SafeXmlCommand: public XmlCommand
 {
 public:
@@ -122,6 +135,22 @@ public:
 	void Execute() override;
 };
 
+class WaitEventsXmlCommand: public SafeXmlCommand
+{
+public:
+	void Execute() override;
+	bool IsWaiting() override { return m_waiting; }
+	bool IsReady() override;
+
+private:
+	static const int MAX_WAIT_SEC = 120;
+
+	bool m_parsed = false;
+	bool m_waiting = false;
+	int m_since = 0;
+	time_t m_deadline = 0;
+};
+
 class StatusXmlCommand: public SafeXmlCommand
 {
 public:
@@ -156,6 +185,9 @@ class NzbInfoXmlCommand: public SafeXmlCommand
 protected:
 	void AppendNzbInfoFields(NzbInfo* nzbInfo);
 	void AppendPostInfoFields(PostInfo* postInfo, int logEntries, bool postQueue);
+	void AppendDeltaStart(int generation, bool full, IdList* deleted, IdList* order);
+	void AppendDeltaEnd();
+	void AppendIdList(const char* name, IdList* idList);
 };
 
 class ListFilesXmlCommand: public SafeXmlCommand
@@ -168,6 +200,7 @@ class ListGroupsXmlCommand: public NzbInfoXmlCommand
 {
 public:
 	void Execute() override;
+	int GetStateGeneration() override;
 private:
 	const char* DetectStatus(NzbInfo* nzbInfo);
 };
@@ -212,8 +245,10 @@ class HistoryXmlCommand: public NzbInfoXmlCommand
 {
 public:
 	void Execute() override;
+	int GetStateGeneration() override;
 private:
-	const char* DetectStatus(HistoryInfo* historyInfo);
+	void ExecuteQuery(bool dup, int offset);
+	void AppendHistoryItem(HistoryInfo* historyInfo);
 };
 
 class UrlQueueXmlCommand: public SafeXmlCommand
@@ -592,16 +627,40 @@ void XmlRpcProcessor::Dispatch()
 	else
 	{
 		std::unique_ptr<XmlCommand> command = CreateCommand(methodName);
+
+		// entity tag from data generation and request (hashed before parameters are decoded in place)
+		if (int generation = command->GetStateGeneration())
+		{
+			uint32 hash = Util::HashBJ96(m_url, m_url.Length(), 0);
+			if (m_httpMethod == hmPost && m_request)
+			{
+				hash = Util::HashBJ96(m_request, strlen(m_request), hash);
+			}
+			m_eTag.Format("\"g%i-%x\"", generation, hash);
+		}
+
 		command->SetRequest(request);
 		command->SetProtocol(m_protocol);
 		command->SetHttpMethod(m_httpMethod);
 		command->SetUserAccess(m_userAccess);
+		command->SetAllowWait(true);
 		command->PrepareParams();
 		m_safeMethod = command->IsSafeMethod();
 		bool safeToExecute = m_safeMethod || m_httpMethod == XmlRpcProcessor::hmPost || m_protocol == XmlRpcProcessor::rpJsonPRpc;
-		if (safeToExecute || command->IsError())
+		if (m_safeMethod && m_oldETag && !m_eTag.Empty() && !strcmp(m_eTag, m_oldETag))
+		{
+			// client already has the response, it's answered with "304 Not Modified" without building the body
+			return;
+		}
+		else if (safeToExecute || command->IsError())
 		{
 			command->Execute();
+			if (command->IsWaiting())
+			{
+				m_waitCommand = std::move(command);
+				m_waitRequestId = *requestId;
+				return;
+			}
 			BuildResponse(command->GetResponse(), command->GetCallbackFunc(), command->GetFault(), requestId);
 		}
 		else
@@ -611,6 +670,70 @@ void XmlRpcProcessor::Dispatch()
 	}
 }
 
+bool XmlRpcProcessor::IsReady()
+{
+	return m_waitCommand->IsReady();
+}
+
+void XmlRpcProcessor::Resume()
+{
+	m_waitCommand->Execute();
+	if (m_waitCommand->IsWaiting())
+	{
+		return;
+	}
+
+	BuildResponse(m_waitCommand->GetResponse(), m_waitCommand->GetCallbackFunc(),
+		m_waitCommand->GetFault(), m_waitRequestId);
+	m_waitCommand.reset();
+}
+
+void XmlRpcProcessor::CheckChanges()
+{
+	int64 curTicks = Util::CurrentTicks();
+	int64 lastCheck = m_lastCheck;
+	if (curTicks - lastCheck < g_Options->GetRemoteEventInterval() * 1000ll ||
+		!m_lastCheck.compare_exchange_strong(lastCheck, curTicks))
+	{
+		return;
+	}
+
+	ChangeFeed::Sample sample;
+	int64 remainingSize, forcedSize;
+	int postJobCount = 0;
+
+	{
+		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+		UpdateGenerations(downloadQueue);
+		sample.queueGeneration = downloadQueue->GetQueueGeneration();
+		sample.historyGeneration = downloadQueue->GetHistoryGeneration();
+		downloadQueue->CalcRemainingSize(&remainingSize, &forcedSize);
+		for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
+		{
+			postJobCount += nzbInfo->GetPostInfo() ? 1 : 0;
+		}
+	}
+
+	{
+		GuardedMessageList messages = g_Log->GuardMessages();
+		sample.logId = messages->empty() ? 0 : messages->back().GetId();
+	}
+
+	int upTimeSec, downloadTimeSec;
+	int64 allBytes;
+	bool serverStandBy;
+	g_StatMeter->CalcTotalStat(&upTimeSec, &downloadTimeSec, &allBytes, &serverStandBy);
+
+	// fields of method "status" which change without changing queue or log
+	int64 status[] = { remainingSize, forcedSize, postJobCount, g_StatMeter->CalcCurrentDownloadSpeed(),
+		serverStandBy, g_WorkState->GetSpeedLimit(), g_WorkState->GetResumeTime(),
+		g_WorkState->GetPauseDownload(), g_WorkState->GetPausePostProcess(), g_WorkState->GetPauseScan(),
+		g_WorkState->GetQuotaReached() };
+	sample.statusHash = Util::HashBJ96((const char*)status, sizeof(status), 0);
+
+	m_changeFeed.Update(sample);
+}
+
 void XmlRpcProcessor::MutliCall()
 {
 	bool error = false;
@@ -784,6 +907,10 @@ std::unique_ptr<XmlCommand> XmlRpcProcessor::CreateCommand(const char* methodNam
 	{
 		command = std::make_unique<StatusXmlCommand>();
 	}
+	else if (!strcasecmp(methodName, "waitevents"))
+	{
+		command = std::make_unique<WaitEventsXmlCommand>();
+	}
 	else if (!strcasecmp(methodName, "sysinfo"))
 	{
 		command = std::make_unique<SysInfoXmlCommand>();
@@ -984,14 +1111,23 @@ bool XmlCommand::IsJson()
 
 void XmlCommand::AppendResponse(const char* part)
 {
-	m_response.Append(part);
+	m_writer.Append(part);
 }
 
 void XmlCommand::AppendFmtResponse(const char* format, ...)
 {
 	va_list args;
 	va_start(args, format);
-	m_response.AppendFmtV(format, args);
+	if (m_writer.IsDeferred())
+	{
+		StringBuilder part;
+		part.AppendFmtV(format, args);
+		m_writer.Append(part);
+	}
+	else
+	{
+		m_response.AppendFmtV(format, args);
+	}
 	va_end(args);
 }
 
@@ -999,10 +1135,37 @@ void XmlCommand::AppendCondResponse(const char* part, bool cond)
 {
 	if (cond)
 	{
-		m_response.Append(part);
+		m_writer.Append(part);
 	}
 }
 
+/*
+ * Supports only "%i", "%u" and "%s" (see ResponseWriter), string arguments
+ * are encoded for the protocol and must not be passed through EncodeStr.
+ */
+void XmlCommand::AppendFieldsResponse(const char* format, ...)
+{
+	va_list args;
+	va_start(args, format);
+	m_writer.AppendFmtV(format, args);
+	va_end(args);
+}
+
+/*
+ * Between BeginSnapshot and EndSnapshot the values passed to Append-functions
+ * are only captured. The formatting is done by EndSnapshot, which should be
+ * called after the queue lock is released.
+ */
+void XmlCommand::BeginSnapshot()
+{
+	m_writer.SetDeferred(true);
+}
+
+void XmlCommand::EndSnapshot()
+{
+	m_writer.SetDeferred(false);
+}
+
 void XmlCommand::BuildErrorResponse(int errCode, const char* errText, ...)
 {
 	const char* XML_RESPONSE_ERROR_BODY =
@@ -1390,6 +1553,61 @@ void SetDownloadRateXmlCommand::Execute()
 	BuildBoolResponse(true);
 }
 
+// struct waitevents(int SinceEventId, int Timeout)
+// Responds once something has changed after the given event or when the timeout (seconds) expires
+void WaitEventsXmlCommand::Execute()
+{
+	if (!m_parsed)
+	{
+		int timeout = 0;
+		if (!NextParamAsInt(&m_since) || !NextParamAsInt(&timeout))
+		{
+			BuildErrorResponse(2, "Invalid parameter");
+			return;
+		}
+
+		m_parsed = true;
+		m_deadline = Util::CurrentTime() + std::clamp(timeout, 0, MAX_WAIT_SEC);
+		XmlRpcProcessor::CheckChanges();
+	}
+
+	int eventId;
+	int changes = XmlRpcProcessor::GetChangeFeed()->GetChanges(m_since, &eventId);
+
+	m_waiting = m_allowWait && !changes && Util::CurrentTime() < m_deadline;
+	if (m_waiting)
+	{
+		return;
+	}
+
+	const char* XML_RESPONSE_BODY =
+		"<struct>\n"
+		"<member><name>EventId</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>Queue</name><value><boolean>%s</boolean></value></member>\n"
+		"<member><name>History</name><value><boolean>%s</boolean></value></member>\n"
+		"<member><name>Log</name><value><boolean>%s</boolean></value></member>\n"
+		"<member><name>Status</name><value><boolean>%s</boolean></value></member>\n"
+		"</struct>\n";
+
+	const char* JSON_RESPONSE_BODY =
+		"{\n"
+		"\"EventId\" : %i,\n"
+		"\"Queue\" : %s,\n"
+		"\"History\" : %s,\n"
+		"\"Log\" : %s,\n"
+		"\"Status\" : %s\n"
+		"}";
+
+	AppendFmtResponse(IsJson() ? JSON_RESPONSE_BODY : XML_RESPONSE_BODY, eventId,
+		BoolToStr(changes & ChangeFeed::ecQueue), BoolToStr(changes & ChangeFeed::ecHistory),
+		BoolToStr(changes & ChangeFeed::ecLog), BoolToStr(changes & ChangeFeed::ecStatus));
+}
+
+bool WaitEventsXmlCommand::IsReady()
+{
+	return XmlRpcProcessor::GetChangeFeed()->GetEventId() != m_since || Util::CurrentTime() >= m_deadline;
+}
+
 void StatusXmlCommand::Execute()
 {
 	const char* XML_STATUS_START =
@@ -1412,6 +1630,17 @@ void StatusXmlCommand::Execute()
 		"<member><name>ArticleCacheLo</name><value><i4>%u</i4></value></member>\n"
 		"<member><name>ArticleCacheHi</name><value><i4>%u</i4></value></member>\n"
 		"<member><name>ArticleCacheMB</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheReservedMB</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheDataMB</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheSlabs</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheSlabsUsed</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheSlabSizeKB</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheSizeClasses</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheFragmentation</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheHugePages</name><value><boolean>%s</boolean></value></member>\n"
+		"<member><name>ArticleCacheFlushRate</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheFlushQueue</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>ArticleCacheFlushActive</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>DownloadRate</name><value><i4>%i</i4></value></member>\n"				// deprecated
 		"<member><name>DownloadRateLo</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>DownloadRateHi</name><value><i4>%i</i4></value></member>\n"
@@ -1448,6 +1677,16 @@ void StatusXmlCommand::Execute()
 		"<member><name>ResumeTime</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>FeedActive</name><value><boolean>%s</boolean></value></member>\n"
 		"<member><name>QueueScriptCount</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>QueueGeneration</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>HistoryGeneration</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteQueueDepth</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteReadingRequests</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteActiveRequests</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteIdleConnections</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteWaitingRequests</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteRequestCount</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteRequestTimeMs</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>RemoteRequestMaxTimeMs</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>NewsServers</name><value><array><data>\n";
 
 	const char* XML_STATUS_END =
@@ -1474,6 +1713,17 @@ void StatusXmlCommand::Execute()
 		"\"ArticleCacheLo\" : %u,\n"
 		"\"ArticleCacheHi\" : %u,\n"
 		"\"ArticleCacheMB\" : %i,\n"
+		"\"ArticleCacheReservedMB\" : %i,\n"
+		"\"ArticleCacheDataMB\" : %i,\n"
+		"\"ArticleCacheSlabs\" : %i,\n"
+		"\"ArticleCacheSlabsUsed\" : %i,\n"
+		"\"ArticleCacheSlabSizeKB\" : %i,\n"
+		"\"ArticleCacheSizeClasses\" : %i,\n"
+		"\"ArticleCacheFragmentation\" : %i,\n"
+		"\"ArticleCacheHugePages\" : %s,\n"
+		"\"ArticleCacheFlushRate\" : %i,\n"
+		"\"ArticleCacheFlushQueue\" : %i,\n"
+		"\"ArticleCacheFlushActive\" : %i,\n"
 		"\"DownloadRate\" : %i,\n"				// deprecated
 		"\"DownloadRateLo\" : %u,\n"
 		"\"DownloadRateHi\" : %u,\n"
@@ -1510,6 +1760,16 @@ void StatusXmlCommand::Execute()
 		"\"ResumeTime\" : %i,\n"
 		"\"FeedActive\" : %s,\n"
 		"\"QueueScriptCount\" : %i,\n"
+		"\"QueueGeneration\" : %i,\n"
+		"\"HistoryGeneration\" : %i,\n"
+		"\"RemoteQueueDepth\" : %i,\n"
+		"\"RemoteReadingRequests\" : %i,\n"
+		"\"RemoteActiveRequests\" : %i,\n"
+		"\"RemoteIdleConnections\" : %i,\n"
+		"\"RemoteWaitingRequests\" : %i,\n"
+		"\"RemoteRequestCount\" : %i,\n"
+		"\"RemoteRequestTimeMs\" : %i,\n"
+		"\"RemoteRequestMaxTimeMs\" : %i,\n"
 		"\"NewsServers\" : [\n";
 
 	const char* JSON_STATUS_END =
@@ -1531,6 +1791,7 @@ void StatusXmlCommand::Execute()
 	int postJobCount = 0;
 	int urlCount = 0;
 	int64 remainingSize, forcedSize;
+	int queueGeneration, historyGeneration;
 	{
 		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
 		for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
@@ -1539,6 +1800,9 @@ void StatusXmlCommand::Execute()
 			urlCount += nzbInfo->GetKind() == NzbInfo::nkUrl ? 1 : 0;
 		}
 		downloadQueue->CalcRemainingSize(&remainingSize, &forcedSize);
+		UpdateGenerations(downloadQueue);
+		queueGeneration = downloadQueue->GetQueueGeneration();
+		historyGeneration = downloadQueue->GetHistoryGeneration();
 	}
 
 	uint32 remainingSizeHi, remainingSizeLo;
@@ -1553,6 +1817,7 @@ void StatusXmlCommand::Execute()
 	uint32 articleCacheHi, articleCacheLo;
 	Util::SplitInt64(articleCache, &articleCacheHi, &articleCacheLo);
 	int articleCacheMBytes = (int)(articleCache / 1024 / 1024);
+	SlabArena::Stats arenaStats = g_ArticleCache->GetArenaStats();
 
 	int64 downloadRate = g_StatMeter->CalcCurrentDownloadSpeed();
 	uint32 downloadRateHi, downloadRateLo;
@@ -1643,12 +1908,17 @@ void StatusXmlCommand::Execute()
 	int resumeTime = (int)g_WorkState->GetResumeTime();
 	bool feedActive = g_FeedCoordinator->HasActiveDownloads();
 	int queuedScripts = g_QueueScriptCoordinator->GetQueueSize();
+	RemoteServer::Stats remoteStats = RemoteServer::GetStats();
 
 	AppendFmtResponse(IsJson() ? JSON_STATUS_START : XML_STATUS_START,
 		remainingSizeLo, remainingSizeHi, remainingMBytes, forcedSizeLo,
 		forcedSizeHi, forcedMBytes, downloadedSizeLo, downloadedSizeHi, downloadedMBytes,
 		monthSizeLo, monthSizeHi, monthMBytes, daySizeLo, daySizeHi, dayMBytes,
 		articleCacheLo, articleCacheHi, articleCacheMBytes,
+		(int)(arenaStats.capacity / 1024 / 1024), (int)(arenaStats.requestedBytes / 1024 / 1024),
+		arenaStats.slabCount, arenaStats.usedSlabs, (int)(arenaStats.slabSize / 1024),
+		arenaStats.sizeClasses, arenaStats.GetFragmentation(), BoolToStr(arenaStats.hugePages),
+		g_ArticleCache->GetFlushRate(), g_ArticleCache->GetFlushQueue(), g_ArticleCache->GetFlushActive(),
 		Util::SafeIntCast<int64, int32>(downloadRate),
 		downloadRateLo,
 		downloadRateHi,
@@ -1674,7 +1944,17 @@ void StatusXmlCommand::Execute()
 		serverTime,
 		resumeTime,
 		BoolToStr(feedActive),
-		queuedScripts
+		queuedScripts,
+		queueGeneration,
+		historyGeneration,
+		remoteStats.queueDepth,
+		remoteStats.readingRequests,
+		remoteStats.activeRequests,
+		remoteStats.idleConnections,
+		remoteStats.waitingRequests,
+		(int)remoteStats.requestCount,
+		remoteStats.requestTimeMs,
+		remoteStats.maxRequestTimeMs
 	);
 
 	int index = 0;
@@ -1863,35 +2143,38 @@ void ListFilesXmlCommand::Execute()
 
 	int index = 0;
 
-	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
-	for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
 	{
-		for (FileInfo* fileInfo : nzbInfo->GetFileList())
+		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+		BeginSnapshot();
+		for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
 		{
-			if ((nzbId > 0 && nzbId == fileInfo->GetNzbInfo()->GetId()) ||
-				(nzbId == 0 && (idStart == 0 || (idStart <= fileInfo->GetId() && fileInfo->GetId() <= idEnd))))
+			for (FileInfo* fileInfo : nzbInfo->GetFileList())
 			{
-				uint32 fileSizeHi, fileSizeLo;
-				uint32 remainingSizeLo, remainingSizeHi;
-				Util::SplitInt64(fileInfo->GetSize(), &fileSizeHi, &fileSizeLo);
-				Util::SplitInt64(fileInfo->GetRemainingSize(), &remainingSizeHi, &remainingSizeLo);
-				CString xmlNzbNicename = EncodeStr(fileInfo->GetNzbInfo()->GetName());
-
-				int progress = fileInfo->GetFailedSize() == 0 && fileInfo->GetSuccessSize() == 0 ? 0 :
-					(int)(1000 - fileInfo->GetRemainingSize() * 1000 / (fileInfo->GetSize() - fileInfo->GetMissedSize()));
-
-				AppendCondResponse(",\n", IsJson() && index++ > 0);
-				AppendFmtResponse(IsJson() ? JSON_LIST_ITEM : XML_LIST_ITEM,
-					fileInfo->GetId(), fileSizeLo, fileSizeHi, remainingSizeLo, remainingSizeHi,
-					(int)fileInfo->GetTime(), BoolToStr(fileInfo->GetFilenameConfirmed()),
-					BoolToStr(fileInfo->GetPaused()), fileInfo->GetNzbInfo()->GetId(),
-					*xmlNzbNicename, *xmlNzbNicename, *EncodeStr(fileInfo->GetNzbInfo()->GetFilename()),
-					*EncodeStr(fileInfo->GetSubject()), *EncodeStr(fileInfo->GetFilename()),
-					*EncodeStr(fileInfo->GetNzbInfo()->GetDestDir()), *EncodeStr(fileInfo->GetNzbInfo()->GetCategory()),
-					fileInfo->GetNzbInfo()->GetPriority(), fileInfo->GetActiveDownloads(), progress);
+				if ((nzbId > 0 && nzbId == fileInfo->GetNzbInfo()->GetId()) ||
+					(nzbId == 0 && (idStart == 0 || (idStart <= fileInfo->GetId() && fileInfo->GetId() <= idEnd))))
+				{
+					uint32 fileSizeHi, fileSizeLo;
+					uint32 remainingSizeLo, remainingSizeHi;
+					Util::SplitInt64(fileInfo->GetSize(), &fileSizeHi, &fileSizeLo);
+					Util::SplitInt64(fileInfo->GetRemainingSize(), &remainingSizeHi, &remainingSizeLo);
+
+					int progress = fileInfo->GetFailedSize() == 0 && fileInfo->GetSuccessSize() == 0 ? 0 :
+						(int)(1000 - fileInfo->GetRemainingSize() * 1000 / (fileInfo->GetSize() - fileInfo->GetMissedSize()));
+
+					AppendCondResponse(",\n", IsJson() && index++ > 0);
+					AppendFieldsResponse(IsJson() ? JSON_LIST_ITEM : XML_LIST_ITEM,
+						fileInfo->GetId(), fileSizeLo, fileSizeHi, remainingSizeLo, remainingSizeHi,
+						(int)fileInfo->GetTime(), BoolToStr(fileInfo->GetFilenameConfirmed()),
+						BoolToStr(fileInfo->GetPaused()), nzbInfo->GetId(),
+						nzbInfo->GetName(), nzbInfo->GetName(), nzbInfo->GetFilename(),
+						fileInfo->GetSubject(), fileInfo->GetFilename(),
+						nzbInfo->GetDestDir(), nzbInfo->GetCategory(),
+						nzbInfo->GetPriority(), fileInfo->GetActiveDownloads(), progress);
+				}
 			}
 		}
 	}
+	EndSnapshot();
 
 	AppendResponse(IsJson() ? "\n]" : "</data></array>\n");
 }
@@ -1939,6 +2222,7 @@ void NzbInfoXmlCommand::AppendNzbInfoFields(NzbInfo* nzbInfo)
 		"<member><name>ParTimeSec</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>RepairTimeSec</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>UnpackTimeSec</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>UnpackStallTimeSec</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>MessageCount</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>ExtraParBlocks</name><value><i4>%i</i4></value></member>\n"
 		"<member><name>Parameters</name><value><array><data>\n";
@@ -1995,6 +2279,7 @@ void NzbInfoXmlCommand::AppendNzbInfoFields(NzbInfo* nzbInfo)
 		"\"ParTimeSec\" : %i,\n"
 		"\"RepairTimeSec\" : %i,\n"
 		"\"UnpackTimeSec\" : %i,\n"
+		"\"UnpackStallTimeSec\" : %i,\n"
 		"\"MessageCount\" : %i,\n"
 		"\"ExtraParBlocks\" : %i,\n"
 		"\"Parameters\" : [\n";
@@ -2068,14 +2353,13 @@ void NzbInfoXmlCommand::AppendNzbInfoFields(NzbInfo* nzbInfo)
 
 	int messageCount = nzbInfo->GetMessageCount() > 0 ? nzbInfo->GetMessageCount() : nzbInfo->GetCachedMessageCount();
 
-	CString xmlNzbNicename = EncodeStr(nzbInfo->GetName());
 	const char* exParStatus = nzbInfo->GetExtraParBlocks() > 0 ? "RECIPIENT" : nzbInfo->GetExtraParBlocks() < 0 ? "DONOR" : "NONE";
 
-	AppendFmtResponse(IsJson() ? JSON_NZB_ITEM_START : XML_NZB_ITEM_START,
-			nzbInfo->GetId(), *xmlNzbNicename, *xmlNzbNicename, kindName[nzbInfo->GetKind()],
-			*EncodeStr(nzbInfo->GetUrl()), *EncodeStr(nzbInfo->GetFilename()),
-			*EncodeStr(nzbInfo->GetDestDir()), *EncodeStr(nzbInfo->GetFinalDir()),
-			*EncodeStr(nzbInfo->GetCategory()), parStatusName[nzbInfo->GetParStatus()], exParStatus,
+	AppendFieldsResponse(IsJson() ? JSON_NZB_ITEM_START : XML_NZB_ITEM_START,
+			nzbInfo->GetId(), nzbInfo->GetName(), nzbInfo->GetName(), kindName[nzbInfo->GetKind()],
+			nzbInfo->GetUrl(), nzbInfo->GetFilename(),
+			nzbInfo->GetDestDir(), nzbInfo->GetFinalDir(),
+			nzbInfo->GetCategory(), parStatusName[nzbInfo->GetParStatus()], exParStatus,
 			unpackStatusName[nzbInfo->GetUnpackStatus()], moveStatusName[nzbInfo->GetMoveStatus()],
 			scriptStatusName[nzbInfo->GetScriptStatuses()->CalcTotalStatus()],
 			deleteStatusName[nzbInfo->GetDeleteStatus()], markStatusName[nzbInfo->GetMarkStatus()],
@@ -2084,20 +2368,21 @@ void NzbInfoXmlCommand::AppendNzbInfoFields(NzbInfo* nzbInfo)
 			(int)nzbInfo->GetMinTime(), (int)nzbInfo->GetMaxTime(),
 			nzbInfo->GetTotalArticles(), nzbInfo->GetCurrentSuccessArticles(), nzbInfo->GetCurrentFailedArticles(),
 			nzbInfo->CalcHealth(), nzbInfo->CalcCriticalHealth(false),
-			*EncodeStr(nzbInfo->GetDupeKey()), nzbInfo->GetDupeScore(), dupeModeName[nzbInfo->GetDupeMode()],
+			nzbInfo->GetDupeKey(), nzbInfo->GetDupeScore(), dupeModeName[nzbInfo->GetDupeMode()],
 			BoolToStr(nzbInfo->GetDeleteStatus() != NzbInfo::dsNone),
 			downloadedSizeLo, downloadedSizeHi, downloadedSizeMB, nzbInfo->GetDownloadSec(),
 			(int)(nzbInfo->GetPostTotalSec() + (nzbInfo->GetPostInfo() && nzbInfo->GetPostInfo()->GetStartTime() ?
 				Util::CurrentTime() - nzbInfo->GetPostInfo()->GetStartTime() : 0)),
-			nzbInfo->GetParSec(), nzbInfo->GetRepairSec(), nzbInfo->GetUnpackSec(), messageCount, nzbInfo->GetExtraParBlocks());
+			nzbInfo->GetParSec(), nzbInfo->GetRepairSec(), nzbInfo->GetUnpackSec(), nzbInfo->GetUnpackStallSec(),
+			messageCount, nzbInfo->GetExtraParBlocks());
 
 	// Post-processing parameters
 	int paramIndex = 0;
 	for (NzbParameter& parameter : nzbInfo->GetParameters())
 	{
 		AppendCondResponse(",\n", IsJson() && paramIndex++ > 0);
-		AppendFmtResponse(IsJson() ? JSON_PARAMETER_ITEM : XML_PARAMETER_ITEM,
-			*EncodeStr(parameter.GetName()), *EncodeStr(parameter.GetValue()));
+		AppendFieldsResponse(IsJson() ? JSON_PARAMETER_ITEM : XML_PARAMETER_ITEM,
+			parameter.GetName(), parameter.GetValue());
 	}
 
 	AppendResponse(IsJson() ? JSON_NZB_ITEM_SCRIPT_START : XML_NZB_ITEM_SCRIPT_START);
@@ -2107,8 +2392,8 @@ void NzbInfoXmlCommand::AppendNzbInfoFields(NzbInfo* nzbInfo)
 	for (ScriptStatus& scriptStatus : nzbInfo->GetScriptStatuses())
 	{
 		AppendCondResponse(",\n", IsJson() && scriptIndex++ > 0);
-		AppendFmtResponse(IsJson() ? JSON_SCRIPT_ITEM : XML_SCRIPT_ITEM,
-			*EncodeStr(scriptStatus.GetName()), *EncodeStr(scriptStatusName[scriptStatus.GetStatus()]));
+		AppendFieldsResponse(IsJson() ? JSON_SCRIPT_ITEM : XML_SCRIPT_ITEM,
+			scriptStatus.GetName(), scriptStatusName[scriptStatus.GetStatus()]);
 	}
 
 	AppendResponse(IsJson() ? JSON_NZB_ITEM_STATS_START : XML_NZB_ITEM_STATS_START);
@@ -2118,7 +2403,7 @@ void NzbInfoXmlCommand::AppendNzbInfoFields(NzbInfo* nzbInfo)
 	for (ServerStat& serverStat : nzbInfo->GetCurrentServerStats())
 	{
 		AppendCondResponse(",\n", IsJson() && statIndex++ > 0);
-		AppendFmtResponse(IsJson() ? JSON_STAT_ITEM : XML_STAT_ITEM,
+		AppendFieldsResponse(IsJson() ? JSON_STAT_ITEM : XML_STAT_ITEM,
 				 serverStat.GetServerId(), serverStat.GetSuccessArticles(), serverStat.GetFailedArticles());
 	}
 
@@ -2187,14 +2472,14 @@ void NzbInfoXmlCommand::AppendPostInfoFields(PostInfo* postInfo, int logEntries,
 	{
 		time_t curTime = Util::CurrentTime();
 
-		AppendFmtResponse(itemStart, *EncodeStr(postInfo->GetProgressLabel()),
+		AppendFieldsResponse(itemStart, postInfo->GetProgressLabel(),
 			postInfo->GetStageProgress(),
 			(int)(postInfo->GetStageTime() ? curTime - postInfo->GetStageTime() : 0),
 			(int)(postInfo->GetStartTime() ? curTime - postInfo->GetStartTime() : 0));
 	}
 	else
 	{
-		AppendFmtResponse(itemStart, "NONE", "", 0, 0, 0, 0);
+		AppendFieldsResponse(itemStart, "NONE", 0, 0, 0);
 	}
 
 	AppendResponse(IsJson() ? JSON_LOG_START : XML_LOG_START);
@@ -2216,9 +2501,9 @@ void NzbInfoXmlCommand::AppendPostInfoFields(PostInfo* postInfo, int logEntries,
 				Message& message = messages->at(i);
 
 				AppendCondResponse(",\n", IsJson() && index++ > 0);
-				AppendFmtResponse(IsJson() ? JSON_LOG_ITEM : XML_LOG_ITEM,
+				AppendFieldsResponse(IsJson() ? JSON_LOG_ITEM : XML_LOG_ITEM,
 					message.GetId(), messageType[message.GetKind()], (int)message.GetTime(),
-					*EncodeStr(message.GetText()));
+					message.GetText());
 			}
 		}
 	}
@@ -2226,13 +2511,65 @@ void NzbInfoXmlCommand::AppendPostInfoFields(PostInfo* postInfo, int logEntries,
 	AppendResponse(IsJson() ? JSON_POSTQUEUE_ITEM_END : XML_POSTQUEUE_ITEM_END);
 }
 
+/*
+ * Delta response for clients tracking changes of queue or history:
+ *   Generation - to pass as parameter "Since" in the next call;
+ *   Full - "Items" contains all entries, the client must drop entries it knows from earlier calls
+ *     (happens if "Since" is too old or is from before a restart);
+ *   Deleted - ids of entries removed since the given generation, to be applied before "Items";
+ *   Order - ids of all entries in queue order (listgroups only);
+ *   Items - entries changed or added since the given generation, in the usual format.
+ */
+void NzbInfoXmlCommand::AppendDeltaStart(int generation, bool full, IdList* deleted, IdList* order)
+{
+	AppendFieldsResponse(IsJson() ? "{\n\"Generation\" : %i,\n\"Full\" : %s,\n" :
+		"<struct>\n<member><name>Generation</name><value><i4>%i</i4></value></member>\n"
+		"<member><name>Full</name><value><boolean>%s</boolean></value></member>\n",
+		generation, BoolToStr(full));
+
+	if (!full)
+	{
+		AppendIdList("Deleted", deleted);
+	}
+
+	if (order)
+	{
+		AppendIdList("Order", order);
+	}
+
+	AppendResponse(IsJson() ? "\"Items\" : [\n" : "<member><name>Items</name><value><array><data>\n");
+}
+
+void NzbInfoXmlCommand::AppendDeltaEnd()
+{
+	AppendResponse(IsJson() ? "\n]\n}" : "</data></array></value></member>\n</struct>\n");
+}
+
+void NzbInfoXmlCommand::AppendIdList(const char* name, IdList* idList)
+{
+	AppendFieldsResponse(IsJson() ? "\"%s\" : [" : "<member><name>%s</name><value><array><data>\n", name);
+
+	int index = 0;
+	for (int id : *idList)
+	{
+		AppendCondResponse(", ", IsJson() && index++ > 0);
+		AppendFieldsResponse(IsJson() ? "%i" : "<value><i4>%i</i4></value>\n", id);
+	}
+
+	AppendResponse(IsJson() ? "],\n" : "</data></array></value></member>\n");
+}
+
 // struct[] listgroups(int NumberOfLogEntries)
+// struct listgroups(int NumberOfLogEntries, int Since)
+// With parameter "Since" (generation from a previous response) only changed groups are returned,
+// see NzbInfoXmlCommand::AppendDeltaStart.
 void ListGroupsXmlCommand::Execute()
 {
 	int nrEntries = 0;
 	NextParamAsInt(&nrEntries);
 
-	AppendResponse(IsJson() ? "[\n" : "<array><data>\n");
+	int since = 0;
+	bool delta = NextParamAsInt(&since);
 
 	const char* XML_LIST_ITEM_START =
 		"<value><struct>\n"
@@ -2275,33 +2612,75 @@ void ListGroupsXmlCommand::Execute()
 		"}";
 
 	int index = 0;
+	bool full = true;
 
-	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
-	for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
 	{
-		uint32 remainingSizeLo, remainingSizeHi, remainingSizeMB;
-		uint32 pausedSizeLo, pausedSizeHi, pausedSizeMB;
-		Util::SplitInt64(nzbInfo->GetRemainingSize(), &remainingSizeHi, &remainingSizeLo);
-		remainingSizeMB = (int)(nzbInfo->GetRemainingSize() / 1024 / 1024);
-		Util::SplitInt64(nzbInfo->GetPausedSize(), &pausedSizeHi, &pausedSizeLo);
-		pausedSizeMB = (int)(nzbInfo->GetPausedSize() / 1024 / 1024);
-		const char* status = DetectStatus(nzbInfo);
+		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+		BeginSnapshot();
 
-		AppendCondResponse(",\n", IsJson() && index++ > 0);
-		AppendFmtResponse(IsJson() ? JSON_LIST_ITEM_START : XML_LIST_ITEM_START,
-			nzbInfo->GetId(), nzbInfo->GetId(), remainingSizeLo, remainingSizeHi, remainingSizeMB,
-			pausedSizeLo, pausedSizeHi, pausedSizeMB, (int)nzbInfo->GetFileList()->size(),
-			nzbInfo->GetRemainingParCount(), nzbInfo->GetPriority(), nzbInfo->GetPriority(),
-			nzbInfo->GetActiveDownloads(), status);
+		if (delta)
+		{
+			UpdateGenerations(downloadQueue);
+			IdList deleted;
+			full = since > downloadQueue->GetGeneration() || !downloadQueue->GetQueueDeleted(since, &deleted);
+			IdList order;
+			for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
+			{
+				order.push_back(nzbInfo->GetId());
+			}
+			AppendDeltaStart(downloadQueue->GetGeneration(), full, &deleted, &order);
+		}
+		else
+		{
+			AppendResponse(IsJson() ? "[\n" : "<array><data>\n");
+		}
 
-		AppendNzbInfoFields(nzbInfo);
-		AppendCondResponse(",\n", IsJson());
-		AppendPostInfoFields(nzbInfo->GetPostInfo(), nrEntries, false);
+		for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
+		{
+			if (!full && nzbInfo->GetChangeGen() <= since)
+			{
+				continue;
+			}
+
+			uint32 remainingSizeLo, remainingSizeHi, remainingSizeMB;
+			uint32 pausedSizeLo, pausedSizeHi, pausedSizeMB;
+			Util::SplitInt64(nzbInfo->GetRemainingSize(), &remainingSizeHi, &remainingSizeLo);
+			remainingSizeMB = (int)(nzbInfo->GetRemainingSize() / 1024 / 1024);
+			Util::SplitInt64(nzbInfo->GetPausedSize(), &pausedSizeHi, &pausedSizeLo);
+			pausedSizeMB = (int)(nzbInfo->GetPausedSize() / 1024 / 1024);
+			const char* status = DetectStatus(nzbInfo);
+
+			AppendCondResponse(",\n", IsJson() && index++ > 0);
+			AppendFieldsResponse(IsJson() ? JSON_LIST_ITEM_START : XML_LIST_ITEM_START,
+				nzbInfo->GetId(), nzbInfo->GetId(), remainingSizeLo, remainingSizeHi, remainingSizeMB,
+				pausedSizeLo, pausedSizeHi, pausedSizeMB, (int)nzbInfo->GetFileList()->size(),
+				nzbInfo->GetRemainingParCount(), nzbInfo->GetPriority(), nzbInfo->GetPriority(),
+				nzbInfo->GetActiveDownloads(), status);
+
+			AppendNzbInfoFields(nzbInfo);
+			AppendCondResponse(",\n", IsJson());
+			AppendPostInfoFields(nzbInfo->GetPostInfo(), nrEntries, false);
 
-		AppendResponse(IsJson() ? JSON_LIST_ITEM_END : XML_LIST_ITEM_END);
+			AppendResponse(IsJson() ? JSON_LIST_ITEM_END : XML_LIST_ITEM_END);
+		}
 	}
+	EndSnapshot();
 
-	AppendResponse(IsJson() ? "\n]" : "</data></array>\n");
+	if (delta)
+	{
+		AppendDeltaEnd();
+	}
+	else
+	{
+		AppendResponse(IsJson() ? "\n]" : "</data></array>\n");
+	}
+}
+
+int ListGroupsXmlCommand::GetStateGeneration()
+{
+	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+	UpdateGenerations(downloadQueue);
+	return downloadQueue->GetQueueGeneration();
 }
 
 const char* ListGroupsXmlCommand::DetectStatus(NzbInfo* nzbInfo)
@@ -2700,26 +3079,30 @@ void PostQueueXmlCommand::Execute()
 
 	int index = 0;
 
-	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
-	for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
 	{
-		PostInfo* postInfo = nzbInfo->GetPostInfo();
-		if (!postInfo)
+		GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+		BeginSnapshot();
+		for (NzbInfo* nzbInfo : downloadQueue->GetQueue())
 		{
-			continue;
-		}
+			PostInfo* postInfo = nzbInfo->GetPostInfo();
+			if (!postInfo)
+			{
+				continue;
+			}
 
-		AppendCondResponse(",\n", IsJson() && index++ > 0);
-		AppendFmtResponse(IsJson() ? JSON_POSTQUEUE_ITEM_START : XML_POSTQUEUE_ITEM_START,
-			nzbInfo->GetId(), *EncodeStr(postInfo->GetNzbInfo()->GetName()),
-			postStageName[postInfo->GetStage()], postInfo->GetFileProgress());
+			AppendCondResponse(",\n", IsJson() && index++ > 0);
+			AppendFieldsResponse(IsJson() ? JSON_POSTQUEUE_ITEM_START : XML_POSTQUEUE_ITEM_START,
+				nzbInfo->GetId(), postInfo->GetNzbInfo()->GetName(),
+				postStageName[postInfo->GetStage()], postInfo->GetFileProgress());
 
-		AppendNzbInfoFields(postInfo->GetNzbInfo());
-		AppendCondResponse(",\n", IsJson());
-		AppendPostInfoFields(postInfo, nrEntries, true);
+			AppendNzbInfoFields(postInfo->GetNzbInfo());
+			AppendCondResponse(",\n", IsJson());
+			AppendPostInfoFields(postInfo, nrEntries, true);
 
-		AppendResponse(IsJson() ? JSON_POSTQUEUE_ITEM_END : XML_POSTQUEUE_ITEM_END);
+			AppendResponse(IsJson() ? JSON_POSTQUEUE_ITEM_END : XML_POSTQUEUE_ITEM_END);
+		}
 	}
+	EndSnapshot();
 
 	AppendResponse(IsJson() ? "\n]" : "</data></array>\n");
 }
@@ -2785,11 +3168,199 @@ void ScanXmlCommand::Execute()
 }
 
 // struct[] history(bool hidden)
-// Parameter "hidden" is optional (new in v12)
+// struct history(bool hidden, int Since)
+// struct history(bool hidden, int Since, int Offset, int Limit, string Sort, string Category, string Status, string Name)
+// Parameter "hidden" is optional (new in v12).
+// With parameter "Since" (generation from a previous response, -1 if not used) only changed entries are returned,
+// see NzbInfoXmlCommand::AppendDeltaStart. Entries are ordered by "HistoryTime", newest first.
+// With paging parameters one page of matching entries is returned, see HistoryXmlCommand::ExecuteQuery.
 void HistoryXmlCommand::Execute()
 {
-	AppendResponse(IsJson() ? "[\n" : "<array><data>\n");
+	bool dup = false;
+	NextParamAsBool(&dup);
+
+	int since = -1;
+	NextParamAsInt(&since);
+	bool delta = since >= 0;
+
+	int offset = 0;
+	if (NextParamAsInt(&offset))
+	{
+		if (delta)
+		{
+			BuildErrorResponse(2, "Invalid parameter (Since can't be combined with paging)");
+			return;
+		}
+		ExecuteQuery(dup, offset);
+		return;
+	}
+
+	int index = 0;
+	bool full = true;
+
+	{
+		GuardedDownloadQueue guard = DownloadQueue::Guard();
+		BeginSnapshot();
+
+		if (delta)
+		{
+			UpdateGenerations(guard);
+			IdList deleted;
+			full = since > guard->GetGeneration() || !guard->GetHistoryDeleted(since, &deleted);
+			if (!full && !dup)
+			{
+				// hiding an entry replaces it with a dup-entry having the same id
+				for (HistoryInfo* historyInfo : guard->GetHistory())
+				{
+					if (historyInfo->GetKind() == HistoryInfo::hkDup && historyInfo->GetChangeGen() > since)
+					{
+						deleted.push_back(historyInfo->GetId());
+					}
+				}
+			}
+			AppendDeltaStart(guard->GetGeneration(), full, &deleted, nullptr);
+		}
+		else
+		{
+			AppendResponse(IsJson() ? "[\n" : "<array><data>\n");
+		}
+
+		for (HistoryInfo* historyInfo : guard->GetHistory())
+		{
+			if ((historyInfo->GetKind() == HistoryInfo::hkDup && !dup) ||
+				(!full && historyInfo->GetChangeGen() <= since))
+			{
+				continue;
+			}
+
+			AppendCondResponse(",\n", IsJson() && index++ > 0);
+			AppendHistoryItem(historyInfo);
+		}
+	}
+	EndSnapshot();
+
+	if (delta)
+	{
+		AppendDeltaEnd();
+	}
+	else
+	{
+		AppendResponse(IsJson() ? "\n]" : "</data></array>\n");
+	}
+}
+
+/*
+ * Paging, sorting and filtering. Remaining parameters, all optional:
+ *   Limit - maximum number of entries to return, 0 - no limit;
+ *   Sort - "time", "name", "category" or "size", prefix "-" for descending order;
+ *     default is the order of history list (newest first);
+ *   Category - only entries of this category;
+ *   Status - only entries whose status begins with this text, e.g. "FAILURE" or "SUCCESS/ALL";
+ *   Name - only entries containing this text in the name.
+ * Returns struct with fields "Total" (number of matching entries) and "Items" (the page).
+ * Entries are picked from secondary indexes of DownloadQueue, which makes a page cost O(page size)
+ * unless filtered by name.
+ */
+void HistoryXmlCommand::ExecuteQuery(bool dup, int offset)
+{
+	int limit = 0;
+	NextParamAsInt(&limit);
 
+	char* sortName = nullptr;
+	char* category = nullptr;
+	char* status = nullptr;
+	char* name = nullptr;
+	for (char** param : {&sortName, &category, &status, &name})
+	{
+		if (NextParamAsStr(param))
+		{
+			DecodeStr(*param);
+		}
+	}
+
+	bool descending = sortName && *sortName == '-';
+	const char* sortKey = sortName ? sortName + (descending ? 1 : 0) : "";
+	DownloadQueue::EHistorySort sort = DownloadQueue::hsNone;
+	if (!strcasecmp(sortKey, "time"))
+	{
+		sort = DownloadQueue::hsTime;
+	}
+	else if (!strcasecmp(sortKey, "name"))
+	{
+		sort = DownloadQueue::hsName;
+	}
+	else if (!strcasecmp(sortKey, "category"))
+	{
+		sort = DownloadQueue::hsCategory;
+	}
+	else if (!strcasecmp(sortKey, "size"))
+	{
+		sort = DownloadQueue::hsSize;
+	}
+	else if (*sortKey)
+	{
+		BuildErrorResponse(2, "Invalid parameter (Sort)");
+		return;
+	}
+
+	offset = std::max(offset, 0);
+	limit = limit > 0 ? limit : std::numeric_limits<int>::max();
+
+	int total = 0;
+	int index = 0;
+
+	{
+		GuardedDownloadQueue guard = DownloadQueue::Guard();
+		UpdateGenerations(guard);
+		BeginSnapshot();
+		RawHistoryList* list = guard->GetHistoryIndex(sort, dup, category, status);
+
+		auto nameMatch = [name](HistoryInfo* historyInfo)
+		{
+			const char* entryName = historyInfo->GetName();
+			const char* end = entryName + strlen(entryName);
+			return std::search(entryName, end, name, name + strlen(name),
+				[](char a, char b) { return tolower((uchar)a) == tolower((uchar)b); }) != end;
+		};
+
+		AppendResponse(IsJson() ? "{\n\"Items\" : [\n" : "<struct>\n<member><name>Items</name><value><array><data>\n");
+
+		if (Util::EmptyStr(name))
+		{
+			total = (int)list->size();
+			for (int i = offset; i < total && i - offset < limit; i++)
+			{
+				AppendCondResponse(",\n", IsJson() && index++ > 0);
+				AppendHistoryItem(list->at(descending ? total - 1 - i : i));
+			}
+		}
+		else
+		{
+			int count = (int)list->size();
+			for (int i = 0; i < count; i++)
+			{
+				HistoryInfo* historyInfo = list->at(descending ? count - 1 - i : i);
+				if (nameMatch(historyInfo))
+				{
+					if (total >= offset && total - offset < limit)
+					{
+						AppendCondResponse(",\n", IsJson() && index++ > 0);
+						AppendHistoryItem(historyInfo);
+					}
+					total++;
+				}
+			}
+		}
+	}
+	EndSnapshot();
+
+	AppendFmtResponse(IsJson() ? "\n],\n\"Total\" : %i\n}" :
+		"</data></array></value></member>\n<member><name>Total</name><value><i4>%i</i4></value></member>\n</struct>\n",
+		total);
+}
+
+void HistoryXmlCommand::AppendHistoryItem(HistoryInfo* historyInfo)
+{
 	const char* XML_HISTORY_ITEM_START =
 		"<value><struct>\n"
 		"<member><name>ID</name><value><i4>%i</i4></value></member>\n"					// Deprecated, use "NZBID" instead
@@ -2851,79 +3422,48 @@ void HistoryXmlCommand::Execute()
 	const char* dupStatusName[] = { "UNKNOWN", "SUCCESS", "FAILURE", "DELETED", "DUPE", "BAD", "GOOD" };
 	const char* dupeModeName[] = { "SCORE", "ALL", "FORCE" };
 
-	bool dup = false;
-	NextParamAsBool(&dup);
+	NzbInfo* nzbInfo = nullptr;
 
-	int index = 0;
+	const char* status = historyInfo->MakeTextStatus();
 
-	GuardedDownloadQueue guard = DownloadQueue::Guard();
-	for (HistoryInfo* historyInfo : guard->GetHistory())
+	if (historyInfo->GetKind() == HistoryInfo::hkNzb ||
+		historyInfo->GetKind() == HistoryInfo::hkUrl)
 	{
-		if (historyInfo->GetKind() == HistoryInfo::hkDup && !dup)
-		{
-			continue;
-		}
-
-		NzbInfo* nzbInfo = nullptr;
+		nzbInfo = historyInfo->GetNzbInfo();
 
-		const char* status = DetectStatus(historyInfo);
-
-		AppendCondResponse(",\n", IsJson() && index++ > 0);
-
-		if (historyInfo->GetKind() == HistoryInfo::hkNzb ||
-			historyInfo->GetKind() == HistoryInfo::hkUrl)
-		{
-			nzbInfo = historyInfo->GetNzbInfo();
+		AppendFieldsResponse(IsJson() ? JSON_HISTORY_ITEM_START : XML_HISTORY_ITEM_START,
+			historyInfo->GetId(), historyInfo->GetName(), nzbInfo->GetParkedFileCount(),
+			BoolToStr(nzbInfo->GetCompletedFiles()->size()), (int)historyInfo->GetTime(), status);
+	}
+	else if (historyInfo->GetKind() == HistoryInfo::hkDup)
+	{
+		DupInfo* dupInfo = historyInfo->GetDupInfo();
 
-			AppendFmtResponse(IsJson() ? JSON_HISTORY_ITEM_START : XML_HISTORY_ITEM_START,
-				historyInfo->GetId(), *EncodeStr(historyInfo->GetName()), nzbInfo->GetParkedFileCount(),
-				BoolToStr(nzbInfo->GetCompletedFiles()->size()), (int)historyInfo->GetTime(), status);
-		}
-		else if (historyInfo->GetKind() == HistoryInfo::hkDup)
-		{
-			DupInfo* dupInfo = historyInfo->GetDupInfo();
-
-			uint32 fileSizeHi, fileSizeLo, fileSizeMB;
-			Util::SplitInt64(dupInfo->GetSize(), &fileSizeHi, &fileSizeLo);
-			fileSizeMB = (int)(dupInfo->GetSize() / 1024 / 1024);
-
-			AppendFmtResponse(IsJson() ? JSON_HISTORY_DUP_ITEM : XML_HISTORY_DUP_ITEM,
-				historyInfo->GetId(), historyInfo->GetId(), "DUP", *EncodeStr(historyInfo->GetName()),
-				(int)historyInfo->GetTime(), fileSizeLo, fileSizeHi, fileSizeMB,
-				*EncodeStr(dupInfo->GetDupeKey()), dupInfo->GetDupeScore(),
-				dupeModeName[dupInfo->GetDupeMode()], dupStatusName[dupInfo->GetStatus()],
-				status);
-		}
+		uint32 fileSizeHi, fileSizeLo, fileSizeMB;
+		Util::SplitInt64(dupInfo->GetSize(), &fileSizeHi, &fileSizeLo);
+		fileSizeMB = (int)(dupInfo->GetSize() / 1024 / 1024);
 
-		if (nzbInfo)
-		{
-			AppendNzbInfoFields(nzbInfo);
-		}
+		AppendFieldsResponse(IsJson() ? JSON_HISTORY_DUP_ITEM : XML_HISTORY_DUP_ITEM,
+			historyInfo->GetId(), historyInfo->GetId(), "DUP", historyInfo->GetName(),
+			(int)historyInfo->GetTime(), fileSizeLo, fileSizeHi, fileSizeMB,
+			dupInfo->GetDupeKey(), dupInfo->GetDupeScore(),
+			dupeModeName[dupInfo->GetDupeMode()], dupStatusName[dupInfo->GetStatus()],
+			status);
+	}
 
-		AppendResponse(IsJson() ? JSON_HISTORY_ITEM_END : XML_HISTORY_ITEM_END);
+	if (nzbInfo)
+	{
+		AppendNzbInfoFields(nzbInfo);
 	}
 
-	AppendResponse(IsJson() ? "\n]" : "</data></array>\n");
+	AppendResponse(IsJson() ? JSON_HISTORY_ITEM_END : XML_HISTORY_ITEM_END);
 }
 
-const char* HistoryXmlCommand::DetectStatus(HistoryInfo* historyInfo)
+int HistoryXmlCommand::GetStateGeneration()
 {
-	const char* status = "FAILURE/INTERNAL_ERROR";
-
-	if (historyInfo->GetKind() == HistoryInfo::hkNzb || historyInfo->GetKind() == HistoryInfo::hkUrl)
-	{
-		NzbInfo* nzbInfo = historyInfo->GetNzbInfo();
-		status = nzbInfo->MakeTextStatus(false);
-	}
-	else if (historyInfo->GetKind() == HistoryInfo::hkDup)
-	{
-		DupInfo* dupInfo = historyInfo->GetDupInfo();
-		const char* dupStatusName[] = { "FAILURE/INTERNAL_ERROR", "SUCCESS/HIDDEN", "FAILURE/HIDDEN",
-			"DELETED/MANUAL", "DELETED/DUPE", "FAILURE/BAD", "SUCCESS/GOOD" };
-		status = dupStatusName[dupInfo->GetStatus()];
-	}
-
-	return status;
+	GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+	UpdateGenerations(downloadQueue);
+	return downloadQueue->GetHistoryGeneration();
 }
 
 // Deprecated in v13
@@ -3950,7 +4490,8 @@ void TestServerXmlCommand::Execute()
 		0,
 		0,
 		false,
-		params.certVerifLevel
+		params.certVerifLevel,
+		1
 	);
 	TestConnection connection(&server, this);
 	connection.SetTimeout(params.timeout == 0 ? g_Options->GetArticleTimeout() : params.timeout);
@@ -24,6 +24,8 @@
 #include "NString.h"
 #include "Connection.h"
 #include "Util.h"
+#include "ResponseWriter.h"
+#include "ChangeFeed.h"
 
 class XmlCommand;
 
@@ -60,6 +62,16 @@ public:
 	const char* GetContentType() { return m_contentType; }
 	static bool IsRpcRequest(const char* url);
 	bool IsSafeMethod() { return m_safeMethod; };
+	void SetOldETag(const char* oldETag) { m_oldETag = oldETag; }
+	// entity tag known without hashing the response, nullptr if not available for the method
+	const char* GetETag() { return m_eTag.Empty() ? nullptr : *m_eTag; }
+	// the request waits for an event, the response is built by Resume() once IsReady() returns true
+	bool IsWaiting() { return (bool)m_waitCommand; }
+	bool IsReady();
+	void Resume();
+	// samples the state for waiting clients, at most once per interval set by option "RemoteEventInterval"
+	static void CheckChanges();
+	static ChangeFeed* GetChangeFeed() { return &m_changeFeed; }
 
 private:
 	char* m_request = nullptr;
@@ -70,6 +82,13 @@ private:
 	CString m_url;
 	StringBuilder m_response;
 	bool m_safeMethod = false;
+	const char* m_oldETag = nullptr;
+	BString<100> m_eTag;
+	std::unique_ptr<XmlCommand> m_waitCommand;
+	BString<100> m_waitRequestId;
+
+	inline static ChangeFeed m_changeFeed;
+	inline static std::atomic<int64> m_lastCheck{0};
 
 	void Dispatch();
 	std::unique_ptr<XmlCommand> CreateCommand(const char* methodName);
@@ -86,7 +105,7 @@ public:
 	virtual void Execute() = 0;
 	void PrepareParams();
 	void SetRequest(char* request) { m_request = request; m_requestPtr = m_request; }
-	void SetProtocol(XmlRpcProcessor::ERpcProtocol protocol) { m_protocol = protocol; }
+	void SetProtocol(XmlRpcProcessor::ERpcProtocol protocol) { m_protocol = protocol; m_writer.SetJson(IsJson()); }
 	void SetHttpMethod(XmlRpcProcessor::EHttpMethod httpMethod) { m_httpMethod = httpMethod; }
 	void SetUserAccess(XmlRpcProcessor::EUserAccess userAccess) { m_userAccess = userAccess; }
 	const char* GetResponse() { return m_response; }
@@ -94,16 +113,24 @@ public:
 	bool GetFault() { return m_fault; }
 	virtual bool IsSafeMethod() { return false; };
 	virtual bool IsError() { return false; };
+	// generation of the data the response is built from, 0 if the method doesn't track generations
+	virtual int GetStateGeneration() { return 0; }
+	// a waiting command has no response yet and is executed again once ready
+	virtual bool IsWaiting() { return false; }
+	virtual bool IsReady() { return true; }
+	void SetAllowWait(bool allowWait) { m_allowWait = allowWait; }
 
 protected:
 	char* m_request = nullptr;
 	char* m_requestPtr = nullptr;
 	char* m_callbackFunc = nullptr;
 	StringBuilder m_response;
+	ResponseWriter m_writer{m_response};
 	bool m_fault = false;
 	XmlRpcProcessor::ERpcProtocol m_protocol = XmlRpcProcessor::rpUndefined;
 	XmlRpcProcessor::EHttpMethod m_httpMethod;
 	XmlRpcProcessor::EUserAccess m_userAccess;
+	bool m_allowWait = false;
 
 	void BuildErrorResponse(int errCode, const char* errText, ...);
 	void BuildBoolResponse(bool ok);
@@ -111,6 +138,9 @@ protected:
 	void AppendResponse(const char* part);
 	void AppendFmtResponse(const char* format, ...);
 	void AppendCondResponse(const char* part, bool cond);
+	void AppendFieldsResponse(const char* format, ...) PRINTF_SYNTAX(2);
+	void BeginSnapshot();
+	void EndSnapshot();
 	bool IsJson();
 	bool NextParamAsInt(int* value);
 	bool NextParamAsBool(bool* value);
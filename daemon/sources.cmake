@@ -60,6 +60,7 @@ set(SRC
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/ParParser.cpp
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/ParRenamer.cpp
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/PrePostProcessor.cpp
+	${CMAKE_SOURCE_DIR}/daemon/postprocess/PostStageLimiter.cpp
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/RarReader.cpp
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/RarRenamer.cpp
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/Rename.cpp
@@ -67,11 +68,13 @@ set(SRC
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/UnpackController.cpp
 	${CMAKE_SOURCE_DIR}/daemon/postprocess/PostUnpackRenamer.cpp
 
+	${CMAKE_SOURCE_DIR}/daemon/queue/BlockVerifier.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/DirectRenamer.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/DiskState.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/DownloadInfo.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/DupeCoordinator.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/HistoryCoordinator.cpp
+	${CMAKE_SOURCE_DIR}/daemon/queue/NzbDirWatcher.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/NzbFile.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/QueueCoordinator.cpp
 	${CMAKE_SOURCE_DIR}/daemon/queue/QueueEditor.cpp
@@ -80,8 +83,10 @@ set(SRC
 	${CMAKE_SOURCE_DIR}/daemon/queue/Deobfuscation.cpp
 
 	${CMAKE_SOURCE_DIR}/daemon/remote/BinRpc.cpp
+	${CMAKE_SOURCE_DIR}/daemon/remote/ChangeFeed.cpp
 	${CMAKE_SOURCE_DIR}/daemon/remote/RemoteClient.cpp
 	${CMAKE_SOURCE_DIR}/daemon/remote/RemoteServer.cpp
+	${CMAKE_SOURCE_DIR}/daemon/remote/ResponseWriter.cpp
 	${CMAKE_SOURCE_DIR}/daemon/remote/WebServer.cpp
 	${CMAKE_SOURCE_DIR}/daemon/remote/XmlRpc.cpp
 	${CMAKE_SOURCE_DIR}/daemon/remote/MessageBase.h
@@ -97,6 +102,9 @@ set(SRC
 	${CMAKE_SOURCE_DIR}/daemon/util/Json.cpp
 	${CMAKE_SOURCE_DIR}/daemon/util/Xml.cpp
 	${CMAKE_SOURCE_DIR}/daemon/util/Benchmark.cpp
+	${CMAKE_SOURCE_DIR}/daemon/util/SlabArena.cpp
+	${CMAKE_SOURCE_DIR}/daemon/util/AsyncWriter.cpp
+	${CMAKE_SOURCE_DIR}/daemon/util/FileMover.cpp
 	${CMAKE_SOURCE_DIR}/daemon/util/DataAnalytics.cpp
 	${CMAKE_SOURCE_DIR}/daemon/util/OpenSSL.cpp
 	${CMAKE_SOURCE_DIR}/daemon/util/SevenZip.cpp
@@ -214,6 +214,14 @@ Status PostStrategyValidator::Validate() const
 								"' is set to 'Rocket'. "
 								"This requires high-end hardware (NVMe SSD, many CPU cores)");
 
+		case Options::EPostStrategy::ppPipeline:
+			return Status::Info("'" + std::string(Options::POSTSTRATEGY) +
+								"' is set to 'Pipeline'. "
+								"Concurrency is limited per stage by '" +
+								std::string(Options::POSTREPAIRLIMIT) + "', '" +
+								std::string(Options::POSTDISKLIMIT) + "' and '" +
+								std::string(Options::POSTSCRIPTLIMIT) + "'");
+
 		default:
 			return Status::Ok();
 	}
@@ -27,7 +27,7 @@ namespace SystemHealth::NewsServer
 NewsServerValidator::NewsServerValidator(const ::NewsServer& server)
 	: m_server(server), m_name("Server" + std::to_string(server.GetId()))
 {
-	m_validators.reserve(16);
+	m_validators.reserve(17);
 	m_validators.push_back(std::make_unique<ServerActiveValidator>(server));
 	m_validators.push_back(std::make_unique<ServerNameValidator>(server));
 	m_validators.push_back(std::make_unique<ServerLevelValidator>(server));
@@ -42,6 +42,7 @@ NewsServerValidator::NewsServerValidator(const ::NewsServer& server)
 	m_validators.push_back(std::make_unique<ServerCipherValidator>(server));
 	m_validators.push_back(std::make_unique<ServerConnectionsValidator>(server));
 	m_validators.push_back(std::make_unique<ServerRetentionValidator>(server));
+	m_validators.push_back(std::make_unique<ServerPipeliningValidator>(server));
 	m_validators.push_back(std::make_unique<ServerCertVerificationValidator>(server));
 	m_validators.push_back(std::make_unique<ServerIpVersionValidator>(server));
 }
@@ -224,6 +225,20 @@ Status ServerRetentionValidator::Validate() const
 	return Status::Ok();
 }
 
+Status ServerPipeliningValidator::Validate() const
+{
+	if (!m_server.GetActive()) return Status::Ok();
+
+	int pipelining = m_server.GetPipelining();
+	if (pipelining < 1 || pipelining > 100)
+		return Status::Error("'Pipelining' value is invalid. It must be between 1 and 100");
+
+	if (pipelining > 1 && m_server.GetJoinGroup())
+		return Status::Info("Pipelining is not used because 'JoinGroup' is enabled");
+
+	return Status::Ok();
+}
+
 Status ServerCertVerificationValidator::Validate() const
 {
 	if (!m_server.GetActive()) return Status::Ok();
@@ -204,6 +204,18 @@ private:
 	const ::NewsServer& m_server;
 };
 
+class ServerPipeliningValidator final : public Validator
+{
+public:
+	explicit ServerPipeliningValidator(const ::NewsServer& server) : m_server(server) {}
+
+	std::string_view GetName() const override { return "Pipelining"; }
+	Status Validate() const override;
+
+private:
+	const ::NewsServer& m_server;
+};
+
 class ServerCertVerificationValidator final : public Validator
 {
 public:
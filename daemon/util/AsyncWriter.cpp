@@ -0,0 +1,215 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include "AsyncWriter.h"
+#include "FileSystem.h"
+
+AsyncWriter::~AsyncWriter()
+{
+	Stop();
+}
+
+void AsyncWriter::Start(int threads, size_t maxPendingBytes)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_maxPendingBytes = maxPendingBytes;
+	m_stopped = false;
+	for (int i = 0; i < threads; i++)
+	{
+		m_workers.emplace_back(&AsyncWriter::WorkerProc, this);
+	}
+}
+
+/*
+ * Completes all queued writes and terminates the workers.
+ */
+void AsyncWriter::Stop()
+{
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		m_stopped = true;
+	}
+	m_jobCond.notify_all();
+
+	for (std::thread& worker : m_workers)
+	{
+		worker.join();
+	}
+	m_workers.clear();
+}
+
+/*
+ * Returns a buffer of at least "size" bytes, reusing the buffer of a completed write if possible.
+ */
+AsyncWriter::Buffer AsyncWriter::AllocBuffer(int64 size)
+{
+	{
+		std::lock_guard<std::mutex> guard(m_mutex);
+		for (auto it = m_freeBuffers.begin(); it != m_freeBuffers.end(); it++)
+		{
+			if (it->capacity >= size)
+			{
+				Buffer buffer = std::move(*it);
+				m_freeBuffers.erase(it);
+				m_freeBytes -= buffer.capacity;
+				return buffer;
+			}
+		}
+	}
+
+	// rounded up, articles of one file differ slightly in size
+	int64 capacity = (size + BUFFER_GRANULARITY - 1) / BUFFER_GRANULARITY * BUFFER_GRANULARITY;
+	return {std::unique_ptr<char[]>(new char[capacity]), capacity};
+}
+
+/*
+ * Keeps the buffer for reuse, the kept buffers are limited like the pending data.
+ */
+void AsyncWriter::FreeBuffer(Buffer buffer)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	if (buffer.data && m_freeBytes + buffer.capacity <= std::max(m_maxPendingBytes, (size_t)buffer.capacity))
+	{
+		m_freeBytes += buffer.capacity;
+		m_freeBuffers.push_back(std::move(buffer));
+	}
+}
+
+void AsyncWriter::Write(AsyncFilePtr file, std::string filename, int64 offset, Buffer buffer, int64 size, Callback callback)
+{
+	{
+		std::lock_guard<std::mutex> guard(file->m_mutex);
+		file->m_pending++;
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(m_mutex);
+
+		// a single block larger than the limit is accepted when nothing else is pending
+		m_spaceCond.wait(lock, [&]
+			{
+				return m_stopped || m_pendingBytes == 0 || m_pendingBytes + size <= m_maxPendingBytes;
+			});
+
+		m_pendingBytes += size;
+		m_pendingJobs++;
+		m_jobs.push_back({std::move(file), std::move(filename), offset, std::move(buffer), size, std::move(callback)});
+	}
+	m_jobCond.notify_one();
+}
+
+void AsyncWriter::WorkerProc()
+{
+	while (true)
+	{
+		Job job;
+
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_jobCond.wait(lock, [&] { return m_stopped || !m_jobs.empty(); });
+			if (m_jobs.empty())
+			{
+				// stopped and nothing left to write
+				return;
+			}
+			job = std::move(m_jobs.front());
+			m_jobs.pop_front();
+		}
+
+		Execute(job);
+
+		{
+			std::lock_guard<std::mutex> guard(m_mutex);
+			m_pendingBytes -= job.size;
+			m_pendingJobs--;
+		}
+		m_spaceCond.notify_all();
+	}
+}
+
+void AsyncWriter::Execute(Job& job)
+{
+	AsyncFile* file = job.file.get();
+	bool ok;
+	CString errmsg;
+
+	{
+		std::lock_guard<std::mutex> guard(file->m_mutex);
+
+		if (file->m_diskFile.Active() && file->m_filename != job.filename)
+		{
+			file->m_diskFile.Close();
+		}
+
+		if (!file->m_diskFile.Active())
+		{
+			file->m_diskFile.Open(job.filename.c_str(), DiskFile::omReadWrite);
+			file->m_filename = job.filename;
+		}
+
+		ok = file->m_diskFile.Active() &&
+			file->m_diskFile.WriteVectored(job.offset, {{job.buffer.data.get(), job.size}});
+		if (!ok)
+		{
+			errmsg = FileSystem::GetLastErrorMessage();
+			file->m_diskFile.Close();
+		}
+	}
+
+	// return the memory before notifying the owner
+	FreeBuffer(std::move(job.buffer));
+
+	if (job.callback)
+	{
+		job.callback(ok, errmsg);
+	}
+
+	{
+		std::lock_guard<std::mutex> guard(file->m_mutex);
+		file->m_pending--;
+	}
+	file->m_cond.notify_all();
+}
+
+/*
+ * Waits until all writes into the file are completed.
+ */
+void AsyncFile::Wait()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_cond.wait(lock, [&] { return m_pending == 0; });
+}
+
+/*
+ * Closes the file between writes, for example before it is renamed or deleted.
+ * Further writes open it again.
+ */
+void AsyncFile::Close()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	m_diskFile.Close();
+}
+
+int AsyncFile::GetPending()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	return m_pending;
+}
@@ -0,0 +1,113 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef ASYNCWRITER_H
+#define ASYNCWRITER_H
+
+#include <functional>
+#include <thread>
+#include <deque>
+#include "FileSystem.h"
+
+/**
+ * Destination of asynchronous writes, shared by its owner and the pending writes.
+ * The file is opened by the first write and kept open until Close() or until
+ * the last reference is gone. Writes into one file are executed one at a time.
+ */
+class AsyncFile
+{
+public:
+	void Wait();
+	void Close();
+	int GetPending();
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_cond;
+	DiskFile m_diskFile;
+	std::string m_filename;
+	int m_pending = 0;
+
+	friend class AsyncWriter;
+};
+
+typedef std::shared_ptr<AsyncFile> AsyncFilePtr;
+
+/**
+ * Writes data blocks at given positions into existing files on a set of
+ * worker threads. The caller hands over the data and continues immediately,
+ * the completion callback is executed on the worker thread.
+ *
+ * When the pending data exceeds the configured limit Write() blocks until
+ * the workers catch up, which keeps the memory bounded if the disk is slower
+ * than the producers. Buffers of completed writes are kept for reuse.
+ */
+class AsyncWriter
+{
+public:
+	typedef std::function<void(bool success, const char* errmsg)> Callback;
+
+	struct Buffer
+	{
+		std::unique_ptr<char[]> data;
+		int64 capacity = 0;
+	};
+
+	AsyncWriter() = default;
+	AsyncWriter(const AsyncWriter&) = delete;
+	~AsyncWriter();
+
+	void Start(int threads, size_t maxPendingBytes);
+	void Stop();
+	bool IsActive() { return !m_workers.empty(); }
+	Buffer AllocBuffer(int64 size);
+	void FreeBuffer(Buffer buffer);
+	void Write(AsyncFilePtr file, std::string filename, int64 offset, Buffer buffer, int64 size, Callback callback);
+	size_t GetPendingBytes() { return m_pendingBytes; }
+	int GetPendingJobs() { return m_pendingJobs; }
+
+private:
+	struct Job
+	{
+		AsyncFilePtr file;
+		std::string filename;
+		int64 offset;
+		Buffer buffer;
+		int64 size;
+		Callback callback;
+	};
+
+	static const int64 BUFFER_GRANULARITY = 64 * 1024;
+
+	std::vector<std::thread> m_workers;
+	std::mutex m_mutex;
+	std::condition_variable m_jobCond;
+	std::condition_variable m_spaceCond;
+	std::deque<Job> m_jobs;
+	std::vector<Buffer> m_freeBuffers;
+	size_t m_freeBytes = 0;
+	size_t m_maxPendingBytes = 0;
+	std::atomic<size_t> m_pendingBytes{0};
+	std::atomic<int> m_pendingJobs{0};
+	bool m_stopped = false;
+
+	void WorkerProc();
+	void Execute(Job& job);
+};
+
+#endif
@@ -0,0 +1,322 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#include <linux/fs.h>
+#endif
+#include "FileMover.h"
+#include "FileSystem.h"
+#include "Util.h"
+
+// size of one copy operation, also the granularity of progress reporting
+static const int64 COPY_CHUNK_SIZE = 8 * 1024 * 1024;
+static const int COPY_BUFFER_SIZE = 1024 * 1024;
+
+void FileMover::AddFile(std::string srcFilename, std::string dstFilename)
+{
+	File file;
+	file.srcFilename = std::move(srcFilename);
+	file.dstFilename = std::move(dstFilename);
+	file.size = std::max(FileSystem::FileSize(file.srcFilename.c_str()), (int64)0);
+	m_files.push_back(std::move(file));
+}
+
+bool FileMover::Execute(ProgressFunc progress)
+{
+	int64 totalSize = 0;
+	for (File& file : m_files)
+	{
+		totalSize += file.size;
+	}
+
+	std::vector<File*> copyFiles;
+	for (File& file : m_files)
+	{
+		bool needCopy = false;
+		if (Rename(file, needCopy))
+		{
+			file.success = true;
+			m_movedSize += file.size;
+		}
+		else if (needCopy)
+		{
+			copyFiles.push_back(&file);
+		}
+	}
+
+	if (!copyFiles.empty())
+	{
+		std::atomic<size_t> nextFile{0};
+		std::atomic<int> runningThreads{0};
+		std::vector<std::thread> threads;
+		int threadCount = std::max(std::min(m_threads, (int)copyFiles.size()), 1);
+
+		for (int i = 0; i < threadCount; i++)
+		{
+			runningThreads++;
+			threads.emplace_back([this, &copyFiles, &nextFile, &runningThreads]()
+				{
+					for (size_t index = nextFile++; index < copyFiles.size(); index = nextFile++)
+					{
+						CopyFile(*copyFiles[index]);
+					}
+					runningThreads--;
+				});
+		}
+
+		while (runningThreads > 0)
+		{
+			if (progress)
+			{
+				progress(m_movedSize, totalSize);
+			}
+			Util::Sleep(100);
+		}
+
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+	}
+
+	if (progress)
+	{
+		progress(m_movedSize, totalSize);
+	}
+
+	return std::all_of(m_files.begin(), m_files.end(), [](File& file) { return file.success; });
+}
+
+/*
+ * Returns false if the file couldn't be renamed, "needCopy" is set if the
+ * destination is on another file system.
+ */
+bool FileMover::Rename(File& file, bool& needCopy)
+{
+#ifdef WIN32
+	bool ok = _wrename(FileSystem::UtfPathToWidePath(file.srcFilename.c_str()),
+		FileSystem::UtfPathToWidePath(file.dstFilename.c_str())) == 0;
+#else
+	bool ok = rename(file.srcFilename.c_str(), file.dstFilename.c_str()) == 0;
+#endif
+
+	needCopy = !ok && errno == EXDEV;
+	if (!ok && !needCopy)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+	}
+	return ok;
+}
+
+#ifdef WIN32
+
+void FileMover::CopyFile(File& file)
+{
+	DiskFile infile;
+	DiskFile outfile;
+	if (!infile.Open(file.srcFilename.c_str(), DiskFile::omRead) ||
+		!outfile.Open(file.dstFilename.c_str(), DiskFile::omWrite))
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+		return;
+	}
+
+	CharBuffer buffer(COPY_BUFFER_SIZE);
+	bool ok = true;
+	int64 cnt;
+	while (ok && (cnt = infile.Read(buffer, buffer.Size())) > 0)
+	{
+		ok = outfile.Write(buffer, cnt) == cnt;
+		m_movedSize += cnt;
+	}
+	ok = ok && !infile.Error();
+	ok = outfile.Close() && ok;
+	infile.Close();
+
+	if (!ok)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+		FileSystem::DeleteFile(file.dstFilename.c_str());
+		return;
+	}
+
+	file.success = FileSystem::DeleteFile(file.srcFilename.c_str());
+	if (!file.success)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+	}
+}
+
+#else
+
+void FileMover::CopyFile(File& file)
+{
+	int inFd = open(file.srcFilename.c_str(), O_RDONLY | O_CLOEXEC);
+	if (inFd == -1)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+		return;
+	}
+
+	int outFd = open(file.dstFilename.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0666);
+	if (outFd == -1)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+		close(inFd);
+		return;
+	}
+
+	ECopyResult result = CloneFile(inFd, outFd, file.size);
+	if (result == crUnsupported)
+	{
+		result = CopyFileRange(inFd, outFd);
+	}
+	if (result == crUnsupported)
+	{
+		result = SendFile(inFd, outFd);
+	}
+	if (result == crUnsupported)
+	{
+		result = CopyData(inFd, outFd);
+	}
+
+	bool ok = result == crDone;
+	if (!ok)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+	}
+
+	// errors of delayed writes (for example on network shares) are reported on close
+	if (close(outFd) != 0 && ok)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+		ok = false;
+	}
+	close(inFd);
+
+	if (!ok)
+	{
+		FileSystem::DeleteFile(file.dstFilename.c_str());
+		return;
+	}
+
+	file.success = FileSystem::DeleteFile(file.srcFilename.c_str());
+	if (!file.success)
+	{
+		file.errmsg = FileSystem::GetLastErrorMessage();
+	}
+}
+
+/*
+ * Reflink shares the data blocks of both files, supported by btrfs, xfs and
+ * others, but only within one file system. Mounts of the same file system
+ * (for example bind mounts in containers) fail to rename with EXDEV though.
+ */
+FileMover::ECopyResult FileMover::CloneFile(int inFd, int outFd, int64 size)
+{
+#ifdef FICLONE
+	if (ioctl(outFd, FICLONE, inFd) == 0)
+	{
+		m_movedSize += size;
+		return crDone;
+	}
+#endif
+	return crUnsupported;
+}
+
+FileMover::ECopyResult FileMover::CopyFileRange(int inFd, int outFd)
+{
+#ifdef HAVE_COPY_FILE_RANGE
+	int64 copied = 0;
+	while (true)
+	{
+		ssize_t len = copy_file_range(inFd, nullptr, outFd, nullptr, COPY_CHUNK_SIZE, 0);
+		if (len == 0)
+		{
+			return crDone;
+		}
+		if (len < 0)
+		{
+			// older kernels and some file systems don't support copying between file systems
+			return copied == 0 && (errno == EXDEV || errno == ENOSYS || errno == EINVAL ||
+				errno == EOPNOTSUPP || errno == EBADF) ? crUnsupported : crFailed;
+		}
+		copied += len;
+		m_movedSize += len;
+	}
+#else
+	return crUnsupported;
+#endif
+}
+
+FileMover::ECopyResult FileMover::SendFile(int inFd, int outFd)
+{
+#ifdef __linux__
+	int64 copied = 0;
+	while (true)
+	{
+		ssize_t len = sendfile(outFd, inFd, nullptr, COPY_CHUNK_SIZE);
+		if (len == 0)
+		{
+			return crDone;
+		}
+		if (len < 0)
+		{
+			return copied == 0 && (errno == ENOSYS || errno == EINVAL) ? crUnsupported : crFailed;
+		}
+		copied += len;
+		m_movedSize += len;
+	}
+#else
+	return crUnsupported;
+#endif
+}
+
+FileMover::ECopyResult FileMover::CopyData(int inFd, int outFd)
+{
+	CharBuffer buffer(COPY_BUFFER_SIZE);
+	while (true)
+	{
+		ssize_t len = read(inFd, buffer, buffer.Size());
+		if (len == 0)
+		{
+			return crDone;
+		}
+		if (len < 0)
+		{
+			return crFailed;
+		}
+
+		for (ssize_t written = 0; written < len; )
+		{
+			ssize_t cnt = write(outFd, buffer + written, len - written);
+			if (cnt < 0)
+			{
+				return crFailed;
+			}
+			written += cnt;
+		}
+		m_movedSize += len;
+	}
+}
+
+#endif
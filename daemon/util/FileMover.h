@@ -0,0 +1,86 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef FILEMOVER_H
+#define FILEMOVER_H
+
+#include <functional>
+#include <atomic>
+#include "NString.h"
+
+/**
+ * Moves a set of files, also between different file systems.
+ *
+ * A file is renamed if possible. Otherwise it is copied and the source file is
+ * deleted; the copy uses the fastest method supported by the system and the
+ * file systems: a reflink (Linux, FICLONE), an in-kernel copy (copy_file_range,
+ * sendfile on Linux) or a plain copy with a large buffer.
+ *
+ * Several files are copied in parallel on own threads, the calling thread
+ * waits and reports the progress.
+ */
+class FileMover
+{
+public:
+	typedef std::function<void(int64 movedSize, int64 totalSize)> ProgressFunc;
+
+	struct File
+	{
+		std::string srcFilename;
+		std::string dstFilename;
+		int64 size = 0;
+		bool success = false;
+		CString errmsg;
+	};
+
+	typedef std::vector<File> FileList;
+
+	FileMover(int threads = 4) : m_threads(threads) {}
+	FileMover(const FileMover&) = delete;
+	void AddFile(std::string srcFilename, std::string dstFilename);
+
+	/**
+	 * @param progress called periodically on the calling thread, can be nullptr.
+	 * @return false if any file couldn't be moved, see GetFiles for details.
+	 */
+	bool Execute(ProgressFunc progress);
+	FileList& GetFiles() { return m_files; }
+
+private:
+	enum ECopyResult
+	{
+		crDone,
+		crUnsupported,	// nothing was written, the next method can be tried
+		crFailed
+	};
+
+	FileList m_files;
+	int m_threads;
+	std::atomic<int64> m_movedSize{0};
+
+	bool Rename(File& file, bool& needCopy);
+	void CopyFile(File& file);
+#ifndef WIN32
+	ECopyResult CloneFile(int inFd, int outFd, int64 size);
+	ECopyResult CopyFileRange(int inFd, int outFd);
+	ECopyResult SendFile(int inFd, int outFd);
+	ECopyResult CopyData(int inFd, int outFd);
+#endif
+};
+
+#endif
@@ -20,6 +20,11 @@
 
 
 #include "nzbget.h"
+
+#ifdef HAVE_PWRITEV
+#include <sys/uio.h>
+#include <climits>
+#endif
 #include "FileSystem.h"
 #include "Util.h"
 #include "Log.h"
@@ -844,6 +849,27 @@ std::optional<FileSystem::DiskState> FileSystem::GetDiskState(const char* path)
 	return std::nullopt;
 }
 
+int64 FileSystem::GetDeviceId(const char* path)
+{
+#ifdef WIN32
+	wchar_t volumePath[MAX_PATH + 1];
+	DWORD serialNumber;
+	if (GetVolumePathNameW(UtfPathToWidePath(path), volumePath, MAX_PATH + 1) &&
+		GetVolumeInformationW(volumePath, nullptr, 0, &serialNumber, nullptr, nullptr, nullptr, 0))
+	{
+		return serialNumber;
+	}
+	return -1;
+#else
+	struct stat buffer;
+	if (stat(path, &buffer))
+	{
+		return -1;
+	}
+	return (int64)buffer.st_dev;
+#endif
+}
+
 bool FileSystem::RenameBak(const char* filename, const char* bakPart, bool removeOldExtension, CString& newName)
 {
 	BString<1024> changedFilename;
@@ -1374,6 +1400,76 @@ int64 DiskFile::Write(const void* buffer, int64 size)
 	return fwrite(buffer, 1, (size_t)size, m_file);
 }
 
+/*
+ * Writes the chunks one after another starting at the given position.
+ * Uses a single pwritev call per batch of chunks when supported by the system.
+ */
+bool DiskFile::WriteVectored(int64 position, const std::vector<WriteChunk>& chunks)
+{
+#ifdef HAVE_PWRITEV
+	if (fflush(m_file) != 0)
+	{
+		return false;
+	}
+
+	int fd = fileno(m_file);
+	std::vector<iovec> iov;
+	iov.reserve(std::min(chunks.size(), (size_t)IOV_MAX));
+
+	size_t index = 0;
+	while (index < chunks.size())
+	{
+		iov.clear();
+		for (size_t i = index; i < chunks.size() && iov.size() < IOV_MAX; i++)
+		{
+			iov.push_back({(void*)chunks[i].buffer, (size_t)chunks[i].size});
+		}
+
+		ssize_t written = pwritev(fd, iov.data(), (int)iov.size(), position);
+		if (written <= 0)
+		{
+			return false;
+		}
+		position += written;
+
+		// skip completely written chunks and continue with the rest of a partially written one
+		while (index < chunks.size() && written >= chunks[index].size)
+		{
+			written -= chunks[index].size;
+			index++;
+		}
+		if (written > 0)
+		{
+			const WriteChunk& chunk = chunks[index];
+			int64 rest = chunk.size - written;
+			if (pwrite(fd, (const char*)chunk.buffer + written, (size_t)rest, position) != rest)
+			{
+				return false;
+			}
+			position += rest;
+			index++;
+		}
+	}
+
+	return true;
+#else
+	if (!Seek(position))
+	{
+		return false;
+	}
+
+	for (const WriteChunk& chunk : chunks)
+	{
+		if (Write(chunk.buffer, chunk.size) != chunk.size)
+		{
+			return false;
+		}
+	}
+
+	return true;
+#endif
+}
+
 int64 DiskFile::Print(const char* format, ...)
 {
 	va_list ap;
@@ -72,6 +72,10 @@ public:
 	static bool SetCurrentDirectory(const char* dirFilename);
 	static int64 FileSize(const char* filename);
 	static std::optional<DiskState> GetDiskState(const char* path);
+
+	/* Identifier of the disk (volume) the path lives on or -1 on error */
+	static int64 GetDeviceId(const char* path);
+
 	static bool DirEmpty(const char* dirFilename);
 	static bool RenameBak(const char* filename, const char* bakPart, bool removeOldExtension, CString& newName);
 #ifndef WIN32
@@ -148,6 +152,12 @@ public:
 		soEnd
 	};
 
+	struct WriteChunk
+	{
+		const void* buffer;
+		int64 size;
+	};
+
 	DiskFile() = default;
 	DiskFile(const DiskFile&) = delete;
 	~DiskFile();
@@ -156,6 +166,7 @@ public:
 	bool Active() { return m_file != nullptr; }
 	int64 Read(void* buffer, int64 size);
 	int64 Write(const void* buffer, int64 size);
+	bool WriteVectored(int64 position, const std::vector<WriteChunk>& chunks);
 	int64 Position();
 	bool Seek(int64 position, ESeekOrigin origin = soSet);
 	bool Eof();
@@ -461,6 +461,57 @@ void StringBuilder::AppendFmtV(const char* format, va_list ap)
 }
 
 
+const char* StringArena::Add(const char* str, int len)
+{
+	if (len == 0)
+	{
+		len = strlen(str);
+	}
+	int size = len + 1;
+
+	if (size > MAX_BLOCK_SIZE / 4)
+	{
+		// large strings get own blocks, the current block remains open for small ones
+		std::unique_ptr<char[]> block(new char[size]);
+		char* data = block.get();
+		memcpy(data, str, len);
+		data[len] = '\0';
+		m_blocks.push_back(std::move(block));
+		m_size += size;
+		m_capacity += size;
+		return data;
+	}
+
+	if (size > m_available)
+	{
+		// blocks grow with the number of strings to keep the waste small for short lists
+		m_blockSize = m_blockSize == 0 ? MIN_BLOCK_SIZE : std::min(m_blockSize * 2, MAX_BLOCK_SIZE);
+		m_blocks.emplace_back(new char[m_blockSize]);
+		m_pos = m_blocks.back().get();
+		m_available = m_blockSize;
+		m_capacity += m_blockSize;
+	}
+
+	char* data = m_pos;
+	memcpy(data, str, len);
+	data[len] = '\0';
+	m_pos += size;
+	m_available -= size;
+	m_size += size;
+	return data;
+}
+
+void StringArena::Clear()
+{
+	m_blocks.clear();
+	m_pos = nullptr;
+	m_available = 0;
+	m_blockSize = 0;
+	m_size = 0;
+	m_capacity = 0;
+}
+
+
 // Instantiate all classes used in our project
 template class BString<1024>;
 template class BString<100>;
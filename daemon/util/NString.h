@@ -219,6 +219,34 @@ protected:
 	int m_size = 0;
 };
 
+/*
+Append-only storage for many small strings. The strings are packed into a few
+large blocks instead of being allocated one by one. Returned pointers remain
+valid until "Clear" or destruction of the arena.
+ */
+class StringArena
+{
+public:
+	StringArena() = default;
+	StringArena(const StringArena&) = delete;
+	StringArena& operator=(const StringArena&) = delete;
+	const char* Add(const char* str, int len = 0);
+	void Clear();
+	int64 GetSize() const { return m_size; }
+	int64 GetCapacity() const { return m_capacity; }
+
+private:
+	static constexpr int MIN_BLOCK_SIZE = 1024;
+	static constexpr int MAX_BLOCK_SIZE = 64 * 1024;
+
+	std::vector<std::unique_ptr<char[]>> m_blocks;
+	char* m_pos = nullptr;
+	int m_available = 0;
+	int m_blockSize = 0;
+	int64 m_size = 0;
+	int64 m_capacity = 0;
+};
+
 #ifdef DEBUG
 // helper declarations to identify incorrect calls to "free" at compile time
 #ifdef WIN32
@@ -97,6 +97,11 @@ void ServiceCoordinator::Run()
 void ServiceCoordinator::Stop()
 {
 	Thread::Stop();
+
+	for (Service* service : m_services)
+	{
+		service->ServiceStop();
+	}
 	
 	// Resume Run() to exit it
 	std::lock_guard<std::mutex> guard(m_waitMutex);
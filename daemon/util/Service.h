@@ -36,6 +36,7 @@ public:
 protected:
 	virtual int ServiceInterval() = 0;
 	virtual void ServiceWork() = 0;
+	virtual void ServiceStop() {}
 	void WakeUp();
 
 private:
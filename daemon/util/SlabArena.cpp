@@ -0,0 +1,390 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
+#include "SlabArena.h"
+
+// alignment of the reserved range, matches the size of x86-64 and arm64 huge pages
+static const size_t ARENA_ALIGNMENT = 2 * 1024 * 1024;
+static const size_t MIN_SLOT_SIZE = 4 * 1024;
+
+SlabArena::~SlabArena()
+{
+	Release();
+}
+
+int SlabArena::Stats::GetFragmentation() const
+{
+	size_t usedBytes = (size_t)usedSlabs * slabSize;
+	return usedBytes > 0 ? (int)((usedBytes - requestedBytes) * 100 / usedBytes) : 0;
+}
+
+/*
+ * Sizes up to 4 KB share one class, larger sizes are rounded up to one of
+ * eight steps per power of two, which keeps the unused tail of a slot below 12.5%.
+ */
+size_t SlabArena::SlotSize(size_t size)
+{
+	if (size <= MIN_SLOT_SIZE)
+	{
+		return MIN_SLOT_SIZE;
+	}
+
+	size_t power = MIN_SLOT_SIZE;
+	while (power * 2 < size)
+	{
+		power *= 2;
+	}
+
+	size_t step = std::max(power / 8, MIN_SLOT_SIZE);
+	return (size + step - 1) / step * step;
+}
+
+bool SlabArena::Init(size_t capacity, bool hugePages)
+{
+	Release();
+
+	if (capacity == 0)
+	{
+		return false;
+	}
+
+	// aim for about 64 slabs, enough to hold several size classes at once
+	size_t slabSize = MIN_SLAB_SIZE;
+	while (slabSize < MAX_SLAB_SIZE && slabSize * 64 < capacity)
+	{
+		slabSize *= 2;
+	}
+
+	size_t slabCount = (capacity + slabSize - 1) / slabSize;
+	capacity = slabCount * slabSize;
+
+#ifdef WIN32
+	// reserve address space only, slabs are committed when they get the first slot
+	char* mapping = (char*)VirtualAlloc(nullptr, capacity, MEM_RESERVE, PAGE_READWRITE);
+	if (!mapping)
+	{
+		return false;
+	}
+	m_mapping = mapping;
+	m_mappingSize = capacity;
+	m_base = mapping;
+	m_hugePages = false;
+#else
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+#ifdef MAP_NORESERVE
+	flags |= MAP_NORESERVE;
+#endif
+	size_t mappingSize = capacity + ARENA_ALIGNMENT;
+	void* mapping = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (mapping == MAP_FAILED)
+	{
+		return false;
+	}
+	m_mapping = (char*)mapping;
+	m_mappingSize = mappingSize;
+	m_base = (char*)(((uintptr_t)mapping + ARENA_ALIGNMENT - 1) / ARENA_ALIGNMENT * ARENA_ALIGNMENT);
+
+	m_hugePages = false;
+#ifdef MADV_HUGEPAGE
+	if (hugePages)
+	{
+		m_hugePages = madvise(m_base, capacity, MADV_HUGEPAGE) == 0;
+	}
+#endif
+#endif
+
+	m_capacity = capacity;
+	m_slabSize = slabSize;
+	m_slabs.resize(slabCount);
+	m_freeSlabs.reserve(slabCount);
+	// lower slabs are taken first
+	for (int i = (int)slabCount - 1; i >= 0; i--)
+	{
+		m_freeSlabs.push_back(i);
+	}
+
+	return true;
+}
+
+void SlabArena::Release()
+{
+	if (m_mapping)
+	{
+#ifdef WIN32
+		VirtualFree(m_mapping, 0, MEM_RELEASE);
+#else
+		munmap(m_mapping, m_mappingSize);
+#endif
+	}
+
+	m_base = nullptr;
+	m_mapping = nullptr;
+	m_mappingSize = 0;
+	m_capacity = 0;
+	m_slabSize = 0;
+	m_slabs.clear();
+	m_freeSlabs.clear();
+	m_partialSlabs.clear();
+	m_slotBytes = 0;
+	m_requestedBytes = 0;
+}
+
+char* SlabArena::Alloc(size_t size)
+{
+	if (!m_base || size == 0 || size > m_slabSize)
+	{
+		return nullptr;
+	}
+
+	size_t slotSize = SlotSize(size);
+	if (slotSize > m_slabSize)
+	{
+		slotSize = m_slabSize;
+	}
+
+	auto it = m_partialSlabs.find(slotSize);
+	if (it == m_partialSlabs.end() || it->second == -1)
+	{
+		if (!AssignSlab(slotSize))
+		{
+			return nullptr;
+		}
+		it = m_partialSlabs.find(slotSize);
+	}
+
+	int index = it->second;
+	Slab& slab = m_slabs[index];
+
+	char* ptr;
+	if (slab.freeList)
+	{
+		ptr = slab.freeList;
+		slab.freeList = *(char**)ptr;
+	}
+	else
+	{
+		ptr = SlabBase(index) + slab.fresh * slotSize;
+		slab.fresh++;
+	}
+
+	slab.used++;
+	if (slab.used == slab.slotCount)
+	{
+		UnlinkPartial(index);
+	}
+
+	m_slotBytes += slotSize;
+	m_requestedBytes += size;
+
+	return ptr;
+}
+
+/*
+ * Moves the data into a slot of a smaller class if there is one available,
+ * otherwise keeps it in place. Returns the new location of the data.
+ */
+char* SlabArena::Shrink(char* ptr, size_t oldSize, size_t newSize)
+{
+	if (!Contains(ptr) || newSize == 0 || newSize > oldSize)
+	{
+		return ptr;
+	}
+
+	size_t slotSize = m_slabs[SlabIndex(ptr)].slotSize;
+	if (SlotSize(newSize) < slotSize)
+	{
+		char* newPtr = Alloc(newSize);
+		if (newPtr)
+		{
+			memcpy(newPtr, ptr, newSize);
+			Free(ptr, oldSize);
+			return newPtr;
+		}
+	}
+
+	m_requestedBytes -= oldSize - newSize;
+	return ptr;
+}
+
+void SlabArena::Free(char* ptr, size_t size)
+{
+	if (!Contains(ptr))
+	{
+		return;
+	}
+
+	int index = SlabIndex(ptr);
+	Slab& slab = m_slabs[index];
+
+	if (slab.used == slab.slotCount)
+	{
+		LinkPartial(index);
+	}
+
+	*(char**)ptr = slab.freeList;
+	slab.freeList = ptr;
+	slab.used--;
+
+	m_slotBytes -= slab.slotSize;
+	m_requestedBytes -= size;
+
+	if (slab.used == 0)
+	{
+		UnlinkPartial(index);
+		slab.slotSize = 0;
+		slab.freeList = nullptr;
+		slab.fresh = 0;
+		m_freeSlabs.push_back(index);
+	}
+}
+
+void SlabArena::Trim()
+{
+	for (int index : m_freeSlabs)
+	{
+		if (m_slabs[index].committed)
+		{
+			Decommit(index);
+		}
+	}
+}
+
+SlabArena::Stats SlabArena::GetStats() const
+{
+	Stats stats;
+	stats.capacity = m_capacity;
+	stats.slabSize = m_slabSize;
+	stats.slabCount = (int)m_slabs.size();
+	stats.usedSlabs = (int)(m_slabs.size() - m_freeSlabs.size());
+	stats.slotBytes = m_slotBytes;
+	stats.requestedBytes = m_requestedBytes;
+	stats.hugePages = m_hugePages;
+
+	std::vector<size_t> classes;
+	for (const Slab& slab : m_slabs)
+	{
+		if (slab.slotSize && std::find(classes.begin(), classes.end(), slab.slotSize) == classes.end())
+		{
+			classes.push_back(slab.slotSize);
+		}
+	}
+	stats.sizeClasses = (int)classes.size();
+
+	return stats;
+}
+
+bool SlabArena::AssignSlab(size_t slotSize)
+{
+	if (m_freeSlabs.empty())
+	{
+		return false;
+	}
+
+	int index = m_freeSlabs.back();
+	if (!m_slabs[index].committed && !Commit(index))
+	{
+		return false;
+	}
+	m_freeSlabs.pop_back();
+
+	Slab& slab = m_slabs[index];
+	slab.slotSize = slotSize;
+	slab.slotCount = (uint32)(m_slabSize / slotSize);
+	slab.used = 0;
+	slab.fresh = 0;
+	slab.freeList = nullptr;
+
+	LinkPartial(index);
+	return true;
+}
+
+void SlabArena::LinkPartial(int index)
+{
+	Slab& slab = m_slabs[index];
+	auto it = m_partialSlabs.find(slab.slotSize);
+	int head = it != m_partialSlabs.end() ? it->second : -1;
+
+	slab.prev = -1;
+	slab.next = head;
+	if (head != -1)
+	{
+		m_slabs[head].prev = index;
+	}
+	m_partialSlabs[slab.slotSize] = index;
+}
+
+void SlabArena::UnlinkPartial(int index)
+{
+	Slab& slab = m_slabs[index];
+
+	if (slab.prev != -1)
+	{
+		m_slabs[slab.prev].next = slab.next;
+	}
+	else
+	{
+		auto it = m_partialSlabs.find(slab.slotSize);
+		if (it != m_partialSlabs.end() && it->second == index)
+		{
+			if (slab.next != -1)
+			{
+				it->second = slab.next;
+			}
+			else
+			{
+				m_partialSlabs.erase(it);
+			}
+		}
+	}
+
+	if (slab.next != -1)
+	{
+		m_slabs[slab.next].prev = slab.prev;
+	}
+
+	slab.prev = -1;
+	slab.next = -1;
+}
+
+bool SlabArena::Commit(int index)
+{
+#ifdef WIN32
+	if (!VirtualAlloc(SlabBase(index), m_slabSize, MEM_COMMIT, PAGE_READWRITE))
+	{
+		return false;
+	}
+#endif
+	m_slabs[index].committed = true;
+	return true;
+}
+
+void SlabArena::Decommit(int index)
+{
+#ifdef WIN32
+	VirtualFree(SlabBase(index), m_slabSize, MEM_DECOMMIT);
+#else
+	madvise(SlabBase(index), m_slabSize, MADV_DONTNEED);
+#endif
+	m_slabs[index].committed = false;
+}
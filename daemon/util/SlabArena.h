@@ -0,0 +1,109 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef SLABARENA_H
+#define SLABARENA_H
+
+#include <map>
+#include <vector>
+
+/**
+ * Size-classed slab allocator working in one address range reserved up front.
+ *
+ * The range is divided into slabs of equal size. A slab is assigned to a size
+ * class when the first slot of that class is needed and returns to the pool of
+ * free slabs once all its slots are released, so memory never gets stranded in
+ * heap fragments. Physical memory of free slabs is returned to the OS by Trim().
+ *
+ * The class is not thread-safe, the owner must serialize the calls.
+ */
+class SlabArena
+{
+public:
+	struct Stats
+	{
+		size_t capacity = 0;		// reserved address space
+		size_t slabSize = 0;
+		int slabCount = 0;
+		int usedSlabs = 0;			// slabs assigned to a size class
+		int sizeClasses = 0;		// size classes with at least one slab
+		size_t slotBytes = 0;		// size of all handed out slots
+		size_t requestedBytes = 0;	// sum of requested sizes
+		bool hugePages = false;
+
+		// share of memory in used slabs not occupied by requested data, in percent
+		int GetFragmentation() const;
+	};
+
+	SlabArena() = default;
+	SlabArena(const SlabArena&) = delete;
+	SlabArena& operator=(const SlabArena&) = delete;
+	~SlabArena();
+
+	bool Init(size_t capacity, bool hugePages);
+	bool IsInitialized() const { return m_base != nullptr; }
+	char* Alloc(size_t size);
+	char* Shrink(char* ptr, size_t oldSize, size_t newSize);
+	void Free(char* ptr, size_t size);
+	void Trim();
+	bool Contains(const char* ptr) const { return m_base && ptr >= m_base && ptr < m_base + m_capacity; }
+	size_t GetSlotBytes() const { return m_slotBytes; }
+	size_t GetMaxSlotSize() const { return m_slabSize; }
+	Stats GetStats() const;
+
+	static size_t SlotSize(size_t size);
+
+	static constexpr size_t MIN_SLAB_SIZE = 4 * 1024 * 1024;
+	static constexpr size_t MAX_SLAB_SIZE = 16 * 1024 * 1024;
+
+private:
+	struct Slab
+	{
+		size_t slotSize = 0;
+		uint32 slotCount = 0;
+		uint32 used = 0;
+		uint32 fresh = 0;			// slots never handed out, taken from the slab end
+		char* freeList = nullptr;	// released slots, linked through their first bytes
+		int prev = -1;				// neighbours in the list of partially used slabs of the class
+		int next = -1;
+		bool committed = false;		// has physical memory behind it
+	};
+
+	char* m_base = nullptr;
+	char* m_mapping = nullptr;
+	size_t m_mappingSize = 0;
+	size_t m_capacity = 0;
+	size_t m_slabSize = 0;
+	bool m_hugePages = false;
+	std::vector<Slab> m_slabs;
+	std::vector<int> m_freeSlabs;
+	std::map<size_t, int> m_partialSlabs;	// slot size -> first partially used slab
+	size_t m_slotBytes = 0;
+	size_t m_requestedBytes = 0;
+
+	char* SlabBase(int index) const { return m_base + index * m_slabSize; }
+	int SlabIndex(const char* ptr) const { return (int)((ptr - m_base) / m_slabSize); }
+	bool AssignSlab(size_t slotSize);
+	void LinkPartial(int index);
+	void UnlinkPartial(int index);
+	bool Commit(int index);
+	void Decommit(int index);
+	void Release();
+};
+
+#endif
@@ -59,6 +59,14 @@ void Thread::Start()
 	t.detach();
 }
 
+void Thread::StartPooled(ThreadPool* pool)
+{
+	debug("Starting pooled Thread");
+
+	m_running = true;
+	pool->Submit(this);
+}
+
 void Thread::Stop()
 {
 	debug("Stopping Thread");
@@ -79,6 +87,11 @@ bool Thread::Kill()
 
 	std::lock_guard<std::mutex> guard(m_threadMutex);
 
+	if (!m_threadObj)
+	{
+		return false;
+	}
+
 #ifdef WIN32
 	bool terminated = TerminateThread(m_threadObj, 0) != 0;
 #else
@@ -122,3 +135,95 @@ int Thread::GetThreadCount()
 {
 	return m_threadCount;
 }
+
+ThreadPool::~ThreadPool()
+{
+	Shutdown();
+}
+
+void ThreadPool::Submit(Thread* thread)
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+
+	m_jobs.push_back(thread);
+
+	if ((int)m_jobs.size() <= m_idleCount || (m_maxWorkers > 0 && m_workerCount >= m_maxWorkers))
+	{
+		m_jobCond.notify_one();
+		return;
+	}
+
+	// all workers are busy, adding one more
+	m_workerCount++;
+	std::thread t([this]{ WorkerProc(); });
+	t.detach();
+}
+
+void ThreadPool::WorkerProc()
+{
+	debug("Entering ThreadPool worker");
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+
+	while (true)
+	{
+		if (!m_jobs.empty())
+		{
+			Thread* thread = m_jobs.front();
+			m_jobs.pop_front();
+			lock.unlock();
+
+			thread->thread_handler();
+
+			lock.lock();
+			continue;
+		}
+
+		if (m_shutdown)
+		{
+			break;
+		}
+
+		m_idleCount++;
+		bool hasWork = m_jobCond.wait_for(lock, std::chrono::seconds(m_idleTimeoutSec),
+			[&] { return !m_jobs.empty() || m_shutdown; });
+		m_idleCount--;
+
+		if (!hasWork)
+		{
+			// idle for too long
+			break;
+		}
+	}
+
+	m_workerCount--;
+	m_exitCond.notify_all();
+
+	debug("Exiting ThreadPool worker");
+}
+
+void ThreadPool::Shutdown()
+{
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_shutdown = true;
+	m_jobCond.notify_all();
+	m_exitCond.wait(lock, [&] { return m_workerCount == 0; });
+}
+
+int ThreadPool::GetWorkerCount()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	return m_workerCount;
+}
+
+int ThreadPool::GetIdleCount()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	return m_idleCount;
+}
+
+int ThreadPool::GetQueueLength()
+{
+	std::lock_guard<std::mutex> guard(m_mutex);
+	return (int)m_jobs.size();
+}
@@ -103,6 +103,8 @@ private:
 	};
 };
 
+class ThreadPool;
+
 class Thread
 {
 public:
@@ -111,6 +113,7 @@ public:
 	virtual ~Thread();
 
 	virtual void Start();
+	void StartPooled(ThreadPool* pool);
 	virtual void Stop();
 	virtual void Resume();
 	bool Kill();
@@ -133,6 +136,43 @@ private:
 	std::atomic<bool> m_autoDestroy{false};
 
 	void thread_handler();
+
+	friend class ThreadPool;
+};
+
+/*
+ * Executes Thread-objects on a set of long living worker threads instead of
+ * creating a new system thread for each object. Workers are created on demand
+ * and exit after being idle for the given time. With a worker limit the objects
+ * started while all workers are busy wait in a queue.
+ */
+class ThreadPool
+{
+public:
+	ThreadPool(int idleTimeoutSec = 60, int maxWorkers = 0) :
+		m_idleTimeoutSec(idleTimeoutSec), m_maxWorkers(maxWorkers) {}
+	ThreadPool(const ThreadPool&) = delete;
+	~ThreadPool();
+	void Shutdown();
+	int GetWorkerCount();
+	int GetIdleCount();
+	int GetQueueLength();
+
+private:
+	std::mutex m_mutex;
+	std::condition_variable m_jobCond;
+	std::condition_variable m_exitCond;
+	std::deque<Thread*> m_jobs;
+	int m_workerCount = 0;
+	int m_idleCount = 0;
+	int m_idleTimeoutSec;
+	int m_maxWorkers;
+	bool m_shutdown = false;
+
+	void Submit(Thread* thread);
+	void WorkerProc();
+
+	friend class Thread;
 };
 
 #endif
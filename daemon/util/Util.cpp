@@ -877,6 +877,36 @@ int Util::NumberOfCpuCores()
 	return std::thread::hardware_concurrency();
 }
 
+void Util::ParallelFor(int count, int minItemsPerThread, std::function<void(int index)> func)
+{
+	const int maxThreads = 8;
+
+	int threads = std::min({std::max(NumberOfCpuCores(), 1), maxThreads,
+		(count + minItemsPerThread - 1) / minItemsPerThread});
+
+	std::atomic<int> next{0};
+	auto worker = [count, &func, &next]()
+	{
+		for (int index = next++; index < count; index = next++)
+		{
+			func(index);
+		}
+	};
+
+	std::vector<std::thread> helpers;
+	for (int i = 1; i < threads; i++)
+	{
+		helpers.emplace_back(worker);
+	}
+
+	worker();
+
+	for (std::thread& helper : helpers)
+	{
+		helper.join();
+	}
+}
+
 int64 Util::CurrentTicks()
 {
 #ifdef WIN32
@@ -1941,7 +1971,8 @@ uint32 ZLib::GZipLen(int inputBufferLength)
 	return (uint32)deflateBound(&zstr, inputBufferLength);
 }
 
-uint32 ZLib::GZip(const void* inputBuffer, int inputBufferLength, void* outputBuffer, int outputBufferLength)
+uint32 ZLib::GZip(const void* inputBuffer, int inputBufferLength, void* outputBuffer, int outputBufferLength,
+	bool bestCompression)
 {
 	z_stream zstr;
 	zstr.zalloc = Z_NULL;
@@ -1953,7 +1984,8 @@ uint32 ZLib::GZip(const void* inputBuffer, int inputBufferLength, void* outputBu
 	zstr.avail_out = outputBufferLength;
 
 	/* add 16 to MAX_WBITS to enforce gzip format */
-	if (Z_OK != deflateInit2(&zstr, Z_DEFAULT_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY))
+	if (Z_OK != deflateInit2(&zstr, bestCompression ? Z_BEST_COMPRESSION : Z_DEFAULT_COMPRESSION,
+		Z_DEFLATED, MAX_WBITS + 16, MAX_MEM_LEVEL, Z_DEFAULT_STRATEGY))
 	{
 		return 0;
 	}
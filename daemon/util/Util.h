@@ -255,6 +255,13 @@ public:
 	* Returns number of available CPU cores or -1 if it could not be determined
 	*/
 	static int NumberOfCpuCores();
+
+	/*
+	* Executes "func" for indices from 0 to "count - 1" on up to 8 threads, the calling
+	* thread included. Each thread gets at least "minItemsPerThread" items.
+	* "func" must only modify objects belonging to its index.
+	*/
+	static void ParallelFor(int count, int minItemsPerThread, std::function<void(int index)> func);
 };
 
 class WebUtil
@@ -426,8 +433,10 @@ public:
 	/*
 	* compresses inputBuffer and returns the size of bytes written to
 	* outputBuffer or 0 if the buffer is too small or an error occured.
+	* "bestCompression" trades speed for size, for data compressed once and sent many times.
 	*/
-	static uint32 GZip(const void* inputBuffer, int inputBufferLength, void* outputBuffer, int outputBufferLength);
+	static uint32 GZip(const void* inputBuffer, int inputBufferLength, void* outputBuffer, int outputBufferLength,
+		bool bestCompression = false);
 };
 
 class GUnzipStream
@@ -0,0 +1,75 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+#include <malloc.h>
+#define HAVE_MALLINFO2
+#endif
+
+#include "DownloadInfo.h"
+
+namespace
+{
+	int64 HeapUsage()
+	{
+#ifdef HAVE_MALLINFO2
+		return (int64)mallinfo2().uordblks;
+#else
+		return 0;
+#endif
+	}
+}
+
+// Memory used by one million segments: 1000 files with 1000 articles each
+BOOST_AUTO_TEST_CASE(ArticleMemoryBenchmark)
+{
+	const int fileCount = 1000;
+	const int articleCount = 1000;
+
+	int64 heapBefore = HeapUsage();
+	{
+		std::vector<std::unique_ptr<FileInfo>> files;
+		int64 arenaSize = 0;
+		for (int i = 0; i < fileCount; i++)
+		{
+			std::unique_ptr<FileInfo> fileInfo = std::make_unique<FileInfo>();
+			fileInfo->GetArticles()->reserve(articleCount);
+			for (int part = 1; part <= articleCount; part++)
+			{
+				ArticleInfo* article = fileInfo->GetArticles()->Add();
+				article->SetPartNumber(part);
+				article->SetSize(739811);
+				article->SetMessageId(fileInfo->GetMessageIds(),
+					BString<100>("<Part%iof%i.%08X%08X@powerpost2000AA.local>", part, articleCount, i * 7919, part * 104729));
+			}
+			arenaSize += fileInfo->GetMessageIds()->GetCapacity();
+			files.push_back(std::move(fileInfo));
+		}
+
+		BOOST_CHECK(arenaSize >= fileCount * articleCount * 40);
+
+		int64 heapUsed = HeapUsage() - heapBefore;
+		BOOST_TEST_MESSAGE("1M segments: ArticleInfo " << sizeof(ArticleInfo) << " bytes, message-ids " <<
+			arenaSize / 1024 / 1024 << " MB" <<
+			(heapUsed > 0 ? ", total heap " + std::to_string(heapUsed / 1024 / 1024) + " MB" : std::string()));
+	}
+}
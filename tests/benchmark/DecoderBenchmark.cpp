@@ -0,0 +1,111 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include <random>
+#include "Decoder.h"
+#include "YEncode.h"
+
+namespace
+{
+	// yEnc-encoded article with random content as sent by news servers
+	std::string MakeArticle(int size)
+	{
+		const int lineSize = 128;
+
+		std::mt19937 gen(12345);
+		std::uniform_int_distribution<> distrib(0, 255);
+		std::vector<uchar> data(size);
+		for (uchar& ch : data)
+		{
+			ch = (uchar)distrib(gen);
+		}
+
+		Crc32 crc;
+		crc.Append(data.data(), (uint32)data.size());
+
+		std::string article = *BString<1024>("=ybegin part=1 line=%i size=%i name=file.bin\r\n"
+			"=ypart begin=1 end=%i\r\n", lineSize, size, size);
+
+		int col = 0;
+		for (uchar raw : data)
+		{
+			uchar ch = (uchar)(raw + 42);
+			if (ch == 0 || ch == '\n' || ch == '\r' || ch == '=' || (ch == '.' && col == 0))
+			{
+				article += '=';
+				ch = (uchar)(ch + 64);
+				col++;
+			}
+			article += (char)ch;
+			if (++col >= lineSize)
+			{
+				article += "\r\n";
+				col = 0;
+			}
+		}
+
+		article += *BString<1024>("\r\n=yend size=%i part=1 pcrc32=%08x\r\n.\r\n", size, crc.Finish());
+		return article;
+	}
+
+	// feeds the article to the decoder in chunks like ArticleDownloader does, returns MB/s
+	double Decode(const std::string& article, bool crcCheck, int chunkSize, int rounds)
+	{
+		std::vector<char> buffer(chunkSize);
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < rounds; i++)
+		{
+			Decoder decoder;
+			decoder.SetCrcCheck(crcCheck);
+			for (size_t pos = 0; pos < article.size(); pos += chunkSize)
+			{
+				int len = (int)std::min(article.size() - pos, (size_t)chunkSize);
+				memcpy(buffer.data(), article.data() + pos, len);
+				decoder.DecodeBuffer(buffer.data(), len);
+			}
+			BOOST_REQUIRE(decoder.Check() == Decoder::dsFinished);
+		}
+
+		double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		return (double)article.size() * rounds / elapsed / 1024.0 / 1024.0;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(YEncDecoderBenchmark)
+{
+	YEncode::init();
+
+	// typical article size and the default of option ArticleReadChunkSize
+	std::string article = MakeArticle(750 * 1024);
+	const int chunkSize = 4 * 1024;
+	const int rounds = 200;
+
+	double plainMBs = Decode(article, false, chunkSize, rounds);
+	double crcMBs = Decode(article, true, chunkSize, rounds);
+
+	BOOST_TEST_MESSAGE("yEnc decoder (" << (YEncode::decode_simd ? "simd" : "scalar") << " decoder, " <<
+		(YEncode::crc_simd ? "simd" : "scalar") << " crc), " << chunkSize / 1024 << " KB chunks: " <<
+		(int)plainMBs << " MB/s without CRC, " << (int)crcMBs << " MB/s with CRC");
+	BOOST_CHECK(plainMBs > 0);
+	BOOST_CHECK(crcMBs > 0);
+}
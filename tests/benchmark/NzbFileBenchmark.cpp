@@ -0,0 +1,125 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "Options.h"
+#include "NzbFile.h"
+
+namespace fs = boost::filesystem;
+
+namespace
+{
+	const fs::path CURR_DIR = fs::current_path();
+
+	double Measure(const std::function<void()>& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	// compares the parser with plain libxml SAX parsing without any processing
+	void Benchmark(const fs::path& filename, int repeat)
+	{
+		double saxTime = Measure([&]()
+			{
+				for (int i = 0; i < repeat; i++)
+				{
+					xmlSAXHandler handler = {};
+					BOOST_REQUIRE_EQUAL(xmlSAXUserParseFile(&handler, nullptr, filename.string().c_str()), 0);
+				}
+			});
+
+		std::unique_ptr<NzbInfo> nzbInfo;
+		double parseTime = Measure([&]()
+			{
+				for (int i = 0; i < repeat; i++)
+				{
+					NzbFile nzbFile(filename.string().c_str(), "");
+					BOOST_REQUIRE(nzbFile.Parse());
+					nzbInfo = nzbFile.DetachNzbInfo();
+				}
+			});
+
+		int articles = 0;
+		int64 arenaSize = 0;
+		for (FileInfo* fileInfo : nzbInfo->GetFileList())
+		{
+			articles += (int)fileInfo->GetArticles()->size();
+			arenaSize += fileInfo->GetMessageIds()->GetCapacity();
+		}
+
+		BOOST_TEST_MESSAGE(filename.filename().string() << " (" << nzbInfo->GetFileCount() << " files, " <<
+			articles << " segments, " << arenaSize / 1024 << " KB message-ids) x" << repeat << ": libxml SAX " <<
+			(int)saxTime << " ms, parser " << (int)parseTime << " ms");
+
+		xmlCleanupParser();
+	}
+
+	void WriteSyntheticNzb(const fs::path& filename, int fileCount, int segmentCount)
+	{
+		std::string content = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+			"<!DOCTYPE nzb PUBLIC \"-//newzBin//DTD NZB 1.0//EN\" \"http://www.newzbin.com/DTD/nzb/nzb-1.0.dtd\">\n"
+			"<nzb xmlns=\"http://www.newzbin.com/DTD/2003/nzb\">\n"
+			"<head>\n<meta type=\"category\">TV</meta>\n</head>\n";
+
+		for (int i = 0; i < fileCount; i++)
+		{
+			content += BString<1024>("<file poster=\"poster &lt;poster@example.com&gt;\" date=\"1700000000\" "
+				"subject=\"[%i/%i] - &quot;some.show.s01.part%03i.rar&quot; yEnc (1/%i)\">\n"
+				"<groups>\n<group>alt.binaries.multimedia</group>\n<group>alt.binaries.tv</group>\n</groups>\n"
+				"<segments>\n", i + 1, fileCount, i + 1, segmentCount);
+			for (int k = 1; k <= segmentCount; k++)
+			{
+				content += BString<1024>("<segment bytes=\"739811\" number=\"%i\">"
+					"Part%iof%i.%08X%08X@powerpost2000AA.local</segment>\n", k, k, segmentCount, i * 7919, k * 104729);
+			}
+			content += "</segments>\n</file>\n";
+		}
+
+		content += "</nzb>\n";
+
+		FILE* file = fopen(filename.string().c_str(), FOPEN_WB);
+		BOOST_REQUIRE(file);
+		fwrite(content.data(), 1, content.length(), file);
+		fclose(file);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(NZBParserBenchmark)
+{
+	Options::CmdOptList cmdOpts;
+	Options options(&cmdOpts, nullptr);
+
+	for (const char* name : {"dotless", "plain", "passwd{{thisisthepassword}}", "passwdMeta"})
+	{
+		Benchmark(CURR_DIR / "nzbfile" / (std::string(name) + ".nzb"), 100);
+	}
+
+	// scaled-up nzbs, the largest one has 400000 segments like a big season pack
+	for (int fileCount : {10, 50, 200})
+	{
+		const fs::path filename = CURR_DIR / "nzbfile-synthetic.nzb";
+		WriteSyntheticNzb(filename, fileCount, 2000);
+		Benchmark(filename, 1);
+		fs::remove(filename);
+	}
+}
@@ -0,0 +1,185 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "ResponseWriter.h"
+#include "DownloadInfo.h"
+#include "Util.h"
+
+namespace
+{
+	const char* JSON_FILE_ITEM =
+		"{\n"
+		"\"ID\" : %i,\n"
+		"\"FileSizeLo\" : %u,\n"
+		"\"FileSizeHi\" : %u,\n"
+		"\"PostTime\" : %i,\n"
+		"\"NZBID\" : %i,\n"
+		"\"NZBName\" : \"%s\",\n"
+		"\"Subject\" : \"%s\",\n"
+		"\"Filename\" : \"%s\",\n"
+		"\"DestDir\" : \"%s\",\n"
+		"\"Category\" : \"%s\"\n"
+		"}";
+
+	const char* JSON_GROUP_ITEM =
+		"{\n"
+		"\"NZBID\" : %i,\n"
+		"\"NZBName\" : \"%s\",\n"
+		"\"NZBFilename\" : \"%s\",\n"
+		"\"RemainingSizeLo\" : %u,\n"
+		"\"RemainingSizeHi\" : %u,\n"
+		"\"FileCount\" : %i,\n"
+		"\"DestDir\" : \"%s\",\n"
+		"\"Category\" : \"%s\",\n"
+		"\"DupeKey\" : \"%s\"\n"
+		"}";
+
+	// formats like XmlCommand did before ResponseWriter: printf with an encoded copy of every string
+	void AppendFilesPrintf(StringBuilder& output, NzbList* queue)
+	{
+		for (NzbInfo* nzbInfo : queue)
+		{
+			for (FileInfo* fileInfo : nzbInfo->GetFileList())
+			{
+				uint32 sizeHi, sizeLo;
+				Util::SplitInt64(fileInfo->GetSize(), &sizeHi, &sizeLo);
+				output.Append(",\n");
+				output.AppendFmt(JSON_FILE_ITEM, fileInfo->GetId(), sizeLo, sizeHi, (int)fileInfo->GetTime(),
+					nzbInfo->GetId(), *WebUtil::JsonEncode(nzbInfo->GetName()),
+					*WebUtil::JsonEncode(fileInfo->GetSubject()), *WebUtil::JsonEncode(fileInfo->GetFilename()),
+					*WebUtil::JsonEncode(nzbInfo->GetDestDir()), *WebUtil::JsonEncode(nzbInfo->GetCategory()));
+			}
+		}
+	}
+
+	void AppendFiles(ResponseWriter& writer, NzbList* queue)
+	{
+		for (NzbInfo* nzbInfo : queue)
+		{
+			for (FileInfo* fileInfo : nzbInfo->GetFileList())
+			{
+				uint32 sizeHi, sizeLo;
+				Util::SplitInt64(fileInfo->GetSize(), &sizeHi, &sizeLo);
+				writer.Append(",\n");
+				writer.AppendFmt(JSON_FILE_ITEM, fileInfo->GetId(), sizeLo, sizeHi, (int)fileInfo->GetTime(),
+					nzbInfo->GetId(), nzbInfo->GetName(), fileInfo->GetSubject(), fileInfo->GetFilename(),
+					nzbInfo->GetDestDir(), nzbInfo->GetCategory());
+			}
+		}
+	}
+
+	void AppendGroupsPrintf(StringBuilder& output, NzbList* queue)
+	{
+		for (NzbInfo* nzbInfo : queue)
+		{
+			uint32 sizeHi, sizeLo;
+			Util::SplitInt64(nzbInfo->GetRemainingSize(), &sizeHi, &sizeLo);
+			output.Append(",\n");
+			output.AppendFmt(JSON_GROUP_ITEM, nzbInfo->GetId(), *WebUtil::JsonEncode(nzbInfo->GetName()),
+				*WebUtil::JsonEncode(nzbInfo->GetFilename()), sizeLo, sizeHi, (int)nzbInfo->GetFileList()->size(),
+				*WebUtil::JsonEncode(nzbInfo->GetDestDir()), *WebUtil::JsonEncode(nzbInfo->GetCategory()),
+				*WebUtil::JsonEncode(nzbInfo->GetDupeKey()));
+		}
+	}
+
+	void AppendGroups(ResponseWriter& writer, NzbList* queue)
+	{
+		for (NzbInfo* nzbInfo : queue)
+		{
+			uint32 sizeHi, sizeLo;
+			Util::SplitInt64(nzbInfo->GetRemainingSize(), &sizeHi, &sizeLo);
+			writer.Append(",\n");
+			writer.AppendFmt(JSON_GROUP_ITEM, nzbInfo->GetId(), nzbInfo->GetName(), nzbInfo->GetFilename(),
+				sizeLo, sizeHi, (int)nzbInfo->GetFileList()->size(), nzbInfo->GetDestDir(),
+				nzbInfo->GetCategory(), nzbInfo->GetDupeKey());
+		}
+	}
+
+	double Measure(const std::function<void()>& func)
+	{
+		auto start = std::chrono::steady_clock::now();
+		func();
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+
+	void Compare(const char* name, NzbList* queue,
+		std::function<void(StringBuilder&, NzbList*)> printfFunc,
+		std::function<void(ResponseWriter&, NzbList*)> writerFunc)
+	{
+		StringBuilder printfOutput;
+		double printfTime = Measure([&]() { printfFunc(printfOutput, queue); });
+
+		StringBuilder directOutput;
+		ResponseWriter direct(directOutput);
+		direct.SetJson(true);
+		double directTime = Measure([&]() { writerFunc(direct, queue); });
+
+		StringBuilder deferredOutput;
+		ResponseWriter deferred(deferredOutput);
+		deferred.SetJson(true);
+		deferred.SetDeferred(true);
+		double snapshotTime = Measure([&]() { writerFunc(deferred, queue); });
+		double flushTime = Measure([&]() { deferred.SetDeferred(false); });
+
+		BOOST_TEST_MESSAGE(name << " (" << printfOutput.Length() / 1024 << " KB): printf " << (int)printfTime <<
+			" ms, writer " << (int)directTime << " ms, snapshot under lock " << (int)snapshotTime <<
+			" ms + formatting " << (int)flushTime << " ms");
+
+		BOOST_CHECK_EQUAL(printfOutput.Length(), directOutput.Length());
+		BOOST_CHECK(!strcmp(printfOutput, directOutput));
+		BOOST_CHECK(!strcmp(printfOutput, deferredOutput));
+	}
+}
+
+// Synthetic queue with 100000 files in 1000 groups
+BOOST_AUTO_TEST_CASE(ResponseWriterBenchmark)
+{
+	NzbList queue;
+	for (int i = 0; i < 1000; i++)
+	{
+		std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
+		nzbInfo->SetName(BString<100>("Some.Show.S01E%02i.1080p.WEB-DL \"group\"", i % 100));
+		nzbInfo->SetFilename(BString<100>("Some.Show.S01E%02i.1080p.nzb", i % 100));
+		nzbInfo->SetDestDir(BString<100>("/downloads/intermediate/Some.Show.S01E%02i.#%i", i % 100, i));
+		nzbInfo->SetCategory("tv");
+		nzbInfo->SetDupeKey(BString<100>("tvdb=12345-S01E%02i", i % 100));
+
+		for (int k = 0; k < 100; k++)
+		{
+			std::unique_ptr<FileInfo> fileInfo = std::make_unique<FileInfo>();
+			fileInfo->SetNzbInfo(nzbInfo.get());
+			fileInfo->SetSubject(BString<1024>("[%i/100] - \"some.show.s01e%02i.part%03i.rar\" yEnc (1/137)",
+				k + 1, i % 100, k));
+			fileInfo->SetFilename(BString<100>("some.show.s01e%02i.part%03i.rar", i % 100, k));
+			fileInfo->SetSize(100000000 + k);
+			fileInfo->SetTime(1700000000 + k);
+			nzbInfo->GetFileList()->Add(std::move(fileInfo));
+		}
+
+		nzbInfo->SetSize(100 * 100000000ll);
+		nzbInfo->SetRemainingSize(100 * 100000000ll);
+		queue.Add(std::move(nzbInfo));
+	}
+
+	Compare("listfiles", &queue, AppendFilesPrintf, AppendFiles);
+	Compare("listgroups", &queue, AppendGroupsPrintf, AppendGroups);
+}
@@ -39,6 +39,7 @@ public:
 	int m_newsServers;
 	int m_feeds;
 	int m_tasks;
+	std::vector<int> m_pipelining;
 	std::vector<FeedInfo::CategorySource> m_categorySources;
 
 	OptionsExtenderMock() : m_newsServers(0), m_feeds(0), m_tasks(0) {}
@@ -47,9 +48,10 @@ protected:
 	void AddNewsServer(int id, bool active, const char* name, const char* host,
 		int port, int ipVersion, const char* user, const char* pass, bool joinGroup, bool tls,
 		const char* cipher, int maxConnections, int retention, 
-		int level, int group, bool optional, unsigned int certVerificationfLevel) override
+		int level, int group, bool optional, unsigned int certVerificationfLevel, int pipelining) override
 	{
 		m_newsServers++;
+		m_pipelining.push_back(pipelining);
 	}
 
 	void AddFeed(
@@ -106,6 +108,7 @@ BOOST_AUTO_TEST_CASE(CallingExtender)
 	cmdOpts.push_back("Server1.Host=news.mynewsserver.com");
 	cmdOpts.push_back("Server1.Port=119");
 	cmdOpts.push_back("Server1.Connections=4");
+	cmdOpts.push_back("Server1.Pipelining=8");
 
 	cmdOpts.push_back("Server2.Host=news1.mynewsserver.com");
 	cmdOpts.push_back("Server2.Port=563");
@@ -121,6 +124,8 @@ BOOST_AUTO_TEST_CASE(CallingExtender)
 	Options options(&cmdOpts, &extender);
 
 	BOOST_CHECK_EQUAL(extender.m_newsServers, 2);
+	BOOST_CHECK_EQUAL(extender.m_pipelining[0], 8);
+	BOOST_CHECK_EQUAL(extender.m_pipelining[1], 1);
 	BOOST_CHECK_EQUAL(extender.m_feeds, 1);
 	BOOST_CHECK_EQUAL(extender.m_tasks, 24);
 	BOOST_CHECK_EQUAL(extender.m_categorySources[0], FeedInfo::CategorySource::NZBFile);
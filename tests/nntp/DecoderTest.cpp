@@ -255,3 +255,76 @@ BOOST_AUTO_TEST_CASE(UnusualMultipartMessageTest)
     BOOST_CHECK_EQUAL(eof, true);
     BOOST_CHECK_EQUAL(res, "get");
 }
+
+/**
+ * Pipelined responses, the buffer contains the beginning of the next response
+ * after the end of article marker:
+ * 
+ * =ybegin line=128 size=6 name=name.dat\r\n
+ * ...data\r\n
+ * =yend size=6\r\n
+ * .\r\n
+ * 222 0 <next@id> body\r\n
+ * =ybegin line=128 size=6 name=next.dat\r\n
+*/
+BOOST_AUTO_TEST_CASE(PipelinedMessageTest)
+{
+    Decoder decoder;
+    decoder.SetCrcCheck(true);
+    std::stringstream ss;
+
+    const std::string data = "nzbget";
+    const std::string filename = "name.dat";
+    const std::string encodedData = yEncEncode(data);
+    const std::string next = "222 0 <next@id> body\r\n=ybegin line=128 size=6 name=next.dat\r\n";
+
+    ss << "=ybegin line=128 size=" << data.size() << " name=" << filename << "\r\n";
+    ss << encodedData << "\r\n";
+    ss << "=yend size=" << data.size() << "\r\n";
+    ss << ".\r\n";
+    ss << next;
+
+    std::string msg = ss.str();
+
+    int len = decoder.DecodeBuffer(msg.data(), msg.size());
+
+    auto status = decoder.Check();
+    auto eof = decoder.GetEof();
+    auto res = msg.substr(0, len);
+    auto trailing = std::string(decoder.GetTrailingData(), decoder.GetTrailingLength());
+
+    BOOST_CHECK_EQUAL(status, Decoder::dsFinished);
+    BOOST_CHECK_EQUAL(eof, true);
+    BOOST_CHECK_EQUAL(res, "nzbget");
+    BOOST_CHECK_EQUAL(trailing, next);
+}
+
+BOOST_AUTO_TEST_CASE(SeparateOutputBufferTest)
+{
+    Decoder decoder;
+    decoder.SetCrcCheck(true);
+    std::stringstream ss;
+
+    const std::string data = "nzbget";
+    const std::string encodedData = yEncEncode(data);
+
+    ss << "=ybegin line=128 size=" << data.size() << " name=name.dat\r\n";
+    std::string header = ss.str();
+    ss.str("");
+    ss << encodedData << "\r\n";
+    ss << "=yend size=" << data.size() << " crc32=a30bff0d\r\n";
+    ss << ".\r\n";
+    std::string body = ss.str();
+
+    int len = decoder.DecodeBuffer(header.data(), header.size());
+    BOOST_CHECK_EQUAL(len, 0);
+
+    std::string out(body.size(), '\0');
+    len = decoder.DecodeBuffer(body.data(), body.size(), out.data());
+
+    BOOST_CHECK_EQUAL(decoder.Check(), Decoder::dsFinished);
+    BOOST_CHECK_EQUAL(decoder.GetCalculatedCrc(), 0xa30bff0d);
+    BOOST_CHECK_EQUAL(decoder.GetEof(), true);
+    BOOST_CHECK_EQUAL(out.substr(0, len), data);
+    BOOST_CHECK_EQUAL(body.substr(0, data.size()), encodedData);
+}
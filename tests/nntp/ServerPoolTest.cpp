@@ -35,7 +35,7 @@ extern DiskState* g_DiskState;
 void AddTestServer(ServerPool* pool, int id, bool active, int level, bool optional, int group, int connections)
 {
 	pool->AddServer(std::make_unique<NewsServer>(id, active, nullptr, "", 119, 0,
-		"", "", false, false, nullptr, connections, 0, level, group, optional, Options::cvStrict));
+		"", "", false, false, nullptr, connections, 0, level, group, optional, Options::cvStrict, 1));
 }
 
 void TestBlockServers(int group)
@@ -207,6 +207,11 @@ BOOST_AUTO_TEST_CASE(ActiveOnOffTest)
 	pool.Changed();
 	BOOST_CHECK(pool.GetGeneration() == 2);
 
+	// pipelining changes must not restart running downloads
+	pool.PipeliningChanged();
+	BOOST_CHECK(pool.GetGeneration() == 2);
+	BOOST_CHECK(pool.GetPipeliningGeneration() == 1);
+
 	con1 = pool.GetConnection(0, nullptr, nullptr);
 	con2 = pool.GetConnection(0, nullptr, nullptr);
 	con3 = pool.GetConnection(0, nullptr, nullptr);
@@ -48,7 +48,25 @@ public:
 		const char* args) { return false; }
 	void HistoryChanged() {}
 	void Save() {};
-	void SaveChanged() {}
+
+	void SaveChanged()
+	{
+		::Guard guard(m_saveMutex);
+		m_saveCount++;
+		m_saveCond.NotifyAll();
+	}
+
+	bool WaitSaveChanged(int msec)
+	{
+		::Guard guard(m_saveMutex);
+		m_saveCond.WaitFor(m_saveMutex, msec, [&]{ return m_saveCount > 0; });
+		return m_saveCount > 0;
+	}
+
+private:
+	Mutex m_saveMutex;
+	ConditionVar m_saveCond;
+	int m_saveCount = 0;
 };
 
 BOOST_AUTO_TEST_CASE(DirectUnpackSimpleTest)
@@ -190,3 +208,47 @@ BOOST_AUTO_TEST_CASE(DirectUnpackTwoArchives)
 	BOOST_CHECK(fs::exists(resultFile2));
 	BOOST_REQUIRE(fs::remove_all(WORKING_DIR));
 }
+
+BOOST_AUTO_TEST_CASE(DirectUnpackWaitTest)
+{
+	Options::CmdOptList cmdOpts;
+	cmdOpts.push_back("WriteLog=none");
+	cmdOpts.push_back("NzbLog=no");
+	Options options(&cmdOpts, nullptr);
+
+	DirectUnpackDownloadQueueMock downloadQueue;
+
+	BOOST_REQUIRE(FileSystem::CreateDirectory(WORKING_DIR.string().c_str()));
+
+	std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
+	NzbInfo* nzbPtr = nzbInfo.get();
+	nzbInfo->SetName("DirectUnpackWaitTest");
+	nzbInfo->SetDestDir(WORKING_DIR.string().c_str());
+	downloadQueue.GetQueue()->Add(std::move(nzbInfo), false);
+
+	DirectUnpack::StartJob(nzbPtr);
+
+	// without archives the thread waits for volumes until the nzb is completed
+	std::thread notifier([&]()
+		{
+			GuardedDownloadQueue downloadQueue = DownloadQueue::Guard();
+			static_cast<DirectUnpack*>(nzbPtr->GetUnpackThread())->NzbDownloaded(downloadQueue, nzbPtr);
+		});
+
+	// the thread saves the queue once it has finished
+	if (!downloadQueue.WaitSaveChanged(5000))
+	{
+		// the unpack thread holds the lock, can't clean up
+		notifier.detach();
+		BOOST_FAIL("Direct unpack thread is blocked");
+	}
+	notifier.join();
+
+	// nothing was unpacked
+	{
+		GuardedDownloadQueue guard = DownloadQueue::Guard();
+		BOOST_CHECK_EQUAL(nzbPtr->GetDirectUnpackStatus(), NzbInfo::nsNone);
+		BOOST_CHECK(nzbPtr->GetUnpackThread() == nullptr);
+	}
+	BOOST_REQUIRE(fs::remove_all(WORKING_DIR));
+}
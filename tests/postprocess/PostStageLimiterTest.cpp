@@ -0,0 +1,96 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "PostStageLimiter.h"
+
+namespace
+{
+	NzbInfo* AddJob(std::vector<std::unique_ptr<NzbInfo>>& jobs, RawNzbList& activeJobs,
+		PostInfo::EStage stage, int64 deviceId)
+	{
+		jobs.push_back(std::make_unique<NzbInfo>());
+		NzbInfo* nzbInfo = jobs.back().get();
+		nzbInfo->EnterPostProcess();
+		nzbInfo->GetPostInfo()->SetStage(stage);
+		nzbInfo->GetPostInfo()->SetWorking(true);
+		nzbInfo->GetPostInfo()->SetDeviceId(deviceId);
+		activeJobs.push_back(nzbInfo);
+		return nzbInfo;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(PostStageLimiterClassTest)
+{
+	std::vector<std::unique_ptr<NzbInfo>> jobs;
+	RawNzbList activeJobs;
+	PostStageLimiter limiter(1, 2, 1);
+
+	NzbInfo* candidate = AddJob(jobs, activeJobs, PostInfo::ptQueued, 1);
+	candidate->GetPostInfo()->SetWorking(false);
+
+	AddJob(jobs, activeJobs, PostInfo::ptExecutingScript, 1);
+	BOOST_CHECK(!limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptExecutingScript, 1));
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptRepairing, 1));
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptUnpacking, 1));
+
+	// a par-check job holding a repair slot counts as repair during all its stages
+	NzbInfo* repair = AddJob(jobs, activeJobs, PostInfo::ptVerifyingRepaired, 1);
+	repair->GetPostInfo()->SetRepairSlot(true);
+	BOOST_CHECK(!limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptRepairing, 1));
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptUnpacking, 1));
+
+	// a job waiting for a repair slot occupies no slot
+	repair->GetPostInfo()->SetRepairSlot(false);
+	repair->GetPostInfo()->SetWaitingRepair(true);
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptRepairing, 1));
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptUnpacking, 1));
+
+	// the job itself is not counted
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, activeJobs[1]->GetPostInfo(), PostInfo::ptExecutingScript, 1));
+
+	// queued and finished jobs are never limited
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptFinished, 1));
+}
+
+BOOST_AUTO_TEST_CASE(PostStageLimiterDeviceTest)
+{
+	std::vector<std::unique_ptr<NzbInfo>> jobs;
+	RawNzbList activeJobs;
+	PostStageLimiter limiter(1, 2, 1);
+
+	NzbInfo* candidate = AddJob(jobs, activeJobs, PostInfo::ptQueued, 1);
+	candidate->GetPostInfo()->SetWorking(false);
+
+	AddJob(jobs, activeJobs, PostInfo::ptUnpacking, 1);
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptMoving, 1));
+
+	AddJob(jobs, activeJobs, PostInfo::ptMoving, 1);
+	BOOST_CHECK(!limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptMoving, 1));
+	BOOST_CHECK(!limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptUnpacking, 1));
+
+	// disk stages are limited per disk
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptUnpacking, 2));
+	AddJob(jobs, activeJobs, PostInfo::ptCleaningUp, 2);
+	AddJob(jobs, activeJobs, PostInfo::ptUnpacking, 2);
+	BOOST_CHECK(!limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptUnpacking, 2));
+	BOOST_CHECK(limiter.CanEnterStage(activeJobs, candidate->GetPostInfo(), PostInfo::ptUnpacking, 3));
+}
@@ -0,0 +1,102 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "DownloadInfo.h"
+#include "Options.h"
+
+namespace
+{
+	class TestSegmentData : public SegmentData
+	{
+	public:
+		TestSegmentData(const char* data, int* released) : m_data(data), m_released(released) {}
+		~TestSegmentData() { (*m_released)++; }
+		char* GetData() override { return const_cast<char*>(m_data); }
+
+	private:
+		const char* m_data;
+		int* m_released;
+	};
+}
+
+BOOST_AUTO_TEST_CASE(ArticleListTest)
+{
+	Options::CmdOptList cmdOpts;
+	Options options(&cmdOpts, nullptr);
+
+	// the queue may hold millions of articles
+	BOOST_CHECK_LE(sizeof(ArticleInfo), 40);
+
+	FileInfo fileInfo;
+	for (int part = 1; part <= 100; part++)
+	{
+		ArticleInfo* article = fileInfo.GetArticles()->Add();
+		article->SetPartNumber(part);
+		article->SetSize(1000 + part);
+		article->SetMessageId(fileInfo.GetMessageIds(), BString<100>("part%i@test", part));
+	}
+
+	int part = 0;
+	for (ArticleInfo* article : fileInfo.GetArticles())
+	{
+		part++;
+		BOOST_CHECK_EQUAL(article->GetPartNumber(), part);
+		BOOST_CHECK_EQUAL(article->GetSize(), 1000 + part);
+		BOOST_CHECK_EQUAL(article->GetMessageId(), std::string(BString<100>("part%i@test", part)));
+		BOOST_CHECK_EQUAL(article->GetStatus(), ArticleInfo::aiUndefined);
+		BOOST_CHECK(!article->GetHasResultFile());
+	}
+	BOOST_CHECK_EQUAL(part, 100);
+
+	ArticleInfo* article5 = &fileInfo.GetArticles()->at(4);
+	ArticleInfo* article7 = &fileInfo.GetArticles()->at(6);
+
+	// result files are named after file id and part number
+	BOOST_CHECK_EQUAL(fileInfo.GetResultFilename(article5), "");
+	article5->SetHasResultFile(true);
+	BOOST_CHECK_EQUAL(fileInfo.GetResultFilename(article5),
+		std::string(BString<1024>("%s%c%i.005", g_Options->GetTempDir(), PATH_SEPARATOR, fileInfo.GetId())));
+
+	// segments in article cache are kept in side table
+	int released = 0;
+	BOOST_CHECK(fileInfo.GetSegmentArticles().empty());
+	fileInfo.AttachSegment(article7, std::make_unique<TestSegmentData>("seven", &released), 6000, 5);
+	fileInfo.AttachSegment(article5, std::make_unique<TestSegmentData>("five", &released), 4000, 4);
+	BOOST_CHECK_EQUAL(article7->GetSegmentOffset(), 6000);
+	BOOST_CHECK_EQUAL(article7->GetSegmentSize(), 5);
+	BOOST_CHECK_EQUAL(fileInfo.GetSegmentContent(article5), "five");
+	BOOST_CHECK(fileInfo.GetSegmentContent(&fileInfo.GetArticles()->at(5)) == nullptr);
+
+	std::vector<ArticleInfo*> cached = fileInfo.GetSegmentArticles();
+	BOOST_REQUIRE_EQUAL(cached.size(), 2);
+	BOOST_CHECK(cached[0] == article5);
+	BOOST_CHECK(cached[1] == article7);
+
+	fileInfo.DiscardSegment(article5);
+	BOOST_CHECK_EQUAL(released, 1);
+	BOOST_CHECK(fileInfo.GetSegmentContent(article5) == nullptr);
+
+	fileInfo.DiscardArticles();
+	BOOST_CHECK_EQUAL(released, 2);
+	BOOST_CHECK(fileInfo.GetArticles()->empty());
+	BOOST_CHECK_EQUAL(fileInfo.GetMessageIds()->GetSize(), 0);
+}
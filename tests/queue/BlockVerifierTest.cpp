@@ -0,0 +1,182 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "BlockVerifier.h"
+#include "YEncode.h"
+
+namespace
+{
+	const int BLOCK_SIZE = 1024;
+	const int ARTICLE_SIZE = 700;
+	const int FILE_SIZE = 10000;
+
+	uint32 CalcCrc(const char* data, int size)
+	{
+		Crc32 crc;
+		crc.Append((uchar*)data, size);
+		return crc.Finish();
+	}
+
+	std::vector<uint32> CalcBlockCrcs(const std::vector<char>& data)
+	{
+		std::vector<uint32> crcs;
+		for (int offset = 0; offset < (int)data.size(); offset += BLOCK_SIZE)
+		{
+			std::vector<char> block(BLOCK_SIZE, 0);
+			std::copy(data.begin() + offset, data.begin() + std::min(offset + BLOCK_SIZE, (int)data.size()), block.begin());
+			crcs.push_back(CalcCrc(block.data(), BLOCK_SIZE));
+		}
+		return crcs;
+	}
+
+	void AddArticle(BlockVerifier& verifier, const std::vector<char>& data, int offset, bool withPieces)
+	{
+		int size = std::min(ARTICLE_SIZE, (int)data.size() - offset);
+
+		// data is passed in two chunks like it comes from decoder
+		BlockCrcCalculator calculator;
+		calculator.Start(withPieces ? BLOCK_SIZE : 0, offset, size);
+		calculator.Append(data.data() + offset, size / 3);
+		calculator.Append(data.data() + offset + size / 3, size - size / 3);
+
+		verifier.AddArticle(offset, size, CalcCrc(data.data() + offset, size), calculator.GetCrcs());
+	}
+
+	std::vector<char> MakeData()
+	{
+		YEncode::init();
+
+		std::vector<char> data(FILE_SIZE);
+		for (int i = 0; i < FILE_SIZE; i++)
+		{
+			data[i] = (char)(i * 7 + i / 13);
+		}
+		return data;
+	}
+}
+
+BOOST_AUTO_TEST_CASE(BlockVerifierAllValidTest)
+{
+	std::vector<char> data = MakeData();
+	BlockVerifier verifier(FILE_SIZE, BLOCK_SIZE, CalcBlockCrcs(data));
+	BOOST_CHECK_EQUAL(verifier.GetBlockCount(), 10);
+
+	// articles complete in random order
+	std::vector<int> offsets;
+	for (int offset = 0; offset < FILE_SIZE; offset += ARTICLE_SIZE)
+	{
+		offsets.push_back(offset);
+	}
+	std::reverse(offsets.begin(), offsets.end());
+	std::swap(offsets[2], offsets[7]);
+
+	for (int offset : offsets)
+	{
+		AddArticle(verifier, data, offset, true);
+	}
+
+	BOOST_CHECK_EQUAL(verifier.GetValidBlocks(), 10);
+	BOOST_CHECK(verifier.Finish());
+	BOOST_CHECK_EQUAL(verifier.GetDamagedBlocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BlockVerifierDamagedTest)
+{
+	std::vector<char> data = MakeData();
+	BlockVerifier verifier(FILE_SIZE, BLOCK_SIZE, CalcBlockCrcs(data));
+
+	// article at 2100 (block 2) has wrong data
+	data[2200] ^= 1;
+
+	for (int offset = 0; offset < FILE_SIZE; offset += ARTICLE_SIZE)
+	{
+		// article at 4900 (blocks 4 and 5) failed
+		if (offset != 4900)
+		{
+			AddArticle(verifier, data, offset, true);
+		}
+	}
+
+	BOOST_CHECK(verifier.Finish());
+	const BlockVerifier::BlockStatusList& status = verifier.GetBlockStatus();
+	BOOST_CHECK_EQUAL(status[2], BlockVerifier::bsDamaged);
+	BOOST_CHECK_EQUAL(status[4], BlockVerifier::bsDamaged);
+	BOOST_CHECK_EQUAL(status[5], BlockVerifier::bsDamaged);
+	BOOST_CHECK_EQUAL(verifier.GetValidBlocks(), 7);
+	BOOST_CHECK_EQUAL(verifier.GetDamagedBlocks(), 3);
+}
+
+BOOST_AUTO_TEST_CASE(BlockVerifierUnknownPiecesTest)
+{
+	std::vector<char> data = MakeData();
+	BlockVerifier verifier(FILE_SIZE, BLOCK_SIZE, CalcBlockCrcs(data));
+
+	for (int offset = 0; offset < FILE_SIZE; offset += ARTICLE_SIZE)
+	{
+		// article at 700 crosses the boundary of blocks 0 and 1, its pieces are unknown
+		AddArticle(verifier, data, offset, offset != 700);
+	}
+
+	BOOST_CHECK(verifier.Finish());
+	const BlockVerifier::BlockStatusList& status = verifier.GetBlockStatus();
+	BOOST_CHECK_EQUAL(status[0], BlockVerifier::bsUnknown);
+	BOOST_CHECK_EQUAL(status[1], BlockVerifier::bsUnknown);
+	BOOST_CHECK_EQUAL(status[2], BlockVerifier::bsValid);
+	BOOST_CHECK_EQUAL(verifier.GetValidBlocks(), 8);
+	BOOST_CHECK_EQUAL(verifier.GetDamagedBlocks(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BlockVerifierWrongFileTest)
+{
+	std::vector<char> data = MakeData();
+	BlockVerifier verifier(FILE_SIZE - 100, BLOCK_SIZE, CalcBlockCrcs(data));
+
+	for (int offset = 0; offset < FILE_SIZE; offset += ARTICLE_SIZE)
+	{
+		AddArticle(verifier, data, offset, true);
+	}
+
+	BOOST_CHECK(!verifier.Finish());
+}
+
+BOOST_AUTO_TEST_CASE(BlockVerifierCrcMapTest)
+{
+	std::vector<char> data = MakeData();
+	BlockVerifier verifier(FILE_SIZE, BLOCK_SIZE, CalcBlockCrcs(data));
+
+	for (int offset = FILE_SIZE / ARTICLE_SIZE * ARTICLE_SIZE; offset >= 0; offset -= ARTICLE_SIZE)
+	{
+		AddArticle(verifier, data, offset, offset != 700);
+	}
+
+	// pieces are sorted and split at block boundaries, except of article without pieces
+	BlockVerifier::CrcMap crcMap = verifier.GetCrcMap();
+	int64 pos = 0;
+	for (BlockVerifier::CrcRange& range : crcMap)
+	{
+		BOOST_CHECK_EQUAL(range.offset, pos);
+		BOOST_CHECK(range.offset == 700 || range.offset / BLOCK_SIZE == (range.offset + range.size - 1) / BLOCK_SIZE);
+		BOOST_CHECK_EQUAL(range.crc, CalcCrc(data.data() + range.offset, range.size));
+		pos += range.size;
+	}
+	BOOST_CHECK_EQUAL(pos, FILE_SIZE);
+}
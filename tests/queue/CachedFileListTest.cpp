@@ -0,0 +1,155 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "DownloadInfo.h"
+
+BOOST_AUTO_TEST_CASE(CachedFileListTest)
+{
+	CachedFileList* cachedFiles = FileInfo::GetCachedFiles();
+
+	auto file1 = std::make_unique<FileInfo>();
+	auto file2 = std::make_unique<FileInfo>();
+	auto file3 = std::make_unique<FileInfo>();
+
+	BOOST_CHECK(cachedFiles->Acquire(true) == nullptr);
+
+	file2->SetCachedArticles(1);
+	file1->SetCachedArticles(2);
+	file3->SetCachedArticles(1);
+	file2->SetCachedArticles(5);
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 3);
+
+	// oldest first, a released file goes to the end of the list
+	BOOST_CHECK(cachedFiles->Acquire(false) == file2.get());
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 2);
+	cachedFiles->Release(file2.get());
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 3);
+
+	BOOST_CHECK(cachedFiles->Acquire(false) == file1.get());
+	cachedFiles->Release(file1.get());
+
+	file2->SetCachedArticles(0);
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 2);
+	BOOST_CHECK(cachedFiles->Acquire(false) == file3.get());
+	cachedFiles->Release(file3.get());
+
+	file1.reset();
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 1);
+	BOOST_CHECK(cachedFiles->Acquire(false) == file3.get());
+
+	// a flushed file is not linked again
+	file3->SetCachedArticles(0);
+	cachedFiles->Release(file3.get());
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 0);
+	BOOST_CHECK(cachedFiles->Acquire(true) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(CachedFileActiveTest)
+{
+	CachedFileList* cachedFiles = FileInfo::GetCachedFiles();
+
+	auto file1 = std::make_unique<FileInfo>();
+	auto file2 = std::make_unique<FileInfo>();
+	file1->SetActiveDownloads(1);
+	file1->SetCachedArticles(1);
+	file2->SetCachedArticles(1);
+
+	// files being downloaded are taken only if there are no idle files
+	BOOST_CHECK(cachedFiles->Acquire(true) == file2.get());
+	BOOST_CHECK(cachedFiles->Acquire(false) == nullptr);
+	BOOST_CHECK(cachedFiles->Acquire(true) == file1.get());
+	cachedFiles->Release(file1.get());
+	cachedFiles->Release(file2.get());
+
+	// the file becomes idle when its last download finishes
+	file1->SetActiveDownloads(0);
+	BOOST_CHECK(cachedFiles->Acquire(false) == file2.get());
+	BOOST_CHECK(cachedFiles->Acquire(false) == file1.get());
+	cachedFiles->Release(file1.get());
+	cachedFiles->Release(file2.get());
+
+	file2->SetActiveDownloads(2);
+	BOOST_CHECK(cachedFiles->Acquire(false) == file1.get());
+	cachedFiles->Release(file1.get());
+
+	file1->SetCachedArticles(0);
+	file2->SetCachedArticles(0);
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(CachedFileAcquireBusyTest)
+{
+	CachedFileList* cachedFiles = FileInfo::GetCachedFiles();
+
+	auto file1 = std::make_unique<FileInfo>();
+	auto file2 = std::make_unique<FileInfo>();
+	file1->SetCachedArticles(1);
+	file2->SetCachedArticles(1);
+
+	// each flusher gets its own file
+	BOOST_CHECK(cachedFiles->Acquire(true) == file1.get());
+	BOOST_CHECK(cachedFiles->Acquire(true) == file2.get());
+	BOOST_CHECK(cachedFiles->Acquire(true) == nullptr);
+	BOOST_CHECK(cachedFiles->IsBusy(file1.get()));
+
+	// a file getting more articles while being flushed stays busy
+	file1->SetCachedArticles(2);
+	BOOST_CHECK(cachedFiles->Acquire(true) == nullptr);
+
+	cachedFiles->Release(file1.get());
+	BOOST_CHECK(!cachedFiles->IsBusy(file1.get()));
+	BOOST_CHECK(cachedFiles->Acquire(true) == file1.get());
+
+	cachedFiles->Release(file1.get());
+	cachedFiles->Release(file2.get());
+	file1->SetCachedArticles(0);
+	file2->SetCachedArticles(0);
+}
+
+BOOST_AUTO_TEST_CASE(CachedFileBusyTest)
+{
+	CachedFileList* cachedFiles = FileInfo::GetCachedFiles();
+
+	auto fileInfo = std::make_unique<FileInfo>();
+	fileInfo->SetCachedArticles(1);
+
+	BOOST_REQUIRE(cachedFiles->Acquire(true) == fileInfo.get());
+
+	// the flusher removes the file from the list without waiting for itself
+	fileInfo->SetCachedArticles(0);
+	BOOST_CHECK_EQUAL(cachedFiles->GetCount(), 0);
+
+	std::atomic<bool> released{false};
+	FileInfo* busyFile = fileInfo.get();
+	std::thread flusher([&]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			released = true;
+			cachedFiles->Release(busyFile);
+		});
+
+	// the destructor waits until the file is released
+	fileInfo.reset();
+	BOOST_CHECK(released);
+
+	flusher.join();
+}
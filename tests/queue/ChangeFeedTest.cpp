@@ -0,0 +1,64 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "ChangeFeed.h"
+
+BOOST_AUTO_TEST_CASE(ChangeFeedTest)
+{
+	ChangeFeed feed;
+	int eventId = -1;
+
+	// unknown event: everything may have changed
+	BOOST_CHECK_EQUAL(feed.GetChanges(0, &eventId), ChangeFeed::ecAll);
+	BOOST_CHECK_EQUAL(eventId, 0);
+
+	ChangeFeed::Sample sample{1, 1, 10, 100};
+	BOOST_CHECK_EQUAL(feed.Update(sample), 0);
+	BOOST_CHECK_EQUAL(feed.Update(sample), 0);
+	BOOST_CHECK_EQUAL(feed.GetEventId(), 0);
+
+	sample.logId = 11;
+	BOOST_CHECK_EQUAL(feed.Update(sample), ChangeFeed::ecLog);
+	sample.queueGeneration = 2;
+	sample.statusHash = 101;
+	BOOST_CHECK_EQUAL(feed.Update(sample), ChangeFeed::ecQueue | ChangeFeed::ecStatus);
+	BOOST_CHECK_EQUAL(feed.GetEventId(), 2);
+
+	// changes are combined over all events after the given one
+	BOOST_CHECK_EQUAL(feed.GetChanges(2, &eventId), 0);
+	BOOST_CHECK_EQUAL(feed.GetChanges(1, &eventId), ChangeFeed::ecQueue | ChangeFeed::ecStatus);
+	BOOST_CHECK_EQUAL(feed.GetChanges(0, &eventId), ChangeFeed::ecAll);
+	BOOST_CHECK_EQUAL(eventId, 2);
+
+	// event from a previous run
+	BOOST_CHECK_EQUAL(feed.GetChanges(50, &eventId), ChangeFeed::ecAll);
+
+	// events older than the kept ones
+	for (int i = 0; i < 150; i++)
+	{
+		sample.historyGeneration++;
+		feed.Update(sample);
+	}
+	BOOST_CHECK_EQUAL(feed.GetEventId(), 152);
+	BOOST_CHECK_EQUAL(feed.GetChanges(2, &eventId), ChangeFeed::ecAll);
+	BOOST_CHECK_EQUAL(feed.GetChanges(100, &eventId), ChangeFeed::ecHistory);
+}
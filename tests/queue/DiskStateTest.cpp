@@ -0,0 +1,220 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "DiskState.h"
+#include "Options.h"
+#include "FileSystem.h"
+#include "TestDownloadQueue.h"
+
+BOOST_AUTO_TEST_CASE(FileStatesLoadTest)
+{
+	const char* queueDir = "DiskStateTest";
+	const int fileCount = 300;
+	CString errmsg;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+	BOOST_REQUIRE(FileSystem::CreateDirectory(queueDir));
+
+	Options* globalOptions = g_Options;
+	Options::CmdOptList cmdOpts;
+	cmdOpts.push_back("QueueDir=DiskStateTest");
+	cmdOpts.push_back("ContinuePartial=yes");
+	cmdOpts.push_back("DirectWrite=yes");
+	Options options(&cmdOpts, nullptr);
+
+	Servers servers;
+
+	{
+		TestDownloadQueue downloadQueue;
+		DiskState diskState;
+
+		std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
+		nzbInfo->SetName("test");
+		for (int i = 0; i < fileCount; i++)
+		{
+			std::unique_ptr<FileInfo> fileInfo = std::make_unique<FileInfo>();
+			fileInfo->SetSubject(BString<100>("subject %i", i));
+			fileInfo->SetFilename(BString<100>("file%03i.bin", i));
+			fileInfo->SetSize(3000 + i);
+			fileInfo->SetTotalArticles(3);
+			for (int part = 1; part <= 3; part++)
+			{
+				ArticleInfo* articleInfo = fileInfo->GetArticles()->Add();
+				articleInfo->SetPartNumber(part);
+				articleInfo->SetSize(1000);
+				articleInfo->SetMessageId(fileInfo->GetMessageIds(), BString<100>("%i-%i@test", i, part));
+			}
+			fileInfo->SetNzbInfo(nzbInfo.get());
+			nzbInfo->GetFileList()->Add(std::move(fileInfo));
+		}
+
+		for (FileInfo* fileInfo : nzbInfo->GetFileList())
+		{
+			BOOST_REQUIRE(diskState.SaveFile(fileInfo));
+
+			// every second file was partially downloaded
+			if (fileInfo->GetId() % 2 == 0)
+			{
+				ArticleInfo* articleInfo = &fileInfo->GetArticles()->at(0);
+				articleInfo->SetStatus(ArticleInfo::aiFinished);
+				articleInfo->SetSegmentOffset(-1);
+				articleInfo->SetSegmentSize(1000);
+				articleInfo->SetCrc(0xF0000000 + fileInfo->GetId());
+				fileInfo->SetSuccessArticles(1);
+				BOOST_REQUIRE(diskState.SaveFileState(fileInfo, false));
+			}
+		}
+
+		downloadQueue.GetQueue()->Add(std::move(nzbInfo));
+		BOOST_REQUIRE(diskState.SaveDownloadQueue(&downloadQueue, false));
+	}
+
+	{
+		TestDownloadQueue downloadQueue;
+		DiskState diskState;
+		BOOST_REQUIRE(diskState.LoadDownloadQueue(&downloadQueue, &servers));
+		BOOST_REQUIRE_EQUAL(downloadQueue.GetQueue()->size(), 1);
+
+		NzbInfo* nzbInfo = downloadQueue.GetQueue()->front().get();
+		BOOST_REQUIRE_EQUAL(nzbInfo->GetFileList()->size(), fileCount);
+
+		int index = 0;
+		for (FileInfo* fileInfo : nzbInfo->GetFileList())
+		{
+			BOOST_CHECK_EQUAL(fileInfo->GetFilename(), *BString<100>("file%03i.bin", index));
+			BOOST_CHECK_EQUAL(fileInfo->GetSize(), 3000 + index);
+
+			if (fileInfo->GetId() % 2 == 0)
+			{
+				BOOST_CHECK_EQUAL(fileInfo->GetPartialState(), FileInfo::psPartial);
+				BOOST_CHECK_EQUAL(fileInfo->GetSuccessArticles(), 1);
+				BOOST_CHECK_EQUAL(fileInfo->GetCompletedArticles(), 1);
+
+				// articles are loaded on demand
+				BOOST_CHECK(diskState.LoadArticles(fileInfo));
+				BOOST_CHECK(diskState.LoadFileState(fileInfo, &servers, false));
+				BOOST_CHECK_EQUAL(fileInfo->GetArticles()->at(0).GetCrc(), 0xF0000000 + fileInfo->GetId());
+				BOOST_CHECK_EQUAL(fileInfo->GetArticles()->at(0).GetSegmentOffset(), -1);
+			}
+			else
+			{
+				BOOST_CHECK_EQUAL(fileInfo->GetPartialState(), FileInfo::psNone);
+			}
+
+			index++;
+		}
+	}
+
+	g_Options = globalOptions;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+}
+
+BOOST_AUTO_TEST_CASE(CompletedFileStateCrcMapTest)
+{
+	const char* queueDir = "DiskStateTest";
+	CString errmsg;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+	BOOST_REQUIRE(FileSystem::CreateDirectory(queueDir));
+
+	Options* globalOptions = g_Options;
+	Options::CmdOptList cmdOpts;
+	cmdOpts.push_back("QueueDir=DiskStateTest");
+	Options options(&cmdOpts, nullptr);
+
+	DiskState diskState;
+
+	{
+		FileInfo fileInfo(1);
+		ArticleInfo* articleInfo = fileInfo.GetArticles()->Add();
+		articleInfo->SetStatus(ArticleInfo::aiFinished);
+		articleInfo->SetSegmentSize(1000);
+
+		// the map isn't saved for files still being downloaded
+		fileInfo.GetCrcMap()->push_back({0, 600, 0x11111111});
+		fileInfo.GetCrcMap()->push_back({600, 400, 0x22222222});
+		BOOST_REQUIRE(diskState.SaveFileState(&fileInfo, false));
+		BOOST_REQUIRE(diskState.SaveFileState(&fileInfo, true));
+	}
+
+	{
+		FileInfo fileInfo(1);
+		BOOST_REQUIRE(diskState.LoadFileState(&fileInfo, nullptr, false));
+		BOOST_CHECK(fileInfo.GetCrcMap()->empty());
+
+		BOOST_REQUIRE(diskState.LoadFileState(&fileInfo, nullptr, true));
+		BOOST_REQUIRE_EQUAL(fileInfo.GetCrcMap()->size(), 2);
+		BlockVerifier::CrcRange& range = fileInfo.GetCrcMap()->at(1);
+		BOOST_CHECK_EQUAL(range.offset, 600);
+		BOOST_CHECK_EQUAL(range.size, 400);
+		BOOST_CHECK_EQUAL(range.crc, 0x22222222);
+	}
+
+	// a corrupted size of the map fails loading instead of reserving memory
+	BString<1024> filename("%s%c%s", queueDir, PATH_SEPARATOR, "1c");
+	CharBuffer buffer;
+	BOOST_REQUIRE(FileSystem::LoadFileIntoBuffer(filename, buffer, true));
+	std::string content = *buffer;
+	size_t pos = content.rfind("\n2\n0,600,");
+	BOOST_REQUIRE(pos != std::string::npos);
+
+	for (const char* size : {"-1", "2000000000"})
+	{
+		std::string corrupted = content.substr(0, pos + 1) + size + content.substr(pos + 2);
+		BOOST_REQUIRE(FileSystem::SaveBufferIntoFile(filename, corrupted.c_str(), (int)corrupted.size()));
+		FileInfo fileInfo(1);
+		BOOST_CHECK(!diskState.LoadFileState(&fileInfo, nullptr, true));
+		BOOST_CHECK(fileInfo.GetCrcMap()->empty());
+	}
+
+	g_Options = globalOptions;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+}
+
+BOOST_AUTO_TEST_CASE(GenerationStateTest)
+{
+	const char* queueDir = "DiskStateTest";
+	CString errmsg;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+	BOOST_REQUIRE(FileSystem::CreateDirectory(queueDir));
+
+	Options* globalOptions = g_Options;
+	Options::CmdOptList cmdOpts;
+	cmdOpts.push_back("QueueDir=DiskStateTest");
+	Options options(&cmdOpts, nullptr);
+
+	DiskState diskState;
+
+	int generation = -1;
+	BOOST_CHECK(diskState.LoadGeneration(&generation));
+	BOOST_CHECK_EQUAL(generation, 0);
+
+	BOOST_CHECK(diskState.SaveGeneration(12345));
+	BOOST_CHECK(diskState.LoadGeneration(&generation));
+	BOOST_CHECK_EQUAL(generation, 12345);
+
+	// the counter survives discarding the queue
+	diskState.DiscardDownloadQueue();
+	BOOST_CHECK(diskState.LoadGeneration(&generation));
+	BOOST_CHECK_EQUAL(generation, 12345);
+
+	g_Options = globalOptions;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+}
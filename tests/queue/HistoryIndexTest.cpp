@@ -0,0 +1,108 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "TestDownloadQueue.h"
+
+static std::string Names(RawHistoryList* list)
+{
+	std::string names;
+	for (HistoryInfo* historyInfo : *list)
+	{
+		names += std::string(historyInfo->GetName()) + " ";
+	}
+	return names;
+}
+
+BOOST_AUTO_TEST_CASE(HistoryIndexTest)
+{
+	TestDownloadQueue downloadQueue;
+	HistoryList* history = downloadQueue.GetHistory();
+
+	struct
+	{
+		const char* name;
+		const char* category;
+		int64 size;
+		time_t time;
+		NzbInfo::EParStatus parStatus;
+	} entries[] = {
+		{ "delta", "movies", 400, 1004, NzbInfo::psFailure },
+		{ "alpha", "tv", 100, 1003, NzbInfo::psSuccess },
+		{ "charlie", "Movies", 300, 1002, NzbInfo::psSuccess },
+		{ "bravo", "", 200, 1001, NzbInfo::psFailure },
+	};
+
+	for (auto& entry : entries)
+	{
+		std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
+		nzbInfo->SetName(entry.name);
+		nzbInfo->SetCategory(entry.category);
+		nzbInfo->SetSize(entry.size);
+		nzbInfo->SetParStatus(entry.parStatus);
+		std::unique_ptr<HistoryInfo> historyInfo = std::make_unique<HistoryInfo>(std::move(nzbInfo));
+		historyInfo->SetTime(entry.time);
+		history->Add(std::move(historyInfo));
+	}
+
+	std::unique_ptr<DupInfo> dupInfo = std::make_unique<DupInfo>();
+	dupInfo->SetName("echo");
+	dupInfo->SetSize(50);
+	dupInfo->SetStatus(DupInfo::dsSuccess);
+	std::unique_ptr<HistoryInfo> hidden = std::make_unique<HistoryInfo>(std::move(dupInfo));
+	hidden->SetTime(1000);
+	history->Add(std::move(hidden));
+
+	downloadQueue.Update();
+
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsNone, true, nullptr, nullptr)),
+		"delta alpha charlie bravo echo ");
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsNone, false, nullptr, nullptr)),
+		"delta alpha charlie bravo ");
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsName, false, nullptr, nullptr)),
+		"alpha bravo charlie delta ");
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsSize, true, nullptr, nullptr)),
+		"echo alpha bravo charlie delta ");
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsTime, false, nullptr, nullptr)),
+		"bravo charlie alpha delta ");
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsName, false, "movies", nullptr)),
+		"charlie delta ");
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsName, false, nullptr, "FAILURE")),
+		"bravo delta ");
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsName, true, nullptr, "success")),
+		"alpha charlie echo ");
+
+	// index is kept while history is unchanged and rebuilt after a change
+	RawHistoryList* index = downloadQueue.GetHistoryIndex(DownloadQueue::hsName, false, nullptr, nullptr);
+	BOOST_CHECK_EQUAL(index, downloadQueue.GetHistoryIndex(DownloadQueue::hsName, false, nullptr, nullptr));
+
+	HistoryInfo* first = history->front().get();
+	first->GetNzbInfo()->SetName("aardvark");
+	first->SetChanged(true);
+	downloadQueue.Update();
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsName, false, nullptr, nullptr)),
+		"aardvark alpha bravo charlie ");
+
+	history->Remove(first);
+	downloadQueue.Update();
+	BOOST_CHECK_EQUAL(Names(downloadQueue.GetHistoryIndex(DownloadQueue::hsName, false, nullptr, nullptr)),
+		"alpha bravo charlie ");
+}
@@ -0,0 +1,142 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "DiskState.h"
+#include "Options.h"
+#include "FileSystem.h"
+#include "TestDownloadQueue.h"
+
+static std::unique_ptr<HistoryInfo> MakeHistoryInfo(int id, const char* name, time_t time)
+{
+	std::unique_ptr<DupInfo> dupInfo = std::make_unique<DupInfo>();
+	dupInfo->SetId(id);
+	dupInfo->SetName(name);
+	std::unique_ptr<HistoryInfo> historyInfo = std::make_unique<HistoryInfo>(std::move(dupInfo));
+	historyInfo->SetTime(time);
+	return historyInfo;
+}
+
+static std::string HistoryIds(HistoryList* history)
+{
+	std::string ids;
+	for (HistoryInfo* historyInfo : history)
+	{
+		ids += std::to_string(historyInfo->GetId()) + " ";
+	}
+	return ids;
+}
+
+BOOST_AUTO_TEST_CASE(HistoryJournalTest)
+{
+	const char* queueDir = "HistoryJournalTest";
+	CString errmsg;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+	BOOST_REQUIRE(FileSystem::CreateDirectory(queueDir));
+	BString<1024> journalFilename("%s%c%s", queueDir, PATH_SEPARATOR, "history.journal");
+
+	Options* globalOptions = g_Options;
+	Options::CmdOptList cmdOpts;
+	cmdOpts.push_back("QueueDir=HistoryJournalTest");
+	Options options(&cmdOpts, nullptr);
+
+	Servers servers;
+
+	{
+		TestDownloadQueue downloadQueue;
+		DiskState diskState;
+		HistoryList* history = downloadQueue.GetHistory();
+		for (int id = 10; id >= 1; id--)
+		{
+			history->Add(MakeHistoryInfo(id, "name", 1000 + id));
+		}
+
+		// first save writes the snapshot
+		BOOST_CHECK(diskState.SaveDownloadQueue(&downloadQueue, true));
+		BOOST_CHECK(!FileSystem::FileExists(journalFilename));
+
+		// nothing changed, nothing written
+		BOOST_CHECK(diskState.SaveDownloadQueue(&downloadQueue, true));
+		BOOST_CHECK(!FileSystem::FileExists(journalFilename));
+
+		// small changes go into the journal, entries edited in place must be marked
+		history->Add(MakeHistoryInfo(11, "new", 2000), true);
+		history->Find(5)->GetDupInfo()->SetName("renamed");
+		history->Find(5)->SetChanged(true);
+		history->Remove(history->Find(3));
+		BOOST_CHECK(diskState.SaveDownloadQueue(&downloadQueue, true));
+		BOOST_CHECK(FileSystem::FileExists(journalFilename));
+		int64 journalSize = FileSystem::FileSize(journalFilename);
+		BOOST_CHECK(!history->Find(5)->GetChanged());
+
+		// unmarked entries are not saved
+		history->Find(6)->GetDupInfo()->SetName("unmarked");
+		BOOST_CHECK(diskState.SaveDownloadQueue(&downloadQueue, true));
+		BOOST_CHECK_EQUAL(FileSystem::FileSize(journalFilename), journalSize);
+		history->Find(6)->GetDupInfo()->SetName("name");
+
+		// entry returned into history with a new time moves to the top
+		history->Remove(history->Find(7));
+		history->Add(MakeHistoryInfo(7, "returned", 3000), true);
+		BOOST_CHECK(diskState.SaveDownloadQueue(&downloadQueue, true));
+
+		BOOST_CHECK_EQUAL(HistoryIds(history), "7 11 10 9 8 6 5 4 2 1 ");
+	}
+
+	{
+		TestDownloadQueue downloadQueue;
+		DiskState diskState;
+		HistoryList* history = downloadQueue.GetHistory();
+		BOOST_CHECK(diskState.LoadDownloadQueue(&downloadQueue, &servers));
+
+		BOOST_CHECK_EQUAL(HistoryIds(history), "7 11 10 9 8 6 5 4 2 1 ");
+		BOOST_CHECK_EQUAL(history->Find(5)->GetDupInfo()->GetName(), "renamed");
+		BOOST_CHECK_EQUAL(history->Find(7)->GetDupInfo()->GetName(), "returned");
+
+		// loaded entries are saved already, the journal is continued
+		BOOST_CHECK(!history->Find(5)->GetChanged());
+		int64 journalSize = FileSystem::FileSize(journalFilename);
+		history->Remove(history->Find(1));
+		history->Find(2)->GetDupInfo()->SetName("edited");
+		history->Find(2)->SetChanged(true);
+		BOOST_CHECK(diskState.SaveDownloadQueue(&downloadQueue, true));
+		BOOST_CHECK(FileSystem::FileSize(journalFilename) > journalSize);
+
+		// changing most of the history rewrites the snapshot
+		for (int id : {4, 5, 6, 8})
+		{
+			history->Remove(history->Find(id));
+		}
+		BOOST_CHECK(diskState.SaveDownloadQueue(&downloadQueue, true));
+		BOOST_CHECK(!FileSystem::FileExists(journalFilename));
+	}
+
+	{
+		TestDownloadQueue downloadQueue;
+		DiskState diskState;
+		BOOST_CHECK(diskState.LoadDownloadQueue(&downloadQueue, &servers));
+		BOOST_CHECK_EQUAL(HistoryIds(downloadQueue.GetHistory()), "7 11 10 9 2 ");
+		BOOST_CHECK_EQUAL(downloadQueue.GetHistory()->Find(2)->GetDupInfo()->GetName(), "edited");
+	}
+
+	g_Options = globalOptions;
+	FileSystem::DeleteDirectoryWithContent(queueDir, errmsg);
+}
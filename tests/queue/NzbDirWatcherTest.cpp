@@ -0,0 +1,133 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "NzbDirWatcher.h"
+#include "FileSystem.h"
+
+#ifdef __linux__
+
+namespace
+{
+	struct WatcherFixture
+	{
+		const std::string dir = "NzbDirWatcherTest";
+		const std::string subDir = dir + PATH_SEPARATOR + "sub";
+		std::mutex mutex;
+		std::condition_variable cond;
+		NzbDirWatcher::Changes changes;
+		NzbDirWatcher watcher{[this]()
+			{
+				std::lock_guard<std::mutex> guard(mutex);
+				NzbDirWatcher::Changes taken = watcher.TakeChanges();
+				changes.files.insert(taken.files.begin(), taken.files.end());
+				changes.dirs.insert(taken.dirs.begin(), taken.dirs.end());
+				changes.overflow |= taken.overflow;
+				cond.notify_all();
+			}};
+
+		WatcherFixture()
+		{
+			CString errmsg;
+			FileSystem::DeleteDirectoryWithContent(dir.c_str(), errmsg);
+			BOOST_REQUIRE(FileSystem::ForceDirectories(subDir.c_str(), errmsg));
+		}
+
+		~WatcherFixture()
+		{
+			watcher.Stop();
+			CString errmsg;
+			FileSystem::DeleteDirectoryWithContent(dir.c_str(), errmsg);
+		}
+
+		bool WaitFor(std::function<bool(NzbDirWatcher::Changes&)> pred)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			return cond.wait_for(lock, std::chrono::seconds(5), [&] { return pred(changes); });
+		}
+
+		static bool HasFile(NzbDirWatcher::Changes& changes, const std::string& filename)
+		{
+			return changes.files.find(filename) != changes.files.end();
+		}
+
+		static bool HasDir(NzbDirWatcher::Changes& changes, const std::string& dirname)
+		{
+			return changes.dirs.find(dirname) != changes.dirs.end();
+		}
+	};
+}
+
+BOOST_FIXTURE_TEST_CASE(NzbDirWatcherCreateTest, WatcherFixture)
+{
+	BOOST_REQUIRE(watcher.Start(dir.c_str()));
+
+	// file written in an existing subdirectory
+	std::string file1 = subDir + PATH_SEPARATOR + "file1.nzb";
+	BOOST_REQUIRE(FileSystem::SaveBufferIntoFile(file1.c_str(), "nzb", 3));
+	BOOST_CHECK(WaitFor([&](NzbDirWatcher::Changes& changes) { return HasFile(changes, file1); }));
+
+	// new subdirectory is reported and watched too
+	std::string newDir = subDir + PATH_SEPARATOR + "new";
+	BOOST_REQUIRE(FileSystem::CreateDirectory(newDir.c_str()));
+	BOOST_CHECK(WaitFor([&](NzbDirWatcher::Changes& changes) { return HasDir(changes, newDir); }));
+
+	std::string file2 = newDir + PATH_SEPARATOR + "file2.nzb";
+	BOOST_REQUIRE(FileSystem::SaveBufferIntoFile(file2.c_str(), "nzb", 3));
+	BOOST_CHECK(WaitFor([&](NzbDirWatcher::Changes& changes) { return HasFile(changes, file2); }));
+
+	// hidden files are skipped like the scanner does
+	std::string hidden = subDir + PATH_SEPARATOR + ".hidden.nzb";
+	BOOST_REQUIRE(FileSystem::SaveBufferIntoFile(hidden.c_str(), "nzb", 3));
+
+	std::lock_guard<std::mutex> guard(mutex);
+	BOOST_CHECK(!HasFile(changes, hidden));
+	BOOST_CHECK(!changes.overflow);
+}
+
+BOOST_FIXTURE_TEST_CASE(NzbDirWatcherRenameTest, WatcherFixture)
+{
+	std::string otherDir = dir + PATH_SEPARATOR + "other";
+	std::string tmpFile = subDir + PATH_SEPARATOR + ".file.tmp";
+	BOOST_REQUIRE(FileSystem::CreateDirectory(otherDir.c_str()));
+	BOOST_REQUIRE(FileSystem::SaveBufferIntoFile(tmpFile.c_str(), "nzb", 3));
+
+	BOOST_REQUIRE(watcher.Start(dir.c_str()));
+
+	// file completed under a temporary name and renamed
+	std::string file1 = subDir + PATH_SEPARATOR + "file1.nzb";
+	BOOST_REQUIRE(FileSystem::MoveFile(tmpFile.c_str(), file1.c_str()));
+	BOOST_CHECK(WaitFor([&](NzbDirWatcher::Changes& changes) { return HasFile(changes, file1); }));
+
+	// renamed subdirectory is reported under its new name and still watched
+	std::string movedDir = subDir + PATH_SEPARATOR + "moved";
+	BOOST_REQUIRE(FileSystem::MoveFile(otherDir.c_str(), movedDir.c_str()));
+	BOOST_CHECK(WaitFor([&](NzbDirWatcher::Changes& changes) { return HasDir(changes, movedDir); }));
+
+	std::string file2 = movedDir + PATH_SEPARATOR + "file2.nzb";
+	BOOST_REQUIRE(FileSystem::SaveBufferIntoFile(file2.c_str(), "nzb", 3));
+	BOOST_CHECK(WaitFor([&](NzbDirWatcher::Changes& changes) { return HasFile(changes, file2); }));
+
+	std::lock_guard<std::mutex> guard(mutex);
+	BOOST_CHECK(!changes.overflow);
+}
+
+#endif
@@ -77,8 +77,6 @@ void TestNzb(std::string testFilename, std::string expectedCategory)
 	}
 
 	fclose(infofile);
-
-	xmlCleanupParser();
 }
 
 BOOST_AUTO_TEST_CASE(NZBParserTest)
@@ -91,3 +89,200 @@ BOOST_AUTO_TEST_CASE(NZBParserTest)
 	TestNzb("passwd{{thisisthepassword}}", "");
 	TestNzb("passwdMeta", "");
 }
+
+namespace
+{
+	void WriteFile(const fs::path& filename, const std::string& content)
+	{
+		FILE* file = fopen(filename.string().c_str(), FOPEN_WB);
+		BOOST_REQUIRE(file);
+		fwrite(content.data(), 1, content.length(), file);
+		fclose(file);
+	}
+
+	std::unique_ptr<NzbInfo> ParseString(const std::string& content, bool expectSuccess = true)
+	{
+		const fs::path filename = CURR_DIR / "nzbfile-syntax.nzb";
+		WriteFile(filename, content);
+		NzbFile nzbFile(filename.string().c_str(), "");
+		BOOST_CHECK_EQUAL(nzbFile.Parse(), expectSuccess);
+		fs::remove(filename);
+		return nzbFile.DetachNzbInfo();
+	}
+}
+
+BOOST_AUTO_TEST_CASE(NZBParserSyntaxTest)
+{
+	Options::CmdOptList cmdOpts;
+	Options options(&cmdOpts, nullptr);
+
+	std::unique_ptr<NzbInfo> nzbInfo = ParseString(
+		"\xEF\xBB\xBF<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+		"<!DOCTYPE nzb PUBLIC \"-//newzBin//DTD NZB 1.0//EN\" \"http://www.newzbin.com/DTD/nzb/nzb-1.0.dtd\" [\n"
+		"  <!ENTITY test \"test\">\n"
+		"]>\n"
+		"<!-- comment with <tags> -->\n"
+		"<nzb xmlns=\"http://www.newzbin.com/DTD/2003/nzb\">\n"
+		"<file poster='a &lt;b@c&gt;' date=\"1335508618\" subject=\"&quot;one&#46;bin&#x22; yEnc (1/2)\">\n"
+		"<groups><group> alt.binaries.test </group><group>alt.binaries.misc</group></groups>\n"
+		"<segments>\n"
+		"<segment bytes=\"100\" number=\"2\">id2&amp;x@news</segment>\n"
+		"<segment bytes=\"100\" number=\"1\"><![CDATA[id1<y>]]>@news</segment>\n"
+		"<segment bytes=\"100\" number=\"3\"/>\n"
+		"</segments>\n"
+		"</file>\n"
+		"<file poster=\"a\" date=\"1335508618\" subject=\"&quot;two.bin&quot; yEnc (1/1)\">\n"
+		"<groups><group>alt.binaries.test</group></groups>\n"
+		"<segments><segment bytes=\"50\" number=\"1\">\n\t id3@news \n</segment></segments>\n"
+		"</file>\n"
+		"</nzb>\n");
+
+	BOOST_REQUIRE_EQUAL(nzbInfo->GetFileList()->size(), 2);
+	FileInfo* file1 = nzbInfo->GetFileList()->at(0).get();
+	FileInfo* file2 = nzbInfo->GetFileList()->at(1).get();
+	BOOST_CHECK_EQUAL(file1->GetSubject(), "\"one.bin\" yEnc (1/2)");
+	BOOST_CHECK_EQUAL(file1->GetFilename(), "one.bin");
+	BOOST_CHECK_EQUAL(file1->GetTime(), 1335508618);
+
+	BOOST_REQUIRE_EQUAL(file1->GetArticles()->size(), 3);
+	BOOST_CHECK_EQUAL(file1->GetArticles()->at(0).GetMessageId(), "<id1<y>@news>");
+	BOOST_CHECK_EQUAL(file1->GetArticles()->at(1).GetMessageId(), "<id2&x@news>");
+	BOOST_CHECK_EQUAL(file1->GetArticles()->at(2).GetMessageId(), "<>");
+	BOOST_REQUIRE_EQUAL(file2->GetArticles()->size(), 1);
+	BOOST_CHECK_EQUAL(file2->GetArticles()->at(0).GetMessageId(), "<id3@news>");
+
+	// group names are shared by all files of nzb
+	BOOST_REQUIRE_EQUAL(file1->GetGroups()->size(), 2);
+	BOOST_REQUIRE_EQUAL(file2->GetGroups()->size(), 1);
+	BOOST_CHECK_EQUAL(*file1->GetGroups()->at(0), "alt.binaries.test");
+	BOOST_CHECK_EQUAL(*file1->GetGroups()->at(1), "alt.binaries.misc");
+	BOOST_CHECK(file1->GetGroups()->at(0) == file2->GetGroups()->at(0));
+
+	nzbInfo = ParseString(
+		"<?xml version='1.0' encoding='iso-8859-1'?>\n"
+		"<nzb><file subject=\"\xE9t\xE9.bin yEnc (1/1)\">"
+		"<segments><segment bytes=\"1\" number=\"1\">a@b</segment></segments></file></nzb>");
+	BOOST_REQUIRE_EQUAL(nzbInfo->GetFileList()->size(), 1);
+	BOOST_CHECK_EQUAL(nzbInfo->GetFileList()->at(0)->GetSubject(), "\xC3\xA9t\xC3\xA9.bin yEnc (1/1)");
+
+	nzbInfo = ParseString(
+		"<?xml version='1.0' encoding='windows-1252'?>\n"
+		"<nzb><file subject=\"\x80 \x93x\x94.bin yEnc (1/1)\">"
+		"<segments><segment bytes=\"1\" number=\"1\">a@b</segment></segments></file></nzb>");
+	BOOST_REQUIRE_EQUAL(nzbInfo->GetFileList()->size(), 1);
+	BOOST_CHECK_EQUAL(nzbInfo->GetFileList()->at(0)->GetSubject(),
+		"\xE2\x82\xAC \xE2\x80\x9Cx\xE2\x80\x9D.bin yEnc (1/1)");
+
+	nzbInfo = ParseString(
+		"<?xml version='1.0' encoding='ISO-8859-15'?>\n"
+		"<nzb><file subject=\"\xA4\xE9.bin yEnc (1/1)\">"
+		"<segments><segment bytes=\"1\" number=\"1\">a@b</segment></segments></file></nzb>");
+	BOOST_REQUIRE_EQUAL(nzbInfo->GetFileList()->size(), 1);
+	BOOST_CHECK_EQUAL(nzbInfo->GetFileList()->at(0)->GetSubject(), "\xE2\x82\xAC\xC3\xA9.bin yEnc (1/1)");
+
+	std::string utf16 = "\xFF\xFE";
+	for (char ch : std::string("<nzb><file subject=\"\xE9.bin yEnc (1/1)\">"
+		"<segments><segment bytes=\"1\" number=\"1\">a@b</segment></segments></file></nzb>"))
+	{
+		utf16 += ch;
+		utf16 += '\0';
+	}
+	nzbInfo = ParseString(utf16);
+	BOOST_REQUIRE_EQUAL(nzbInfo->GetFileList()->size(), 1);
+	BOOST_CHECK_EQUAL(nzbInfo->GetFileList()->at(0)->GetSubject(), "\xC3\xA9.bin yEnc (1/1)");
+
+	ParseString("<?xml version='1.0' encoding='x-unknown'?><nzb></nzb>", false);
+	ParseString("<nzb><file subject=\"a\"><segments></file></nzb>", false);
+	ParseString("<nzb><file subject=\"a\"><segments><segment number=\"1\">a@b</segment>", false);
+	ParseString("<nzb><file subject=a></file></nzb>", false);
+	ParseString("<nzb><file subject=\"a & b\"></file></nzb>", false);
+	ParseString("<nzb></nzb><nzb></nzb>", false);
+	ParseString("", false);
+}
+
+namespace
+{
+	// reference results of libxml SAX parser
+	struct SaxResult
+	{
+		std::map<std::string, std::map<int, std::string>> files;	// subject -> part number -> message-id
+		std::string subject;
+		int partNumber = 0;
+		std::string content;
+	};
+
+	void SaxStartElement(SaxResult* result, const char* name, const char** atts)
+	{
+		result->content.clear();
+		for (int i = 0; atts && atts[i]; i += 2)
+		{
+			if (!strcmp(name, "file") && !strcmp(atts[i], "subject"))
+			{
+				result->subject = atts[i + 1];
+			}
+			if (!strcmp(name, "segment") && !strcmp(atts[i], "number"))
+			{
+				result->partNumber = atoi(atts[i + 1]);
+			}
+		}
+	}
+
+	void SaxEndElement(SaxResult* result, const char* name)
+	{
+		if (!strcmp(name, "segment"))
+		{
+			result->files[result->subject][result->partNumber] = "<" + result->content + ">";
+		}
+	}
+
+	void SaxCharacters(SaxResult* result, const char* str, int len)
+	{
+		while (len > 0 && strchr(" \t\r\n", *str)) { str++; len--; }
+		while (len > 0 && strchr(" \t\r\n", str[len - 1])) len--;
+		result->content.append(str, len);
+	}
+
+	// checks the articles found by the parser against libxml SAX parser
+	void CompareWithSax(const fs::path& filename)
+	{
+		SaxResult reference;
+		xmlSAXHandler handler = {};
+		handler.startElement = reinterpret_cast<startElementSAXFunc>(SaxStartElement);
+		handler.endElement = reinterpret_cast<endElementSAXFunc>(SaxEndElement);
+		handler.characters = reinterpret_cast<charactersSAXFunc>(SaxCharacters);
+		handler.getEntity = reinterpret_cast<getEntitySAXFunc>(+[](void*, const xmlChar* name)
+			{ return xmlGetPredefinedEntity(name); });
+		BOOST_REQUIRE_EQUAL(xmlSAXUserParseFile(&handler, &reference, filename.string().c_str()), 0);
+
+		NzbFile nzbFile(filename.string().c_str(), "");
+		BOOST_REQUIRE(nzbFile.Parse());
+		std::unique_ptr<NzbInfo> nzbInfo = nzbFile.DetachNzbInfo();
+
+		for (FileInfo* fileInfo : nzbInfo->GetFileList())
+		{
+			auto it = reference.files.find(fileInfo->GetSubject());
+			BOOST_REQUIRE(it != reference.files.end());
+			BOOST_REQUIRE_EQUAL(fileInfo->GetArticles()->size(), it->second.size());
+			auto refIt = it->second.begin();
+			for (ArticleInfo* article : fileInfo->GetArticles())
+			{
+				BOOST_CHECK_EQUAL(article->GetPartNumber(), refIt->first);
+				BOOST_CHECK_EQUAL(article->GetMessageId(), refIt->second);
+				refIt++;
+			}
+		}
+
+		xmlCleanupParser();
+	}
+}
+
+BOOST_AUTO_TEST_CASE(NZBParserSaxTest)
+{
+	Options::CmdOptList cmdOpts;
+	Options options(&cmdOpts, nullptr);
+
+	for (const char* name : {"dotless", "plain", "passwd{{thisisthepassword}}", "passwdMeta"})
+	{
+		CompareWithSax(CURR_DIR / "nzbfile" / (std::string(name) + ".nzb"));
+	}
+}
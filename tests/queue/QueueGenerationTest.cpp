@@ -0,0 +1,160 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "TestDownloadQueue.h"
+
+BOOST_AUTO_TEST_CASE(QueueGenerationTest)
+{
+	TestDownloadQueue downloadQueue;
+	NzbList* queue = downloadQueue.GetQueue();
+	HistoryList* history = downloadQueue.GetHistory();
+
+	int initial = downloadQueue.GetGeneration();
+	BOOST_CHECK(initial > 0);
+
+	std::vector<NzbInfo*> nzbInfos;
+	for (int i = 0; i < 3; i++)
+	{
+		std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
+		nzbInfo->SetName(BString<100>("nzb%i", i));
+		nzbInfos.push_back(nzbInfo.get());
+		queue->Add(std::move(nzbInfo));
+	}
+
+	// first call stamps all entries
+	downloadQueue.Update();
+	int gen1 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(gen1, initial + 1);
+	BOOST_CHECK_EQUAL(downloadQueue.GetQueueGeneration(), gen1);
+	BOOST_CHECK_EQUAL(downloadQueue.GetHistoryGeneration(), initial);
+	for (NzbInfo* nzbInfo : nzbInfos)
+	{
+		BOOST_CHECK_EQUAL(nzbInfo->GetChangeGen(), gen1);
+	}
+
+	// nothing changed
+	downloadQueue.Update();
+	BOOST_CHECK_EQUAL(downloadQueue.GetGeneration(), gen1);
+
+	// one entry changed
+	nzbInfos[1]->SetPriority(100);
+	downloadQueue.Update();
+	int gen2 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(gen2, gen1 + 1);
+	BOOST_CHECK_EQUAL(nzbInfos[0]->GetChangeGen(), gen1);
+	BOOST_CHECK_EQUAL(nzbInfos[1]->GetChangeGen(), gen2);
+	BOOST_CHECK_EQUAL(nzbInfos[2]->GetChangeGen(), gen1);
+
+	// reordering bumps queue generation without touching entries
+	std::unique_ptr<NzbInfo> moved = queue->Remove(nzbInfos[0]);
+	queue->Add(std::move(moved));
+	downloadQueue.Update();
+	int gen3 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(gen3, gen2 + 1);
+	BOOST_CHECK_EQUAL(downloadQueue.GetQueueGeneration(), gen3);
+	BOOST_CHECK_EQUAL(nzbInfos[0]->GetChangeGen(), gen1);
+
+	// deletion
+	int deletedId = nzbInfos[2]->GetId();
+	std::unique_ptr<NzbInfo> deleted = queue->Remove(nzbInfos[2]);
+	downloadQueue.Update();
+	int gen4 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(gen4, gen3 + 1);
+
+	IdList idList;
+	BOOST_CHECK(downloadQueue.GetQueueDeleted(gen3, &idList));
+	BOOST_CHECK(idList == IdList({deletedId}));
+	idList.clear();
+	BOOST_CHECK(downloadQueue.GetQueueDeleted(gen4, &idList));
+	BOOST_CHECK(idList.empty());
+	// generation from before start (or from another run) can't be answered with a delta
+	BOOST_CHECK(!downloadQueue.GetQueueDeleted(initial - 1, &idList));
+
+	// entry returning into queue is reported again even if unchanged
+	queue->Add(std::move(deleted));
+	downloadQueue.Update();
+	int gen5 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(nzbInfos[2]->GetChangeGen(), gen5);
+
+	// history entries are stamped when marked as changed
+	std::unique_ptr<DupInfo> dupInfo = std::make_unique<DupInfo>();
+	dupInfo->SetId(1000);
+	history->Add(std::make_unique<HistoryInfo>(std::move(dupInfo)));
+	HistoryInfo* historyInfo = history->front().get();
+	downloadQueue.Update();
+	int gen6 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(gen6, gen5 + 1);
+	BOOST_CHECK_EQUAL(downloadQueue.GetHistoryGeneration(), gen6);
+	BOOST_CHECK_EQUAL(downloadQueue.GetQueueGeneration(), gen5);
+	BOOST_CHECK_EQUAL(historyInfo->GetChangeGen(), gen6);
+
+	historyInfo->SetChanged(false);
+	downloadQueue.Update();
+	BOOST_CHECK_EQUAL(downloadQueue.GetGeneration(), gen6);
+
+	historyInfo->SetChanged(true);
+	downloadQueue.Update();
+	int gen7 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(gen7, gen6 + 1);
+	BOOST_CHECK_EQUAL(historyInfo->GetChangeGen(), gen7);
+
+	history->Remove(historyInfo);
+	downloadQueue.Update();
+	int gen8 = downloadQueue.GetGeneration();
+	BOOST_CHECK_EQUAL(gen8, gen7 + 1);
+	BOOST_CHECK_EQUAL(downloadQueue.GetHistoryGeneration(), gen8);
+	idList.clear();
+	BOOST_CHECK(downloadQueue.GetHistoryDeleted(gen7, &idList));
+	BOOST_CHECK(idList == IdList({1000}));
+}
+
+BOOST_AUTO_TEST_CASE(QueueGenerationRestartTest)
+{
+	TestDownloadQueue downloadQueue;
+	downloadQueue.StartGenerations(0);
+	int initial = downloadQueue.GetGeneration();
+	int reserved = downloadQueue.GetSavedGeneration();
+	BOOST_CHECK(initial > 0);
+	BOOST_CHECK(reserved > initial);
+
+	std::unique_ptr<NzbInfo> nzbInfo = std::make_unique<NzbInfo>();
+	NzbInfo* nzbInfoPtr = nzbInfo.get();
+	downloadQueue.GetQueue()->Add(std::move(nzbInfo));
+
+	// handing out generations beyond the reserved block reserves the next one
+	while (downloadQueue.GetGeneration() < reserved)
+	{
+		nzbInfoPtr->SetPriority(nzbInfoPtr->GetPriority() + 1);
+		downloadQueue.Update();
+	}
+	BOOST_CHECK(downloadQueue.GetSavedGeneration() > downloadQueue.GetGeneration());
+
+	// the next run continues above every generation handed out before the restart
+	int lastGeneration = downloadQueue.GetGeneration();
+	TestDownloadQueue restarted;
+	restarted.StartGenerations(downloadQueue.GetSavedGeneration());
+	BOOST_CHECK(restarted.GetGeneration() > lastGeneration);
+	BOOST_CHECK(restarted.GetSavedGeneration() > restarted.GetGeneration());
+	IdList idList;
+	BOOST_CHECK(!restarted.GetQueueDeleted(lastGeneration, &idList));
+	BOOST_CHECK(!restarted.GetHistoryDeleted(lastGeneration, &idList));
+}
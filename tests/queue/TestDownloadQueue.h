@@ -0,0 +1,46 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef TESTDOWNLOADQUEUE_H
+#define TESTDOWNLOADQUEUE_H
+
+#include "DownloadInfo.h"
+
+// Download queue without a coordinator behind it, edits are rejected and nothing is saved
+class TestDownloadQueue : public DownloadQueue
+{
+public:
+	bool EditEntry([[maybe_unused]] int ID, [[maybe_unused]] EEditAction action,
+		[[maybe_unused]] const char* args) override { return false; }
+	bool EditList([[maybe_unused]] IdList* idList, [[maybe_unused]] NameList* nameList,
+		[[maybe_unused]] EMatchMode matchMode, [[maybe_unused]] EEditAction action,
+		[[maybe_unused]] const char* args) override { return false; }
+	void HistoryChanged() override {}
+	void Save() override {}
+	void SaveChanged() override {}
+	void Update() { UpdateGenerations([]([[maybe_unused]] NzbInfo* nzbInfo) { return 0u; }); }
+	int GetSavedGeneration() { return m_savedGeneration; }
+
+protected:
+	void SaveGeneration(int generation) override { m_savedGeneration = generation; }
+
+private:
+	int m_savedGeneration = 0;
+};
+
+#endif
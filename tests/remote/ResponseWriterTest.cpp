@@ -0,0 +1,83 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "ResponseWriter.h"
+#include "Util.h"
+
+BOOST_AUTO_TEST_CASE(ResponseWriterEncodingTest)
+{
+	const char* samples[] = { "plain", "<a href=\"x\">&'</a>", "back\\slash/\b\f\n\r\t",
+		"\x01\x7f", "caf\xc3\xa9 \xe2\x82\xac \xf0\x9f\x98\x80", "\xef\xbf\xbe", "cut\xe2\x82", "" };
+
+	for (bool json : {false, true})
+	{
+		for (const char* sample : samples)
+		{
+			StringBuilder output;
+			ResponseWriter writer(output);
+			writer.SetJson(json);
+			writer.AppendFmt("[%s]", sample);
+			BString<1024> expected("[%s]", json ? *WebUtil::JsonEncode(sample) : *WebUtil::XmlEncode(sample));
+			BOOST_CHECK_EQUAL(*output, *expected);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ResponseWriterFormatTest)
+{
+	StringBuilder output;
+	ResponseWriter writer(output);
+	writer.SetJson(true);
+	writer.AppendFmt("%i %u %i %s 100%%", -12345, 4000000000u, std::numeric_limits<int>::min(), "");
+	BOOST_CHECK_EQUAL(*output, "-12345 4000000000 -2147483648  100%");
+
+	// unsupported conversions would make the following conversions read wrong arguments
+	for (bool deferred : {false, true})
+	{
+		StringBuilder output;
+		ResponseWriter writer(output);
+		writer.SetDeferred(deferred);
+		BOOST_CHECK_THROW(writer.AppendFmt("%lli %s", (long long)1, "text"), std::invalid_argument);
+		BOOST_CHECK_THROW(writer.AppendFmt("%x", 1), std::invalid_argument);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(ResponseWriterDeferredTest)
+{
+	StringBuilder output;
+	ResponseWriter writer(output);
+	writer.SetJson(true);
+
+	CString name = "first \"name\"";
+	writer.Append("[");
+	writer.SetDeferred(true);
+	writer.AppendFmt("{\"ID\" : %i, \"Name\" : \"%s\"}", 1, *name);
+	writer.Append(", ");
+	writer.AppendEncoded("a/b");
+	BOOST_CHECK_EQUAL(*output, "[");
+
+	// captured values are not affected by later changes
+	name = "second";
+	writer.SetDeferred(false);
+	writer.Append("]");
+	BOOST_CHECK_EQUAL(*output, "[{\"ID\" : 1, \"Name\" : \"first \\\"name\\\"\"}, a\\/b]");
+}
@@ -33,11 +33,11 @@ struct ServerFixture
 		int port = 563, bool tls = true, const char* user = "user", const char* pass = "pass",
 		int maxConn = 50, int level = 0, int retention = 0, const char* cipher = "",
 		int ipVersion = Connection::ipAuto, bool optional = false, int group = 0, int joinGroup = 0,
-		unsigned int certLevel = Options::cvStrict)
+		unsigned int certLevel = Options::cvStrict, int pipelining = 1)
 	{
 		return std::make_unique<NewsServer>(1, active, name, host, port, ipVersion, user, pass,
 											(bool)joinGroup, tls, cipher, maxConn, retention, level,
-											group, optional, certLevel);
+											group, optional, certLevel, pipelining);
 	}
 };
 
@@ -201,6 +201,27 @@ BOOST_AUTO_TEST_CASE(TestOptional)
 			.IsWarning());
 }
 
+BOOST_AUTO_TEST_CASE(TestPipelining)
+{
+	BOOST_CHECK(SystemHealth::NewsServer::ServerPipeliningValidator(
+					*CreateServer(true, "", "", 563, true, "", "", 50, 0, 0, "", Connection::ipAuto,
+								  false, 0, 0, Options::cvStrict, 4))
+					.Validate()
+					.IsOk());
+
+	BOOST_CHECK(SystemHealth::NewsServer::ServerPipeliningValidator(
+					*CreateServer(true, "", "", 563, true, "", "", 50, 0, 0, "", Connection::ipAuto,
+								  false, 0, 1, Options::cvStrict, 4))
+					.Validate()
+					.IsInfo());
+
+	BOOST_CHECK(SystemHealth::NewsServer::ServerPipeliningValidator(
+					*CreateServer(true, "", "", 563, true, "", "", 50, 0, 0, "", Connection::ipAuto,
+								  false, 0, 0, Options::cvStrict, 0))
+					.Validate()
+					.IsError());
+}
+
 BOOST_AUTO_TEST_CASE(TestCertVerification)
 {
 	BOOST_CHECK(SystemHealth::NewsServer::ServerCertVerificationValidator(
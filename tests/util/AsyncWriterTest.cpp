@@ -0,0 +1,121 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "AsyncWriter.h"
+#include "FileSystem.h"
+
+static AsyncWriter::Buffer MakeBlock(AsyncWriter& writer, char fill, int size)
+{
+	AsyncWriter::Buffer buffer = writer.AllocBuffer(size);
+	memset(buffer.data.get(), fill, size);
+	return buffer;
+}
+
+BOOST_AUTO_TEST_CASE(AsyncWriteTest)
+{
+	const char* filename = "AsyncWriterTest.dat";
+	const int blockSize = 1000;
+	const int blockCount = 20;
+
+	DiskFile file;
+	BOOST_REQUIRE(file.Open(filename, DiskFile::omWrite));
+	file.Close();
+
+	std::atomic<int> succeeded{0};
+	std::atomic<int> failed{0};
+	auto callback = [&](bool success, const char* errmsg)
+		{
+			(success ? succeeded : failed)++;
+		};
+
+	AsyncWriter writer;
+	BOOST_CHECK(!writer.IsActive());
+	// a limit of two blocks makes the writes wait for the workers
+	writer.Start(3, blockSize * 2);
+	BOOST_CHECK(writer.IsActive());
+
+	// written in reverse order to check positioning
+	AsyncFilePtr asyncFile = std::make_shared<AsyncFile>();
+	for (int i = blockCount - 1; i >= 0; i--)
+	{
+		writer.Write(asyncFile, filename, (int64)i * blockSize, MakeBlock(writer, 'a' + i, blockSize), blockSize, callback);
+	}
+	writer.Write(std::make_shared<AsyncFile>(), "nonexistent/AsyncWriterTest.dat", 0,
+		MakeBlock(writer, 'x', 10), 10, callback);
+
+	asyncFile->Wait();
+	BOOST_CHECK_EQUAL(asyncFile->GetPending(), 0);
+	// the file stays open between writes until closed by the owner
+	asyncFile->Close();
+
+	writer.Stop();
+	BOOST_CHECK(!writer.IsActive());
+	BOOST_CHECK_EQUAL(writer.GetPendingJobs(), 0);
+	BOOST_CHECK_EQUAL(writer.GetPendingBytes(), 0u);
+	BOOST_CHECK_EQUAL(succeeded, blockCount);
+	BOOST_CHECK_EQUAL(failed, 1);
+
+	std::vector<char> buffer(blockSize * blockCount + 1);
+	BOOST_REQUIRE(file.Open(filename, DiskFile::omRead));
+	int64 len = file.Read(buffer.data(), buffer.size());
+	file.Close();
+	FileSystem::DeleteFile(filename);
+
+	BOOST_CHECK_EQUAL(len, blockSize * blockCount);
+	for (int i = 0; i < blockCount; i++)
+	{
+		BOOST_CHECK(buffer[i * blockSize] == 'a' + i);
+		BOOST_CHECK(buffer[i * blockSize + blockSize - 1] == 'a' + i);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AsyncWriteBufferTest)
+{
+	AsyncWriter writer;
+	writer.Start(1, 1024 * 1024);
+
+	// the size is rounded up, so that articles of slightly different sizes share buffers
+	AsyncWriter::Buffer buffer = writer.AllocBuffer(1000);
+	BOOST_CHECK(buffer.capacity >= 1000);
+	char* data = buffer.data.get();
+	writer.FreeBuffer(std::move(buffer));
+
+	buffer = writer.AllocBuffer(1010);
+	BOOST_CHECK(buffer.data.get() == data);
+
+	// a freed buffer is reused after the write
+	const char* filename = "AsyncWriterTest.dat";
+	DiskFile file;
+	BOOST_REQUIRE(file.Open(filename, DiskFile::omWrite));
+	file.Close();
+
+	AsyncFilePtr asyncFile = std::make_shared<AsyncFile>();
+	writer.Write(asyncFile, filename, 0, std::move(buffer), 1010, nullptr);
+	asyncFile->Wait();
+	buffer = writer.AllocBuffer(500);
+	BOOST_CHECK(buffer.data.get() == data);
+
+	writer.Stop();
+	asyncFile->Close();
+	BOOST_CHECK_EQUAL(FileSystem::FileSize(filename), 1010);
+	FileSystem::DeleteFile(filename);
+}
@@ -0,0 +1,110 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "FileMover.h"
+#include "FileSystem.h"
+
+static void MakeFile(const std::string& filename, char fill, int size)
+{
+	std::vector<char> data(size, fill);
+	BOOST_REQUIRE(FileSystem::SaveBufferIntoFile(filename.c_str(), data.data(), size));
+}
+
+static void CheckFile(const std::string& filename, char fill, int size)
+{
+	CharBuffer buffer;
+	BOOST_REQUIRE(FileSystem::LoadFileIntoBuffer(filename.c_str(), buffer, false));
+	BOOST_CHECK_EQUAL(buffer.Size(), size);
+	BOOST_CHECK(std::all_of(buffer + 0, buffer + buffer.Size(), [fill](char ch) { return ch == fill; }));
+}
+
+static void MoveFiles(const std::string& srcDir, const std::string& dstDir)
+{
+	const int fileCount = 5;
+	const int fileSize = 100000;
+
+	for (int i = 0; i < fileCount; i++)
+	{
+		MakeFile(srcDir + "/FileMoverTest" + std::to_string(i) + ".dat", 'a' + i, fileSize + i);
+	}
+
+	FileMover mover(2);
+	for (int i = 0; i < fileCount; i++)
+	{
+		std::string filename = "/FileMoverTest" + std::to_string(i) + ".dat";
+		mover.AddFile(srcDir + filename, dstDir + filename);
+	}
+	mover.AddFile(srcDir + "/nonexistent.dat", dstDir + "/nonexistent.dat");
+
+	int64 lastMoved = 0;
+	int64 lastTotal = 0;
+	BOOST_CHECK(!mover.Execute([&](int64 movedSize, int64 totalSize)
+		{
+			BOOST_CHECK(movedSize >= lastMoved);
+			lastMoved = movedSize;
+			lastTotal = totalSize;
+		}));
+
+	BOOST_CHECK_EQUAL(lastTotal, (int64)fileCount * fileSize + fileCount * (fileCount - 1) / 2);
+	BOOST_CHECK_EQUAL(lastMoved, lastTotal);
+
+	for (int i = 0; i < fileCount; i++)
+	{
+		std::string filename = "/FileMoverTest" + std::to_string(i) + ".dat";
+		BOOST_CHECK(mover.GetFiles()[i].success);
+		BOOST_CHECK(!FileSystem::FileExists((srcDir + filename).c_str()));
+		CheckFile(dstDir + filename, 'a' + i, fileSize + i);
+		FileSystem::DeleteFile((dstDir + filename).c_str());
+	}
+
+	BOOST_CHECK(!mover.GetFiles()[fileCount].success);
+}
+
+BOOST_AUTO_TEST_CASE(FileMoverRenameTest)
+{
+	CString errmsg;
+	BOOST_REQUIRE(FileSystem::ForceDirectories("FileMoverTest", errmsg));
+
+	MoveFiles(".", "FileMoverTest");
+
+	FileSystem::RemoveDirectory("FileMoverTest");
+}
+
+#ifndef WIN32
+BOOST_AUTO_TEST_CASE(FileMoverCopyTest)
+{
+	// copying between file systems is tested only if a memory file system is available
+	std::string tmpDir = "/dev/shm/FileMoverTest";
+	if (!FileSystem::DirectoryExists("/dev/shm") ||
+		FileSystem::GetDeviceId("/dev/shm") == FileSystem::GetDeviceId("."))
+	{
+		return;
+	}
+
+	CString errmsg;
+	BOOST_REQUIRE(FileSystem::ForceDirectories(tmpDir.c_str(), errmsg));
+
+	MoveFiles(tmpDir, ".");
+
+	FileSystem::RemoveDirectory(tmpDir.c_str());
+}
+#endif
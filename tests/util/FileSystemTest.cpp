@@ -147,3 +147,27 @@ BOOST_AUTO_TEST_CASE(SplitPathAndFilenameTest)
 		BOOST_TEST(result.second == "");
 	}
 }
+
+BOOST_AUTO_TEST_CASE(WriteVectoredTest)
+{
+	const char* filename = "WriteVectoredTest.dat";
+
+	DiskFile file;
+	BOOST_REQUIRE(file.Open(filename, DiskFile::omWrite));
+	BOOST_CHECK(file.Write("0123456789", 10) == 10);
+
+	std::vector<DiskFile::WriteChunk> chunks = { { "abc", 3 }, { "", 0 }, { "defg", 4 } };
+	BOOST_CHECK(file.WriteVectored(12, chunks));
+	BOOST_CHECK(file.WriteVectored(2, { { "XY", 2 } }));
+	file.Close();
+
+	char buffer[32] = {};
+	BOOST_REQUIRE(file.Open(filename, DiskFile::omRead));
+	int64 len = file.Read(buffer, sizeof(buffer));
+	file.Close();
+	FileSystem::DeleteFile(filename);
+
+	BOOST_CHECK_EQUAL(len, 19);
+	BOOST_CHECK(!memcmp(buffer, "01XY456789", 10));
+	BOOST_CHECK(!memcmp(buffer + 12, "abcdefg", 7));
+}
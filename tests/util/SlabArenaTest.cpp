@@ -0,0 +1,133 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "SlabArena.h"
+
+static const size_t MB = 1024 * 1024;
+
+BOOST_AUTO_TEST_CASE(SlotSizeTest)
+{
+	BOOST_CHECK_EQUAL(SlabArena::SlotSize(1), 4096u);
+	BOOST_CHECK_EQUAL(SlabArena::SlotSize(4096), 4096u);
+	BOOST_CHECK_EQUAL(SlabArena::SlotSize(4097), 8192u);
+	BOOST_CHECK_EQUAL(SlabArena::SlotSize(700000), 720896u);
+	BOOST_CHECK_EQUAL(SlabArena::SlotSize(768000), 786432u);
+
+	for (size_t size = 1000; size < 10 * MB; size += 12345)
+	{
+		size_t slot = SlabArena::SlotSize(size);
+		BOOST_CHECK(slot >= size);
+		BOOST_CHECK(slot - size <= std::max(size / 8, (size_t)4096));
+	}
+}
+
+BOOST_AUTO_TEST_CASE(AllocFreeTest)
+{
+	SlabArena arena;
+	BOOST_REQUIRE(arena.Init(64 * MB, false));
+
+	SlabArena::Stats stats = arena.GetStats();
+	BOOST_CHECK_EQUAL(stats.capacity, 64 * MB);
+	BOOST_CHECK_EQUAL(stats.slabSize, SlabArena::MIN_SLAB_SIZE);
+	BOOST_CHECK_EQUAL(stats.slabCount, 16);
+	BOOST_CHECK_EQUAL(stats.usedSlabs, 0);
+
+	std::vector<char*> segments;
+	for (int i = 0; i < 10; i++)
+	{
+		char* p = arena.Alloc(700000);
+		BOOST_REQUIRE(p);
+		BOOST_CHECK(arena.Contains(p));
+		memset(p, i, 700000);
+		segments.push_back(p);
+	}
+
+	stats = arena.GetStats();
+	BOOST_CHECK_EQUAL(stats.usedSlabs, 2); // 5 slots per slab
+	BOOST_CHECK_EQUAL(stats.sizeClasses, 1);
+	BOOST_CHECK_EQUAL(stats.slotBytes, 10 * SlabArena::SlotSize(700000));
+	BOOST_CHECK_EQUAL(stats.requestedBytes, 10 * 700000u);
+
+	for (int i = 0; i < 10; i++)
+	{
+		BOOST_CHECK_EQUAL(segments[i][0], (char)i);
+		BOOST_CHECK_EQUAL(segments[i][699999], (char)i);
+		arena.Free(segments[i], 700000);
+	}
+
+	stats = arena.GetStats();
+	BOOST_CHECK_EQUAL(stats.usedSlabs, 0);
+	BOOST_CHECK_EQUAL(stats.slotBytes, 0u);
+	BOOST_CHECK_EQUAL(stats.requestedBytes, 0u);
+
+	arena.Trim();
+	BOOST_CHECK(arena.Alloc(100000));
+}
+
+BOOST_AUTO_TEST_CASE(ExhaustionTest)
+{
+	SlabArena arena;
+	BOOST_REQUIRE(arena.Init(16 * MB, false));
+
+	std::vector<char*> segments;
+	while (char* p = arena.Alloc(1000000))
+	{
+		segments.push_back(p);
+	}
+	BOOST_CHECK_EQUAL(segments.size(), 16u); // 4 slots per slab
+	BOOST_CHECK(!arena.Alloc(5000));
+	BOOST_CHECK(!arena.Alloc(arena.GetMaxSlotSize() + 1));
+
+	// freeing all slots of a slab makes it available for another size class
+	for (int i = 0; i < 4; i++)
+	{
+		arena.Free(segments[i], 1000000);
+	}
+	BOOST_CHECK(arena.Alloc(5000));
+	BOOST_CHECK_EQUAL(arena.GetStats().sizeClasses, 2);
+}
+
+BOOST_AUTO_TEST_CASE(ShrinkTest)
+{
+	SlabArena arena;
+	BOOST_REQUIRE(arena.Init(16 * MB, false));
+
+	char* p = arena.Alloc(768000);
+	BOOST_REQUIRE(p);
+	memset(p, 'x', 768000);
+
+	// same size class, stays in place
+	char* same = arena.Shrink(p, 768000, 767000);
+	BOOST_CHECK(same == p);
+	BOOST_CHECK_EQUAL(arena.GetStats().requestedBytes, 767000u);
+
+	// smaller class, data is moved
+	char* moved = arena.Shrink(same, 767000, 300000);
+	BOOST_CHECK(moved != p);
+	BOOST_CHECK_EQUAL(moved[0], 'x');
+	BOOST_CHECK_EQUAL(moved[299999], 'x');
+	BOOST_CHECK_EQUAL(arena.GetStats().slotBytes, SlabArena::SlotSize(300000));
+	BOOST_CHECK_EQUAL(arena.GetStats().requestedBytes, 300000u);
+
+	arena.Free(moved, 300000);
+	BOOST_CHECK_EQUAL(arena.GetStats().usedSlabs, 0);
+}
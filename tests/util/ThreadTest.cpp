@@ -0,0 +1,112 @@
+/*
+ *  This file is part of nzbget. See <https://nzbget.com>.
+ *
+ *  Copyright (C) 2025 Denis <denis@nzbget.com>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <https://www.gnu.org/licenses/>.
+ */
+
+
+#include "nzbget.h"
+
+#include <boost/test/unit_test.hpp>
+
+#include "Thread.h"
+#include "Util.h"
+
+class CountingThread : public Thread
+{
+public:
+	CountingThread(std::atomic<int>& counter) : m_counter(counter) {}
+
+protected:
+	void Run() override
+	{
+		Util::Sleep(10);
+		m_counter++;
+	}
+
+private:
+	std::atomic<int>& m_counter;
+};
+
+BOOST_AUTO_TEST_CASE(ThreadPoolTest)
+{
+	std::atomic<int> counter{0};
+	ThreadPool pool;
+
+	for (int i = 0; i < 20; i++)
+	{
+		CountingThread* thread = new CountingThread(counter);
+		thread->SetAutoDestroy(true);
+		thread->StartPooled(&pool);
+	}
+
+	for (int i = 0; i < 500 && counter < 20; i++)
+	{
+		Util::Sleep(10);
+	}
+
+	BOOST_CHECK_EQUAL(counter, 20);
+	BOOST_CHECK(pool.GetWorkerCount() > 0);
+	BOOST_CHECK(pool.GetWorkerCount() <= 20);
+
+	// idle workers are reused for new jobs
+	int workers = pool.GetWorkerCount();
+	for (int i = 0; i < workers; i++)
+	{
+		Util::Sleep(20);
+		CountingThread* thread = new CountingThread(counter);
+		thread->SetAutoDestroy(true);
+		thread->StartPooled(&pool);
+	}
+	for (int i = 0; i < 500 && counter < 20 + workers; i++)
+	{
+		Util::Sleep(10);
+	}
+
+	BOOST_CHECK_EQUAL(counter, 20 + workers);
+	BOOST_CHECK_EQUAL(pool.GetWorkerCount(), workers);
+
+	pool.Shutdown();
+	BOOST_CHECK_EQUAL(pool.GetWorkerCount(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(BoundedThreadPoolTest)
+{
+	std::atomic<int> counter{0};
+	ThreadPool pool(60, 3);
+
+	for (int i = 0; i < 20; i++)
+	{
+		CountingThread* thread = new CountingThread(counter);
+		thread->SetAutoDestroy(true);
+		thread->StartPooled(&pool);
+	}
+
+	BOOST_CHECK(pool.GetWorkerCount() <= 3);
+	BOOST_CHECK(pool.GetQueueLength() > 0);
+
+	for (int i = 0; i < 500 && counter < 20; i++)
+	{
+		Util::Sleep(10);
+	}
+
+	BOOST_CHECK_EQUAL(counter, 20);
+	BOOST_CHECK_EQUAL(pool.GetWorkerCount(), 3);
+	BOOST_CHECK_EQUAL(pool.GetQueueLength(), 0);
+
+	pool.Shutdown();
+	BOOST_CHECK_EQUAL(pool.GetWorkerCount(), 0);
+}